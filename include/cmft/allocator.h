@@ -74,11 +74,74 @@ namespace cmft
     #   define CMFT_POP(_stackAllocator)  (_stackAllocator)->pop(0, 0)
     #endif // CMFT_ALLOCATOR_DEBUG
 
+    /// Allocations aligned above natural alignment store the offset to the original
+    /// malloc'ed pointer in the 4 bytes preceding the returned pointer.
+    static inline void* alignedAlloc(size_t _size, size_t _align)
+    {
+        uint8_t* ptr = (uint8_t*)::malloc(_size + _align + sizeof(uint32_t));
+        if (NULL == ptr)
+        {
+            return NULL;
+        }
+
+        const size_t mask = _align-1;
+        uint8_t* aligned = (uint8_t*)((size_t(ptr) + sizeof(uint32_t) + mask) & ~mask);
+        uint32_t* header = (uint32_t*)aligned - 1;
+        *header = uint32_t(aligned - ptr);
+
+        return aligned;
+    }
+
+    static inline void alignedFree(void* _ptr)
+    {
+        uint8_t* aligned = (uint8_t*)_ptr;
+        uint32_t* header = (uint32_t*)aligned - 1;
+        ::free(aligned - *header);
+    }
+
+    static inline void* alignedRealloc(void* _ptr, size_t _size, size_t _align)
+    {
+        uint8_t* aligned = (uint8_t*)_ptr;
+        const uint32_t offset = *((uint32_t*)aligned - 1);
+        uint8_t* ptr = (uint8_t*)::realloc(aligned - offset, _size + _align + sizeof(uint32_t));
+        if (NULL == ptr)
+        {
+            return NULL;
+        }
+
+        // Realloc might have moved the block to a differently aligned address.
+        const size_t mask = _align-1;
+        uint8_t* newAligned = (uint8_t*)((size_t(ptr) + sizeof(uint32_t) + mask) & ~mask);
+        const uint32_t newOffset = uint32_t(newAligned - ptr);
+        if (newOffset != offset)
+        {
+            memmove(newAligned, ptr + offset, _size);
+        }
+        *((uint32_t*)newAligned - 1) = newOffset;
+
+        return newAligned;
+    }
+
     struct CrtAllocator : AllocatorI
     {
         virtual void* realloc(void* _ptr, size_t _size, size_t _align, const char* /*_file*/, size_t /*_line*/)
         {
-            (void)_align; // Ignoring alignment for now.
+            if (_align > CMFT_CONFIG_ALLOCATOR_NATURAL_ALIGNMENT)
+            {
+                if (0 == _ptr)
+                {
+                    return alignedAlloc(_size, _align);
+                }
+                else if (0 == _size)
+                {
+                    alignedFree(_ptr);
+                    return NULL;
+                }
+                else
+                {
+                    return alignedRealloc(_ptr, _size, _align);
+                }
+            }
 
             if (0 == _ptr)
             {
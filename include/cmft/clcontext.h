@@ -30,6 +30,24 @@ namespace cmft
     void    clPrintDevices();
     int32_t clUnload();
 
+    /// Directory in which built OpenCL programs are stored, keyed by device name, driver version and
+    /// program source. Following runs load the binaries instead of compiling the source again.
+    /// Pass NULL to disable the disk cache, which is the default.
+    void    clSetProgramCacheDir(const char* _dir);
+
+    /// Counts programs acquired since the start of the process. m_hits were already built on the same context,
+    /// m_diskHits were loaded from the cache dir and m_misses were compiled from source, of which m_diskWrites
+    /// were stored to the cache dir.
+    struct ClProgramCacheStats
+    {
+        uint64_t m_hits;
+        uint64_t m_diskHits;
+        uint64_t m_misses;
+        uint64_t m_diskWrites;
+    };
+
+    void    clProgramCacheGetStats(ClProgramCacheStats& _stats);
+
 
     // ClContext.
     //-----
@@ -11,21 +11,50 @@
 
 namespace cmft
 {
-    #define SH_COEFF_NUM 25
+    /// Spherical harmonics of bands 0..L have (L+1)^2 coefficients, ordered by band and within a band
+    /// from m = -l to m = l. Default order is L4 with SH_COEFF_NUM coefficients, L2 has 9.
+    #define SH_COEFF_NUM     25
+    #define SH_MAX_BAND      8
+    #define SH_MAX_COEFF_NUM ((SH_MAX_BAND+1)*(SH_MAX_BAND+1))
 
-    /// Computes spherical harominics coefficients for given cubemap data.
-    /// Input data should be in RGBA32F format.
-    void cubemapShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], void* _data, uint32_t _faceSize, uint32_t _faceOffsets[6]);
+    static inline uint32_t shCoeffNum(uint8_t _maxBand)
+    {
+        return (uint32_t(_maxBand)+1)*(uint32_t(_maxBand)+1);
+    }
+
+    /// Computes spherical harominics coefficients of bands 0.._maxBand for given cubemap data into the first
+    /// shCoeffNum(_maxBand) entries of _shCoeffs. Returns false when _maxBand is bigger than SH_MAX_BAND.
+    /// Input data should be in RGBA32F format. Faces are projected in row bands on the thread pool,
+    /// basis is evaluated in float and summed in double. Results do not depend on the number of threads.
+    /// Partial sums of the row bands are allocated with _allocator.
+    bool cubemapShCoeffs(double _shCoeffs[][3], uint8_t _maxBand, void* _data, uint32_t _faceSize, uint32_t _faceOffsets[6], AllocatorI* _allocator = g_allocator);
+    bool cubemapShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], void* _data, uint32_t _faceSize, uint32_t _faceOffsets[6], AllocatorI* _allocator = g_allocator);
+
+    /// Computes spherical harominics coefficients of bands 0.._maxBand for given cubemap image, projecting mip level _mip.
+    /// Returns false when the image is not a cubemap, has no such mip or _maxBand is bigger than SH_MAX_BAND.
+    bool imageShCoeffs(double _shCoeffs[][3], uint8_t _maxBand, const Image& _image, AllocatorI* _allocator = g_allocator, uint8_t _mip = 0);
+    bool imageShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], const Image& _image, AllocatorI* _allocator = g_allocator, uint8_t _mip = 0);
 
-    /// Computes spherical harominics coefficients for given cubemap image.
-    bool imageShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], const Image& _image, AllocatorI* _allocator = g_allocator);
+    /// Rotates spherical harmonics coefficients of bands 0.._maxBand, so they describe the environment rotated by
+    /// _rotation, which is a row major 3x3 rotation matrix. Radiance coming from direction d is moved to _rotation*d.
+    /// Costs O(_maxBand^4), independent of the cubemap size. _dst and _src may be the same array.
+    /// Returns false when _maxBand is bigger than SH_MAX_BAND.
+    bool shCoeffsRotate(double _dst[][3], const double _src[][3], uint8_t _maxBand, const float _rotation[9]);
 
     /// Creates irradiance cubemap. Uses fast spherical harmonics implementation.
+    /// Output texels are reconstructed on the thread pool from a basis table of the output face size,
+    /// which is kept in the table cache when it fits.
     bool imageIrradianceFilterSh(Image& _dst, uint32_t _dstFaceSize, const Image& _src, AllocatorI* _allocator = g_allocator);
 
     /// Converts cubemap image into irradiance cubemap. Uses fast spherical harmonics implementation.
     void imageIrradianceFilterSh(Image& _image, uint32_t _faceSize, AllocatorI* _allocator = g_allocator);
 
+    /// Phong and Blinn lobes are integrated over every source texel in the filter area of each output texel.
+    /// Ggx is the Trowbridge-Reitz lobe with roughness sqrt(2/(specularPower+2)) of each mip, assuming that
+    /// view direction equals the normal. It is evaluated by filtered importance sampling: a fixed set of
+    /// samples per mip, each read from a mipmapped source at the level that matches its solid angle.
+    /// Cost is proportional to the number of samples instead of the lobe size, see m_ggxSamples.
+    /// Ggx is filtered on cpu only.
     struct LightingModel
     {
         enum Enum
@@ -34,6 +63,7 @@ namespace cmft
             PhongBrdf,
             Blinn,
             BlinnBrdf,
+            Ggx,
 
             Count
         };
@@ -66,12 +96,185 @@ namespace cmft
         };
     };
 
+    /// Memory layout of the normal/solid angle table and the source data that the radiance filter reads.
+    ///   Interleaved - (x,y,z,solidAngle) and (r,g,b,a) float4 per texel. Default.
+    ///   Planar      - separate x,y,z,solidAngle and r,g,b float planes per face, rows aligned to 64 bytes.
+    ///                 Alpha is never read and rows can be loaded with straight vector loads. Opt in.
+    ///                 Applies to RGBA32F sources, RGBA16F and RGBE sources are read interleaved.
+    struct TableLayout
+    {
+        enum Enum
+        {
+            Interleaved,
+            Planar,
+
+            Count
+        };
+    };
+
+    /// Evaluation of the specular lobe weight pow(cos, specularPower) in cpu kernels.
+    ///   Precise - powf() in scalar kernels and a float accurate log2/exp2 in simd kernels.
+    ///   Fast    - division free log2/exp2 polynomials in simd kernels, scalar kernels keep powf().
+    ///             Max relative error of a single weight is 1e-4 over the filtered lobe.
+    ///             OpenCL device always uses native_powr().
+    struct LobeMath
+    {
+        enum Enum
+        {
+            Precise,
+            Fast,
+
+            Count
+        };
+    };
+
+    /// Source of texel directions and solid angles in cpu kernels.
+    ///   Auto     - Computed for source faces of at least 1024 texels (2048 with TableLayout::Planar),
+    ///              Table for smaller ones.
+    ///   Table    - read from a precomputed float4 table that is as large as the RGBA32F source.
+    ///   Computed - evaluated from texel coordinates, so kernels stream source data only. Solid angle
+    ///              is approximated at the texel center, relative error is 2.5e-4 at 64 texel faces
+    ///              and falls with the square of face size. OpenCL device reads the table
+    ///              unless DeviceFormat::Half is used.
+    struct TexelNormals
+    {
+        enum Enum
+        {
+            Auto,
+            Table,
+            Computed,
+
+            Count
+        };
+    };
+
+    /// Summation of weighted texels in cpu kernels.
+    ///   Float  - float sums over the whole filter area.
+    ///   Double - scalar kernels sum in double. Simd kernels sum each source row in float lanes
+    ///            and add row sums in double, which keeps their full width.
+    ///   Compensated - each source row is summed in float, simd lanes are assigned by texel column, and row
+    ///            sums are added in fixed row order with compensated (Kahan-Babuska) float summation. Close to
+    ///            Double accuracy at Float speed, and the result does not depend on tile culling or threads.
+    struct Accumulation
+    {
+        enum Enum
+        {
+            Float,
+            Double,
+            Compensated,
+
+            Count
+        };
+    };
+
+    /// Texel format of OpenCL device images.
+    ///   Auto  - Half when every cubemap of a batch is RGBA16F or when Float images of the largest one do not
+    ///           fit device memory, Float otherwise.
+    ///   Float - RGBA32F source, normal/solid angle table and output images.
+    ///   Half  - RGBA16F source images. Texel normals and solid angles are computed on the device, as with
+    ///           TexelNormals::Computed, instead of read from a table. Source takes a quarter of the Float
+    ///           device memory and upload. Rows of RGBA16F targets are filtered into RGBA16F output images,
+    ///           which halves readback. Source values above 65504 are clamped.
+    struct DeviceFormat
+    {
+        enum Enum
+        {
+            Auto,
+            Float,
+            Half,
+
+            Count
+        };
+    };
+
+    /// Optional radiance filter settings. Defaults match the behaviour when no options are passed.
+    ///
+    /// m_sourceMipThreshold - Each destination mip is filtered from the coarsest level of a box filtered source
+    ///                        pyramid whose texel angle is at most m_sourceMipThreshold * filter angle of that mip.
+    ///                        Smaller is more accurate and slower, 0.0 filters every mip from the full resolution
+    ///                        source. Values around 0.1 are visually lossless. OpenCL device always reads the full
+    ///                        resolution source.
+    ///
+    /// m_tileCulling        - Skip 8x8 texel tiles whose normals are all outside of the specular lobe and
+    ///                        skip the per texel lobe test for tiles that are all inside of it. Filter areas
+    ///                        are already tight for the default lobes, so this only pays off when a large
+    ///                        part of them is rejected.
+    ///
+    /// m_lobeMath           - See LobeMath.
+    ///
+    /// m_texelNormals       - See TexelNormals.
+    ///
+    /// m_accumulation       - See Accumulation.
+    ///
+    /// m_ggxSamples         - Number of importance samples per output texel of LightingModel::Ggx.
+    ///                        Other options do not apply to Ggx.
+    ///
+    /// m_deviceFormat       - See DeviceFormat.
+    ///
+    /// m_shPowerThreshold   - Mips whose specular power is below m_shPowerThreshold are not filtered texel by
+    ///                        texel. Source is projected once to SH bands 0..SH_MAX_BAND, coefficients of each
+    ///                        band are scaled by the zonal coefficient of the lobe and the mip is reconstructed
+    ///                        from them, so its cost does not depend on the filter area. Lobe energy above
+    ///                        SH_MAX_BAND is lost, which stays below 1% for powers up to 8. Values above 8.0
+    ///                        are clamped to it with a warning. 0.0 filters every mip texel by texel.
+    ///                        Projecting the source costs about as much as filtering a few small rough mips,
+    ///                        so SH is used only when the estimated work of the mips it replaces outweighs
+    ///                        it. Small sources, or rough mips only a few texels wide, keep being filtered
+    ///                        texel by texel. Does not apply to Ggx.
+    ///
+    struct RadianceFilterOptions
+    {
+        RadianceFilterOptions()
+            : m_tableLayout(TableLayout::Interleaved)
+            , m_sourceMipThreshold(0.0f)
+            , m_tileCulling(false)
+            , m_lobeMath(LobeMath::Precise)
+            , m_texelNormals(TexelNormals::Auto)
+            , m_accumulation(Accumulation::Float)
+            , m_ggxSamples(256)
+            , m_deviceFormat(DeviceFormat::Auto)
+            , m_shPowerThreshold(0.0f)
+        {
+        }
+
+        TableLayout::Enum m_tableLayout;
+        float m_sourceMipThreshold;
+        bool m_tileCulling;
+        LobeMath::Enum m_lobeMath;
+        TexelNormals::Enum m_texelNormals;
+        Accumulation::Enum m_accumulation;
+        uint16_t m_ggxSamples;
+        DeviceFormat::Enum m_deviceFormat;
+        float m_shPowerThreshold;
+    };
+
     /// Helper functions.
     float specularPowerFor(float _mip, float _mipCount, float _glossScale, float _glossBias);
     float applyLightningModel(float _specularPower, LightingModel::Enum _lightingModel);
 
     struct ClContext;
 
+    /// Scheduler state, precomputed tables and OpenCL program of the radiance filter.
+    /// Calls with different contexts can run concurrently, a single context is used by one call at a time.
+    struct RadianceFilterContext;
+
+    RadianceFilterContext* radianceFilterContextCreate();
+    void                   radianceFilterContextDestroy(RadianceFilterContext* _context);
+
+    /// Work done by cpu workers and the OpenCL device in the last call with a context. Rows of a face may be
+    /// split between both, the face is counted on the one that filtered its last rows. SH mips are not counted.
+    /// m_deviceFormat is the format of device images, DeviceFormat::Auto when the device filtered no rows.
+    struct RadianceFilterStats
+    {
+        uint32_t m_cpuFaces;
+        uint32_t m_gpuFaces;
+        uint32_t m_cpuRows;
+        uint32_t m_gpuRows;
+        DeviceFormat::Enum m_deviceFormat;
+    };
+
+    void radianceFilterContextGetStats(const RadianceFilterContext* _context, RadianceFilterStats& _stats);
+
     /// Creates radiance cubemap image.
     bool imageRadianceFilter(Image& _dst
                            , uint32_t _dstFaceSize
@@ -85,6 +288,7 @@ namespace cmft
                            , uint8_t _numCpuProcessingThreads = 0
                            , ClContext* _clContext = NULL
                            , AllocatorI* _allocator = g_allocator
+                           , const RadianceFilterOptions* _options = NULL
                            );
 
     /// Converts cubemap image into radiance cubemap.
@@ -99,8 +303,98 @@ namespace cmft
                            , uint8_t _numCpuProcessingThreads = 0
                            , ClContext* _clContext = NULL
                            , AllocatorI* _allocator = g_allocator
+                           , const RadianceFilterOptions* _options = NULL
                            );
 
+    /// Same as above, using given context. Functions without the context parameter use a temporary one.
+    bool imageRadianceFilter(RadianceFilterContext* _context
+                           , Image& _dst
+                           , uint32_t _dstFaceSize
+                           , LightingModel::Enum _lightingModel
+                           , bool _excludeBase
+                           , uint8_t _mipCount
+                           , uint8_t _glossScale
+                           , uint8_t _glossBias
+                           , const Image& _src
+                           , EdgeFixup::Enum _edgeFixup = EdgeFixup::None
+                           , uint8_t _numCpuProcessingThreads = 0
+                           , ClContext* _clContext = NULL
+                           , AllocatorI* _allocator = g_allocator
+                           , const RadianceFilterOptions* _options = NULL
+                           );
+
+    bool imageRadianceFilter(RadianceFilterContext* _context
+                           , Image& _image
+                           , uint32_t _dstFaceSize
+                           , LightingModel::Enum _lightingModel
+                           , bool _excludeBase
+                           , uint8_t _mipCount
+                           , uint8_t _glossScale
+                           , uint8_t _glossBias
+                           , EdgeFixup::Enum _edgeFixup = EdgeFixup::None
+                           , uint8_t _numCpuProcessingThreads = 0
+                           , ClContext* _clContext = NULL
+                           , AllocatorI* _allocator = g_allocator
+                           , const RadianceFilterOptions* _options = NULL
+                           );
+
+    /// Filters _count cubemaps _src[ii] into _dst[ii] with the same parameters, _dst may be the same array as _src.
+    /// OpenCL program is built once and faces of all cubemaps are processed by a single run of cpu workers and
+    /// the OpenCL device, so faces of small cubemaps and mips keep workers busy while others finish the large ones.
+    /// Source pyramids and tables of all cubemaps are kept in memory until the whole batch is done.
+    bool imageRadianceFilterBatch(Image* _dst
+                                , const Image* _src
+                                , uint32_t _count
+                                , uint32_t _dstFaceSize
+                                , LightingModel::Enum _lightingModel
+                                , bool _excludeBase
+                                , uint8_t _mipCount
+                                , uint8_t _glossScale
+                                , uint8_t _glossBias
+                                , EdgeFixup::Enum _edgeFixup = EdgeFixup::None
+                                , uint8_t _numCpuProcessingThreads = 0
+                                , ClContext* _clContext = NULL
+                                , AllocatorI* _allocator = g_allocator
+                                , const RadianceFilterOptions* _options = NULL
+                                );
+
+    bool imageRadianceFilterBatch(RadianceFilterContext* _context
+                                , Image* _dst
+                                , const Image* _src
+                                , uint32_t _count
+                                , uint32_t _dstFaceSize
+                                , LightingModel::Enum _lightingModel
+                                , bool _excludeBase
+                                , uint8_t _mipCount
+                                , uint8_t _glossScale
+                                , uint8_t _glossBias
+                                , EdgeFixup::Enum _edgeFixup = EdgeFixup::None
+                                , uint8_t _numCpuProcessingThreads = 0
+                                , ClContext* _clContext = NULL
+                                , AllocatorI* _allocator = g_allocator
+                                , const RadianceFilterOptions* _options = NULL
+                                );
+
+    /// Normal and solid angle tables, irradiance SH basis tables and OpenCL filter areas of each face size are kept in a process wide
+    /// cache, so filtering many cubemaps of the same size builds them once. Tables that are not used by any
+    /// running call are evicted in least recently used order when the cache grows over the max size.
+    struct TableCacheStats
+    {
+        uint64_t m_hits;
+        uint64_t m_misses;
+        uint64_t m_evictions;
+        uint64_t m_size;
+        uint64_t m_maxSize;
+        uint32_t m_numTables;
+    };
+
+    /// Default max size is 256 MB, 0 frees every table after use.
+    void tableCacheSetMaxSize(uint64_t _maxSize);
+    void tableCacheGetStats(TableCacheStats& _stats);
+
+    /// Frees all tables that are not in use.
+    void tableCacheClear();
+
 } // namespace cmft
 
 #endif // CMFT_CUBEMAPFILTER_H_HEADER_GUARD
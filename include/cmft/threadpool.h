@@ -0,0 +1,34 @@
+/*
+ * Copyright 2016 Dario Manesku. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef CMFT_THREADPOOL_H_HEADER_GUARD
+#define CMFT_THREADPOOL_H_HEADER_GUARD
+
+#include <stdint.h>
+
+namespace cmft
+{
+    /// Process wide worker threads used by all parallel cmft operations.
+    /// The pool is created on first use with one worker less than the number of hardware threads,
+    /// because the calling thread is also processing. Call threadPoolInit() before any other cmft
+    /// function to choose the number of workers, 0 makes all operations run on the calling thread.
+    /// After threadPoolShutdown() the pool is created again on next use.
+    /// Neither threadPoolInit() nor threadPoolShutdown() may be called while an operation is running.
+    bool    threadPoolInit(uint8_t _numWorkers);
+    void    threadPoolShutdown();
+    uint8_t threadPoolNumWorkers();
+
+    typedef void (*ThreadPoolTaskFn)(void* _userData, uint32_t _index);
+
+    /// Calls _fn(_userData, index) for each index in [0, _count) and returns when all calls are done.
+    /// Tasks are started in index order on the calling thread and on at most _maxWorkers pool workers.
+    /// Safe to call from multiple threads and from inside of a task.
+    void threadPoolRun(ThreadPoolTaskFn _fn, void* _userData, uint32_t _count, uint8_t _maxWorkers = UINT8_MAX);
+
+} // namespace cmft
+
+#endif //CMFT_THREADPOOL_H_HEADER_GUARD
+
+/* vim: set sw=4 ts=4 expandtab: */
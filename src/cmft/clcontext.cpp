@@ -7,9 +7,13 @@
 #include "common/cl.h"
 
 #include <cmft/clcontext.h>
+#include <cmft/allocator.h>
 #include "clcontext_internal.h"
 
 #include <stdint.h>
+#include <stdio.h>  // fopen, rename
+#include <string.h> // strlen
+#include <atomic>   // C++11
 
 #include "common/config.h"
 #include "common/utils.h"
@@ -158,15 +162,25 @@ namespace cmft
             }
         }
 
-        // Create command queue
+        // Create command queues. Kernels and transfers are on separate queues so they can overlap.
+        // Profiling is enabled for per stage timings.
         cl_command_queue commandQueue;
-        commandQueue = clCreateCommandQueue(context, chosenDevice, 0, &err);
+        commandQueue = clCreateCommandQueue(context, chosenDevice, CL_QUEUE_PROFILING_ENABLE, &err);
         if (CL_SUCCESS != err)
         {
             WARN("OpenCL context initialization failed!");
             return NULL;
         }
 
+        cl_command_queue transferQueue;
+        transferQueue = clCreateCommandQueue(context, chosenDevice, CL_QUEUE_PROFILING_ENABLE, &err);
+        if (CL_SUCCESS != err)
+        {
+            WARN("OpenCL context initialization failed!");
+            clReleaseCommandQueue(commandQueue);
+            return NULL;
+        }
+
         ClContext* clContext = s_clContextStorage.alloc();
 
         // Get device name, vendor and type.
@@ -175,13 +189,30 @@ namespace cmft
         char deviceName[128];
         CL_CHECK(clGetDeviceInfo(chosenDevice, CL_DEVICE_NAME, sizeof(deviceName), deviceName, NULL));
         CL_CHECK(clGetDeviceInfo(chosenDevice, CL_DEVICE_TYPE, sizeof(clContext->m_deviceType), &clContext->m_deviceType, NULL));
+        char driverVersion[128];
+        CL_CHECK(clGetDeviceInfo(chosenDevice, CL_DRIVER_VERSION, sizeof(driverVersion), driverVersion, NULL));
+        cl_ulong globalMemSize;
+        CL_CHECK(clGetDeviceInfo(chosenDevice, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemSize), &globalMemSize, NULL));
+        cl_ulong maxAllocSize;
+        CL_CHECK(clGetDeviceInfo(chosenDevice, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocSize), &maxAllocSize, NULL));
 
         // Fill structure.
         cmft::stracpy(clContext->m_deviceVendor, cmft::trim(deviceVendor));
         cmft::stracpy(clContext->m_deviceName, cmft::trim(deviceName));
+
+        // Driver version is a part of the program binary cache key. Copied with an explicit bound, strncat in
+        // stracpy() makes gcc warn about truncation of a buffer of the same size.
+        const char* trimmedDriverVersion = cmft::trim(driverVersion);
+        const size_t driverVersionLen = CMFT_MIN(strlen(trimmedDriverVersion), sizeof(clContext->m_driverVersion)-1);
+        memcpy(clContext->m_driverVersion, trimmedDriverVersion, driverVersionLen);
+        clContext->m_driverVersion[driverVersionLen] = '\0';
+
+        clContext->m_globalMemSize = globalMemSize;
+        clContext->m_maxAllocSize = maxAllocSize;
         clContext->m_device = chosenDevice;
         clContext->m_context = context;
         clContext->m_commandQueue = commandQueue;
+        clContext->m_transferQueue = transferQueue;
 
         return clContext;
     }
@@ -274,6 +305,18 @@ namespace cmft
             return;
         }
 
+        for (uint32_t ii = 0; ii < _clContext->m_numPrograms; ++ii)
+        {
+            clReleaseProgram(_clContext->m_programs[ii].m_program);
+        }
+        _clContext->m_numPrograms = 0;
+
+        if (NULL != _clContext->m_transferQueue)
+        {
+            clReleaseCommandQueue(_clContext->m_transferQueue);
+            _clContext->m_transferQueue = NULL;
+        }
+
         if (NULL != _clContext->m_commandQueue)
         {
             clReleaseCommandQueue(_clContext->m_commandQueue);
@@ -289,6 +332,262 @@ namespace cmft
         s_clContextStorage.free(_clContext);
     }
 
+    // Program cache.
+    //-----
+
+    static char s_programCacheDir[CMFT_PATH_LEN] = "";
+
+    static std::atomic<uint64_t> s_programCacheHits(0);
+    static std::atomic<uint64_t> s_programCacheDiskHits(0);
+    static std::atomic<uint64_t> s_programCacheMisses(0);
+    static std::atomic<uint64_t> s_programCacheDiskWrites(0);
+
+    void clSetProgramCacheDir(const char* _dir)
+    {
+        if (NULL == _dir)
+        {
+            s_programCacheDir[0] = '\0';
+        }
+        else
+        {
+            cmft::stracpy(s_programCacheDir, _dir);
+        }
+    }
+
+    void clProgramCacheGetStats(ClProgramCacheStats& _stats)
+    {
+        _stats.m_hits       = s_programCacheHits;
+        _stats.m_diskHits   = s_programCacheDiskHits;
+        _stats.m_misses     = s_programCacheMisses;
+        _stats.m_diskWrites = s_programCacheDiskWrites;
+    }
+
+    static inline uint64_t hashFnv1a(const void* _data, size_t _size, uint64_t _hash = UINT64_C(0xcbf29ce484222325))
+    {
+        const uint8_t* data = (const uint8_t*)_data;
+        for (size_t ii = 0; ii < _size; ++ii)
+        {
+            _hash ^= data[ii];
+            _hash *= UINT64_C(0x100000001b3);
+        }
+
+        return _hash;
+    }
+
+    #define CL_BINARY_MAGIC CMFT_MAKEFOURCC('C', 'M', 'C', 'L')
+
+    struct ClBinaryHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_reserved;
+        uint64_t m_key;
+        uint64_t m_size;
+        uint64_t m_hash;
+    };
+
+    static cl_program clProgramBuildFromSource(const ClContext* _clContext, const char* _source, size_t _sourceSize)
+    {
+        cl_int err;
+
+        // Create program.
+        const char* sources[1] = { _source };
+        const size_t sizes[1] = { _sourceSize };
+        cl_program program = clCreateProgramWithSource(_clContext->m_context, 1, sources, sizes, &err);
+        if (CL_SUCCESS != err)
+        {
+            WARN("Could not create OpenCL program. OpenCL source file probably missing!");
+            return NULL;
+        }
+
+        // Build program.
+        err = clBuildProgram(program, 1, &_clContext->m_device, NULL, NULL, NULL);
+        if (CL_SUCCESS != err)
+        {
+            // Print error.
+            char buffer[1024*16];
+            clGetProgramBuildInfo(program, _clContext->m_device, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, NULL);
+            WARN("CL Compilation failed:\n%s", buffer);
+
+            clReleaseProgram(program);
+            return NULL;
+        }
+
+        return program;
+    }
+
+    // Returns NULL when the file is missing, stale or rejected by the driver.
+    static cl_program clProgramLoadBinary(const ClContext* _clContext, const char* _filePath, uint64_t _key)
+    {
+        FILE* fp = fopen(_filePath, "rb");
+        if (NULL == fp)
+        {
+            return NULL;
+        }
+
+        cl_program program = NULL;
+
+        ClBinaryHeader header;
+        if (1 == fread(&header, sizeof(header), 1, fp)
+        &&  CL_BINARY_MAGIC == header.m_magic
+        &&  _key == header.m_key
+        &&  0 != header.m_size
+        &&  header.m_size == uint64_t(cmft::fsize(fp)-sizeof(header)))
+        {
+            const size_t size = size_t(header.m_size);
+            unsigned char* binary = (unsigned char*)CMFT_ALLOC(g_allocator, size);
+            MALLOC_CHECK(binary);
+
+            if (1 == fread(binary, size, 1, fp)
+            &&  header.m_hash == hashFnv1a(binary, size))
+            {
+                const unsigned char* binaries[1] = { binary };
+                cl_int status = CL_SUCCESS;
+                cl_int err;
+                program = clCreateProgramWithBinary(_clContext->m_context, 1, &_clContext->m_device, &size, binaries, &status, &err);
+
+                if (NULL != program
+                && (CL_SUCCESS != err || CL_SUCCESS != status || CL_SUCCESS != clBuildProgram(program, 1, &_clContext->m_device, NULL, NULL, NULL)))
+                {
+                    clReleaseProgram(program);
+                    program = NULL;
+                }
+            }
+
+            CMFT_FREE(g_allocator, binary);
+        }
+
+        fclose(fp);
+
+        return program;
+    }
+
+    // Returns true when the binary was written.
+    static bool clProgramSaveBinary(cl_program _program, const char* _filePath, uint64_t _key)
+    {
+        size_t size = 0;
+        if (CL_SUCCESS != clGetProgramInfo(_program, CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, NULL)
+        ||  0 == size)
+        {
+            return false;
+        }
+
+        bool saved = false;
+
+        unsigned char* binary = (unsigned char*)CMFT_ALLOC(g_allocator, size);
+        MALLOC_CHECK(binary);
+
+        unsigned char* binaries[1] = { binary };
+        if (CL_SUCCESS == clGetProgramInfo(_program, CL_PROGRAM_BINARIES, sizeof(binaries), binaries, NULL))
+        {
+            ClBinaryHeader header;
+            header.m_magic    = CL_BINARY_MAGIC;
+            header.m_reserved = 0;
+            header.m_key      = _key;
+            header.m_size     = size;
+            header.m_hash     = hashFnv1a(binary, size);
+
+            // Write next to the destination and rename, so other processes never read a partial file.
+            char tmpPath[CMFT_PATH_LEN];
+            snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", _filePath);
+
+            FILE* fp = fopen(tmpPath, "wb");
+            if (NULL != fp)
+            {
+                const bool written = (1 == fwrite(&header, sizeof(header), 1, fp))
+                                  && (1 == fwrite(binary, size, 1, fp));
+                fclose(fp);
+
+                remove(_filePath);
+                saved = written && 0 == rename(tmpPath, _filePath);
+                if (!saved)
+                {
+                    remove(tmpPath);
+                    WARN("Could not write OpenCL program binary %s.", _filePath);
+                }
+            }
+            else
+            {
+                WARN("Could not open file %s for writing.", tmpPath);
+            }
+        }
+
+        CMFT_FREE(g_allocator, binary);
+
+        return saved;
+    }
+
+    cl_program clProgramAcquire(ClContext* _clContext, const char* _source, size_t _sourceSize)
+    {
+        const uint64_t sourceHash = hashFnv1a(_source, _sourceSize);
+
+        std::lock_guard<std::mutex> lock(_clContext->m_programAccess);
+
+        // Program was already built on this context.
+        for (uint32_t ii = 0; ii < _clContext->m_numPrograms; ++ii)
+        {
+            if (sourceHash == _clContext->m_programs[ii].m_key)
+            {
+                cl_program program = _clContext->m_programs[ii].m_program;
+                clRetainProgram(program);
+                s_programCacheHits++;
+                return program;
+            }
+        }
+
+        // Binaries are valid only for the device and driver they were built with.
+        char filePath[CMFT_PATH_LEN];
+        filePath[0] = '\0';
+
+        uint64_t binaryKey = hashFnv1a(_clContext->m_deviceName, strlen(_clContext->m_deviceName));
+        binaryKey = hashFnv1a(_clContext->m_driverVersion, strlen(_clContext->m_driverVersion), binaryKey);
+        binaryKey = hashFnv1a(&sourceHash, sizeof(sourceHash), binaryKey);
+
+        cl_program program = NULL;
+        if ('\0' != s_programCacheDir[0])
+        {
+            snprintf(filePath, sizeof(filePath), "%s/cmft_%08x%08x.clbin"
+                    , s_programCacheDir
+                    , uint32_t(binaryKey>>32)
+                    , uint32_t(binaryKey)
+                    );
+
+            program = clProgramLoadBinary(_clContext, filePath, binaryKey);
+            if (NULL != program)
+            {
+                INFO("Loaded OpenCL program binary %s.", filePath);
+                s_programCacheDiskHits++;
+            }
+        }
+
+        if (NULL == program)
+        {
+            program = clProgramBuildFromSource(_clContext, _source, _sourceSize);
+            if (NULL == program)
+            {
+                return NULL;
+            }
+
+            s_programCacheMisses++;
+
+            if ('\0' != filePath[0]
+            &&  clProgramSaveBinary(program, filePath, binaryKey))
+            {
+                s_programCacheDiskWrites++;
+            }
+        }
+
+        // Context keeps its own reference.
+        if (_clContext->m_numPrograms < ClContext::MaxPrograms)
+        {
+            clRetainProgram(program);
+            _clContext->m_programs[_clContext->m_numPrograms].m_key     = sourceHash;
+            _clContext->m_programs[_clContext->m_numPrograms].m_program = program;
+            _clContext->m_numPrograms++;
+        }
+
+        return program;
+    }
+
 } // namespace cmft
 
 /* vim: set sw=4 ts=4 expandtab: */
@@ -8,6 +8,9 @@
 
 #include "common/cl.h"
 
+#include <stdint.h>
+#include <mutex> // C++11
+
 namespace cmft
 {
     struct ClContext
@@ -17,18 +20,47 @@ namespace cmft
             m_device = NULL;
             m_context = NULL;
             m_commandQueue = NULL;
+            m_transferQueue = NULL;
             m_deviceVendor[0] = '\0';
             m_deviceName[0] = '\0';
+            m_driverVersion[0] = '\0';
+            m_globalMemSize = 0;
+            m_maxAllocSize = 0;
+            m_numPrograms = 0;
         }
 
+        enum { MaxPrograms = 8 };
+
+        struct CachedProgram
+        {
+            uint64_t m_key;
+            cl_program m_program;
+        };
+
         cl_device_id m_device;
         cl_context m_context;
         cl_command_queue m_commandQueue;
+        cl_command_queue m_transferQueue; // Uploads and readbacks, overlapping with kernels on m_commandQueue.
         cl_device_type m_deviceType;
         char m_deviceVendor[128];
         char m_deviceName[128];
+        char m_driverVersion[128];
+        uint64_t m_globalMemSize;
+        uint64_t m_maxAllocSize;
+
+        // Programs built on this context, released by clDestroy().
+        CachedProgram m_programs[MaxPrograms];
+        uint32_t m_numPrograms;
+        std::mutex m_programAccess;
     };
 
+    /// Returns program built from given source for the device of given context and NULL on failure.
+    /// Programs are kept alive until the context is destroyed, so building the same source again is
+    /// free. When clSetProgramCacheDir() was called, device binaries are also stored there and loaded by
+    /// following processes instead of compiling the source. The returned reference is released
+    /// with clReleaseProgram().
+    cl_program clProgramAcquire(ClContext* _clContext, const char* _source, size_t _sourceSize);
+
 } // namespace cmft
 
 #endif //CMFT_CLCONTEXT_INTERNAL_H_HEADER_GUARD
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2014-2015 Dario Manesku. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef CMFT_CPU_H_HEADER_GUARD
+#define CMFT_CPU_H_HEADER_GUARD
+
+#include <stdint.h>
+#include "platform.h"
+
+// Instruction sets that the compiler is able to generate code for.
+// Whether the host cpu actually supports them is checked at runtime with cpuFeatures().
+// Other architectures than x86 use scalar code only.
+//-----
+
+#if !CMFT_ARCH_X86
+#   define CMFT_SIMD_COMPILER_SUPPORT 0
+#elif defined(__clang__)
+#   define CMFT_SIMD_COMPILER_SUPPORT (__clang_major__ >= 9) // Needs '#pragma clang attribute'.
+#elif defined(__GNUC__)
+#   define CMFT_SIMD_COMPILER_SUPPORT ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#elif defined(_MSC_VER)
+#   define CMFT_SIMD_COMPILER_SUPPORT (_MSC_VER >= 1700)
+#else
+#   define CMFT_SIMD_COMPILER_SUPPORT 0
+#endif
+
+#ifndef CMFT_SIMD_SSE41
+#   define CMFT_SIMD_SSE41 CMFT_SIMD_COMPILER_SUPPORT
+#endif //CMFT_SIMD_SSE41
+
+#ifndef CMFT_SIMD_AVX2
+#   define CMFT_SIMD_AVX2 CMFT_SIMD_COMPILER_SUPPORT
+#endif //CMFT_SIMD_AVX2
+
+#ifndef CMFT_SIMD_AVX512
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define CMFT_SIMD_AVX512 (_MSC_VER >= 1910)
+#   else
+#       define CMFT_SIMD_AVX512 CMFT_SIMD_COMPILER_SUPPORT
+#   endif
+#endif //CMFT_SIMD_AVX512
+
+#if !CMFT_ARCH_X86
+#   undef  CMFT_SIMD_SSE41
+#   define CMFT_SIMD_SSE41 0
+#   undef  CMFT_SIMD_AVX2
+#   define CMFT_SIMD_AVX2 0
+#   undef  CMFT_SIMD_AVX512
+#   define CMFT_SIMD_AVX512 0
+#endif //!CMFT_ARCH_X86
+
+#if CMFT_ARCH_X86 && defined(_MSC_VER)
+#   include <intrin.h> // __cpuid, __cpuidex, _xgetbv
+#elif CMFT_ARCH_X86 && defined(__GNUC__)
+#   include <cpuid.h>  // __cpuid, __cpuid_count
+#endif
+
+namespace cmft
+{
+    struct CpuFeature
+    {
+        enum Enum
+        {
+            Sse41   = 0x1,
+            Avx2    = 0x2,
+            Fma     = 0x4,
+            Avx512f = 0x8,
+            F16c    = 0x10,
+        };
+    };
+
+    static inline void cpuId(uint32_t _regs[4], uint32_t _leaf, uint32_t _subLeaf = 0)
+    {
+    #if CMFT_ARCH_X86 && defined(_MSC_VER)
+        int regs[4];
+        __cpuidex(regs, int(_leaf), int(_subLeaf));
+        _regs[0] = uint32_t(regs[0]);
+        _regs[1] = uint32_t(regs[1]);
+        _regs[2] = uint32_t(regs[2]);
+        _regs[3] = uint32_t(regs[3]);
+    #elif CMFT_ARCH_X86 && defined(__GNUC__)
+        __cpuid_count(_leaf, _subLeaf, _regs[0], _regs[1], _regs[2], _regs[3]);
+    #else
+        _regs[0] = _regs[1] = _regs[2] = _regs[3] = 0;
+        (void)_leaf;
+        (void)_subLeaf;
+    #endif
+    }
+
+    /// Returns OS enabled register state (XCR0). Call only when OSXSAVE bit is set.
+    static inline uint64_t cpuXgetbv()
+    {
+    #if CMFT_ARCH_X86 && defined(_MSC_VER)
+        return uint64_t(_xgetbv(0));
+    #elif CMFT_ARCH_X86 && defined(__GNUC__)
+        uint32_t eax, edx;
+        __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0)); // xgetbv
+        return (uint64_t(edx)<<32) | eax;
+    #else
+        return 0;
+    #endif
+    }
+
+    /// Returns a combination of CpuFeature flags supported by both the cpu and the os, 0 on other
+    /// architectures than x86.
+    static inline uint32_t cpuFeatures()
+    {
+        uint32_t result = 0;
+        if (!CMFT_ARCH_X86)
+        {
+            return result;
+        }
+
+        uint32_t regs[4];
+        cpuId(regs, 0);
+        const uint32_t maxLeaf = regs[0];
+        if (maxLeaf < 1)
+        {
+            return result;
+        }
+
+        cpuId(regs, 1);
+        const bool sse41   = 0 != (regs[2] & (1<<19));
+        const bool fma     = 0 != (regs[2] & (1<<12));
+        const bool f16c    = 0 != (regs[2] & (1<<29));
+        const bool osxsave = 0 != (regs[2] & (1<<27));
+        const bool avx     = 0 != (regs[2] & (1<<28));
+
+        if (sse41)
+        {
+            result |= CpuFeature::Sse41;
+        }
+
+        // Avx registers have to be enabled by the os.
+        if (!osxsave || !avx)
+        {
+            return result;
+        }
+
+        const uint64_t xcr0 = cpuXgetbv();
+        const bool osYmm = (xcr0 & 0x06) == 0x06; // xmm|ymm
+        const bool osZmm = (xcr0 & 0xe6) == 0xe6; // xmm|ymm|opmask|zmm_hi256|hi16_zmm
+        if (!osYmm || maxLeaf < 7)
+        {
+            return result;
+        }
+
+        if (fma)
+        {
+            result |= CpuFeature::Fma;
+        }
+
+        if (f16c)
+        {
+            result |= CpuFeature::F16c;
+        }
+
+        cpuId(regs, 7, 0);
+        if (0 != (regs[1] & (1<<5)))
+        {
+            result |= CpuFeature::Avx2;
+        }
+
+        if (osZmm && 0 != (regs[1] & (1<<16)))
+        {
+            result |= CpuFeature::Avx512f;
+        }
+
+        return result;
+    }
+
+} // namespace cmft
+
+#endif //CMFT_CPU_H_HEADER_GUARD
+
+/* vim: set sw=4 ts=4 expandtab: */
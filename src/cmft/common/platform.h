@@ -18,6 +18,7 @@
 
 #define CMFT_ARCH_32BIT 0
 #define CMFT_ARCH_64BIT 0
+#define CMFT_ARCH_X86 0
 
 #define CMFT_PTR_SIZE 0
 
@@ -55,6 +56,8 @@
     || defined (_M_AMD64)   )
 #   undef CMFT_ARCH_64BIT
 #   define CMFT_ARCH_64BIT 1
+#   undef CMFT_ARCH_X86
+#   define CMFT_ARCH_X86 1
 #   undef CMFT_PTR_SIZE
 #   define CMFT_PTR_SIZE 8
 #elif (0                   \
@@ -69,6 +72,23 @@
       || defined(__X86__)  )
 #   undef CMFT_ARCH_32BIT
 #   define CMFT_ARCH_32BIT 1
+#   undef CMFT_ARCH_X86
+#   define CMFT_ARCH_X86 1
+#   undef CMFT_PTR_SIZE
+#   define CMFT_PTR_SIZE 4
+#elif (0                     \
+      || defined(__aarch64__) \
+      || defined(__arm64__)   \
+      || defined(_M_ARM64)    )
+#   undef CMFT_ARCH_64BIT
+#   define CMFT_ARCH_64BIT 1
+#   undef CMFT_PTR_SIZE
+#   define CMFT_PTR_SIZE 8
+#elif (0                 \
+      || defined(__arm__) \
+      || defined(_M_ARM)  )
+#   undef CMFT_ARCH_32BIT
+#   define CMFT_ARCH_32BIT 1
 #   undef CMFT_PTR_SIZE
 #   define CMFT_PTR_SIZE 4
 #else
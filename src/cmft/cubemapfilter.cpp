@@ -6,22 +6,26 @@
 #include "common/config.h"
 #include "common/utils.h"
 #include "common/timer.h"
+#include "common/handlealloc.h"
+#include "common/halffloat.h"
 
 #include <cmft/cubemapfilter.h>
 #include <cmft/clcontext.h>
 #include <cmft/allocator.h>
+#include <cmft/threadpool.h>
 
 #include "clcontext_internal.h"
 
 #include "cubemaputils.h"
+#include "radiancekernel.h"
 #include "radiance.h"
 
 #include <string.h>       //memset
 #include <math.h>         //pow, sqrt
 #include <float.h>        //FLT_MAX
 
-#include <thread> // C++11
 #include <mutex>  // C++11
+#include <atomic> // C++11
 
 #define CMFT_COMPUTE_FILTER_AREA_ON_CPU 1
 
@@ -121,1048 +125,3157 @@ namespace cmft
         return mem;
     }
 
-    // Irradiance.
-    //-----
+    static inline size_t cubemapPlanesSize(uint32_t _cubemapFaceSize, uint8_t _numChannels)
+    {
+        return (cubemapPlanePitch(_cubemapFaceSize) /*pitch*/
+              * _cubemapFaceSize /*height*/
+              * 6 /*numFaces*/
+              * _numChannels
+              * 4 /*bytesPerChannel*/
+              );
+    }
 
-    void evalSHBasis5(double* _shBasis, const float* _dir)
+    /// Splits the first _numChannels channels of cubemap texels into separate float planes. Texels of formats
+    /// other than RGBA32F are converted with toRgba32f().
+    /// Output is laid out as [face][channel][row][pitch] floats, see cubemapPlanePitch(). Row padding is zero.
+    void buildCubemapPlanes(float* _dst
+                          , uint8_t _numChannels
+                          , const void* _src
+                          , const uint32_t _srcFaceOffsets[6]
+                          , uint32_t _cubemapFaceSize
+                          , TextureFormat::Enum _srcFormat = TextureFormat::RGBA32F
+                          )
     {
-        const double x = double(_dir[0]);
-        const double y = double(_dir[1]);
-        const double z = double(_dir[2]);
+        const uint32_t pitch = cubemapPlanePitch(_cubemapFaceSize);
+        const uint32_t planeSize = pitch*_cubemapFaceSize;
+        const uint32_t bytesPerPixel = getImageDataInfo(_srcFormat).m_bytesPerPixel;
+        const uint32_t srcPitch = _cubemapFaceSize*bytesPerPixel;
 
-        const double x2 = x*x;
-        const double y2 = y*y;
-        const double z2 = z*z;
+        memset(_dst, 0, cubemapPlanesSize(_cubemapFaceSize, _numChannels));
 
-        const double z3 = pow(z, 3.0);
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            const uint8_t* srcFace = (const uint8_t*)_src + _srcFaceOffsets[face];
+            float* dstFace = _dst + planeSize*_numChannels*face;
 
-        const double x4 = pow(x, 4.0);
-        const double y4 = pow(y, 4.0);
-        const double z4 = pow(z, 4.0);
+            for (uint32_t yy = 0; yy < _cubemapFaceSize; ++yy)
+            {
+                const uint8_t* srcRow = srcFace + yy*srcPitch;
+                float* dstRow = dstFace + yy*pitch;
 
-        //Equations based on data from: http://ppsloan.org/publications/StupidSH36.pdf
-        _shBasis[ 0] =  1.0/(2.0*SQRT_PI);
+                for (uint32_t xx = 0; xx < _cubemapFaceSize; ++xx)
+                {
+                    float texel[4];
+                    if (TextureFormat::RGBA32F == _srcFormat)
+                    {
+                        memcpy(texel, srcRow + xx*bytesPerPixel, sizeof(texel));
+                    }
+                    else
+                    {
+                        toRgba32f(texel, _srcFormat, srcRow + xx*bytesPerPixel);
+                    }
 
-        _shBasis[ 1] = -sqrt(3.0/PI4)*y;
-        _shBasis[ 2] =  sqrt(3.0/PI4)*z;
-        _shBasis[ 3] = -sqrt(3.0/PI4)*x;
+                    for (uint8_t ch = 0; ch < _numChannels; ++ch)
+                    {
+                        dstRow[ch*planeSize + xx] = texel[ch];
+                    }
+                }
+            }
+        }
+    }
 
-        _shBasis[ 4] =  sqrt(15.0/PI4)*y*x;
-        _shBasis[ 5] = -sqrt(15.0/PI4)*y*z;
-        _shBasis[ 6] =  sqrt(5.0/PI16)*(3.0*z2-1.0);
-        _shBasis[ 7] = -sqrt(15.0/PI4)*x*z;
-        _shBasis[ 8] =  sqrt(15.0/PI16)*(x2-y2);
+    float* buildCubemapPlanes(uint8_t _numChannels
+                            , const void* _src
+                            , const uint32_t _srcFaceOffsets[6]
+                            , uint32_t _cubemapFaceSize
+                            , AllocatorI* _allocator = g_allocator
+                            , TextureFormat::Enum _srcFormat = TextureFormat::RGBA32F
+                            )
+    {
+        const size_t size = cubemapPlanesSize(_cubemapFaceSize, _numChannels);
+        float* mem = (float*)CMFT_ALIGNED_ALLOC(_allocator, size, 64);
+        MALLOC_CHECK(mem);
 
-        _shBasis[ 9] = -sqrt( 70.0/PI64)*y*(3*x2-y2);
-        _shBasis[10] =  sqrt(105.0/ PI4)*y*x*z;
-        _shBasis[11] = -sqrt( 21.0/PI16)*y*(-1.0+5.0*z2);
-        _shBasis[12] =  sqrt(  7.0/PI16)*(5.0*z3-3.0*z);
-        _shBasis[13] = -sqrt( 42.0/PI64)*x*(-1.0+5.0*z2);
-        _shBasis[14] =  sqrt(105.0/PI16)*(x2-y2)*z;
-        _shBasis[15] = -sqrt( 70.0/PI64)*x*(x2-3.0*y2);
+        buildCubemapPlanes(mem, _numChannels, _src, _srcFaceOffsets, _cubemapFaceSize, _srcFormat);
 
-        _shBasis[16] =  3.0*sqrt(35.0/PI16)*x*y*(x2-y2);
-        _shBasis[17] = -3.0*sqrt(70.0/PI64)*y*z*(3.0*x2-y2);
-        _shBasis[18] =  3.0*sqrt( 5.0/PI16)*y*x*(-1.0+7.0*z2);
-        _shBasis[19] = -3.0*sqrt(10.0/PI64)*y*z*(-3.0+7.0*z2);
-        _shBasis[20] =  (105.0*z4-90.0*z2+9.0)/(16.0*SQRT_PI);
-        _shBasis[21] = -3.0*sqrt(10.0/PI64)*x*z*(-3.0+7.0*z2);
-        _shBasis[22] =  3.0*sqrt( 5.0/PI64)*(x2-y2)*(-1.0+7.0*z2);
-        _shBasis[23] = -3.0*sqrt(70.0/PI64)*x*z*(x2-3.0*y2);
-        _shBasis[24] =  3.0*sqrt(35.0/(4.0*PI64))*(x4-6.0*y2*x2+y4);
+        return mem;
     }
 
-    void cubemapShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], void* _data, uint32_t _faceSize, uint32_t _faceOffsets[6])
+    #define RADIANCE_TILE_SIZE 8
+
+    /// Bounding cone of texel normals of a RADIANCE_TILE_SIZE x RADIANCE_TILE_SIZE block of a cube face.
+    struct RadianceTile
     {
-        memset(_shCoeffs, 0, SH_COEFF_NUM*3*sizeof(double));
+        float m_axis[3];
+        float m_cosSpread;
+        float m_sinSpread;
+    };
 
-        double weightAccum = 0.0;
+    static inline uint32_t cubemapTilesPerRow(uint32_t _cubemapFaceSize)
+    {
+        return (_cubemapFaceSize + RADIANCE_TILE_SIZE - 1) / RADIANCE_TILE_SIZE;
+    }
 
-        // Build cubemap vectors.
-        float* cubemapVectors = buildCubemapNormalSolidAngle(_faceSize, EdgeFixup::None, g_allocator);
-        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
-        const uint32_t vectorPitch = _faceSize * bytesPerPixel;
-        const uint32_t vectorFaceDataSize = vectorPitch * _faceSize;
+    /// Builds [face][tileRow][tileColumn] bounding cones from a cubemap normal solid angle table.
+    RadianceTile* buildCubemapTiles(const float* _cubemapNormalSolidAngle, uint32_t _cubemapFaceSize, AllocatorI* _allocator = g_allocator)
+    {
+        const uint32_t tilesPerRow = cubemapTilesPerRow(_cubemapFaceSize);
+        RadianceTile* mem = (RadianceTile*)CMFT_ALLOC(_allocator, tilesPerRow*tilesPerRow*6*sizeof(RadianceTile));
+        MALLOC_CHECK(mem);
+
+        // Widen cones a bit to stay conservative despite rounding of the dot products.
+        const float angleEpsilon = 1e-4f;
 
-        // Evaluate spherical harmonics coefficients.
+        RadianceTile* tile = mem;
         for (uint8_t face = 0; face < 6; ++face)
         {
-            const float* srcPtr = (const float*)((const uint8_t*)_data + _faceOffsets[face]);
-            const float* vecPtr = (const float*)((const uint8_t*)cubemapVectors + vectorFaceDataSize*face);
+            const float* faceNormals = _cubemapNormalSolidAngle + _cubemapFaceSize*_cubemapFaceSize*4*face;
 
-            for (uint32_t texel = 0, count = _faceSize*_faceSize; texel < count; ++texel, srcPtr+=4, vecPtr+=4)
+            for (uint32_t ty = 0; ty < tilesPerRow; ++ty)
             {
-                const double rr = double(srcPtr[0]);
-                const double gg = double(srcPtr[1]);
-                const double bb = double(srcPtr[2]);
+                const uint32_t minY = ty*RADIANCE_TILE_SIZE;
+                const uint32_t maxY = CMFT_MIN(minY + RADIANCE_TILE_SIZE, _cubemapFaceSize);
 
-                double shBasis[SH_COEFF_NUM];
-                evalSHBasis5(shBasis, vecPtr);
+                for (uint32_t tx = 0; tx < tilesPerRow; ++tx, ++tile)
+                {
+                    const uint32_t minX = tx*RADIANCE_TILE_SIZE;
+                    const uint32_t maxX = CMFT_MIN(minX + RADIANCE_TILE_SIZE, _cubemapFaceSize);
 
-                const double weight = (double)vecPtr[3];
+                    float axis[3] = { 0.0f, 0.0f, 0.0f };
+                    for (uint32_t yy = minY; yy < maxY; ++yy)
+                    {
+                        for (uint32_t xx = minX; xx < maxX; ++xx)
+                        {
+                            const float* normal = faceNormals + (yy*_cubemapFaceSize + xx)*4;
+                            axis[0] += normal[0];
+                            axis[1] += normal[1];
+                            axis[2] += normal[2];
+                        }
+                    }
+                    vec3Norm(tile->m_axis, axis);
 
-                for (uint8_t ii = 0; ii < SH_COEFF_NUM; ++ii)
-                {
-                    _shCoeffs[ii][0] += rr * shBasis[ii] * weight;
-                    _shCoeffs[ii][1] += gg * shBasis[ii] * weight;
-                    _shCoeffs[ii][2] += bb * shBasis[ii] * weight;
-                }
+                    float minDot = 1.0f;
+                    for (uint32_t yy = minY; yy < maxY; ++yy)
+                    {
+                        for (uint32_t xx = minX; xx < maxX; ++xx)
+                        {
+                            const float* normal = faceNormals + (yy*_cubemapFaceSize + xx)*4;
+                            minDot = CMFT_MIN(minDot, vec3Dot(tile->m_axis, normal));
+                        }
+                    }
 
-                weightAccum += weight;
+                    const float spread = acosf(CMFT_CLAMP(minDot, -1.0f, 1.0f)) + angleEpsilon;
+                    tile->m_cosSpread = cosf(spread);
+                    tile->m_sinSpread = sinf(spread);
+                }
             }
         }
 
-        // Normalization.
-        // This is not really necesarry because usually PI*4 - weightAccum ~= 0.000003
-        // so it doesn't change almost anything, but it doesn't cost much be more correct.
-        const double norm = PI4 / weightAccum;
-        for (uint8_t ii = 0; ii < SH_COEFF_NUM; ++ii)
-        {
-            _shCoeffs[ii][0] *= norm;
-            _shCoeffs[ii][1] *= norm;
-            _shCoeffs[ii][2] *= norm;
-        }
-
-        CMFT_FREE(g_allocator, cubemapVectors);
+        return mem;
     }
 
-    bool imageShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], const Image& _image, AllocatorI* _allocator)
+    // Irradiance.
+    //-----
+
+    /// Tables kept in the table cache, see cubemapTableAcquire().
+    struct CubemapTable
     {
-        // Input image must be a cubemap.
-        if (!imageIsCubemap(_image))
+        enum Enum
         {
-            return false;
-        }
-
-        // Processing is done in Rgba32f format.
-        ImageSoftRef imageRgba32f;
-        imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _image, _allocator);
+            NormalSolidAngle, // buildCubemapNormalSolidAngle()
+            NormalPlanes,     // buildCubemapPlanes() of the NormalSolidAngle table.
+            FilterArea,       // buildCubemapFilterArea()
+            ShIrradiance,     // buildCubemapShIrradiance()
 
-        // Get face data offsets.
-        uint32_t faceOffsets[6];
-        imageGetFaceOffsets(faceOffsets, imageRgba32f);
+            Count
+        };
+    };
 
-        // Compute spherical harmonic coefficients.
-        cubemapShCoeffs(_shCoeffs, imageRgba32f.m_data, imageRgba32f.m_width, faceOffsets);
+    /// Returns cached table or builds it on miss. Face index and filter size are used by FilterArea only.
+    /// Every acquired table has to be released with cubemapTableRelease().
+    const float* cubemapTableAcquire(CubemapTable::Enum _table
+                                   , uint32_t _faceSize
+                                   , EdgeFixup::Enum _fixup
+                                   , uint8_t _faceIdx = 0
+                                   , float _filterSize = 0.0f
+                                   );
+    void cubemapTableRelease(const float* _table);
+
+    /// Spherical harmonics projection is split into bands of whole rows with about ShBandTexels texels.
+    /// Band count depends on the face size only, partial sums of the bands are reduced pairwise in
+    /// a fixed order and the result does not depend on the number of threads.
+    /// Within a band, the basis is evaluated in float for ShBlockSize texels at once and products are
+    /// summed in ShLanes independent float lanes, which vectorize without reassociation. Lane sums are
+    /// added to double precision band sums after every block.
+    enum
+    {
+        ShBandTexels = 32768,
+        ShBlockSize  = 64,
+        ShLanes      = 8,
+    };
 
-        // Cleanup.
-        imageUnload(imageRgba32f, _allocator);
+    struct ShProjectionBand
+    {
+        double m_shCoeffs[SH_MAX_COEFF_NUM][3];
+        double m_weight;
+    };
 
-        return true;
-    }
+    struct ShProjectionTask
+    {
+        const void* m_data;
+        const uint32_t* m_faceOffsets;
+        const float* m_cubemapVectors;
+        uint32_t m_faceSize;
+        uint32_t m_bandRows;
+        uint32_t m_bandsPerFace;
+        uint8_t m_maxBand;
+        ShProjectionBand* m_bands;
+    };
 
-    bool imageIrradianceFilterSh(Image& _dst, uint32_t _dstFaceSize, const Image& _src, AllocatorI* _allocator)
+    /// Normalization of real spherical harmonics Y_l^m, including the sqrt(2) of m > 0.
+    static double shNormalization(uint8_t _band, uint8_t _m)
     {
-        // Input image must be a cubemap.
-        if (!imageIsCubemap(_src))
+        // (l-m)!/(l+m)!
+        double ratio = 1.0;
+        for (uint32_t ii = _band-_m+1; ii <= uint32_t(_band+_m); ++ii)
         {
-            return false;
+            ratio /= double(ii);
         }
 
-        // Processing is done in Rgba32f format.
-        ImageSoftRef imageRgba32f;
-        imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _src, _allocator);
-
-        // Get face data offsets.
-        uint32_t faceOffsets[6];
-        imageGetFaceOffsets(faceOffsets, imageRgba32f);
-
-        // Compute spherical harmonic coefficients.
-        double shRgb[SH_COEFF_NUM][3];
-        cubemapShCoeffs(shRgb, imageRgba32f.m_data, imageRgba32f.m_width, faceOffsets);
-
-        // Alloc dst data.
-        const uint32_t dstFaceSize = (0 == _dstFaceSize) ? _src.m_width : _dstFaceSize;
-        const uint8_t dstBytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
-        const uint32_t dstPitch = dstFaceSize*dstBytesPerPixel;
-        const uint32_t dstFaceDataSize = dstPitch * dstFaceSize;
-        const uint32_t dstDataSize = dstFaceDataSize * 6 /*numFaces*/;
-        void* dstData = CMFT_ALLOC(_allocator, dstDataSize);
-        MALLOC_CHECK(dstData);
+        const double kk = sqrt((2.0*_band+1.0)/PI4 * ratio);
+        return (0 == _m) ? kk : sqrt(2.0)*kk;
+    }
 
-        // Build cubemap texel vectors.
-        float* cubemapVectors = buildCubemapNormalSolidAngle(dstFaceSize, EdgeFixup::None, g_allocator);
-        const uint8_t vectorBytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
-        const uint32_t vectorPitch = dstFaceSize * vectorBytesPerPixel;
-        const uint32_t vectorFaceDataSize = vectorPitch * dstFaceSize;
+    /// Evaluates bands 0.._maxBand for a block of directions with the recurrence of associated Legendre
+    /// polynomials. With (x+iy)^m = C_m+iS_m, Y_l^m = K_l^m*Q_l^m(z)*C_m and Y_l^-m = K_l^m*Q_l^m(z)*S_m,
+    /// where Q_l^m is P_l^m divided by sin^m of the polar angle, which is a polynomial of z.
+    static void evalShBasisBlockRecurrence(float _shBasis[][ShBlockSize], uint8_t _maxBand, const float* _xx, const float* _yy, const float* _zz)
+    {
+        float cm[ShBlockSize];
+        float sm[ShBlockSize];
+        float qq[3][ShBlockSize];
 
-        uint64_t totalTime = cmft::getHPCounter();
+        for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+        {
+            cm[ii] = 1.0f;
+            sm[ii] = 0.0f;
+        }
 
-        // Output info.
-        INFO("Running irradiance filter for:\n"
-             "\t[srcFaceSize=%u]\n"
-             "\t[shOrder=5]\n"
-             "\t[dstFaceSize=%u]"
-             , imageRgba32f.m_width
-             , dstFaceSize
-             );
+        // Q_m^m = (-1)^m (2m-1)!!
+        double qmm = 1.0;
 
-        // Compute irradiance using SH data.
-        for (uint8_t face = 0; face < 6; ++face)
+        for (uint8_t mm = 0; mm <= _maxBand; ++mm)
         {
-            float* dstPtr = (float*)((uint8_t*)dstData + dstFaceDataSize*face);
-            const float* vecPtr = (const float*)((const uint8_t*)cubemapVectors + vectorFaceDataSize*face);
-
-            for (uint32_t texel = 0, count = dstFaceSize*dstFaceSize; texel < count ;++texel, dstPtr+=4, vecPtr+=4)
+            if (mm > 0)
             {
-                double shBasis[SH_COEFF_NUM];
-                evalSHBasis5(shBasis, vecPtr);
-
-                double rgb[3] = { 0.0, 0.0, 0.0 };
+                qmm *= -(2.0*mm-1.0);
+                for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+                {
+                    const float cc = cm[ii]*_xx[ii] - sm[ii]*_yy[ii];
+                    sm[ii] = cm[ii]*_yy[ii] + sm[ii]*_xx[ii];
+                    cm[ii] = cc;
+                }
+            }
 
-                // Band 0 (factor 1.0)
-                rgb[0] += shRgb[0][0] * shBasis[0] * 1.0f;
-                rgb[1] += shRgb[0][1] * shBasis[0] * 1.0f;
-                rgb[2] += shRgb[0][2] * shBasis[0] * 1.0f;
+            for (uint8_t ll = mm; ll <= _maxBand; ++ll)
+            {
+                float* q0 = qq[ll%3];
+                const float* q1 = qq[(ll+2)%3];
+                const float* q2 = qq[(ll+1)%3];
 
-                // Band 1 (factor 2/3).
-                uint8_t ii = 1;
-                for (; ii < 4; ++ii)
+                if (ll == mm)
+                {
+                    for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+                    {
+                        q0[ii] = float(qmm);
+                    }
+                }
+                else if (ll == mm+1)
                 {
-                    rgb[0] += shRgb[ii][0] * shBasis[ii] * (2.0f/3.0f);
-                    rgb[1] += shRgb[ii][1] * shBasis[ii] * (2.0f/3.0f);
-                    rgb[2] += shRgb[ii][2] * shBasis[ii] * (2.0f/3.0f);
+                    const float aa = float(2.0*mm+1.0);
+                    for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+                    {
+                        q0[ii] = aa*_zz[ii]*q1[ii];
+                    }
                 }
-
-                // Band 2 (factor 1/4).
-                for (; ii < 9; ++ii)
+                else
                 {
-                    rgb[0] += shRgb[ii][0] * shBasis[ii] * (1.0f/4.0f);
-                    rgb[1] += shRgb[ii][1] * shBasis[ii] * (1.0f/4.0f);
-                    rgb[2] += shRgb[ii][2] * shBasis[ii] * (1.0f/4.0f);
+                    const float aa = float(double(2*ll-1)/double(ll-mm));
+                    const float bb = float(double(ll+mm-1)/double(ll-mm));
+                    for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+                    {
+                        q0[ii] = aa*_zz[ii]*q1[ii] - bb*q2[ii];
+                    }
                 }
 
-                // Band 3 (factor 0).
-                ii = 16;
-
-                // Band 4 (factor -1/24).
-                for (; ii < 25; ++ii)
+                const float kk = float(shNormalization(ll, mm));
+                const uint32_t center = uint32_t(ll)*ll + ll;
+                if (0 == mm)
                 {
-                    rgb[0] += shRgb[ii][0] * shBasis[ii] * (-1.0f/24.0f);
-                    rgb[1] += shRgb[ii][1] * shBasis[ii] * (-1.0f/24.0f);
-                    rgb[2] += shRgb[ii][2] * shBasis[ii] * (-1.0f/24.0f);
+                    for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+                    {
+                        _shBasis[center][ii] = kk*q0[ii];
+                    }
+                }
+                else
+                {
+                    for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+                    {
+                        _shBasis[center+mm][ii] = kk*q0[ii]*cm[ii];
+                        _shBasis[center-mm][ii] = kk*q0[ii]*sm[ii];
+                    }
                 }
-
-                dstPtr[0] = float(rgb[0]);
-                dstPtr[1] = float(rgb[1]);
-                dstPtr[2] = float(rgb[2]);
-                dstPtr[3] = 1.0f;
             }
         }
-
-        // Output progress info.
-        const double freq = double(cmft::getHPFrequency());
-        const double toSec = 1.0/freq;
-        totalTime = cmft::getHPCounter() - totalTime;
-        INFO("Irradiance -> Done! Total time: %.3f seconds.", double(totalTime)*toSec);
-
-        // Fill structure.
-        Image result;
-        result.m_width = dstFaceSize;
-        result.m_height = dstFaceSize;
-        result.m_dataSize = dstFaceSize /*width*/
-                          * dstFaceSize /*height*/
-                          * 6 /*numFaces*/
-                          * 4 /*numChannels*/
-                          * 4 /*bytesPerChannel*/
-                          ;
-        result.m_format = TextureFormat::RGBA32F;
-        result.m_numMips = 1;
-        result.m_numFaces = 6;
-        result.m_data = dstData;
-
-        // Convert back to source format.
-        if (TextureFormat::RGBA32F == _src.m_format)
-        {
-            imageMove(_dst, result, _allocator);
-        }
-        else
-        {
-            imageConvert(_dst, (TextureFormat::Enum)_src.m_format, result, _allocator);
-            imageUnload(result, _allocator);
-        }
-
-        // Cleanup.
-        imageUnload(imageRgba32f, _allocator);
-
-        CMFT_FREE(g_allocator, cubemapVectors);
-
-        return true;
     }
 
-    void imageIrradianceFilterSh(Image& _image, uint32_t _faceSize, AllocatorI* _allocator)
+    /// Evaluates spherical harmonics basis of bands 0.._maxBand for a block of directions into the first
+    /// shCoeffNum(_maxBand) rows of _shBasis. Bands up to 4 are evaluated from closed form polynomials,
+    /// each band in a separate loop, so lower orders skip the work of the higher bands.
+    /// Equations based on data from: http://ppsloan.org/publications/StupidSH36.pdf
+    static void evalShBasisBlock(float _shBasis[][ShBlockSize], uint8_t _maxBand, const float* _xx, const float* _yy, const float* _zz)
     {
-        Image tmp;
-        if (imageIrradianceFilterSh(tmp, _faceSize, _image, _allocator))
+        if (_maxBand > 4)
         {
-            imageMove(_image, tmp, _allocator);
+            evalShBasisBlockRecurrence(_shBasis, _maxBand, _xx, _yy, _zz);
+            return;
         }
-    }
-
-    // Radiance.
-    //-----
 
-    struct Aabb
-    {
-        Aabb()
+        const float c0 = float(1.0/(2.0*SQRT_PI));
+        for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
         {
-            m_min[0] = FLT_MAX;
-            m_min[1] = FLT_MAX;
-            m_max[0] = -FLT_MAX;
-            m_max[1] = -FLT_MAX;
+            _shBasis[0][ii] = c0;
         }
 
-        void add(float _x, float _y)
+        if (_maxBand >= 1)
         {
-            m_min[0] = CMFT_MIN(m_min[0], _x);
-            m_min[1] = CMFT_MIN(m_min[1], _y);
-            m_max[0] = CMFT_MAX(m_max[0], _x);
-            m_max[1] = CMFT_MAX(m_max[1], _y);
+            const float c1 = float(sqrt(3.0/PI4));
+            for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+            {
+                _shBasis[1][ii] = -c1*_yy[ii];
+                _shBasis[2][ii] =  c1*_zz[ii];
+                _shBasis[3][ii] = -c1*_xx[ii];
+            }
         }
 
-        inline void clampMin(float _x, float _y)
+        if (_maxBand >= 2)
         {
-            m_min[0] = CMFT_MAX(m_min[0], _x);
-            m_min[1] = CMFT_MAX(m_min[1], _y);
+            const float c4 = float(sqrt(15.0/PI4));
+            const float c6 = float(sqrt(5.0/PI16));
+            const float c8 = float(sqrt(15.0/PI16));
+            for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+            {
+                const float x = _xx[ii];
+                const float y = _yy[ii];
+                const float z = _zz[ii];
+
+                const float x2 = x*x;
+                const float y2 = y*y;
+                const float z2 = z*z;
+
+                _shBasis[4][ii] =  c4*y*x;
+                _shBasis[5][ii] = -c4*y*z;
+                _shBasis[6][ii] =  c6*(3.0f*z2-1.0f);
+                _shBasis[7][ii] = -c4*x*z;
+                _shBasis[8][ii] =  c8*(x2-y2);
+            }
         }
 
-        inline void clampMax(float _x, float _y)
+        if (_maxBand >= 3)
         {
-            m_max[0] = CMFT_MIN(m_max[0], _x);
-            m_max[1] = CMFT_MIN(m_max[1], _y);
+            const float c9  = float(sqrt( 70.0/PI64));
+            const float c10 = float(sqrt(105.0/ PI4));
+            const float c11 = float(sqrt( 21.0/(2.0*PI16)));
+            const float c12 = float(sqrt(  7.0/PI16));
+            const float c13 = float(sqrt( 42.0/PI64));
+            const float c14 = float(sqrt(105.0/PI16));
+            for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+            {
+                const float x = _xx[ii];
+                const float y = _yy[ii];
+                const float z = _zz[ii];
+
+                const float x2 = x*x;
+                const float y2 = y*y;
+                const float z2 = z*z;
+                const float z2b3 = 5.0f*z2-1.0f;
+
+                _shBasis[ 9][ii] = -c9*y*(3.0f*x2-y2);
+                _shBasis[10][ii] =  c10*y*x*z;
+                _shBasis[11][ii] = -c11*y*z2b3;
+                _shBasis[12][ii] =  c12*z*(5.0f*z2-3.0f);
+                _shBasis[13][ii] = -c13*x*z2b3;
+                _shBasis[14][ii] =  c14*(x2-y2)*z;
+                _shBasis[15][ii] = -c9*x*(x2-3.0f*y2);
+            }
         }
 
-        void clamp(float _minX, float _minY, float _maxX, float _maxY)
+        if (_maxBand >= 4)
         {
-            clampMin(_minX, _minY);
-            clampMax(_maxX, _maxY);
+            const float c16 = float(3.0*sqrt(35.0/PI16));
+            const float c17 = float(3.0*sqrt(70.0/PI64));
+            const float c18 = float(3.0*sqrt( 5.0/PI16));
+            const float c19 = float(3.0*sqrt(10.0/PI64));
+            const float c20 = float(1.0/(16.0*SQRT_PI));
+            const float c22 = float(3.0*sqrt( 5.0/PI64));
+            const float c24 = float(3.0*sqrt(35.0/(4.0*PI64)));
+            for (uint32_t ii = 0; ii < ShBlockSize; ++ii)
+            {
+                const float x = _xx[ii];
+                const float y = _yy[ii];
+                const float z = _zz[ii];
+
+                const float x2 = x*x;
+                const float y2 = y*y;
+                const float z2 = z*z;
+                const float x2my2 = x2-y2;
+                const float z2b4  = 7.0f*z2-1.0f;
+
+                _shBasis[16][ii] =  c16*x*y*x2my2;
+                _shBasis[17][ii] = -c17*y*z*(3.0f*x2-y2);
+                _shBasis[18][ii] =  c18*y*x*z2b4;
+                _shBasis[19][ii] = -c19*y*z*(7.0f*z2-3.0f);
+                _shBasis[20][ii] =  c20*(105.0f*z2*z2-90.0f*z2+9.0f);
+                _shBasis[21][ii] = -c19*x*z*(7.0f*z2-3.0f);
+                _shBasis[22][ii] =  c22*x2my2*z2b4;
+                _shBasis[23][ii] = -c17*x*z*(x2-3.0f*y2);
+                _shBasis[24][ii] =  c24*(x2*x2-6.0f*y2*x2+y2*y2);
+            }
         }
+    }
 
-        void clamp(float _min, float _max)
+    /// Irradiance convolution factors of SH bands, clamped cosine lobe coefficients divided by PI.
+    static const float s_shIrradianceBandFactor[5] = { 1.0f, 2.0f/3.0f, 1.0f/4.0f, 0.0f, -1.0f/24.0f };
+
+    static inline float shIrradianceFactor(uint8_t _coeff)
+    {
+        const uint8_t band = uint8_t(sqrtf(float(_coeff)));
+        return s_shIrradianceBandFactor[band];
+    }
+
+    /// Evaluates basis for _count texel vectors multiplied by the irradiance factor of each band.
+    /// Entries past _count are evaluated for a zero vector.
+    static void evalShIrradianceBlock(float _shBasis[SH_COEFF_NUM][ShBlockSize], const float* _vectors, uint32_t _count)
+    {
+        float xx[ShBlockSize];
+        float yy[ShBlockSize];
+        float zz[ShBlockSize];
+
+        uint32_t ii = 0;
+        for (; ii < _count; ++ii, _vectors+=4)
         {
-            clampMin(_min, _min);
-            clampMax(_max, _max);
+            xx[ii] = _vectors[0];
+            yy[ii] = _vectors[1];
+            zz[ii] = _vectors[2];
+        }
+        for (; ii < ShBlockSize; ++ii)
+        {
+            xx[ii] = 0.0f;
+            yy[ii] = 0.0f;
+            zz[ii] = 0.0f;
         }
 
-        bool isEmpty()
+        evalShBasisBlock(_shBasis, 4, xx, yy, zz);
+
+        for (uint8_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
         {
-            // Has to have at least two points added so that no value is equal to initial state.
-            return ((m_min[0] ==  FLT_MAX)
-                  ||(m_min[1] ==  FLT_MAX)
-                  ||(m_max[0] == -FLT_MAX)
-                  ||(m_max[1] == -FLT_MAX)
-                   );
+            const float factor = shIrradianceFactor(coeff);
+            for (uint32_t jj = 0; jj < ShBlockSize; ++jj)
+            {
+                _shBasis[coeff][jj] *= factor;
+            }
         }
+    }
 
-        float m_min[2];
-        float m_max[2];
-    };
+    static inline size_t cubemapShIrradianceSize(uint32_t _faceSize)
+    {
+        return size_t(_faceSize)*_faceSize*6*SH_COEFF_NUM*sizeof(float);
+    }
 
-    /// Computes filter area for each of the cubemap faces for given tap vector and filter size.
-    void determineFilterArea(Aabb _filterArea[6], const float* _tapVec, float _filterSize)
+    /// Builds basis of every texel, multiplied by the irradiance factor of its band.
+    /// Layout is [face][coeff][texel] floats, so each coefficient of a texel block is contiguous.
+    static void buildCubemapShIrradiance(float* _dst, uint32_t _faceSize)
     {
-        ///   ______
-        ///  |      |
-        ///  |      |
-        ///  |    x |
-        ///  |______|
+        const float* cubemapVectors = cubemapTableAcquire(CubemapTable::NormalSolidAngle, _faceSize, EdgeFixup::None);
+        const uint32_t faceTexels = _faceSize*_faceSize;
+
+        float shBasis[SH_COEFF_NUM][ShBlockSize];
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            float* dstFace = _dst + uint32_t(face)*faceTexels*SH_COEFF_NUM;
+            const float* vecFace = cubemapVectors + uint32_t(face)*faceTexels*4;
+
+            for (uint32_t begin = 0; begin < faceTexels; begin += ShBlockSize)
+            {
+                const uint32_t count = CMFT_MIN(faceTexels - begin, uint32_t(ShBlockSize));
+                evalShIrradianceBlock(shBasis, vecFace + begin*4, count);
+
+                for (uint8_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
+                {
+                    memcpy(dstFace + coeff*faceTexels + begin, shBasis[coeff], count*sizeof(float));
+                }
+            }
+        }
+
+        cubemapTableRelease(cubemapVectors);
+    }
+
+    static void shProjectionTask(void* _userData, uint32_t _bandIdx)
+    {
+        const ShProjectionTask& task = *(const ShProjectionTask*)_userData;
+        ShProjectionBand& band = task.m_bands[_bandIdx];
+        memset(&band, 0, sizeof(ShProjectionBand));
+
+        const uint8_t face = uint8_t(_bandIdx / task.m_bandsPerFace);
+        const uint32_t beginY = (_bandIdx % task.m_bandsPerFace) * task.m_bandRows;
+        const uint32_t endY = CMFT_MIN(beginY + task.m_bandRows, task.m_faceSize);
+        const uint32_t begin = beginY * task.m_faceSize;
+        const uint32_t end = endY * task.m_faceSize;
+
+        const float* srcFace = (const float*)((const uint8_t*)task.m_data + task.m_faceOffsets[face]);
+        const float* vecFace = task.m_cubemapVectors + uint32_t(face)*task.m_faceSize*task.m_faceSize*4;
+
+        float xx[ShBlockSize];
+        float yy[ShBlockSize];
+        float zz[ShBlockSize];
+        float rgb[3][ShBlockSize];
+        float shBasis[SH_MAX_COEFF_NUM][ShBlockSize];
+
+        const uint32_t numCoeffs = shCoeffNum(task.m_maxBand);
+
+        for (uint32_t blockBegin = begin; blockBegin < end; blockBegin += ShBlockSize)
+        {
+            const uint32_t blockSize = CMFT_MIN(end - blockBegin, uint32_t(ShBlockSize));
+
+            // Deinterleave, texels past the end of the band get zero weight.
+            const float* srcPtr = srcFace + blockBegin*4;
+            const float* vecPtr = vecFace + blockBegin*4;
+            uint32_t ii = 0;
+            for (; ii < blockSize; ++ii, srcPtr+=4, vecPtr+=4)
+            {
+                const float weight = vecPtr[3];
+                xx[ii] = vecPtr[0];
+                yy[ii] = vecPtr[1];
+                zz[ii] = vecPtr[2];
+                rgb[0][ii] = srcPtr[0]*weight;
+                rgb[1][ii] = srcPtr[1]*weight;
+                rgb[2][ii] = srcPtr[2]*weight;
+
+                band.m_weight += double(weight);
+            }
+            for (; ii < ShBlockSize; ++ii)
+            {
+                xx[ii] = 0.0f;
+                yy[ii] = 0.0f;
+                zz[ii] = 0.0f;
+                rgb[0][ii] = 0.0f;
+                rgb[1][ii] = 0.0f;
+                rgb[2][ii] = 0.0f;
+            }
+
+            evalShBasisBlock(shBasis, task.m_maxBand, xx, yy, zz);
+
+            for (uint32_t coeff = 0; coeff < numCoeffs; ++coeff)
+            {
+                float sum[3][ShLanes];
+                memset(sum, 0, sizeof(sum));
+
+                for (uint32_t jj = 0; jj < ShBlockSize; jj += ShLanes)
+                {
+                    for (uint32_t lane = 0; lane < ShLanes; ++lane)
+                    {
+                        const float basis = shBasis[coeff][jj+lane];
+                        sum[0][lane] += basis*rgb[0][jj+lane];
+                        sum[1][lane] += basis*rgb[1][jj+lane];
+                        sum[2][lane] += basis*rgb[2][jj+lane];
+                    }
+                }
+
+                for (uint32_t lane = 0; lane < ShLanes; ++lane)
+                {
+                    band.m_shCoeffs[coeff][0] += double(sum[0][lane]);
+                    band.m_shCoeffs[coeff][1] += double(sum[1][lane]);
+                    band.m_shCoeffs[coeff][2] += double(sum[2][lane]);
+                }
+            }
+        }
+    }
+
+    bool cubemapShCoeffs(double _shCoeffs[][3], uint8_t _maxBand, void* _data, uint32_t _faceSize, uint32_t _faceOffsets[6], AllocatorI* _allocator)
+    {
+        if (_maxBand > SH_MAX_BAND)
+        {
+            WARN("Spherical harmonics band %u requested, max band is %u.", uint32_t(_maxBand), uint32_t(SH_MAX_BAND));
+            return false;
+        }
+
+        const uint32_t numCoeffs = shCoeffNum(_maxBand);
+        const float* cubemapVectors = cubemapTableAcquire(CubemapTable::NormalSolidAngle, _faceSize, EdgeFixup::None);
+
+        ShProjectionTask task;
+        task.m_data           = _data;
+        task.m_faceOffsets    = _faceOffsets;
+        task.m_cubemapVectors = cubemapVectors;
+        task.m_faceSize       = _faceSize;
+        task.m_bandRows       = CMFT_MAX(uint32_t(ShBandTexels)/_faceSize, UINT32_C(1));
+        task.m_bandsPerFace   = (_faceSize + task.m_bandRows - 1) / task.m_bandRows;
+        task.m_maxBand        = _maxBand;
+
+        const uint32_t numBands = task.m_bandsPerFace*6;
+        task.m_bands = (ShProjectionBand*)CMFT_ALLOC(_allocator, numBands*sizeof(ShProjectionBand));
+        MALLOC_CHECK(task.m_bands);
+
+        threadPoolRun(shProjectionTask, (void*)&task, numBands);
+
+        // Pairwise reduction in fixed order.
+        ShProjectionBand* bands = task.m_bands;
+        for (uint32_t stride = 1; stride < numBands; stride *= 2)
+        {
+            for (uint32_t ii = 0; ii + stride < numBands; ii += 2*stride)
+            {
+                for (uint32_t coeff = 0; coeff < numCoeffs; ++coeff)
+                {
+                    bands[ii].m_shCoeffs[coeff][0] += bands[ii+stride].m_shCoeffs[coeff][0];
+                    bands[ii].m_shCoeffs[coeff][1] += bands[ii+stride].m_shCoeffs[coeff][1];
+                    bands[ii].m_shCoeffs[coeff][2] += bands[ii+stride].m_shCoeffs[coeff][2];
+                }
+                bands[ii].m_weight += bands[ii+stride].m_weight;
+            }
+        }
+
+        // Normalization.
+        // This is not really necesarry because usually PI*4 - weightAccum ~= 0.000003
+        // so it doesn't change almost anything, but it doesn't cost much be more correct.
+        const double norm = PI4 / bands[0].m_weight;
+        for (uint32_t ii = 0; ii < numCoeffs; ++ii)
+        {
+            _shCoeffs[ii][0] = bands[0].m_shCoeffs[ii][0] * norm;
+            _shCoeffs[ii][1] = bands[0].m_shCoeffs[ii][1] * norm;
+            _shCoeffs[ii][2] = bands[0].m_shCoeffs[ii][2] * norm;
+        }
+
+        CMFT_FREE(_allocator, task.m_bands);
+        cubemapTableRelease(cubemapVectors);
+
+        return true;
+    }
+
+    bool cubemapShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], void* _data, uint32_t _faceSize, uint32_t _faceOffsets[6], AllocatorI* _allocator)
+    {
+        return cubemapShCoeffs(_shCoeffs, 4, _data, _faceSize, _faceOffsets, _allocator);
+    }
+
+    bool imageShCoeffs(double _shCoeffs[][3], uint8_t _maxBand, const Image& _image, AllocatorI* _allocator, uint8_t _mip)
+    {
+        // Input image must be a cubemap.
+        if (!imageIsCubemap(_image))
+        {
+            return false;
+        }
+
+        if (_maxBand > SH_MAX_BAND)
+        {
+            WARN("Spherical harmonics band %u requested, max band is %u.", uint32_t(_maxBand), uint32_t(SH_MAX_BAND));
+            return false;
+        }
+
+        if (_mip >= _image.m_numMips)
+        {
+            WARN("Mip %u requested for spherical harmonics, image has %u mips.", uint32_t(_mip), uint32_t(_image.m_numMips));
+            return false;
+        }
+
+        // Processing is done in Rgba32f format.
+        ImageSoftRef imageRgba32f;
+        imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _image, _allocator);
+
+        // Get face data offsets of the mip.
+        uint32_t mipOffsets[CUBE_FACE_NUM][MAX_MIP_NUM];
+        imageGetMipOffsets(mipOffsets, imageRgba32f);
+
+        uint32_t faceOffsets[6];
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            faceOffsets[face] = mipOffsets[face][_mip];
+        }
+
+        // Compute spherical harmonic coefficients.
+        const uint32_t mipFaceSize = CMFT_MAX(imageRgba32f.m_width >> _mip, UINT32_C(1));
+        cubemapShCoeffs(_shCoeffs, _maxBand, imageRgba32f.m_data, mipFaceSize, faceOffsets, _allocator);
+
+        // Cleanup.
+        imageUnload(imageRgba32f, _allocator);
+
+        return true;
+    }
+
+    bool imageShCoeffs(double _shCoeffs[SH_COEFF_NUM][3], const Image& _image, AllocatorI* _allocator, uint8_t _mip)
+    {
+        return imageShCoeffs(_shCoeffs, 4, _image, _allocator, _mip);
+    }
+
+    /// Evaluates 2*_band+1 basis functions of a single band in double, same recurrence as evalShBasisBlockRecurrence().
+    static void evalShBand(double* _shBasis, uint8_t _band, const double* _dir)
+    {
+        double cm = 1.0;
+        double sm = 0.0;
+        double qmm = 1.0;
+
+        for (uint8_t mm = 0; mm <= _band; ++mm)
+        {
+            if (mm > 0)
+            {
+                qmm *= -(2.0*mm-1.0);
+                const double cc = cm*_dir[0] - sm*_dir[1];
+                sm = cm*_dir[1] + sm*_dir[0];
+                cm = cc;
+            }
+
+            // Q_l^m for l = mm.._band.
+            double q2 = 0.0;
+            double q1 = qmm;
+            for (uint8_t ll = mm+1; ll <= _band; ++ll)
+            {
+                const double q0 = (ll == mm+1)
+                                ? (2.0*mm+1.0)*_dir[2]*q1
+                                : (double(2*ll-1)*_dir[2]*q1 - double(ll+mm-1)*q2)/double(ll-mm)
+                                ;
+                q2 = q1;
+                q1 = q0;
+            }
+
+            const double kk = shNormalization(_band, mm);
+            if (0 == mm)
+            {
+                _shBasis[_band] = kk*q1;
+            }
+            else
+            {
+                _shBasis[_band+mm] = kk*q1*cm;
+                _shBasis[_band-mm] = kk*q1*sm;
+            }
+        }
+    }
+
+    /// Solves _aa*x = _bb for 3 right hand sides with partial pivoting, x is returned in _bb.
+    static void solveLinear3(double _aa[][2*SH_MAX_BAND+1], double _bb[][3], uint32_t _size)
+    {
+        for (uint32_t col = 0; col < _size; ++col)
+        {
+            uint32_t pivot = col;
+            for (uint32_t row = col+1; row < _size; ++row)
+            {
+                if (fabs(_aa[row][col]) > fabs(_aa[pivot][col]))
+                {
+                    pivot = row;
+                }
+            }
+
+            for (uint32_t ii = 0; ii < _size; ++ii)
+            {
+                const double tmp = _aa[col][ii]; _aa[col][ii] = _aa[pivot][ii]; _aa[pivot][ii] = tmp;
+            }
+            for (uint8_t ch = 0; ch < 3; ++ch)
+            {
+                const double tmp = _bb[col][ch]; _bb[col][ch] = _bb[pivot][ch]; _bb[pivot][ch] = tmp;
+            }
+
+            for (uint32_t row = 0; row < _size; ++row)
+            {
+                if (row == col)
+                {
+                    continue;
+                }
+
+                const double factor = _aa[row][col]/_aa[col][col];
+                for (uint32_t ii = col; ii < _size; ++ii)
+                {
+                    _aa[row][ii] -= factor*_aa[col][ii];
+                }
+                for (uint8_t ch = 0; ch < 3; ++ch)
+                {
+                    _bb[row][ch] -= factor*_bb[col][ch];
+                }
+            }
+        }
+
+        for (uint32_t row = 0; row < _size; ++row)
+        {
+            for (uint8_t ch = 0; ch < 3; ++ch)
+            {
+                _bb[row][ch] /= _aa[row][row];
+            }
+        }
+    }
+
+    bool shCoeffsRotate(double _dst[][3], const double _src[][3], uint8_t _maxBand, const float _rotation[9])
+    {
+        if (_maxBand > SH_MAX_BAND)
+        {
+            WARN("Spherical harmonics band %u requested, max band is %u.", uint32_t(_maxBand), uint32_t(SH_MAX_BAND));
+            return false;
+        }
+
+        double src[SH_MAX_COEFF_NUM][3];
+        memcpy(src, _src, shCoeffNum(_maxBand)*sizeof(double)*3);
+
+        // Band 0 is invariant.
+        _dst[0][0] = src[0][0];
+        _dst[0][1] = src[0][1];
+        _dst[0][2] = src[0][2];
+
+        // Rotated band l has to match the source band at each direction: sum_m c'_lm*Y_lm(d) = sum_m c_lm*Y_lm(R^T*d).
+        // It is solved in least squares sense at 4*(2l+1) directions on a fibonacci spiral, which are spread
+        // evenly enough for the normal equations to stay well conditioned.
+        for (uint8_t band = 1; band <= _maxBand; ++band)
+        {
+            const uint32_t size = 2*band+1;
+            const uint32_t numDirs = 4*size;
+            const double* bandSrc = &src[uint32_t(band)*band][0];
+
+            double aa[2*SH_MAX_BAND+1][2*SH_MAX_BAND+1];
+            double bb[2*SH_MAX_BAND+1][3];
+            memset(aa, 0, sizeof(aa));
+            memset(bb, 0, sizeof(bb));
+
+            for (uint32_t kk = 0; kk < numDirs; ++kk)
+            {
+                const double zz = 1.0 - (2.0*kk+1.0)/double(numDirs);
+                const double rr = sqrt(1.0 - zz*zz);
+                const double phi = 2.39996322972865332*kk;
+                const double dir[3] = { rr*cos(phi), rr*sin(phi), zz };
+
+                // R^T*d.
+                const double rotDir[3] =
+                {
+                    _rotation[0]*dir[0] + _rotation[3]*dir[1] + _rotation[6]*dir[2],
+                    _rotation[1]*dir[0] + _rotation[4]*dir[1] + _rotation[7]*dir[2],
+                    _rotation[2]*dir[0] + _rotation[5]*dir[1] + _rotation[8]*dir[2],
+                };
+
+                double basis[2*SH_MAX_BAND+1];
+                double rotBasis[2*SH_MAX_BAND+1];
+                evalShBand(basis, band, dir);
+                evalShBand(rotBasis, band, rotDir);
+
+                double value[3] = { 0.0, 0.0, 0.0 };
+                for (uint32_t mm = 0; mm < size; ++mm)
+                {
+                    value[0] += rotBasis[mm]*bandSrc[mm*3+0];
+                    value[1] += rotBasis[mm]*bandSrc[mm*3+1];
+                    value[2] += rotBasis[mm]*bandSrc[mm*3+2];
+                }
+
+                for (uint32_t row = 0; row < size; ++row)
+                {
+                    for (uint32_t col = 0; col < size; ++col)
+                    {
+                        aa[row][col] += basis[row]*basis[col];
+                    }
+
+                    bb[row][0] += basis[row]*value[0];
+                    bb[row][1] += basis[row]*value[1];
+                    bb[row][2] += basis[row]*value[2];
+                }
+            }
+
+            solveLinear3(aa, bb, size);
+
+            for (uint32_t mm = 0; mm < size; ++mm)
+            {
+                _dst[uint32_t(band)*band+mm][0] = bb[mm][0];
+                _dst[uint32_t(band)*band+mm][1] = bb[mm][1];
+                _dst[uint32_t(band)*band+mm][2] = bb[mm][2];
+            }
+        }
+
+        return true;
+    }
+
+    /// Output faces are reconstructed in row bands of about IrradianceBandTexels texels on the thread pool.
+    enum
+    {
+        IrradianceBandTexels = 4096,
+    };
+
+    struct IrradianceTask
+    {
+        float m_shRgb[SH_COEFF_NUM][3];
+        const float* m_shIrradiance;   // ShIrradiance table or NULL.
+        const float* m_cubemapVectors; // Used when there is no ShIrradiance table.
+        float* m_dstData;
+        uint32_t m_faceSize;
+        uint32_t m_bandRows;
+        uint32_t m_bandsPerFace;
+    };
+
+    static void irradianceTask(void* _userData, uint32_t _bandIdx)
+    {
+        const IrradianceTask& task = *(const IrradianceTask*)_userData;
+
+        const uint8_t face = uint8_t(_bandIdx / task.m_bandsPerFace);
+        const uint32_t beginY = (_bandIdx % task.m_bandsPerFace) * task.m_bandRows;
+        const uint32_t endY = CMFT_MIN(beginY + task.m_bandRows, task.m_faceSize);
+        const uint32_t faceTexels = task.m_faceSize*task.m_faceSize;
+        const uint32_t begin = beginY * task.m_faceSize;
+        const uint32_t end = endY * task.m_faceSize;
+
+        float* dstFace = task.m_dstData + uint32_t(face)*faceTexels*4;
+
+        float shBasis[SH_COEFF_NUM][ShBlockSize];
+        float rgb[3][ShBlockSize];
+
+        for (uint32_t blockBegin = begin; blockBegin < end; blockBegin += ShBlockSize)
+        {
+            const uint32_t blockSize = CMFT_MIN(end - blockBegin, uint32_t(ShBlockSize));
+
+            const float* basis;
+            uint32_t coeffStride;
+            if (NULL != task.m_shIrradiance)
+            {
+                basis = task.m_shIrradiance + uint32_t(face)*faceTexels*SH_COEFF_NUM + blockBegin;
+                coeffStride = faceTexels;
+            }
+            else
+            {
+                evalShIrradianceBlock(shBasis, task.m_cubemapVectors + (uint32_t(face)*faceTexels + blockBegin)*4, blockSize);
+                basis = &shBasis[0][0];
+                coeffStride = ShBlockSize;
+            }
+
+            memset(rgb, 0, sizeof(rgb));
+            for (uint8_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
+            {
+                // Band 3 does not contribute to irradiance.
+                if (0.0f == shIrradianceFactor(coeff))
+                {
+                    continue;
+                }
+
+                const float* coeffBasis = basis + coeff*coeffStride;
+                const float rr = task.m_shRgb[coeff][0];
+                const float gg = task.m_shRgb[coeff][1];
+                const float bb = task.m_shRgb[coeff][2];
+                for (uint32_t ii = 0; ii < blockSize; ++ii)
+                {
+                    rgb[0][ii] += coeffBasis[ii]*rr;
+                    rgb[1][ii] += coeffBasis[ii]*gg;
+                    rgb[2][ii] += coeffBasis[ii]*bb;
+                }
+            }
+
+            float* dstPtr = dstFace + blockBegin*4;
+            for (uint32_t ii = 0; ii < blockSize; ++ii, dstPtr+=4)
+            {
+                dstPtr[0] = rgb[0][ii];
+                dstPtr[1] = rgb[1][ii];
+                dstPtr[2] = rgb[2][ii];
+                dstPtr[3] = 1.0f;
+            }
+        }
+    }
+
+    bool imageIrradianceFilterSh(Image& _dst, uint32_t _dstFaceSize, const Image& _src, AllocatorI* _allocator)
+    {
+        // Input image must be a cubemap.
+        if (!imageIsCubemap(_src))
+        {
+            return false;
+        }
+
+        // Processing is done in Rgba32f format.
+        ImageSoftRef imageRgba32f;
+        imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _src, _allocator);
+
+        // Get face data offsets.
+        uint32_t faceOffsets[6];
+        imageGetFaceOffsets(faceOffsets, imageRgba32f);
+
+        // Compute spherical harmonic coefficients.
+        double shRgb[SH_COEFF_NUM][3];
+        cubemapShCoeffs(shRgb, imageRgba32f.m_data, imageRgba32f.m_width, faceOffsets, _allocator);
+
+        // Alloc dst data.
+        const uint32_t dstFaceSize = (0 == _dstFaceSize) ? _src.m_width : _dstFaceSize;
+        const uint8_t dstBytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+        const uint32_t dstPitch = dstFaceSize*dstBytesPerPixel;
+        const uint32_t dstFaceDataSize = dstPitch * dstFaceSize;
+        const uint32_t dstDataSize = dstFaceDataSize * 6 /*numFaces*/;
+        void* dstData = CMFT_ALLOC(_allocator, dstDataSize);
+        MALLOC_CHECK(dstData);
+
+        uint64_t totalTime = cmft::getHPCounter();
+
+        // Output info.
+        INFO("Running irradiance filter for:\n"
+             "\t[srcFaceSize=%u]\n"
+             "\t[shOrder=5]\n"
+             "\t[dstFaceSize=%u]"
+             , imageRgba32f.m_width
+             , dstFaceSize
+             );
+
+        // Basis table is kept in the table cache. When it does not fit, basis is evaluated per texel block.
+        TableCacheStats cacheStats;
+        tableCacheGetStats(cacheStats);
+        const bool useTable = cubemapShIrradianceSize(dstFaceSize) <= cacheStats.m_maxSize;
+
+        IrradianceTask task;
+        for (uint8_t ii = 0; ii < SH_COEFF_NUM; ++ii)
+        {
+            task.m_shRgb[ii][0] = float(shRgb[ii][0]);
+            task.m_shRgb[ii][1] = float(shRgb[ii][1]);
+            task.m_shRgb[ii][2] = float(shRgb[ii][2]);
+        }
+        task.m_shIrradiance   = useTable ? cubemapTableAcquire(CubemapTable::ShIrradiance, dstFaceSize, EdgeFixup::None) : NULL;
+        task.m_cubemapVectors = useTable ? NULL : cubemapTableAcquire(CubemapTable::NormalSolidAngle, dstFaceSize, EdgeFixup::None);
+        task.m_dstData        = (float*)dstData;
+        task.m_faceSize       = dstFaceSize;
+        task.m_bandRows       = CMFT_MAX(uint32_t(IrradianceBandTexels)/dstFaceSize, UINT32_C(1));
+        task.m_bandsPerFace   = (dstFaceSize + task.m_bandRows - 1) / task.m_bandRows;
+
+        // Compute irradiance using SH data.
+        threadPoolRun(irradianceTask, (void*)&task, task.m_bandsPerFace*6);
+
+        cubemapTableRelease(useTable ? task.m_shIrradiance : task.m_cubemapVectors);
+
+        // Output progress info.
+        const double freq = double(cmft::getHPFrequency());
+        const double toSec = 1.0/freq;
+        totalTime = cmft::getHPCounter() - totalTime;
+        INFO("Irradiance -> Done! Total time: %.3f seconds.", double(totalTime)*toSec);
+
+        // Fill structure.
+        Image result;
+        result.m_width = dstFaceSize;
+        result.m_height = dstFaceSize;
+        result.m_dataSize = dstFaceSize /*width*/
+                          * dstFaceSize /*height*/
+                          * 6 /*numFaces*/
+                          * 4 /*numChannels*/
+                          * 4 /*bytesPerChannel*/
+                          ;
+        result.m_format = TextureFormat::RGBA32F;
+        result.m_numMips = 1;
+        result.m_numFaces = 6;
+        result.m_data = dstData;
+
+        // Convert back to source format.
+        if (TextureFormat::RGBA32F == _src.m_format)
+        {
+            imageMove(_dst, result, _allocator);
+        }
+        else
+        {
+            imageConvert(_dst, (TextureFormat::Enum)_src.m_format, result, _allocator);
+            imageUnload(result, _allocator);
+        }
+
+        // Cleanup.
+        imageUnload(imageRgba32f, _allocator);
+
+        return true;
+    }
+
+    void imageIrradianceFilterSh(Image& _image, uint32_t _faceSize, AllocatorI* _allocator)
+    {
+        Image tmp;
+        if (imageIrradianceFilterSh(tmp, _faceSize, _image, _allocator))
+        {
+            imageMove(_image, tmp, _allocator);
+        }
+    }
+
+    // Radiance.
+    //-----
+
+    struct Aabb
+    {
+        Aabb()
+        {
+            m_min[0] = FLT_MAX;
+            m_min[1] = FLT_MAX;
+            m_max[0] = -FLT_MAX;
+            m_max[1] = -FLT_MAX;
+        }
+
+        void add(float _x, float _y)
+        {
+            m_min[0] = CMFT_MIN(m_min[0], _x);
+            m_min[1] = CMFT_MIN(m_min[1], _y);
+            m_max[0] = CMFT_MAX(m_max[0], _x);
+            m_max[1] = CMFT_MAX(m_max[1], _y);
+        }
+
+        inline void clampMin(float _x, float _y)
+        {
+            m_min[0] = CMFT_MAX(m_min[0], _x);
+            m_min[1] = CMFT_MAX(m_min[1], _y);
+        }
+
+        inline void clampMax(float _x, float _y)
+        {
+            m_max[0] = CMFT_MIN(m_max[0], _x);
+            m_max[1] = CMFT_MIN(m_max[1], _y);
+        }
+
+        void clamp(float _minX, float _minY, float _maxX, float _maxY)
+        {
+            clampMin(_minX, _minY);
+            clampMax(_maxX, _maxY);
+        }
+
+        void clamp(float _min, float _max)
+        {
+            clampMin(_min, _min);
+            clampMax(_max, _max);
+        }
+
+        bool isEmpty() const
+        {
+            // Has to have at least two points added so that no value is equal to initial state.
+            return ((m_min[0] ==  FLT_MAX)
+                  ||(m_min[1] ==  FLT_MAX)
+                  ||(m_max[0] == -FLT_MAX)
+                  ||(m_max[1] == -FLT_MAX)
+                   );
+        }
+
+        float m_min[2];
+        float m_max[2];
+    };
+
+    /// Computes filter area for each of the cubemap faces for given tap vector and filter size.
+    void determineFilterArea(Aabb _filterArea[6], const float* _tapVec, float _filterSize)
+    {
+        ///   ______
+        ///  |      |
+        ///  |      |
+        ///  |    x |
+        ///  |______|
+        ///
+        // Get face and hit coordinates.
+        float uu, vv;
+        uint8_t hitFaceIdx;
+        vecToTexelCoord(uu, vv, hitFaceIdx, _tapVec);
+
+        ///  ........
+        ///  .      .
+        ///  .   ___.
+        ///  .  | x |
+        ///  ...|___|
+        ///
+        // Calculate hit face filter bounds.
+        Aabb hitFaceFilterBounds;
+        hitFaceFilterBounds.add(uu-_filterSize, vv-_filterSize);
+        hitFaceFilterBounds.add(uu+_filterSize, vv+_filterSize);
+        hitFaceFilterBounds.clamp(0.0f, 1.0f);
+
+        // Output result for hit face.
+        DEBUG_CHECK(6 > hitFaceIdx, "Face idx should be in range 0-5");
+        memcpy(&_filterArea[hitFaceIdx], &hitFaceFilterBounds, sizeof(Aabb));
+
+        /// Filter area might extend on neighbour faces.
+        /// Case when extending over the right edge:
         ///
-        // Get face and hit coordinates.
-        float uu, vv;
-        uint8_t hitFaceIdx;
-        vecToTexelCoord(uu, vv, hitFaceIdx, _tapVec);
+        ///  --> U
+        /// |        ......
+        /// v       .      .
+        /// V       .      .
+        ///         .      .
+        ///  ....... ...... .......
+        ///  .      .      .      .
+        ///  .      .  .....__min .
+        ///  .      .  .   .  |  -> amount
+        ///  ....... .....x.__|....
+        ///         .  .   .  max
+        ///         .  ........
+        ///         .      .
+        ///          ......
+        ///         .      .
+        ///         .      .
+        ///         .      .
+        ///          ......
+        ///
+
+        enum NeighbourSides
+        {
+            Left,
+            Right,
+            Top,
+            Bottom,
+
+            NeighbourSidesCount,
+        };
+
+        struct NeighourFaceBleed
+        {
+            float m_amount;
+            float m_bbMin;
+            float m_bbMax;
+        } bleed[NeighbourSidesCount] =
+        {
+            { // Left
+                _filterSize - uu,
+                hitFaceFilterBounds.m_min[1],
+                hitFaceFilterBounds.m_max[1],
+            },
+            { // Right
+                uu + _filterSize - 1.0f,
+                hitFaceFilterBounds.m_min[1],
+                hitFaceFilterBounds.m_max[1],
+            },
+            { // Top
+                _filterSize - vv,
+                hitFaceFilterBounds.m_min[0],
+                hitFaceFilterBounds.m_max[0],
+            },
+            { // Bottom
+                vv + _filterSize - 1.0f,
+                hitFaceFilterBounds.m_min[0],
+                hitFaceFilterBounds.m_max[0],
+            },
+        };
+
+        // Determine bleeding for each side.
+        for (uint8_t side = 0; side < 4; ++side)
+        {
+            uint8_t currentFaceIdx = hitFaceIdx;
+
+            for (float bleedAmount = bleed[side].m_amount; bleedAmount > 0.0f; bleedAmount -= 1.0f)
+            {
+                uint8_t neighbourFaceIdx  = s_cubeFaceNeighbours[currentFaceIdx][side].m_faceIdx;
+                uint8_t neighbourFaceEdge = s_cubeFaceNeighbours[currentFaceIdx][side].m_faceEdge;
+                currentFaceIdx = neighbourFaceIdx;
+
+                ///
+                /// https://code.google.com/p/cubemapgen/source/browse/trunk/CCubeMapProcessor.cpp#773
+                ///
+                /// Handle situations when bbMin and bbMax should be flipped.
+                ///
+                ///    L - Left           ....................T-T
+                ///    R - Right          v                     .
+                ///    T - Top        __________                .
+                ///    B - Bottom    .          |               .
+                ///                  .          |               .
+                ///                  .          |<...R-T        .
+                ///                  .          |    v          v
+                ///        .......... ..........|__________ __________
+                ///       .          .          .          .          .
+                ///       .          .          .          .          .
+                ///       .          .          .          .          .
+                ///       .          .          .          .          .
+                ///        __________ .......... .......... __________
+                ///            ^     |          .               ^
+                ///            .     |          .               .
+                ///            B-L..>|          .               .
+                ///                  |          .               .
+                ///                  |__________.               .
+                ///                       ^                     .
+                ///                       ....................B-B
+                ///
+                /// Those are:
+                ///     B-L, B-B
+                ///     T-R, T-T
+                ///     (and in reverse order, R-T and L-B)
+                ///
+                /// If we add, R-R and L-L (which never occur), we get:
+                ///     B-L, B-B
+                ///     T-R, T-T
+                ///     R-T, R-R
+                ///     L-B, L-L
+                ///
+                /// And if L = 0, R = 1, T = 2, B = 3 as in NeighbourSides enumeration,
+                /// a general rule can be derived for when to flip bbMin and bbMax:
+                ///     if ((a+b) == 3 || (a == b))
+                ///     {
+                ///        ..flip bbMin and bbMax
+                ///     }
+                ///
+                float bbMin = bleed[side].m_bbMin;
+                float bbMax = bleed[side].m_bbMax;
+                if ((side == neighbourFaceEdge)
+                || (3 == (side + neighbourFaceEdge)))
+                {
+                    // Flip.
+                    bbMin = 1.0f - bbMin;
+                    bbMax = 1.0f - bbMax;
+                }
+
+                switch (neighbourFaceEdge)
+                {
+                case CMFT_EDGE_LEFT:
+                    {
+                        ///  --> U
+                        /// |  .............
+                        /// v  .           .
+                        /// V  x___        .
+                        ///    |   |       .
+                        ///    |   |       .
+                        ///    |___x       .
+                        ///    .           .
+                        ///    .............
+                        ///
+                        _filterArea[neighbourFaceIdx].add(0.0f, bbMin);
+                        _filterArea[neighbourFaceIdx].add(bleedAmount, bbMax);
+                    }
+                break;
+
+                case CMFT_EDGE_RIGHT:
+                    {
+                        ///  --> U
+                        /// |  .............
+                        /// v  .           .
+                        /// V  .       x___.
+                        ///    .       |   |
+                        ///    .       |   |
+                        ///    .       |___x
+                        ///    .           .
+                        ///    .............
+                        ///
+                        _filterArea[neighbourFaceIdx].add(1.0f - bleedAmount, bbMin);
+                        _filterArea[neighbourFaceIdx].add(1.0f, bbMax);
+                    }
+                break;
+
+                case CMFT_EDGE_TOP:
+                    {
+                        ///  --> U
+                        /// |  ...x____ ...
+                        /// v  .  |    |  .
+                        /// V  .  |____x  .
+                        ///    .          .
+                        ///    .          .
+                        ///    .          .
+                        ///    ............
+                        ///
+                        _filterArea[neighbourFaceIdx].add(bbMin, 0.0f);
+                        _filterArea[neighbourFaceIdx].add(bbMax, bleedAmount);
+                    }
+                break;
+
+                case CMFT_EDGE_BOTTOM:
+                    {
+                        ///  --> U
+                        /// |  ............
+                        /// v  .          .
+                        /// V  .          .
+                        ///    .          .
+                        ///    .  x____   .
+                        ///    .  |    |  .
+                        ///    ...|____x...
+                        ///
+                        _filterArea[neighbourFaceIdx].add(bbMin, 1.0f - bleedAmount);
+                        _filterArea[neighbourFaceIdx].add(bbMax, 1.0f);
+                    }
+                break;
+                }
+
+                // Clamp bounding box to face size.
+                _filterArea[neighbourFaceIdx].clamp(0.0f, 1.0f);
+            }
+        }
+    }
+
+    static inline size_t cubemapFilterAreaSize(uint32_t _cubemapFaceSize)
+    {
+        return (_cubemapFaceSize /*width*/
+              * _cubemapFaceSize /*height*/
+              * (6*4) /*numChannels*/
+              * 4 /*bytesPerChannel*/
+              );
+    }
+
+    void* buildCubemapFilterArea(void* _mem, size_t _size, uint8_t _faceIdx, uint32_t _cubemapFaceSize, float _filterSize, EdgeFixup::Enum _fixup = EdgeFixup::None)
+    {
+        const float cfs = float(int32_t(_cubemapFaceSize));
+        const float invCfs = 1.0f/cfs;
+
+        if (EdgeFixup::None == _fixup)
+        {
+            float* dstPtr = (float*)_mem;
+
+            float yyf = 1.0f;
+            for (uint32_t yy = 0; yy < _cubemapFaceSize; ++yy, yyf+=2.0f)
+            {
+                float xxf = 1.0f;
+                for (uint32_t xx = 0; xx < _cubemapFaceSize; ++xx, xxf+=2.0f)
+                {
+                    // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
+                    // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
+                    //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
+                    const float uu = xxf*invCfs - 1.0f;
+                    const float vv = yyf*invCfs - 1.0f;
+
+                    float tapVec[3];
+                    texelCoordToVec(tapVec, uu, vv, _faceIdx);
+
+                    Aabb* faces = (Aabb*)dstPtr;
+                    determineFilterArea(faces, tapVec, _filterSize);
+
+                    dstPtr += (6*4); // six faces -> 6 x Aabb
+                }
+            }
+        }
+        else //if (EdgeFixup::Warp == _fixup)#
+        {
+            const float warp = warpFixupFactor(cfs);
+            float* dstPtr = (float*)_mem;
+
+            float yyf = 1.0f;
+            for (uint32_t yy = 0; yy < _cubemapFaceSize; ++yy, yyf+=2.0f)
+            {
+                float xxf = 1.0f;
+                for (uint32_t xx = 0; xx < _cubemapFaceSize; ++xx, xxf+=2.0f)
+                {
+                    // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
+                    // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
+                    //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
+                    const float uu = xxf*invCfs - 1.0f;
+                    const float vv = yyf*invCfs - 1.0f;
 
-        ///  ........
-        ///  .      .
-        ///  .   ___.
-        ///  .  | x |
-        ///  ...|___|
-        ///
-        // Calculate hit face filter bounds.
-        Aabb hitFaceFilterBounds;
-        hitFaceFilterBounds.add(uu-_filterSize, vv-_filterSize);
-        hitFaceFilterBounds.add(uu+_filterSize, vv+_filterSize);
-        hitFaceFilterBounds.clamp(0.0f, 1.0f);
+                    float tapVec[3];
+                    texelCoordToVecWarp(tapVec, uu, vv, _faceIdx, warp);
 
-        // Output result for hit face.
-        DEBUG_CHECK(6 > hitFaceIdx, "Face idx should be in range 0-5");
-        memcpy(&_filterArea[hitFaceIdx], &hitFaceFilterBounds, sizeof(Aabb));
+                    Aabb* faces = (Aabb*)dstPtr;
+                    determineFilterArea(faces, tapVec, _filterSize);
 
-        /// Filter area might extend on neighbour faces.
-        /// Case when extending over the right edge:
-        ///
-        ///  --> U
-        /// |        ......
-        /// v       .      .
-        /// V       .      .
-        ///         .      .
-        ///  ....... ...... .......
-        ///  .      .      .      .
-        ///  .      .  .....__min .
-        ///  .      .  .   .  |  -> amount
-        ///  ....... .....x.__|....
-        ///         .  .   .  max
-        ///         .  ........
-        ///         .      .
-        ///          ......
-        ///         .      .
-        ///         .      .
-        ///         .      .
-        ///          ......
-        ///
+                    dstPtr += (6*4); // six faces -> 6 x Aabb
+                }
+            }
+        }
+
+        return (uint8_t*)_mem + _size;
+    }
+
+    float* buildCubemapFilterArea(uint8_t _faceIdx, uint32_t _cubemapFaceSize, float _filterSize, EdgeFixup::Enum _fixup = EdgeFixup::None, AllocatorI* _allocator = g_allocator)
+    {
+        const size_t size = cubemapFilterAreaSize(_cubemapFaceSize);
+        float* mem = (float*)CMFT_ALLOC(_allocator, size);
+        MALLOC_CHECK(mem);
+
+        buildCubemapFilterArea(mem, size, _faceIdx, _cubemapFaceSize, _filterSize, _fixup);
+
+        return mem;
+    }
+
+    // Table cache.
+    //-----
+
+    struct CubemapTableKey
+    {
+        bool operator==(const CubemapTableKey& _other) const
+        {
+            return m_table      == _other.m_table
+                && m_faceSize   == _other.m_faceSize
+                && m_fixup      == _other.m_fixup
+                && m_faceIdx    == _other.m_faceIdx
+                && m_filterSize == _other.m_filterSize
+                ;
+        }
+
+        CubemapTable::Enum m_table;
+        uint32_t m_faceSize;
+        EdgeFixup::Enum m_fixup;
+        uint8_t m_faceIdx;
+        float m_filterSize;
+    };
+
+    struct CubemapTableEntry
+    {
+        CubemapTableKey m_key;
+        float* m_data;
+        size_t m_size;
+        uint32_t m_refCount;
+        uint64_t m_lastUse;
+    };
+
+    /// Tables are allocated with 64 byte alignment, so planar kernels can use aligned loads.
+    static float* buildCubemapTable(size_t& _size, const CubemapTableKey& _key)
+    {
+        switch (_key.m_table)
+        {
+        case CubemapTable::NormalSolidAngle: _size = cubemapNormalSolidAngleSize(_key.m_faceSize); break;
+        case CubemapTable::NormalPlanes:     _size = cubemapPlanesSize(_key.m_faceSize, 4);        break;
+        case CubemapTable::ShIrradiance:     _size = cubemapShIrradianceSize(_key.m_faceSize);     break;
+        default:                             _size = cubemapFilterAreaSize(_key.m_faceSize);       break;
+        }
+
+        float* mem = (float*)CMFT_ALIGNED_ALLOC(&g_crtAllocator, _size, 64);
+        MALLOC_CHECK(mem);
+
+        if (CubemapTable::NormalSolidAngle == _key.m_table)
+        {
+            buildCubemapNormalSolidAngle(mem, _size, _key.m_faceSize, _key.m_fixup);
+        }
+        else if (CubemapTable::NormalPlanes == _key.m_table)
+        {
+            const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+            uint32_t normalFaceOffsets[CUBE_FACE_NUM];
+            for (uint8_t face = 0; face < 6; ++face)
+            {
+                normalFaceOffsets[face] = face*_key.m_faceSize*_key.m_faceSize*bytesPerPixel;
+            }
+
+            const float* cubemapVectors = cubemapTableAcquire(CubemapTable::NormalSolidAngle, _key.m_faceSize, _key.m_fixup);
+            buildCubemapPlanes(mem, 4, cubemapVectors, normalFaceOffsets, _key.m_faceSize);
+            cubemapTableRelease(cubemapVectors);
+        }
+        else if (CubemapTable::ShIrradiance == _key.m_table)
+        {
+            buildCubemapShIrradiance(mem, _key.m_faceSize);
+        }
+        else
+        {
+            buildCubemapFilterArea(mem, _size, _key.m_faceIdx, _key.m_faceSize, _key.m_filterSize, _key.m_fixup);
+        }
+
+        return mem;
+    }
+
+    struct TableCache
+    {
+        enum
+        {
+            MaxEntries = 256,
+        };
+
+        TableCache()
+        {
+            m_numEntries = 0;
+            m_useCounter = 0;
+            m_size       = 0;
+            m_maxSize    = UINT64_C(256)<<20;
+            m_hits       = 0;
+            m_misses     = 0;
+            m_evictions  = 0;
+        }
+
+        ~TableCache()
+        {
+            clear();
+        }
+
+        const float* acquire(const CubemapTableKey& _key)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_access);
+
+                CubemapTableEntry* entry = find(_key);
+                if (NULL != entry)
+                {
+                    m_hits++;
+                    return use(*entry);
+                }
+
+                m_misses++;
+            }
+
+            // Build outside of the lock, so misses of other tables are not serialized.
+            size_t size;
+            float* data = buildCubemapTable(size, _key);
+
+            std::lock_guard<std::mutex> lock(m_access);
+
+            // Another thread built the same table meanwhile.
+            CubemapTableEntry* entry = find(_key);
+            if (NULL != entry)
+            {
+                CMFT_ALIGNED_FREE(&g_crtAllocator, data, 64);
+                return use(*entry);
+            }
+
+            if (m_numEntries == MaxEntries && !evictLru())
+            {
+                // Every entry is in use, caller gets an uncached table that is freed on release.
+                return data;
+            }
+
+            entry = &m_entries[m_numEntries++];
+            entry->m_key      = _key;
+            entry->m_data     = data;
+            entry->m_size     = size;
+            entry->m_refCount = 0;
+            m_size += size;
+
+            const float* result = use(*entry);
+            trim();
+
+            return result;
+        }
+
+        void release(const float* _data)
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+
+            for (uint16_t ii = 0; ii < m_numEntries; ++ii)
+            {
+                if (m_entries[ii].m_data == _data)
+                {
+                    m_entries[ii].m_refCount--;
+                    trim();
+                    return;
+                }
+            }
+
+            CMFT_ALIGNED_FREE(&g_crtAllocator, const_cast<float*>(_data), 64);
+        }
+
+        void setMaxSize(uint64_t _maxSize)
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+            m_maxSize = _maxSize;
+            trim();
+        }
+
+        void getStats(TableCacheStats& _stats)
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+            _stats.m_hits      = m_hits;
+            _stats.m_misses    = m_misses;
+            _stats.m_evictions = m_evictions;
+            _stats.m_size      = m_size;
+            _stats.m_maxSize   = m_maxSize;
+            _stats.m_numTables = m_numEntries;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+            while (evictLru())
+            {
+            }
+        }
+
+    private:
+        // Functions below expect m_access to be locked.
+        CubemapTableEntry* find(const CubemapTableKey& _key)
+        {
+            for (uint16_t ii = 0; ii < m_numEntries; ++ii)
+            {
+                if (m_entries[ii].m_key == _key)
+                {
+                    return &m_entries[ii];
+                }
+            }
+
+            return NULL;
+        }
+
+        const float* use(CubemapTableEntry& _entry)
+        {
+            _entry.m_refCount++;
+            _entry.m_lastUse = ++m_useCounter;
+            return _entry.m_data;
+        }
+
+        // Frees least recently used table that is not in use. Returns false when there is none.
+        bool evictLru()
+        {
+            uint16_t lru = UINT16_MAX;
+            for (uint16_t ii = 0; ii < m_numEntries; ++ii)
+            {
+                if (0 == m_entries[ii].m_refCount
+                && (UINT16_MAX == lru || m_entries[ii].m_lastUse < m_entries[lru].m_lastUse))
+                {
+                    lru = ii;
+                }
+            }
+
+            if (UINT16_MAX == lru)
+            {
+                return false;
+            }
+
+            CMFT_ALIGNED_FREE(&g_crtAllocator, m_entries[lru].m_data, 64);
+            m_size -= m_entries[lru].m_size;
+            m_evictions++;
+
+            m_entries[lru] = m_entries[--m_numEntries];
+
+            return true;
+        }
+
+        void trim()
+        {
+            while (m_size > m_maxSize && evictLru())
+            {
+            }
+        }
+
+        std::mutex m_access;
+        CubemapTableEntry m_entries[MaxEntries];
+        uint16_t m_numEntries;
+        uint64_t m_useCounter;
+        uint64_t m_size;
+        uint64_t m_maxSize;
+        uint64_t m_hits;
+        uint64_t m_misses;
+        uint64_t m_evictions;
+    };
+
+    static TableCache s_tableCache;
+
+    const float* cubemapTableAcquire(CubemapTable::Enum _table, uint32_t _faceSize, EdgeFixup::Enum _fixup, uint8_t _faceIdx, float _filterSize)
+    {
+        const bool filterArea = (CubemapTable::FilterArea == _table);
+
+        CubemapTableKey key;
+        key.m_table      = _table;
+        key.m_faceSize   = _faceSize;
+        key.m_fixup      = _fixup;
+        key.m_faceIdx    = filterArea ? _faceIdx    : 0;
+        key.m_filterSize = filterArea ? _filterSize : 0.0f;
+
+        return s_tableCache.acquire(key);
+    }
+
+    void cubemapTableRelease(const float* _table)
+    {
+        s_tableCache.release(_table);
+    }
+
+    void tableCacheSetMaxSize(uint64_t _maxSize)
+    {
+        s_tableCache.setMaxSize(_maxSize);
+    }
+
+    void tableCacheGetStats(TableCacheStats& _stats)
+    {
+        s_tableCache.getStats(_stats);
+    }
+
+    void tableCacheClear()
+    {
+        s_tableCache.clear();
+    }
+
+    struct TileClass
+    {
+        enum Enum
+        {
+            Outside,
+            Partial,
+            Inside,
+        };
+    };
+
+    /// Tile is outside when the angle between tap and tile axis exceeds lobe angle + tile spread,
+    /// inside when it does not exceed lobe angle - tile spread.
+    static inline TileClass::Enum classifyTile(const RadianceTile& _tile, const float* _tapVec, float _cosLobe, float _sinLobe)
+    {
+        const float cosAxis = vec3Dot(_tile.m_axis, _tapVec);
+
+        const float sinSum = _sinLobe*_tile.m_cosSpread + _cosLobe*_tile.m_sinSpread;
+        const float cosSum = _cosLobe*_tile.m_cosSpread - _sinLobe*_tile.m_sinSpread;
+        if (sinSum > 0.0f && cosAxis < cosSum)
+        {
+            return TileClass::Outside;
+        }
+
+        const float cosDiff = _cosLobe*_tile.m_cosSpread + _sinLobe*_tile.m_sinSpread;
+        if (_tile.m_cosSpread >= _cosLobe && cosAxis >= cosDiff)
+        {
+            return TileClass::Inside;
+        }
+
+        return TileClass::Partial;
+    }
+
+    /// Type in which kernel results of a single output texel are added up.
+    template <Accumulation::Enum AccumulationT>
+    struct AccumulationType
+    {
+        typedef float Type;
+    };
+
+    template <>
+    struct AccumulationType<Accumulation::Double>
+    {
+        typedef double Type;
+    };
+
+    /// Collects filter spans and accumulates them with the kernel each time the buffer fills up. Spans are shared
+    /// by all sources of _args, which differ in source data only. More sources are accumulated with the group
+    /// kernel when there is one.
+    template <Accumulation::Enum AccumulationT>
+    struct RadianceSpanBatch
+    {
+        typedef typename AccumulationType<AccumulationT>::Type AccumT;
+
+        RadianceSpanBatch(RadianceKernelFn _kernel, RadianceGroupKernelFn _groupKernel, RadianceKernelArgs* _args, uint8_t _numArgs)
+            : m_kernel(_kernel)
+            , m_groupKernel(_groupKernel)
+            , m_args(_args)
+            , m_numArgs(_numArgs)
+            , m_numSpans(0)
+        {
+            memset(m_runningSum, 0, sizeof(m_runningSum));
+
+            for (uint8_t ii = 0; ii < m_numArgs; ++ii)
+            {
+                m_args[ii].m_spans = m_spans;
+                m_args[ii].m_numSpans = 0;
+                m_args[ii].m_runningSum = m_runningSum[ii];
+
+                m_colorWeight[ii][0] = AccumT(0.0f);
+                m_colorWeight[ii][1] = AccumT(0.0f);
+                m_colorWeight[ii][2] = AccumT(0.0f);
+                m_colorWeight[ii][3] = AccumT(0.0f);
+            }
+        }
+
+        void add(const RadianceFilterSpan& _span)
+        {
+            m_spans[m_numSpans++] = _span;
+
+            if (CMFT_COUNTOF(m_spans) == m_numSpans)
+            {
+                flush();
+            }
+        }
+
+        void flush()
+        {
+            if (0 == m_numSpans)
+            {
+                return;
+            }
+
+            float colorWeights[RADIANCE_KERNEL_MAX_GROUP][4];
+            for (uint8_t ii = 0; ii < m_numArgs; ++ii)
+            {
+                m_args[ii].m_numSpans = m_numSpans;
+            }
+
+            if (1 < m_numArgs && NULL != m_groupKernel)
+            {
+                m_groupKernel(colorWeights[0], m_args, m_numArgs);
+            }
+            else
+            {
+                for (uint8_t ii = 0; ii < m_numArgs; ++ii)
+                {
+                    m_kernel(colorWeights[ii], m_args[ii]);
+                }
+            }
 
-        enum NeighbourSides
-        {
-            Left,
-            Right,
-            Top,
-            Bottom,
+            for (uint8_t ii = 0; ii < m_numArgs; ++ii)
+            {
+                const float* colorWeight = colorWeights[ii];
 
-            NeighbourSidesCount,
-        };
+                // Compensated kernels continue m_runningSum and return the total so far.
+                if (Accumulation::Compensated == AccumulationT)
+                {
+                    m_colorWeight[ii][0] = colorWeight[0];
+                    m_colorWeight[ii][1] = colorWeight[1];
+                    m_colorWeight[ii][2] = colorWeight[2];
+                    m_colorWeight[ii][3] = colorWeight[3];
+                }
+                else
+                {
+                    m_colorWeight[ii][0] += colorWeight[0];
+                    m_colorWeight[ii][1] += colorWeight[1];
+                    m_colorWeight[ii][2] += colorWeight[2];
+                    m_colorWeight[ii][3] += colorWeight[3];
+                }
+            }
 
-        struct NeighourFaceBleed
-        {
-            float m_amount;
-            float m_bbMin;
-            float m_bbMax;
-        } bleed[NeighbourSidesCount] =
+            m_numSpans = 0;
+        }
+
+        RadianceKernelFn m_kernel;
+        RadianceGroupKernelFn m_groupKernel;
+        RadianceKernelArgs* m_args;
+        uint8_t m_numArgs;
+        uint32_t m_numSpans;
+        RadianceFilterSpan m_spans[32];
+        AccumT m_colorWeight[RADIANCE_KERNEL_MAX_GROUP][4];
+        float m_runningSum[RADIANCE_KERNEL_MAX_GROUP][8];
+    };
+
+    /// Accumulates the lobe over filter area of a single output texel, for each of _numArgs sources of the same
+    /// size and format. _args must have everything but the tap vector and spans set, _res gets three floats
+    /// per source. TilesT enables tile culling.
+    template <bool TilesT, Accumulation::Enum AccumulationT>
+    static void processFilterArea(float* _res
+                                , RadianceKernelFn _kernel
+                                , RadianceGroupKernelFn _groupKernel
+                                , RadianceKernelArgs* _args
+                                , uint8_t _numArgs
+                                , const float* _tapVec
+                                , const Aabb _filterArea[6]
+                                , const RadianceTile* _tiles
+                                )
+    {
+        const uint32_t srcFaceSize = _args[0].m_srcFaceSize;
+        const float faceSize_MinusOne = float(int32_t(srcFaceSize-1));
+        const uint32_t tilesPerRow = cubemapTilesPerRow(srcFaceSize);
+
+        for (uint8_t ii = 0; ii < _numArgs; ++ii)
         {
-            { // Left
-                _filterSize - uu,
-                hitFaceFilterBounds.m_min[1],
-                hitFaceFilterBounds.m_max[1],
-            },
-            { // Right
-                uu + _filterSize - 1.0f,
-                hitFaceFilterBounds.m_min[1],
-                hitFaceFilterBounds.m_max[1],
-            },
-            { // Top
-                _filterSize - vv,
-                hitFaceFilterBounds.m_min[0],
-                hitFaceFilterBounds.m_max[0],
-            },
-            { // Bottom
-                vv + _filterSize - 1.0f,
-                hitFaceFilterBounds.m_min[0],
-                hitFaceFilterBounds.m_max[0],
-            },
-        };
+            _args[ii].m_tapVec = _tapVec;
+        }
 
-        // Determine bleeding for each side.
-        for (uint8_t side = 0; side < 4; ++side)
+        typedef typename AccumulationType<AccumulationT>::Type AccumT;
+        RadianceSpanBatch<AccumulationT> batch(_kernel, _groupKernel, _args, _numArgs);
+
+        for (uint8_t face = 0; face < 6; ++face)
         {
-            uint8_t currentFaceIdx = hitFaceIdx;
+            if (_filterArea[face].isEmpty())
+            {
+                continue;
+            }
 
-            for (float bleedAmount = bleed[side].m_amount; bleedAmount > 0.0f; bleedAmount -= 1.0f)
+            const uint32_t minX = uint32_t(_filterArea[face].m_min[0] * faceSize_MinusOne);
+            const uint32_t maxX = uint32_t(_filterArea[face].m_max[0] * faceSize_MinusOne);
+            const uint32_t minY = uint32_t(_filterArea[face].m_min[1] * faceSize_MinusOne);
+            const uint32_t maxY = uint32_t(_filterArea[face].m_max[1] * faceSize_MinusOne);
+
+            // Without tiles, or when filter area is not larger than a tile, it is passed as it is.
+            if (!TilesT
+            || (maxX - minX < RADIANCE_TILE_SIZE && maxY - minY < RADIANCE_TILE_SIZE))
             {
-                uint8_t neighbourFaceIdx  = s_cubeFaceNeighbours[currentFaceIdx][side].m_faceIdx;
-                uint8_t neighbourFaceEdge = s_cubeFaceNeighbours[currentFaceIdx][side].m_faceEdge;
-                currentFaceIdx = neighbourFaceIdx;
+                const RadianceFilterSpan span = { minX, maxX, minY, maxY, face, false };
+                batch.add(span);
+                continue;
+            }
 
-                ///
-                /// https://code.google.com/p/cubemapgen/source/browse/trunk/CCubeMapProcessor.cpp#773
-                ///
-                /// Handle situations when bbMin and bbMax should be flipped.
-                ///
-                ///    L - Left           ....................T-T
-                ///    R - Right          v                     .
-                ///    T - Top        __________                .
-                ///    B - Bottom    .          |               .
-                ///                  .          |               .
-                ///                  .          |<...R-T        .
-                ///                  .          |    v          v
-                ///        .......... ..........|__________ __________
-                ///       .          .          .          .          .
-                ///       .          .          .          .          .
-                ///       .          .          .          .          .
-                ///       .          .          .          .          .
-                ///        __________ .......... .......... __________
-                ///            ^     |          .               ^
-                ///            .     |          .               .
-                ///            B-L..>|          .               .
-                ///                  |          .               .
-                ///                  |__________.               .
-                ///                       ^                     .
-                ///                       ....................B-B
-                ///
-                /// Those are:
-                ///     B-L, B-B
-                ///     T-R, T-T
-                ///     (and in reverse order, R-T and L-B)
-                ///
-                /// If we add, R-R and L-L (which never occur), we get:
-                ///     B-L, B-B
-                ///     T-R, T-T
-                ///     R-T, R-R
-                ///     L-B, L-L
-                ///
-                /// And if L = 0, R = 1, T = 2, B = 3 as in NeighbourSides enumeration,
-                /// a general rule can be derived for when to flip bbMin and bbMax:
-                ///     if ((a+b) == 3 || (a == b))
-                ///     {
-                ///        ..flip bbMin and bbMax
-                ///     }
-                ///
-                float bbMin = bleed[side].m_bbMin;
-                float bbMax = bleed[side].m_bbMax;
-                if ((side == neighbourFaceEdge)
-                || (3 == (side + neighbourFaceEdge)))
-                {
-                    // Flip.
-                    bbMin = 1.0f - bbMin;
-                    bbMax = 1.0f - bbMax;
-                }
+            // For each row of tiles, trim tiles outside of the lobe from both ends. Texel rows of a cube face
+            // are great circle arcs and the lobe (at most a hemisphere) is convex, so the run is inside the lobe
+            // when both of its end tiles are. Tile rows with equal texel range and class are merged.
+            const float cosLobe = _args[0].m_specularAngle;
+            const float sinLobe = sqrtf(CMFT_MAX(0.0f, 1.0f - cosLobe*cosLobe));
+            const uint32_t minTx = minX/RADIANCE_TILE_SIZE;
+            const uint32_t maxTx = maxX/RADIANCE_TILE_SIZE;
+            RadianceFilterSpan span = { 0, 0, 0, 0, face, false };
+            bool pending = false;
+
+            for (uint32_t ty = minY/RADIANCE_TILE_SIZE, tyEnd = maxY/RADIANCE_TILE_SIZE; ty <= tyEnd; ++ty)
+            {
+                const RadianceTile* tileRow = _tiles + (face*tilesPerRow + ty)*tilesPerRow;
 
-                switch (neighbourFaceEdge)
+                uint32_t first = minTx;
+                TileClass::Enum firstClass = TileClass::Outside;
+                for (; first <= maxTx; ++first)
                 {
-                case CMFT_EDGE_LEFT:
+                    firstClass = classifyTile(tileRow[first], _tapVec, cosLobe, sinLobe);
+                    if (TileClass::Outside != firstClass)
                     {
-                        ///  --> U
-                        /// |  .............
-                        /// v  .           .
-                        /// V  x___        .
-                        ///    |   |       .
-                        ///    |   |       .
-                        ///    |___x       .
-                        ///    .           .
-                        ///    .............
-                        ///
-                        _filterArea[neighbourFaceIdx].add(0.0f, bbMin);
-                        _filterArea[neighbourFaceIdx].add(bleedAmount, bbMax);
+                        break;
                     }
-                break;
+                }
 
-                case CMFT_EDGE_RIGHT:
-                    {
-                        ///  --> U
-                        /// |  .............
-                        /// v  .           .
-                        /// V  .       x___.
-                        ///    .       |   |
-                        ///    .       |   |
-                        ///    .       |___x
-                        ///    .           .
-                        ///    .............
-                        ///
-                        _filterArea[neighbourFaceIdx].add(1.0f - bleedAmount, bbMin);
-                        _filterArea[neighbourFaceIdx].add(1.0f, bbMax);
-                    }
-                break;
+                if (first > maxTx)
+                {
+                    continue;
+                }
 
-                case CMFT_EDGE_TOP:
+                uint32_t last = maxTx;
+                bool inside = (TileClass::Inside == firstClass);
+                for (; last > first; --last)
+                {
+                    const TileClass::Enum lastClass = classifyTile(tileRow[last], _tapVec, cosLobe, sinLobe);
+                    if (TileClass::Outside != lastClass)
                     {
-                        ///  --> U
-                        /// |  ...x____ ...
-                        /// v  .  |    |  .
-                        /// V  .  |____x  .
-                        ///    .          .
-                        ///    .          .
-                        ///    .          .
-                        ///    ............
-                        ///
-                        _filterArea[neighbourFaceIdx].add(bbMin, 0.0f);
-                        _filterArea[neighbourFaceIdx].add(bbMax, bleedAmount);
+                        inside &= (TileClass::Inside == lastClass);
+                        break;
                     }
-                break;
+                }
 
-                case CMFT_EDGE_BOTTOM:
-                    {
-                        ///  --> U
-                        /// |  ............
-                        /// v  .          .
-                        /// V  .          .
-                        ///    .          .
-                        ///    .  x____   .
-                        ///    .  |    |  .
-                        ///    ...|____x...
-                        ///
-                        _filterArea[neighbourFaceIdx].add(bbMin, 1.0f - bleedAmount);
-                        _filterArea[neighbourFaceIdx].add(bbMax, 1.0f);
-                    }
-                break;
+                const uint32_t spanMinX = CMFT_MAX(minX, first*RADIANCE_TILE_SIZE);
+                const uint32_t spanMaxX = CMFT_MIN(maxX, last*RADIANCE_TILE_SIZE + RADIANCE_TILE_SIZE-1);
+                const uint32_t spanMinY = CMFT_MAX(minY, ty*RADIANCE_TILE_SIZE);
+                const uint32_t spanMaxY = CMFT_MIN(maxY, ty*RADIANCE_TILE_SIZE + RADIANCE_TILE_SIZE-1);
+
+                if (pending
+                &&  span.m_minX   == spanMinX
+                &&  span.m_maxX   == spanMaxX
+                &&  span.m_maxY+1 == spanMinY
+                &&  span.m_inside == inside)
+                {
+                    span.m_maxY = spanMaxY;
+                    continue;
+                }
+
+                if (pending)
+                {
+                    batch.add(span);
                 }
 
-                // Clamp bounding box to face size.
-                _filterArea[neighbourFaceIdx].clamp(0.0f, 1.0f);
+                span.m_minX   = spanMinX;
+                span.m_maxX   = spanMaxX;
+                span.m_minY   = spanMinY;
+                span.m_maxY   = spanMaxY;
+                span.m_inside = inside;
+                pending = true;
+            }
+
+            if (pending)
+            {
+                batch.add(span);
+            }
+        }
+
+        batch.flush();
+
+        for (uint8_t ii = 0; ii < _numArgs; ++ii)
+        {
+            const AccumT* colorWeight = batch.m_colorWeight[ii];
+            float* res = &_res[ii*3];
+
+            // Divide color by colorWeight and store result.
+            if (AccumT(0.0f) != colorWeight[3])
+            {
+                const AccumT invWeight = AccumT(1.0f)/colorWeight[3];
+                res[0] = float(colorWeight[0] * invWeight);
+                res[1] = float(colorWeight[1] * invWeight);
+                res[2] = float(colorWeight[2] * invWeight);
+            }
+            // Else if colorWeight == 0 (result of convolution is zero) take a direct color sample.
+            else
+            {
+                float uu, vv;
+                uint8_t hitFaceIdx;
+                vecToTexelCoord(uu, vv, hitFaceIdx, _tapVec);
+
+                const uint32_t xx = uint32_t(uu*float(srcFaceSize));
+                const uint32_t yy = uint32_t(vv*float(srcFaceSize));
+
+                const RadianceKernelArgs& args = _args[ii];
+                const uint32_t bytesPerPixel = getImageDataInfo(args.m_srcFormat).m_bytesPerPixel;
+                const uint32_t pitch = srcFaceSize*bytesPerPixel;
+                const void* dataPtr = (const uint8_t*)args.m_srcData
+                                    + args.m_faceOffsets[hitFaceIdx]
+                                    + yy*pitch
+                                    + xx*bytesPerPixel
+                                    ;
+
+                float texel[4];
+                toRgba32f(texel, args.m_srcFormat, dataPtr);
+                res[0] = texel[0];
+                res[1] = texel[1];
+                res[2] = texel[2];
+            }
+        }
+    }
+
+    struct RadianceFilterSource;
+    struct GgxSampleSet;
+    struct RadianceFilterParams;
+
+    /// Face of another cubemap of a batch that is filtered along with the face of RadianceFilterParams. Source has
+    /// the same size and format, so filter area and spans of each texel are found once for both.
+    struct RadianceFilterSibling
+    {
+        float* m_dstPtr;
+        const Image* m_image;
+        const uint32_t* m_faceOffsets;
+        const float* m_srcPlanes;
+    };
+
+    /// Filters rows [_rowBegin, _rowEnd) of the face given by _params.
+    typedef void (*RadianceFilterFn)(const RadianceFilterParams& _params, uint32_t _rowBegin, uint32_t _rowEnd);
+
+    struct RadianceFilterParams
+    {
+        float* m_dstPtr;
+        uint8_t m_face;
+        uint32_t m_mipFaceSize;
+        float m_filterSize;
+        float m_specularPower;
+        float m_specularAngle;
+        const float* m_cubemapVectors;
+        const Image* m_image;
+        const uint32_t* m_faceOffsets;
+        const float* m_normalPlanes;
+        const float* m_srcPlanes;
+        const RadianceTile* m_tiles;
+        EdgeFixup::Enum m_edgeFixup;
+        RadianceKernelFn m_kernel;
+        RadianceGroupKernelFn m_groupKernel;
+        const GgxSampleSet* m_ggxSamples; // Used by Ggx lobe instead of the other lobe parameters and tables.
+        const RadianceFilterSource* m_srcLevels;
+        uint8_t m_srcLevelCount;
+        RadianceFilterFn m_filter;
+        TextureFormat::Enum m_dstFormat; // Format the destination is converted to when filtering is done.
+        const RadianceFilterSibling* m_siblings;
+        uint8_t m_numSiblings;
+    };
+
+    /// Direction of destination texel at center adressed _u and _v.
+    template <bool WarpT>
+    static inline void dstTexelVec(float* _out3f, float _u, float _v, uint8_t _face, float _warpFixup)
+    {
+        if (WarpT)
+        {
+            texelCoordToVecWarp(_out3f, _u, _v, _face, _warpFixup);
+        }
+        else
+        {
+            texelCoordToVec(_out3f, _u, _v, _face);
+        }
+    }
+
+    /// Filters rows [_rowBegin, _rowEnd) of a single face, and the same face of each sibling, with the lobe
+    /// integrated over the filter area. WarpT is EdgeFixup::Warp and TilesT enables tile culling.
+    template <bool WarpT, bool TilesT, Accumulation::Enum AccumulationT>
+    static void radianceFilter(const RadianceFilterParams& _params, uint32_t _rowBegin, uint32_t _rowEnd)
+    {
+        const uint32_t mipFaceSize = _params.m_mipFaceSize;
+        const float mfs = float(int32_t(mipFaceSize));
+        const float invMfs = 1.0f/mfs;
+        const float warp = WarpT ? warpFixupFactor(mfs) : 0.0f;
+        const uint32_t srcFaceSize = _params.m_image->m_width;
+
+        RadianceKernelArgs args[RADIANCE_KERNEL_MAX_GROUP];
+        args[0].m_specularPower = _params.m_specularPower;
+        args[0].m_specularAngle = _params.m_specularAngle;
+        args[0].m_cubemapNormalSolidAngle = _params.m_cubemapVectors;
+        args[0].m_srcData = _params.m_image->m_data;
+        args[0].m_srcFormat = _params.m_image->m_format;
+        args[0].m_faceOffsets = _params.m_faceOffsets;
+        args[0].m_normalPlanes = _params.m_normalPlanes;
+        args[0].m_srcPlanes = _params.m_srcPlanes;
+        args[0].m_planePitch = cubemapPlanePitch(srcFaceSize);
+        args[0].m_srcFaceSize = srcFaceSize;
+        args[0].m_warpFixup = WarpT ? warpFixupFactor(float(int32_t(srcFaceSize))) : 0.0f; // For kernels that compute source texel normals.
+
+        const uint32_t rowOffset = _rowBegin*mipFaceSize*4;
+        float* dstPtr[RADIANCE_KERNEL_MAX_GROUP];
+        dstPtr[0] = _params.m_dstPtr + rowOffset;
+
+        const uint8_t numArgs = uint8_t(1 + _params.m_numSiblings);
+        for (uint8_t ii = 1; ii < numArgs; ++ii)
+        {
+            const RadianceFilterSibling& sibling = _params.m_siblings[ii-1];
+            args[ii] = args[0];
+            args[ii].m_srcData = sibling.m_image->m_data;
+            args[ii].m_faceOffsets = sibling.m_faceOffsets;
+            args[ii].m_srcPlanes = sibling.m_srcPlanes;
+            dstPtr[ii] = sibling.m_dstPtr + rowOffset;
+        }
+
+        float yyf = 1.0f + 2.0f*float(int32_t(_rowBegin));
+        for (uint32_t yy = _rowBegin; yy < _rowEnd; ++yy, yyf+=2.0f)
+        {
+            float xxf = 1.0f;
+            for (uint32_t xx = 0; xx < mipFaceSize; ++xx, xxf+=2.0f)
+            {
+                // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
+                // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
+                //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
+                const float uu = xxf*invMfs - 1.0f;
+                const float vv = yyf*invMfs - 1.0f;
+
+                float tapVec[3];
+                dstTexelVec<WarpT>(tapVec, uu, vv, _params.m_face, warp);
+
+                Aabb facesBb[6];
+                determineFilterArea(facesBb, tapVec, _params.m_filterSize);
+
+                float color[RADIANCE_KERNEL_MAX_GROUP*3];
+                processFilterArea<TilesT, AccumulationT>(color, _params.m_kernel, _params.m_groupKernel, args, numArgs, tapVec, facesBb, _params.m_tiles);
+
+                for (uint8_t ii = 0; ii < numArgs; ++ii)
+                {
+                    dstPtr[ii][0] = color[ii*3+0];
+                    dstPtr[ii][1] = color[ii*3+1];
+                    dstPtr[ii][2] = color[ii*3+2];
+                    dstPtr[ii][3] = 1.0f;
+
+                    dstPtr[ii] += 4;
+                }
             }
         }
     }
 
-    static inline size_t cubemapFilterAreaSize(uint32_t _cubemapFaceSize)
+    /// Source data and tables that cpu kernels read for one level of the source pyramid.
+    /// m_image is RGBA32F, or RGBA16F or RGBE which kernels decode as they read it.
+    struct RadianceFilterSource
     {
-        return (_cubemapFaceSize /*width*/
-              * _cubemapFaceSize /*height*/
-              * (6*4) /*numChannels*/
-              * 4 /*bytesPerChannel*/
-              );
-    }
+        const Image* m_image;
+        uint32_t m_faceOffsets[CUBE_FACE_NUM];
+        const float* m_cubemapVectors;
+        const float* m_normalPlanes;
+        float* m_srcPlanes;
+        RadianceTile* m_tiles;
+        TexelNormals::Enum m_texelNormals;
+        RadianceKernelFn m_kernel;
+        RadianceGroupKernelFn m_groupKernel;
+    };
 
-    void* buildCubemapFilterArea(void* _mem, size_t _size, uint8_t _faceIdx, uint32_t _cubemapFaceSize, float _filterSize, EdgeFixup::Enum _fixup = EdgeFixup::None)
+    /// Source face sizes from which TexelNormals::Auto computes normals instead of reading the table.
+    /// Planar table reads are cheaper, computed normals only pay off there once the table is far
+    /// out of cache (see testRadianceComputedNormals).
+    #define CMFT_COMPUTED_NORMALS_MIN_FACE_SIZE        1024
+    #define CMFT_COMPUTED_NORMALS_MIN_FACE_SIZE_PLANAR 2048
+
+    void radianceFilterSourceInit(RadianceFilterSource& _source
+                                , const Image& _image
+                                , EdgeFixup::Enum _fixup
+                                , const RadianceFilterOptions& _options
+                                , SimdLevel::Enum _simdLevel
+                                )
     {
-        const float cfs = float(int32_t(_cubemapFaceSize));
-        const float invCfs = 1.0f/cfs;
+        const uint32_t faceSize = _image.m_width;
 
-        if (EdgeFixup::None == _fixup)
+        // Planar kernels read float planes, RGBA16F and RGBE sources are read in place by interleaved kernels
+        // instead of being expanded into planes 2-4x their size.
+        const TableLayout::Enum tableLayout = (TextureFormat::RGBA32F == _image.m_format) ? _options.m_tableLayout : TableLayout::Interleaved;
+        const bool planar = (TableLayout::Planar == tableLayout);
+
+        _source.m_image = &_image;
+        imageGetFaceOffsets(_source.m_faceOffsets, _image);
+
+        _source.m_texelNormals = _options.m_texelNormals;
+        if (TexelNormals::Auto == _source.m_texelNormals)
         {
-            float* dstPtr = (float*)_mem;
+            const uint32_t minFaceSize = planar ? CMFT_COMPUTED_NORMALS_MIN_FACE_SIZE_PLANAR : CMFT_COMPUTED_NORMALS_MIN_FACE_SIZE;
+            _source.m_texelNormals = (faceSize >= minFaceSize) ? TexelNormals::Computed : TexelNormals::Table;
+        }
+        _source.m_kernel      = radianceKernel(_simdLevel, tableLayout, _options.m_lobeMath, _source.m_texelNormals, _options.m_accumulation, _image.m_format);
+        _source.m_groupKernel = radianceGroupKernel(_simdLevel, tableLayout, _options.m_lobeMath, _source.m_texelNormals, _options.m_accumulation, _image.m_format);
 
-            float yyf = 1.0f;
-            for (uint32_t yy = 0; yy < _cubemapFaceSize; ++yy, yyf+=2.0f)
-            {
-                float xxf = 1.0f;
-                for (uint32_t xx = 0; xx < _cubemapFaceSize; ++xx, xxf+=2.0f)
-                {
-                    // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
-                    // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
-                    //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
-                    const float uu = xxf*invCfs - 1.0f;
-                    const float vv = yyf*invCfs - 1.0f;
+        const bool normalTable = (TexelNormals::Table == _source.m_texelNormals);
 
-                    float tapVec[3];
-                    texelCoordToVec(tapVec, uu, vv, _faceIdx);
+        _source.m_cubemapVectors = NULL;
+        _source.m_normalPlanes   = NULL;
+        _source.m_srcPlanes      = NULL;
+        _source.m_tiles          = NULL;
 
-                    Aabb* faces = (Aabb*)dstPtr;
-                    determineFilterArea(faces, tapVec, _filterSize);
+        // Interleaved table is only read by interleaved kernels with table normals, or to build tiles.
+        if ((!planar && normalTable) || _options.m_tileCulling)
+        {
+            _source.m_cubemapVectors = cubemapTableAcquire(CubemapTable::NormalSolidAngle, faceSize, _fixup);
+        }
 
-                    dstPtr += (6*4); // six faces -> 6 x Aabb
-                }
-            }
+        if (_options.m_tileCulling)
+        {
+            _source.m_tiles = buildCubemapTiles(_source.m_cubemapVectors, faceSize, &g_crtAllocator);
         }
-        else //if (EdgeFixup::Warp == _fixup)#
+
+        if (planar)
         {
-            const float warp = warpFixupFactor(cfs);
-            float* dstPtr = (float*)_mem;
+            _source.m_normalPlanes = normalTable ? cubemapTableAcquire(CubemapTable::NormalPlanes, faceSize, _fixup) : NULL;
+            _source.m_srcPlanes    = buildCubemapPlanes(3, _image.m_data, _source.m_faceOffsets, faceSize, &g_crtAllocator, _image.m_format);
+        }
 
-            float yyf = 1.0f;
-            for (uint32_t yy = 0; yy < _cubemapFaceSize; ++yy, yyf+=2.0f)
-            {
-                float xxf = 1.0f;
-                for (uint32_t xx = 0; xx < _cubemapFaceSize; ++xx, xxf+=2.0f)
-                {
-                    // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
-                    // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
-                    //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
-                    const float uu = xxf*invCfs - 1.0f;
-                    const float vv = yyf*invCfs - 1.0f;
+        if (NULL != _source.m_cubemapVectors
+        && (planar || !normalTable))
+        {
+            cubemapTableRelease(_source.m_cubemapVectors);
+            _source.m_cubemapVectors = NULL;
+        }
+    }
 
-                    float tapVec[3];
-                    texelCoordToVecWarp(tapVec, uu, vv, _faceIdx, warp);
+    void radianceFilterSourceFree(RadianceFilterSource& _source)
+    {
+        if (NULL != _source.m_cubemapVectors)
+        {
+            cubemapTableRelease(_source.m_cubemapVectors);
+        }
 
-                    Aabb* faces = (Aabb*)dstPtr;
-                    determineFilterArea(faces, tapVec, _filterSize);
+        if (NULL != _source.m_normalPlanes)
+        {
+            cubemapTableRelease(_source.m_normalPlanes);
+        }
 
-                    dstPtr += (6*4); // six faces -> 6 x Aabb
+        if (NULL != _source.m_srcPlanes)
+        {
+            CMFT_ALIGNED_FREE(&g_crtAllocator, _source.m_srcPlanes, 64);
+        }
+
+        if (NULL != _source.m_tiles)
+        {
+            CMFT_FREE(&g_crtAllocator, _source.m_tiles);
+        }
+    }
+
+    /// Creates an RGBA32F cubemap of half the face size by averaging 2x2 texel blocks of cubemap _src.
+    void imageCubemapDownsample(Image& _dst, const Image& _src, AllocatorI* _allocator)
+    {
+        const uint32_t srcFaceSize = _src.m_width;
+        const uint32_t dstFaceSize = CMFT_MAX(UINT32_C(1), srcFaceSize/2);
+        const uint32_t bytesPerPixel = getImageDataInfo(_src.m_format).m_bytesPerPixel;
+        const uint32_t srcPitch = srcFaceSize*bytesPerPixel;
+        const TextureFormat::Enum srcFormat = _src.m_format;
+
+        imageCreate(_dst, dstFaceSize, dstFaceSize, 0, 1, 6, TextureFormat::RGBA32F, _allocator);
+
+        uint32_t srcFaceOffsets[CUBE_FACE_NUM];
+        uint32_t dstFaceOffsets[CUBE_FACE_NUM];
+        imageGetFaceOffsets(srcFaceOffsets, _src);
+        imageGetFaceOffsets(dstFaceOffsets, _dst);
+
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            const uint8_t* srcFace = (const uint8_t*)_src.m_data + srcFaceOffsets[face];
+            float* dstPtr = (float*)((uint8_t*)_dst.m_data + dstFaceOffsets[face]);
+
+            for (uint32_t yy = 0; yy < dstFaceSize; ++yy)
+            {
+                const uint8_t* src0 = srcFace + (2*yy)*srcPitch;
+                const uint8_t* src1 = srcFace + CMFT_MIN(2*yy+1, srcFaceSize-1)*srcPitch;
+
+                for (uint32_t xx = 0; xx < dstFaceSize; ++xx, dstPtr += 4)
+                {
+                    const uint32_t x0 = (2*xx)*bytesPerPixel;
+                    const uint32_t x1 = CMFT_MIN(2*xx+1, srcFaceSize-1)*bytesPerPixel;
+
+                    float t00[4], t01[4], t10[4], t11[4];
+                    toRgba32f(t00, srcFormat, src0 + x0);
+                    toRgba32f(t01, srcFormat, src0 + x1);
+                    toRgba32f(t10, srcFormat, src1 + x0);
+                    toRgba32f(t11, srcFormat, src1 + x1);
+
+                    dstPtr[0] = (t00[0] + t01[0] + t10[0] + t11[0]) * 0.25f;
+                    dstPtr[1] = (t00[1] + t01[1] + t10[1] + t11[1]) * 0.25f;
+                    dstPtr[2] = (t00[2] + t01[2] + t10[2] + t11[2]) * 0.25f;
+                    dstPtr[3] = 1.0f;
                 }
             }
         }
+    }
 
-        return (uint8_t*)_mem + _size;
+    /// Sets up _source to read _image only, without any tables. Used by filters that sample the source directly.
+    void radianceFilterSourceInitImage(RadianceFilterSource& _source, const Image& _image)
+    {
+        _source.m_image = &_image;
+        imageGetFaceOffsets(_source.m_faceOffsets, _image);
+
+        _source.m_cubemapVectors = NULL;
+        _source.m_normalPlanes   = NULL;
+        _source.m_srcPlanes      = NULL;
+        _source.m_tiles          = NULL;
+        _source.m_texelNormals   = TexelNormals::Table;
+        _source.m_kernel         = NULL;
+        _source.m_groupKernel    = NULL;
     }
 
-    float* buildCubemapFilterArea(uint8_t _faceIdx, uint32_t _cubemapFaceSize, float _filterSize, EdgeFixup::Enum _fixup = EdgeFixup::None, AllocatorI* _allocator = g_allocator)
+    // Ggx.
+    //-----
+
+    /// Importance sample of the GGX lobe in tangent space of the output direction, where +z is the normal.
+    struct GgxSample
     {
-        const size_t size = cubemapFilterAreaSize(_cubemapFaceSize);
-        float* mem = (float*)CMFT_ALLOC(_allocator, size);
-        MALLOC_CHECK(mem);
+        float m_dir[3];
+        float m_weight; // Cosine between the sample direction and the normal.
+        float m_lod;    // Source level whose texels match solid angle of the sample.
+    };
 
-        buildCubemapFilterArea(mem, size, _faceIdx, _cubemapFaceSize, _filterSize, _fixup);
+    struct GgxSampleSet
+    {
+        const GgxSample* m_samples;
+        uint32_t m_numSamples;
+    };
 
-        return mem;
+    static inline float radicalInverse(uint32_t _bits)
+    {
+        _bits = (_bits << 16) | (_bits >> 16);
+        _bits = ((_bits & UINT32_C(0x55555555)) << 1) | ((_bits & UINT32_C(0xaaaaaaaa)) >> 1);
+        _bits = ((_bits & UINT32_C(0x33333333)) << 2) | ((_bits & UINT32_C(0xcccccccc)) >> 2);
+        _bits = ((_bits & UINT32_C(0x0f0f0f0f)) << 4) | ((_bits & UINT32_C(0xf0f0f0f0)) >> 4);
+        _bits = ((_bits & UINT32_C(0x00ff00ff)) << 8) | ((_bits & UINT32_C(0xff00ff00)) >> 8);
+        return float(_bits) * 2.3283064365386963e-10f; // / 0x100000000
     }
 
-    template <typename floatOrDouble>
-    void processFilterArea(floatOrDouble _res[3]
-                         , float _specularPower
-                         , float _specularAngle
-                         , const float* _tapVec
-                         , const float* _cubemapNormalSolidAngle
-                         , Aabb _filterArea[6]
-                         , uint32_t _srcFaceSize
-                         , const void* _srcData
-                         , const uint32_t _faceOffsets[6]
-                         )
+    /// Writes Hammersley distributed samples of the GGX lobe with given roughness into _samples and returns
+    /// their count. Samples below the horizon are dropped, so the count can be less than _numSamples.
+    /// Ref: Colbert, Krivanek, "GPU-Based Importance Sampling", GPU Gems 3, chapter 20.
+    ///      Karis, "Real Shading in Unreal Engine 4", SIGGRAPH 2013.
+    uint32_t buildGgxSamples(GgxSample* _samples, uint32_t _numSamples, float _roughness, uint32_t _srcFaceSize, uint8_t _srcLevelCount)
     {
-        floatOrDouble colorWeight[4] = { floatOrDouble(0.0), floatOrDouble(0.0), floatOrDouble(0.0), floatOrDouble(0.0) };
+        const float alpha   = CMFT_MAX(_roughness, 0.001f);
+        const float alphaSq = alpha*alpha;
+        const float numSamplesf = float(int32_t(_numSamples));
+        const float srcFaceSizef = float(int32_t(_srcFaceSize));
+        const float texelSolidAngle = (4.0f*CMFT_PI)/(6.0f*srcFaceSizef*srcFaceSizef);
+        const float maxLod = float(int32_t(_srcLevelCount-1));
+
+        uint32_t count = 0;
+        for (uint32_t ii = 0; ii < _numSamples; ++ii)
+        {
+            const float xi0 = float(int32_t(ii))/numSamplesf;
+            const float xi1 = radicalInverse(ii);
 
-        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
-        const uint32_t pitch = _srcFaceSize*bytesPerPixel;
-        const uint32_t normalFaceSize = pitch*_srcFaceSize;
-        const float faceSize_MinusOne = float(int32_t(_srcFaceSize-1));
+            // Half vector distributed by D(h)*(n.h).
+            const float phi = CMFT_2PI*xi0;
+            const float cosTheta = sqrtf((1.0f - xi1)/(1.0f + (alphaSq - 1.0f)*xi1));
+            const float sinTheta = sqrtf(CMFT_MAX(0.0f, 1.0f - cosTheta*cosTheta));
 
-        for (uint8_t face = 0; face < 6; ++face)
-        {
-            if (_filterArea[face].isEmpty())
+            // View vector equals the normal, reflect it around the half vector.
+            const float nDotL = 2.0f*cosTheta*cosTheta - 1.0f;
+            if (nDotL <= 0.0f)
             {
                 continue;
             }
 
-            const uint32_t minX = uint32_t(_filterArea[face].m_min[0] * faceSize_MinusOne);
-            const uint32_t maxX = uint32_t(_filterArea[face].m_max[0] * faceSize_MinusOne);
-            const uint32_t minY = uint32_t(_filterArea[face].m_min[1] * faceSize_MinusOne);
-            const uint32_t maxY = uint32_t(_filterArea[face].m_max[1] * faceSize_MinusOne);
+            // pdf(l) = D(h)*(n.h)/(4*(v.h)) = D(h)/4, because n.h == v.h.
+            const float dd = (alphaSq - 1.0f)*cosTheta*cosTheta + 1.0f;
+            const float pdf = alphaSq/(4.0f*CMFT_PI*dd*dd);
+
+            // Read from the level whose texels cover the solid angle of the sample. One level of bias
+            // blurs the gaps between neighbouring samples.
+            const float sampleSolidAngle = 1.0f/(numSamplesf*pdf);
+            const float lod = 0.5f*log2f(sampleSolidAngle/texelSolidAngle) + 1.0f;
+
+            GgxSample& sample = _samples[count++];
+            sample.m_dir[0] = 2.0f*cosTheta*sinTheta*cosf(phi);
+            sample.m_dir[1] = 2.0f*cosTheta*sinTheta*sinf(phi);
+            sample.m_dir[2] = nDotL;
+            sample.m_weight = nDotL;
+            sample.m_lod    = CMFT_CLAMP(lod, 0.0f, maxLod);
+        }
 
-            const uint8_t* faceData    = (const uint8_t*)_srcData                 + _faceOffsets[face];
-            const uint8_t* faceNormals = (const uint8_t*)_cubemapNormalSolidAngle + normalFaceSize*face;
+        return count;
+    }
 
-            for (uint32_t yy = minY; yy <= maxY; ++yy)
-            {
-                const uint8_t* rowData    = (const uint8_t*)faceData    + yy*pitch;
-                const uint8_t* rowNormals = (const uint8_t*)faceNormals + yy*pitch;
+    /// Bilinear lookup of RGBA32F cubemap face. Texels are clamped at face edges.
+    static inline void sampleCubemapFace(float _rgb[3], const RadianceFilterSource& _source, uint8_t _face, float _u, float _v)
+    {
+        const uint32_t faceSize = _source.m_image->m_width;
+        const float* faceData = (const float*)((const uint8_t*)_source.m_image->m_data + _source.m_faceOffsets[_face]);
+
+        const float maxCoord = float(int32_t(faceSize-1));
+        const float xx = CMFT_CLAMP(_u*float(int32_t(faceSize)) - 0.5f, 0.0f, maxCoord);
+        const float yy = CMFT_CLAMP(_v*float(int32_t(faceSize)) - 0.5f, 0.0f, maxCoord);
+
+        const uint32_t x0 = uint32_t(xx);
+        const uint32_t y0 = uint32_t(yy);
+        const uint32_t x1 = CMFT_MIN(x0+1, faceSize-1);
+        const uint32_t y1 = CMFT_MIN(y0+1, faceSize-1);
+
+        const float tx = xx - float(int32_t(x0));
+        const float ty = yy - float(int32_t(y0));
+
+        const float* t00 = &faceData[(y0*faceSize + x0)*4];
+        const float* t01 = &faceData[(y0*faceSize + x1)*4];
+        const float* t10 = &faceData[(y1*faceSize + x0)*4];
+        const float* t11 = &faceData[(y1*faceSize + x1)*4];
+
+        for (uint8_t ch = 0; ch < 3; ++ch)
+        {
+            const float top    = t00[ch] + (t01[ch] - t00[ch])*tx;
+            const float bottom = t10[ch] + (t11[ch] - t10[ch])*tx;
+            _rgb[ch] = top + (bottom - top)*ty;
+        }
+    }
+
+    /// Filters rows [_rowBegin, _rowEnd) of a single face with importance samples of the GGX lobe, read from
+    /// the source pyramid down to 1x1 faces. WarpT is EdgeFixup::Warp.
+    template <bool WarpT>
+    static void radianceFilterGgx(const RadianceFilterParams& _params, uint32_t _rowBegin, uint32_t _rowEnd)
+    {
+        const GgxSampleSet& samples = *_params.m_ggxSamples;
+        const RadianceFilterSource* srcLevels = _params.m_srcLevels;
+        const uint32_t mipFaceSize = _params.m_mipFaceSize;
+        const float mfs = float(int32_t(mipFaceSize));
+        const float invMfs = 1.0f/mfs;
+        const float warp = WarpT ? warpFixupFactor(mfs) : 0.0f;
+        const uint8_t maxLevel = uint8_t(_params.m_srcLevelCount-1);
+
+        float* dstPtr = _params.m_dstPtr + _rowBegin*mipFaceSize*4;
 
-                for (uint32_t xx = minX; xx <= maxX; ++xx)
+        float yyf = 1.0f + 2.0f*float(int32_t(_rowBegin));
+        for (uint32_t yy = _rowBegin; yy < _rowEnd; ++yy, yyf+=2.0f)
+        {
+            float xxf = 1.0f;
+            for (uint32_t xx = 0; xx < mipFaceSize; ++xx, xxf+=2.0f)
+            {
+                const float uu = xxf*invMfs - 1.0f;
+                const float vv = yyf*invMfs - 1.0f;
+
+                float normal[3];
+                dstTexelVec<WarpT>(normal, uu, vv, _params.m_face, warp);
+
+                // Tangent frame around the normal.
+                const float up[3] = { 0.0f, 0.0f, 1.0f };
+                const float right[3] = { 1.0f, 0.0f, 0.0f };
+                float tangent[3];
+                float tangentX[3];
+                float tangentY[3];
+                vec3Cross(tangent, (fabsf(normal[2]) < 0.999f) ? up : right, normal);
+                vec3Norm(tangentX, tangent);
+                vec3Cross(tangentY, normal, tangentX);
+
+                float color[3] = { 0.0f, 0.0f, 0.0f };
+                float weight = 0.0f;
+
+                for (uint32_t ii = 0; ii < samples.m_numSamples; ++ii)
                 {
-                    const float* normalPtr = (const float*)((const uint8_t*)rowNormals + xx*bytesPerPixel);
-                    const float dotProduct = vec3Dot(normalPtr, _tapVec);
+                    const GgxSample& sample = samples.m_samples[ii];
+
+                    const float dir[3] =
+                    {
+                        tangentX[0]*sample.m_dir[0] + tangentY[0]*sample.m_dir[1] + normal[0]*sample.m_dir[2],
+                        tangentX[1]*sample.m_dir[0] + tangentY[1]*sample.m_dir[1] + normal[1]*sample.m_dir[2],
+                        tangentX[2]*sample.m_dir[0] + tangentY[2]*sample.m_dir[1] + normal[2]*sample.m_dir[2],
+                    };
+
+                    float su;
+                    float sv;
+                    uint8_t sampleFace;
+                    vecToTexelCoord(su, sv, sampleFace, dir);
+
+                    // Trilinear lookup between two neighbouring source levels. Lod is clamped
+                    // to the first or the last level for most samples of sharp and rough lobes.
+                    const uint8_t level0 = uint8_t(sample.m_lod);
+                    const float tl = sample.m_lod - float(level0);
+
+                    float rgb[3];
+                    sampleCubemapFace(rgb, srcLevels[level0], sampleFace, su, sv);
 
-                    if (dotProduct >= _specularAngle)
+                    if (0.0f < tl && level0 < maxLevel)
                     {
-                        const float solidAngle = normalPtr[3];
-                        const floatOrDouble weight = floatOrDouble(solidAngle * powf(dotProduct, _specularPower));
-
-                        const float* dataPtr = (const float*)((const uint8_t*)rowData + xx*bytesPerPixel);
-                        colorWeight[0] += floatOrDouble(dataPtr[0]) * weight;
-                        colorWeight[1] += floatOrDouble(dataPtr[1]) * weight;
-                        colorWeight[2] += floatOrDouble(dataPtr[2]) * weight;
-                        colorWeight[3] += floatOrDouble(1.0)        * weight;
+                        float rgb1[3];
+                        sampleCubemapFace(rgb1, srcLevels[level0+1], sampleFace, su, sv);
+
+                        rgb[0] += (rgb1[0] - rgb[0])*tl;
+                        rgb[1] += (rgb1[1] - rgb[1])*tl;
+                        rgb[2] += (rgb1[2] - rgb[2])*tl;
                     }
+
+                    color[0] += rgb[0]*sample.m_weight;
+                    color[1] += rgb[1]*sample.m_weight;
+                    color[2] += rgb[2]*sample.m_weight;
+                    weight   += sample.m_weight;
                 }
+
+                const float invWeight = (0.0f < weight) ? 1.0f/weight : 0.0f;
+                dstPtr[0] = color[0]*invWeight;
+                dstPtr[1] = color[1]*invWeight;
+                dstPtr[2] = color[2]*invWeight;
+                dstPtr[3] = 1.0f;
+
+                dstPtr += 4;
             }
         }
+    }
+
+    /// Returns cpu filter specialized for the lobe, edge fixup, tile culling and accumulation.
+    static RadianceFilterFn radianceFilterFn(bool _ggx, EdgeFixup::Enum _fixup, bool _tiles, Accumulation::Enum _accumulation)
+    {
+        // [warp][tiles][accumulation]
+        static const RadianceFilterFn s_filter[2][2][Accumulation::Count] =
+        {
+            {
+                { radianceFilter<false, false, Accumulation::Float>, radianceFilter<false, false, Accumulation::Double>, radianceFilter<false, false, Accumulation::Compensated> },
+                { radianceFilter<false, true,  Accumulation::Float>, radianceFilter<false, true,  Accumulation::Double>, radianceFilter<false, true,  Accumulation::Compensated> },
+            },
+            {
+                { radianceFilter<true,  false, Accumulation::Float>, radianceFilter<true,  false, Accumulation::Double>, radianceFilter<true,  false, Accumulation::Compensated> },
+                { radianceFilter<true,  true,  Accumulation::Float>, radianceFilter<true,  true,  Accumulation::Double>, radianceFilter<true,  true,  Accumulation::Compensated> },
+            },
+        };
+
+        static const RadianceFilterFn s_filterGgx[2] =
+        {
+            radianceFilterGgx<false>,
+            radianceFilterGgx<true>,
+        };
 
-        // Divide color by colorWeight and store result.
-        if (0.0f != colorWeight[3])
+        const uint8_t warp = uint8_t(EdgeFixup::Warp == _fixup);
+        if (_ggx)
         {
-            const floatOrDouble invWeight = floatOrDouble(1.0)/colorWeight[3];
-            _res[0] = colorWeight[0] * invWeight;
-            _res[1] = colorWeight[1] * invWeight;
-            _res[2] = colorWeight[2] * invWeight;
+            return s_filterGgx[warp];
         }
-        // Else if colorWeight == 0 (result of convolution is zero) take a direct color sample.
-        else
+
+        DEBUG_CHECK(_accumulation < Accumulation::Count, "Reading array out of bounds!");
+        return s_filter[warp][_tiles][_accumulation];
+    }
+
+    /// Progress of a single radiance filter call, for all cubemaps of a batch.
+    struct RadianceFilterState
+    {
+        RadianceFilterState()
+        {
+            reset();
+        }
+
+        void reset()
         {
-            float uu, vv;
-            uint8_t hitFaceIdx;
-            vecToTexelCoord(uu, vv, hitFaceIdx, _tapVec);
+            m_startTime         = 0;
+            m_completedTasksGpu = 0;
+            m_completedTasksCpu = 0;
+            m_totalTasks        = 0;
+            m_rowsGpu           = 0;
+            m_rowsCpu           = 0;
+        }
 
-            const uint32_t xx = uint32_t(uu*float(_srcFaceSize));
-            const uint32_t yy = uint32_t(vv*float(_srcFaceSize));
+        void incrCompletedTasksGpu()
+        {
+            std::lock_guard<std::mutex> lock(m_completedTasks);
+            m_completedTasksGpu++;
+            CMFT_PROGRESS("%u %u", m_completedTasksCpu + m_completedTasksGpu, m_totalTasks);
+        }
 
-            const float* dataPtr = (const float*)((const uint8_t*)_srcData
-                                 + _faceOffsets[hitFaceIdx]
-                                 + yy*pitch
-                                 + xx*bytesPerPixel
-                                 );
+        void incrCompletedTasksCpu(uint32_t _numFaces)
+        {
+            std::lock_guard<std::mutex> lock(m_completedTasks);
+            m_completedTasksCpu += _numFaces;
+            CMFT_PROGRESS("%u %u", m_completedTasksCpu + m_completedTasksGpu, m_totalTasks);
+        }
+
+        uint64_t m_startTime;
+        uint32_t m_completedTasksGpu;
+        uint32_t m_completedTasksCpu;
+        uint32_t m_totalTasks;
+        std::mutex m_completedTasks;
+        std::atomic<uint32_t> m_rowsGpu;
+        std::atomic<uint32_t> m_rowsCpu;
+    };
+
+    /// Rows of a single face that a cpu worker is processing. The worker takes rows from the front,
+    /// idle workers and the gpu steal part of the remaining rows from the back.
+    struct RadianceFilterWorker
+    {
+        RadianceFilterWorker()
+        {
+            m_params   = NULL;
+            m_rowBegin = 0;
+            m_rowEnd   = 0;
+            m_busyTime = 0;
+            m_busyCost = 0;
+        }
+
+        std::mutex m_access;
+        const RadianceFilterParams* m_params;
+        uint32_t m_rowBegin;
+        uint32_t m_rowEnd;
+        std::atomic<uint64_t> m_busyTime;
+        std::atomic<uint64_t> m_busyCost;
+    };
 
-            _res[0] = floatOrDouble(dataPtr[0]);
-            _res[1] = floatOrDouble(dataPtr[1]);
-            _res[2] = floatOrDouble(dataPtr[2]);
+    /// Rows [m_rowBegin, m_rowEnd) of a face.
+    struct RadianceFilterRows
+    {
+        const RadianceFilterParams* m_params;
+        uint32_t m_rowBegin;
+        uint32_t m_rowEnd;
+    };
+
+    /// Cost of filtering one row of a face, number of destination texels times number of source texels read for
+    /// each of them. Lobe reads the texels of the spherical cap inside of the specular angle, Ggx reads samples.
+    static uint64_t radianceFilterRowCost(const RadianceFilterParams& _params, uint32_t _srcFaceSize)
+    {
+        if (NULL != _params.m_ggxSamples)
+        {
+            return uint64_t(_params.m_mipFaceSize)*CMFT_MAX(UINT64_C(1), uint64_t(_params.m_ggxSamples->m_numSamples));
         }
+
+        // Cap covers (1-cos)/2 of the sphere, which is 6*srcFaceSize^2 texels.
+        const double srcFaceSize = double(_srcFaceSize);
+        const double capTexels = 3.0*srcFaceSize*srcFaceSize*(1.0 - double(_params.m_specularAngle));
+        return uint64_t(1 + _params.m_numSiblings)*uint64_t(_params.m_mipFaceSize)*uint64_t(CMFT_MAX(capTexels, 1.0));
     }
 
-    void radianceFilter(float* _dstPtr
-                      , uint8_t _face
-                      , uint32_t _mipFaceSize
-                      , float _filterSize
-                      , float _specularPower
-                      , float _specularAngle
-                      , const float* _cubemapVectors
-                      , const Image* _imageRgba32f
-                      , const uint32_t _faceOffsets[CUBE_FACE_NUM]
-                      , EdgeFixup::Enum _fixup
-                      )
+    struct RadianceProgram;
+
+    struct RadianceFilterTaskList
     {
-        const float mfs = float(int32_t(_mipFaceSize));
-        const float invMfs = 1.0f/mfs;
+        enum
+        {
+            MaxWorkers = 64,
 
-        if (EdgeFixup::None == _fixup)
+            GpuFirstRows = 64, // Rows of the first gpu chunk, before speed of both devices is known.
+        };
+
+        // Tasks are cube faces of all cubemaps of a batch, set cubemap by cubemap from the top mip level. Gpu takes
+        // rows from the front and cpu from the back, so cpu workers read source of one cubemap at a time and faces
+        // of small mips keep them busy while the gpu or other workers finish the large ones.
+        //
+        // Gpu takes as many rows as it can filter before cpu workers filter all remaining rows, estimated from the
+        // cost of rows and speed of each device measured so far, so neither of them is left with a large face
+        // while the other one idles. When there are no rows left, gpu steals rows from cpu workers the same way.
+        RadianceFilterTaskList(RadianceFilterState& _state, RadianceProgram& _program, uint32_t _numTasks)
+            : m_state(_state)
+            , m_program(_program)
         {
-            float yyf = 1.0f;
-            for (uint32_t yy = 0; yy < _mipFaceSize; ++yy, yyf+=2.0f)
+            m_numTasks   = _numTasks;
+            m_params     = (RadianceFilterParams*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(RadianceFilterParams));
+            m_rowsLeft   = (std::atomic<uint32_t>*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(std::atomic<uint32_t>));
+            m_faceTime   = (std::atomic<uint64_t>*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(std::atomic<uint64_t>));
+            m_free       = (RadianceFilterRows*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(RadianceFilterRows));
+            m_rowCost    = (uint64_t*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(uint64_t));
+            m_gpuRowCost = (uint64_t*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(uint64_t));
+            m_unfinished = (RadianceFilterRows*)CMFT_ALLOC(&g_crtAllocator, _numTasks*sizeof(RadianceFilterRows));
+            MALLOC_CHECK(m_params);
+            MALLOC_CHECK(m_rowsLeft);
+            MALLOC_CHECK(m_faceTime);
+            MALLOC_CHECK(m_free);
+            MALLOC_CHECK(m_rowCost);
+            MALLOC_CHECK(m_gpuRowCost);
+            MALLOC_CHECK(m_unfinished);
+
+            m_gpuNext = 0;
+            m_cpuNext = _numTasks;
+            m_pendingCost = 0;
+            m_unfinishedCount = 0;
+            m_numWorkers = 0;
+            m_gpuBusyTime = 0;
+            m_gpuBusyCost = 0;
+            m_useGpu = false;
+        }
+
+        ~RadianceFilterTaskList()
+        {
+            CMFT_FREE(&g_crtAllocator, m_params);
+            CMFT_FREE(&g_crtAllocator, m_rowsLeft);
+            CMFT_FREE(&g_crtAllocator, m_faceTime);
+            CMFT_FREE(&g_crtAllocator, m_free);
+            CMFT_FREE(&g_crtAllocator, m_rowCost);
+            CMFT_FREE(&g_crtAllocator, m_gpuRowCost);
+            CMFT_FREE(&g_crtAllocator, m_unfinished);
+        }
+
+        void set(uint32_t _task, const RadianceFilterParams* _params)
+        {
+            memcpy(&m_params[_task], _params, sizeof(RadianceFilterParams));
+
+            const uint32_t numRows = _params->m_mipFaceSize;
+            m_rowsLeft[_task] = numRows;
+            m_faceTime[_task] = 0;
+
+            m_free[_task].m_params   = &m_params[_task];
+            m_free[_task].m_rowBegin = 0;
+            m_free[_task].m_rowEnd   = numRows;
+
+            // Gpu always reads the full resolution source.
+            m_rowCost[_task]    = radianceFilterRowCost(*_params, _params->m_image->m_width);
+            m_gpuRowCost[_task] = radianceFilterRowCost(*_params, _params->m_srcLevels[0].m_image->m_width);
+            m_pendingCost += m_rowCost[_task]*numRows;
+        }
+
+        // Returns rows for the gpu, starting from the top mip level of the first cubemap.
+        bool getGpuRows(RadianceFilterRows& _rows)
+        {
+            const double gpuRate = rate(m_gpuBusyCost, m_gpuBusyTime);
+            const double cpuRate = cpuTotalRate();
+
             {
-                float xxf = 1.0f;
-                for (uint32_t xx = 0; xx < _mipFaceSize; ++xx, xxf+=2.0f)
+                std::lock_guard<std::mutex> lock(m_access);
+
+                while (m_gpuNext < m_numTasks)
                 {
-                    // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
-                    // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
-                    //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
-                    const float uu = xxf*invMfs - 1.0f;
-                    const float vv = yyf*invMfs - 1.0f;
+                    const uint32_t task = m_gpuNext;
+                    RadianceFilterRows& free = m_free[task];
+                    const uint32_t available = free.m_rowEnd - free.m_rowBegin;
+                    if (0 == available)
+                    {
+                        m_gpuNext++;
+                        continue;
+                    }
+
+                    const uint32_t numRows = gpuRowCount(task, available, double(m_pendingCost), cpuRate, gpuRate);
+                    if (0 == numRows)
+                    {
+                        return false;
+                    }
+
+                    _rows.m_params   = free.m_params;
+                    _rows.m_rowBegin = free.m_rowBegin;
+                    _rows.m_rowEnd   = free.m_rowBegin + numRows;
+                    free.m_rowBegin += numRows;
+                    m_pendingCost -= m_rowCost[task]*numRows;
+                    return true;
+                }
+            }
+
+            // Split rows of a cpu worker.
+            const uint8_t numWorkers = m_numWorkers;
+            for (uint8_t ii = 0; ii < numWorkers; ++ii)
+            {
+                RadianceFilterWorker& victim = m_workers[ii];
+                const double workerRate = rate(victim.m_busyCost, victim.m_busyTime);
+
+                std::lock_guard<std::mutex> lock(victim.m_access);
+                const uint32_t remaining = victim.m_rowEnd - victim.m_rowBegin;
+                if (remaining < 2)
+                {
+                    continue;
+                }
+
+                const uint32_t task = uint32_t(victim.m_params - m_params);
+                const uint32_t numRows = gpuRowCount(task, remaining-1, double(m_rowCost[task]*remaining), workerRate, gpuRate);
+                if (0 == numRows)
+                {
+                    continue;
+                }
+
+                _rows.m_params   = victim.m_params;
+                _rows.m_rowEnd   = victim.m_rowEnd;
+                _rows.m_rowBegin = victim.m_rowEnd - numRows;
+                victim.m_rowEnd  = _rows.m_rowBegin;
+                m_pendingCost -= m_rowCost[task]*numRows;
+                return true;
+            }
+
+            return false;
+        }
+
+        // Returns all rows of a face that are left for the cpu, starting from the bottom mip level of the last cubemap.
+        bool getCpuRows(RadianceFilterRows& _rows)
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+
+            while (m_cpuNext > 0)
+            {
+                RadianceFilterRows& free = m_free[m_cpuNext-1];
+                if (free.m_rowBegin < free.m_rowEnd)
+                {
+                    _rows = free;
+                    free.m_rowBegin = free.m_rowEnd;
+                    return true;
+                }
+
+                m_cpuNext--;
+            }
+
+            return false;
+        }
+
+        void pushUnfinished(const RadianceFilterRows& _rows)
+        {
+            const uint32_t task = uint32_t(_rows.m_params - m_params);
+            m_pendingCost += m_rowCost[task]*(_rows.m_rowEnd - _rows.m_rowBegin);
 
-                    float tapVec[3];
-                    texelCoordToVec(tapVec, uu, vv, _face);
+            std::lock_guard<std::mutex> lock(m_accessUnfinished);
+            m_unfinished[m_unfinishedCount++] = _rows;
+        }
 
-                    Aabb facesBb[6];
-                    determineFilterArea(facesBb, tapVec, _filterSize);
+        bool popUnfinished(RadianceFilterRows& _rows)
+        {
+            std::lock_guard<std::mutex> lock(m_accessUnfinished);
+            if (0 == m_unfinishedCount)
+            {
+                return false;
+            }
 
-                    float color[3];
-                    processFilterArea<float>(color
-                                           , _specularPower
-                                           , _specularAngle
-                                           , tapVec
-                                           , _cubemapVectors
-                                           , facesBb
-                                           , _imageRgba32f->m_width
-                                           , _imageRgba32f->m_data
-                                           , _faceOffsets
-                                           );
+            _rows = m_unfinished[--m_unfinishedCount];
+            return true;
+        }
 
-                    _dstPtr[0] = float(color[0]);
-                    _dstPtr[1] = float(color[1]);
-                    _dstPtr[2] = float(color[2]);
-                    _dstPtr[3] = 1.0f;
+        uint32_t unfinishedCount() const
+        {
+            return m_unfinishedCount;
+        }
 
-                    _dstPtr += 4;
-                }
-            }
+        uint8_t addWorker()
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+            DEBUG_CHECK(m_numWorkers < MaxWorkers, "Too many cpu workers!");
+            return m_numWorkers++;
         }
-        else //if (EdgeFixup::Warp == _fixup)#
+
+        // Returns the next row for cpu worker. Worker continues with rows of its current face, then takes
+        // a new face from the bottom mip level and at last steals rows from other workers.
+        bool getRow(uint8_t _worker, const RadianceFilterParams*& _params, uint32_t& _row)
         {
-            const float warp = warpFixupFactor(mfs);
+            RadianceFilterWorker& worker = m_workers[_worker];
 
-            float yyf = 1.0f;
-            for (uint32_t yy = 0; yy < _mipFaceSize; ++yy, yyf+=2.0f)
             {
-                float xxf = 1.0f;
-                for (uint32_t xx = 0; xx < _mipFaceSize; ++xx, xxf+=2.0f)
+                std::lock_guard<std::mutex> lock(worker.m_access);
+                if (worker.m_rowBegin < worker.m_rowEnd)
                 {
-                    // From [0..size-1] to [-1.0+invSize .. 1.0-invSize].
-                    // Ref: uu = 2.0*(xxf+0.5)/faceSize - 1.0;
-                    //      vv = 2.0*(yyf+0.5)/faceSize - 1.0;
-                    const float uu = xxf*invMfs - 1.0f;
-                    const float vv = yyf*invMfs - 1.0f;
-
-                    float tapVec[3];
-                    texelCoordToVecWarp(tapVec, uu, vv, _face, warp);
+                    _params = worker.m_params;
+                    _row = worker.m_rowBegin++;
+                    return true;
+                }
+            }
 
-                    Aabb facesBb[6];
-                    determineFilterArea(facesBb, tapVec, _filterSize);
+            RadianceFilterRows rows;
+            if (getCpuRows(rows)
+            ||  popUnfinished(rows))
+            {
+                std::lock_guard<std::mutex> lock(worker.m_access);
+                worker.m_params   = rows.m_params;
+                worker.m_rowBegin = rows.m_rowBegin+1;
+                worker.m_rowEnd   = rows.m_rowEnd;
+
+                _params = rows.m_params;
+                _row = rows.m_rowBegin;
+                return true;
+            }
 
-                    float color[3];
-                    processFilterArea<float>(color
-                                           , _specularPower
-                                           , _specularAngle
-                                           , tapVec
-                                           , _cubemapVectors
-                                           , facesBb
-                                           , _imageRgba32f->m_width
-                                           , _imageRgba32f->m_data
-                                           , _faceOffsets
-                                           );
+            const uint8_t numWorkers = m_numWorkers;
+            for (uint8_t ii = 1; ii < numWorkers; ++ii)
+            {
+                RadianceFilterWorker& victim = m_workers[(_worker + ii) % numWorkers];
 
-                    _dstPtr[0] = float(color[0]);
-                    _dstPtr[1] = float(color[1]);
-                    _dstPtr[2] = float(color[2]);
-                    _dstPtr[3] = 1.0f;
+                const RadianceFilterParams* params;
+                uint32_t rowBegin, rowEnd;
+                {
+                    std::lock_guard<std::mutex> lock(victim.m_access);
+                    const uint32_t remaining = victim.m_rowEnd - victim.m_rowBegin;
+                    if (remaining < 2)
+                    {
+                        continue;
+                    }
 
-                    _dstPtr += 4;
+                    params   = victim.m_params;
+                    rowEnd   = victim.m_rowEnd;
+                    rowBegin = rowEnd - remaining/2;
+                    victim.m_rowEnd = rowBegin;
                 }
+
+                std::lock_guard<std::mutex> lock(worker.m_access);
+                worker.m_params   = params;
+                worker.m_rowBegin = rowBegin+1;
+                worker.m_rowEnd   = rowEnd;
+
+                _params = params;
+                _row = rowBegin;
+                return true;
             }
+
+            return false;
         }
-    }
 
-    struct RadianceFilterGlobalState
-    {
-        RadianceFilterGlobalState()
+        // Accumulates processing time of a row. Returns true when it was the last row of the face.
+        bool rowDone(uint8_t _worker, const RadianceFilterParams* _params, uint64_t _duration, uint64_t& _faceTime)
         {
-            reset();
+            const uint32_t task = uint32_t(_params - m_params);
+            RadianceFilterWorker& worker = m_workers[_worker];
+            worker.m_busyTime += _duration;
+            worker.m_busyCost += m_rowCost[task];
+            m_pendingCost -= m_rowCost[task];
+            m_state.m_rowsCpu += 1 + _params->m_numSiblings;
+
+            return rowsDone(task, 1, _duration, _faceTime);
         }
 
-        void reset()
+        // Accumulates processing time of gpu rows. Returns true when they were the last rows of the face.
+        bool gpuRowsDone(const RadianceFilterRows& _rows, uint64_t _duration, uint64_t& _faceTime)
         {
-            m_startTime         = 0;
-            m_completedTasksGpu = 0;
-            m_completedTasksCpu = 0;
-            m_totalTasks        = 0;
-            m_threadId          = 0;
+            const uint32_t task = uint32_t(_rows.m_params - m_params);
+            const uint32_t numRows = _rows.m_rowEnd - _rows.m_rowBegin;
+            m_gpuBusyTime += _duration;
+            m_gpuBusyCost += m_gpuRowCost[task]*numRows;
+            m_state.m_rowsGpu += numRows;
+
+            return rowsDone(task, numRows, _duration, _faceTime);
         }
 
-        uint8_t getThreadId()
+        uint8_t numWorkers() const
         {
-            std::lock_guard<std::mutex> lock(m_threadIdMutex);
-            return m_threadId++;
+            return m_numWorkers;
         }
 
-        void incrCompletedTasksGpu()
+        uint64_t busyTime(uint8_t _worker) const
         {
-            std::lock_guard<std::mutex> lock(m_completedTasks);
-            m_completedTasksGpu++;
-            CMFT_PROGRESS("%d %d", m_completedTasksCpu + m_completedTasksGpu, m_totalTasks);
+            return m_workers[_worker].m_busyTime;
         }
 
-        void incrCompletedTasksCpu()
+        uint64_t gpuBusyTime() const
         {
-            std::lock_guard<std::mutex> lock(m_completedTasks);
-            m_completedTasksCpu++;
-            CMFT_PROGRESS("%d %d", m_completedTasksCpu + m_completedTasksGpu, m_totalTasks);
+            return m_gpuBusyTime;
         }
 
-        uint64_t m_startTime;
-        uint16_t m_completedTasksGpu;
-        uint16_t m_completedTasksCpu;
-        uint16_t m_totalTasks;
-        uint8_t m_threadId;
-        std::mutex m_threadIdMutex;
-        std::mutex m_completedTasks;
-    };
-    static RadianceFilterGlobalState s_globalState;
+        void setUseGpu(bool _useGpu)
+        {
+            m_useGpu = _useGpu;
+        }
 
-    struct RadianceFilterParams
-    {
-        float* m_dstPtr;
-        uint8_t m_face;
-        uint32_t m_mipFaceSize;
-        float m_filterSize;
-        float m_specularPower;
-        float m_specularAngle;
-        const float* m_cubemapVectors;
-        const Image* m_imageRgba32f;
-        const uint32_t* m_faceOffsets;
-        EdgeFixup::Enum m_edgeFixup;
-    };
+        bool useGpu() const
+        {
+            return m_useGpu;
+        }
 
-    struct RadianceFilterTaskList
-    {
-        RadianceFilterTaskList(uint8_t _mipBegin, uint8_t _mipTotalCount)
+        RadianceFilterState& state()
         {
-            m_mipStart = _mipBegin;
-            m_mipEnd   = _mipTotalCount-1;
-            memset(m_mipFace, 0, MAX_MIP_NUM);
+            return m_state;
+        }
 
-            m_unfinishedCount = 0;
+        RadianceProgram& program()
+        {
+            return m_program;
         }
 
-        void set(uint8_t _mip, uint8_t _face, RadianceFilterParams* _params)
+    private:
+        bool rowsDone(uint32_t _task, uint32_t _numRows, uint64_t _duration, uint64_t& _faceTime)
         {
-            memcpy(&m_params[_mip][_face], _params, sizeof(RadianceFilterParams));
+            _faceTime = (m_faceTime[_task] += _duration);
+            return (0 == (m_rowsLeft[_task] -= _numRows));
         }
 
-        // Returns cube face radiance filter parameters starting from the top mip level.
-        const RadianceFilterParams* getFromTop()
+        // Cost filtered per timer tick, 0.0 when nothing was measured yet.
+        static double rate(uint64_t _cost, uint64_t _time)
         {
-            std::lock_guard<std::mutex> lock(m_access);
+            return (0 == _time) ? 0.0 : double(_cost)/double(_time);
+        }
 
-            while (m_mipStart <= m_mipEnd)
+        double cpuTotalRate() const
+        {
+            double result = 0.0;
+            for (uint8_t ii = 0, end = m_numWorkers; ii < end; ++ii)
             {
-                if (m_mipFace[m_mipStart] >= 6)
-                {
-                    m_mipStart++;
-                }
-                else
-                {
-                    const uint8_t face = m_mipFace[m_mipStart]++;
-                    return &m_params[m_mipStart][face];
-                }
-
+                result += rate(m_workers[ii].m_busyCost, m_workers[ii].m_busyTime);
             }
-
-            return NULL;
+            return result;
         }
 
-        // Returns cube face radiance filter parameters starting from the bottom mip level.
-        const RadianceFilterParams* getFromBottom()
+        // Number of rows of _task, at most _available, that gpu filters in time in which cpu filters the rest of
+        // _cpuCost. Gpu time of n rows is n*gpuRowCost/gpuRate and cpu time of the rest is
+        // (_cpuCost - n*rowCost)/_cpuRate.
+        uint32_t gpuRowCount(uint32_t _task, uint32_t _available, double _cpuCost, double _cpuRate, double _gpuRate) const
         {
-            std::lock_guard<std::mutex> lock(m_access);
-
-            while (m_mipStart <= m_mipEnd)
+            if (0.0 == _gpuRate || 0.0 == _cpuRate)
             {
-                if (m_mipFace[m_mipEnd] >= 6)
-                {
-                    m_mipEnd--;
-                }
-                else
-                {
-                    const uint8_t face = m_mipFace[m_mipEnd]++;
-                    return &m_params[m_mipEnd][face];
-                }
+                return CMFT_MIN(_available, uint32_t(GpuFirstRows));
             }
 
-            return NULL;
-        }
-
-        void pushUnfinished(const RadianceFilterParams* _params)
-        {
-            std::lock_guard<std::mutex> lock(m_accessUnfinished);
-            m_unfinished[m_unfinishedCount++] = _params;
-        }
+            const double gpuRowTime = double(m_gpuRowCost[_task])/_gpuRate;
+            const double cpuRowTime = double(m_rowCost[_task])/_cpuRate;
+            const double numRows = (_cpuCost/_cpuRate)/(gpuRowTime + cpuRowTime);
 
-        const RadianceFilterParams* popUnfinished()
-        {
-            std::lock_guard<std::mutex> lock(m_accessUnfinished);
-            return (0 == m_unfinishedCount) ? NULL : m_unfinished[--m_unfinishedCount];
+            return uint32_t(CMFT_MIN(double(_available), CMFT_MAX(numRows, 0.0)));
         }
 
-        uint16_t unfinishedCount() const
-        {
-            return m_unfinishedCount;
-        }
+        RadianceFilterState& m_state;
+        RadianceProgram& m_program;
 
-    private:
         std::mutex m_access;
-        int8_t m_mipStart;
-        int8_t m_mipEnd;
-        int8_t m_mipFace[MAX_MIP_NUM];
-        RadianceFilterParams m_params[MAX_MIP_NUM][CUBE_FACE_NUM];
+        uint32_t m_numTasks;
+        uint32_t m_gpuNext;
+        uint32_t m_cpuNext;
+        RadianceFilterParams* m_params;
+        std::atomic<uint32_t>* m_rowsLeft;
+        std::atomic<uint64_t>* m_faceTime;
+        RadianceFilterRows* m_free;
+        uint64_t* m_rowCost;
+        uint64_t* m_gpuRowCost;
+        std::atomic<uint64_t> m_pendingCost; // Cpu cost of rows that are neither filtered on cpu nor taken by gpu.
 
         std::mutex m_accessUnfinished;
-        uint16_t m_unfinishedCount;
-        const RadianceFilterParams* m_unfinished[MAX_MIP_NUM*CUBE_FACE_NUM];
+        uint32_t m_unfinishedCount;
+        RadianceFilterRows* m_unfinished;
+
+        std::atomic<uint8_t> m_numWorkers;
+        RadianceFilterWorker m_workers[MaxWorkers];
+        std::atomic<uint64_t> m_gpuBusyTime;
+        std::atomic<uint64_t> m_gpuBusyCost;
+        bool m_useGpu;
     };
 
     int32_t radianceFilterCpu(void* _taskList)
     {
-        const uint8_t threadId = s_globalState.getThreadId();
         const double freq = double(cmft::getHPFrequency());
         const double toSec = 1.0/freq;
 
         RadianceFilterTaskList* taskList = (RadianceFilterTaskList*)_taskList;
+        const uint8_t workerId = taskList->addWorker();
 
-        // Cpu is processing from the bottom level mip map to the top.
+        // Cpu is processing from the bottom level mip map to the top, one row at a time.
         const RadianceFilterParams* params;
-        while ((params = taskList->getFromBottom()) != NULL
-        ||     (params = taskList->popUnfinished()) != NULL)
+        uint32_t row;
+        while (taskList->getRow(workerId, params, row))
         {
             // Start timer.
             const uint64_t startTime = cmft::getHPCounter();
 
             // Process data.
-            radianceFilter(params->m_dstPtr
-                         , params->m_face
-                         , params->m_mipFaceSize
-                         , params->m_filterSize
-                         , params->m_specularPower
-                         , params->m_specularAngle
-                         , params->m_cubemapVectors
-                         , params->m_imageRgba32f
-                         , params->m_faceOffsets
-                         , params->m_edgeFixup
-                         );
+            params->m_filter(*params, row, row+1);
 
             // Determine task duration.
             const uint64_t currentTime = cmft::getHPCounter();
-            const uint64_t taskDuration = currentTime - startTime;
-            const uint64_t totalDuration = currentTime - s_globalState.m_startTime;
-
-            // Output process info.
-            char cpuId[16];
-            sprintf(cpuId, "[CPU%u]", threadId);
-            INFO("Radiance -> %-8s| %4u | %7.3fs | %7.3fs"
-                , cpuId
-                , params->m_mipFaceSize
-                , double(taskDuration)*toSec
-                , double(totalDuration)*toSec
-                );
+            const uint64_t rowDuration = currentTime - startTime;
 
-            // Update task counter.
-            s_globalState.incrCompletedTasksCpu();
+            uint64_t faceTime;
+            if (taskList->rowDone(workerId, params, rowDuration, faceTime))
+            {
+                const uint64_t totalDuration = currentTime - taskList->state().m_startTime;
+
+                // Output process info. Face time is the sum over all workers that processed its rows.
+                char cpuId[16];
+                sprintf(cpuId, "[CPU%u]", workerId);
+                INFO("Radiance -> %-8s| %4u | %7.3fs | %7.3fs"
+                    , cpuId
+                    , params->m_mipFaceSize
+                    , double(faceTime)*toSec
+                    , double(totalDuration)*toSec
+                    );
+
+                // Update task counter, siblings are done along with the face.
+                taskList->state().incrCompletedTasksCpu(1 + params->m_numSiblings);
+            }
         }
 
         return EXIT_SUCCESS;
     }
 
+    /// Refs RGBA16F image, converts any other one. Unlike imageConvert(), values outside of the half float
+    /// range are clamped to it instead of becoming infinite.
+    static void imageRefOrConvertHalf(ImageSoftRef& _dst, const Image& _src)
+    {
+        if (TextureFormat::RGBA16F == _src.m_format)
+        {
+            imageRefOrConvert(_dst, TextureFormat::RGBA16F, _src, &g_crtAllocator);
+            return;
+        }
+
+        ImageSoftRef rgba32f;
+        imageRefOrConvert(rgba32f, TextureFormat::RGBA32F, _src, &g_crtAllocator);
+
+        const uint32_t numValues = rgba32f.m_dataSize/sizeof(float);
+        const float* src = (const float*)rgba32f.m_data;
+        uint16_t* dst = (uint16_t*)CMFT_ALLOC(&g_crtAllocator, numValues*sizeof(uint16_t));
+        MALLOC_CHECK(dst);
+
+        for (uint32_t ii = 0; ii < numValues; ++ii)
+        {
+            dst[ii] = cmft::halfFromFloat(CMFT_CLAMP(src[ii], -65504.0f, 65504.0f));
+        }
+
+        _dst.m_width    = rgba32f.m_width;
+        _dst.m_height   = rgba32f.m_height;
+        _dst.m_dataSize = numValues*sizeof(uint16_t);
+        _dst.m_format   = TextureFormat::RGBA16F;
+        _dst.m_numMips  = rgba32f.m_numMips;
+        _dst.m_numFaces = rgba32f.m_numFaces;
+        _dst.m_data     = dst;
+        _dst.m_isRef    = false;
+
+        imageUnload(rgba32f, &g_crtAllocator);
+    }
+
     struct RadianceProgram
     {
+        enum
+        {
+            MaxInFlight = 2, // Rows filtered on the device while the previous ones are read back.
+        };
+
+        struct Stage
+        {
+            enum Enum
+            {
+                Upload,
+                Filter,
+                Sum,
+                Readback,
+
+                Count
+            };
+        };
+
+        /// Output images and events of rows in flight.
+        struct Slot
+        {
+            RadianceFilterRows m_rows;
+            cl_mem m_out;
+            cl_mem m_faces[6];
+            cl_mem m_area;
+            uint32_t m_faceSize;
+            bool m_outHalf;
+            void* m_staging; // Rows of a RGBA16F output image, converted to the float destination on completion.
+            cl_event m_filterBegin;
+            cl_event m_filterEnd;
+            cl_event m_sum;
+            cl_event m_read;
+            uint64_t m_submitTime;
+        };
+
         RadianceProgram()
         {
             m_clContext       = NULL;
@@ -1170,29 +3283,37 @@ namespace cmft
             m_radFilter       = NULL;
             m_radFilterSingle = NULL;
             m_sum             = NULL;
-            m_event           = NULL;
-            m_memOut          = NULL;
-            m_prevDstFaceSize = 0;
             m_srcFaceSize     = 0.0f;
-            m_memFaceData[0]  = NULL;
-            m_memFaceData[1]  = NULL;
-            m_memFaceData[2]  = NULL;
-            m_memFaceData[3]  = NULL;
-            m_memFaceData[4]  = NULL;
-            m_memFaceData[5]  = NULL;
-            m_memNormalSolidAngle[0] = NULL;
-            m_memNormalSolidAngle[1] = NULL;
-            m_memNormalSolidAngle[2] = NULL;
-            m_memNormalSolidAngle[3] = NULL;
-            m_memNormalSolidAngle[4] = NULL;
-            m_memNormalSolidAngle[5] = NULL;
-        }
-
-        void setDeviceContext(const ClContext* _clContext)
+            m_srcWarp         = 0.0f;
+            m_half            = false;
+            m_source          = NULL;
+            m_numUploadEvents = 0;
+            m_uploadTable     = NULL;
+            m_slotBegin       = 0;
+            m_numInFlight     = 0;
+            memset(m_memFaceData,         0, sizeof(m_memFaceData));
+            memset(m_memNormalSolidAngle, 0, sizeof(m_memNormalSolidAngle));
+            memset(m_uploadEvents,        0, sizeof(m_uploadEvents));
+            memset(m_slots,               0, sizeof(m_slots));
+            memset(m_stageTime,           0, sizeof(m_stageTime));
+        }
+
+        void setDeviceContext(ClContext* _clContext)
         {
             m_clContext = _clContext;
         }
 
+        /// Source and RGBA16F targets use half float images, kernels have to be built with CMFT_COMPUTED_NORMALS.
+        void setHalfFloat(bool _half)
+        {
+            m_half = _half;
+        }
+
+        bool isHalfFloat() const
+        {
+            return m_half;
+        }
+
         bool hasValidDeviceContext() const
         {
             return (NULL != m_clContext && NULL != m_clContext->m_context);
@@ -1225,29 +3346,14 @@ namespace cmft
             return createFromStr(src, total);
         }
 
+        // Program is built once per context and source, see clProgramAcquire().
         bool createFromStr(const char* _source, size_t _sourceSize)
         {
             cl_int err;
 
-            // Create program.
-            const char* sources[1] = { _source };
-            const size_t sizes[1] = { _sourceSize };
-            m_program = clCreateProgramWithSource(m_clContext->m_context, 1, sources, sizes, &err);
-            if (CL_SUCCESS != err)
-            {
-                WARN("Could not create OpenCL program. OpenCL source file probably missing!");
-                return false;
-            }
-
-            // Build program.
-            err = clBuildProgram(m_program, 1, &m_clContext->m_device, NULL, NULL, NULL);
-            if (CL_SUCCESS != err)
+            m_program = clProgramAcquire(m_clContext, _source, _sourceSize);
+            if (NULL == m_program)
             {
-                // Print error.
-                char buffer[1024*16];
-                clGetProgramBuildInfo(m_program, m_clContext->m_device, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, NULL);
-                WARN("CL Compilation failed:\n%s", buffer);
-
                 return false;
             }
 
@@ -1256,6 +3362,7 @@ namespace cmft
             if (CL_SUCCESS != err)
             {
                 WARN("Could not create OpenCL kernel. Kernel name probably inavlid! Should be: 'radianceFilter'");
+                destroy();
                 return false;
             }
 
@@ -1263,6 +3370,7 @@ namespace cmft
             if (CL_SUCCESS != err)
             {
                 WARN("Could not create OpenCL kernel. Kernel name probably inavlid! Should be: 'radianceFilterSingleFace'");
+                destroy();
                 return false;
             }
 
@@ -1270,6 +3378,7 @@ namespace cmft
             if (CL_SUCCESS != err)
             {
                 WARN("Could not create OpenCL kernel. Kernel name probably inavlid! Should be: 'sum'");
+                destroy();
                 return false;
             }
 
@@ -1335,10 +3444,45 @@ namespace cmft
                 }                           \
             } while(0)
 
-        bool initDeviceMemory(const Image& _image, float* _cubemapNormalSolidAngle)
+        // Creates source image and starts uploading _data on the transfer queue. Kernels wait for the upload,
+        // _data has to stay valid until waitUpload().
+        bool createSourceImage(cl_mem& _mem, const cl_image_format& _format, size_t _width, size_t _height, size_t _rowPitch, const void* _data)
         {
             cl_int err;
 
+            _mem = clCreateImage2D(m_clContext->m_context
+                                 , CL_MEM_READ_ONLY
+                                 , &_format
+                                 , _width
+                                 , _height
+                                 , 0
+                                 , NULL
+                                 , &err
+                                 );
+            CL_CHECK_RETURN(err);
+
+            const size_t origin[3] = { 0, 0, 0 };
+            const size_t region[3] = { _width, _height, 1 };
+            cl_event event;
+            CL_CHECK_EXPR_RETURN(clEnqueueWriteImage(m_clContext->m_transferQueue
+                                                   , _mem
+                                                   , CL_FALSE
+                                                   , origin
+                                                   , region
+                                                   , _rowPitch
+                                                   , 0
+                                                   , _data
+                                                   , 0
+                                                   , NULL
+                                                   , &event
+                                                   ));
+            m_uploadEvents[m_numUploadEvents++] = event;
+
+            return true;
+        }
+
+        bool initDeviceMemory(const Image& _image, const float* _cubemapNormalSolidAngle)
+        {
             uint32_t faceOffsets[CUBE_FACE_NUM];
             imageGetFaceOffsets(faceOffsets, _image);
             const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
@@ -1347,27 +3491,23 @@ namespace cmft
 
             for (uint8_t face = 0; face < 6; ++face)
             {
-                m_memFaceData[face] = clCreateImage2D(m_clContext->m_context
-                                                    , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
-                                                    , &sc_imageFormat
-                                                    , _image.m_width
-                                                    , _image.m_height
-                                                    , _image.m_width*bytesPerPixel
-                                                    , ((uint8_t*)_image.m_data + faceOffsets[face])
-                                                    , &err
-                                                    );
-                CL_CHECK_RETURN(err);
-
-                m_memNormalSolidAngle[face] = clCreateImage2D(m_clContext->m_context
-                                                            , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
-                                                            , &sc_imageFormat
-                                                            , _image.m_width
-                                                            , _image.m_height
-                                                            , _image.m_width*bytesPerPixel
-                                                            , ((uint8_t*)_cubemapNormalSolidAngle + normalFaceSize*face)
-                                                            , &err
-                                                            );
-                CL_CHECK_RETURN(err);
+                if (!createSourceImage(m_memFaceData[face]
+                                     , sc_imageFormat
+                                     , _image.m_width
+                                     , _image.m_height
+                                     , _image.m_width*bytesPerPixel
+                                     , ((uint8_t*)_image.m_data + faceOffsets[face])
+                                     )
+                ||  !createSourceImage(m_memNormalSolidAngle[face]
+                                     , sc_imageFormat
+                                     , _image.m_width
+                                     , _image.m_height
+                                     , _image.m_width*bytesPerPixel
+                                     , ((const uint8_t*)_cubemapNormalSolidAngle + normalFaceSize*face)
+                                     ))
+                {
+                    return false;
+                }
             }
 
             m_srcFaceSize = float(int32_t(_image.m_width));
@@ -1375,62 +3515,242 @@ namespace cmft
             return true;
         }
 
-        bool processAllAtOnce(void* _out
-                            , uint8_t _faceIdx
-                            , uint32_t _dstFaceSize
-                            , float _specularPower
-                            , float _specularAngle
-                            , float _filterSize
-                            , EdgeFixup::Enum _edgeFixup = EdgeFixup::None
-                            )
+        /// Uploads RGBA16F source images. Kernels built with CMFT_COMPUTED_NORMALS do not read the normal table,
+        /// but still take it as an argument, so a 1x1 image is bound for each face instead.
+        bool initDeviceMemoryHalf(const Image& _image)
         {
             cl_int err;
-            static const cl_image_format sc_imageFormat = { CL_RGBA, CL_FLOAT };
 
-            const float warp = warpFixupFactor(float(int32_t(_dstFaceSize)));
-            const size_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+            uint32_t faceOffsets[CUBE_FACE_NUM];
+            imageGetFaceOffsets(faceOffsets, _image);
+            const uint32_t bytesPerPixel = 4 /*numChannels*/ * 2 /*bytesPerChannel*/;
+            static const cl_image_format sc_imageFormat = { CL_RGBA, CL_HALF_FLOAT };
+            static const cl_image_format sc_tableFormat = { CL_RGBA, CL_FLOAT };
+
+            float unused[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            cl_mem table = clCreateImage2D(m_clContext->m_context
+                                         , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
+                                         , &sc_tableFormat
+                                         , 1
+                                         , 1
+                                         , sizeof(unused)
+                                         , unused
+                                         , &err
+                                         );
+            CL_CHECK_RETURN(err);
 
-            // Create output image.
-            if (m_prevDstFaceSize != _dstFaceSize)
+            for (uint8_t face = 0; face < 6; ++face)
             {
-                if (NULL != m_memOut)
+                if (0 != face)
+                {
+                    clRetainMemObject(table);
+                }
+                m_memNormalSolidAngle[face] = table;
+
+                if (!createSourceImage(m_memFaceData[face]
+                                     , sc_imageFormat
+                                     , _image.m_width
+                                     , _image.m_height
+                                     , _image.m_width*bytesPerPixel
+                                     , ((uint8_t*)_image.m_data + faceOffsets[face])
+                                     ))
                 {
-                    clReleaseMemObject(m_memOut);
+                    return false;
                 }
+            }
 
-                m_memOut = clCreateImage2D(m_clContext->m_context
-                                         , CL_MEM_WRITE_ONLY
-                                         , &sc_imageFormat
-                                         , _dstFaceSize
-                                         , _dstFaceSize
-                                         , 0
-                                         , NULL
-                                         , &err
-                                         );
+            m_srcFaceSize = float(int32_t(_image.m_width));
+
+            return true;
+        }
+
+        /// Uploads planar tables as single channel images, one per face, with the planes stacked vertically.
+        /// Kernels have to be built with CMFT_PLANAR_LAYOUT defined.
+        bool initDeviceMemoryPlanar(const float* _normalPlanes, const float* _srcPlanes, uint32_t _faceSize)
+        {
+            const uint32_t pitch = cubemapPlanePitch(_faceSize);
+            const uint32_t planeSize = pitch*_faceSize;
+            const size_t rowPitch = pitch * 4 /*bytesPerChannel*/;
+            static const cl_image_format sc_imageFormat = { CL_R, CL_FLOAT };
+
+            for (uint8_t face = 0; face < 6; ++face)
+            {
+                if (!createSourceImage(m_memFaceData[face]
+                                     , sc_imageFormat
+                                     , _faceSize
+                                     , _faceSize*3
+                                     , rowPitch
+                                     , (_srcPlanes + planeSize*3*face)
+                                     )
+                ||  !createSourceImage(m_memNormalSolidAngle[face]
+                                     , sc_imageFormat
+                                     , _faceSize
+                                     , _faceSize*4
+                                     , rowPitch
+                                     , (_normalPlanes + planeSize*4*face)
+                                     ))
+                {
+                    return false;
+                }
+            }
+
+            m_srcFaceSize = float(int32_t(_faceSize));
+
+            return true;
+        }
+
+        // Output images of a slot are kept while consecutive rows have the same face size.
+        bool initSlotMemory(Slot& _slot, uint32_t _dstFaceSize, bool _partialFaces)
+        {
+            cl_int err;
+            static const cl_image_format sc_imageFormat = { CL_RGBA, CL_FLOAT };
+            static const cl_image_format sc_halfFormat  = { CL_RGBA, CL_HALF_FLOAT };
+
+            const bool outHalf = m_half && (TextureFormat::RGBA16F == _slot.m_rows.m_params->m_dstFormat);
+            if (_slot.m_faceSize != _dstFaceSize
+            ||  _slot.m_outHalf  != outHalf)
+            {
+                releaseSlotMemory(_slot);
+
+                _slot.m_out = clCreateImage2D(m_clContext->m_context
+                                            , CL_MEM_READ_WRITE
+                                            , outHalf ? &sc_halfFormat : &sc_imageFormat
+                                            , _dstFaceSize
+                                            , _dstFaceSize
+                                            , 0
+                                            , NULL
+                                            , &err
+                                            );
                 CL_CHECK_RETURN(err);
+
+                if (outHalf)
+                {
+                    _slot.m_staging = CMFT_ALLOC(&g_crtAllocator, _dstFaceSize*_dstFaceSize*4*sizeof(uint16_t));
+                    MALLOC_CHECK(_slot.m_staging);
+                }
+
+                _slot.m_faceSize = _dstFaceSize;
+                _slot.m_outHalf  = outHalf;
+            }
+
+            for (uint8_t ii = 0; ii < 6 && _partialFaces; ++ii)
+            {
+                if (NULL == _slot.m_faces[ii])
+                {
+                    _slot.m_faces[ii] = clCreateImage2D(m_clContext->m_context
+                                                      , CL_MEM_READ_WRITE
+                                                      , &sc_imageFormat
+                                                      , _dstFaceSize
+                                                      , _dstFaceSize
+                                                      , 0
+                                                      , NULL
+                                                      , &err
+                                                      );
+                    CL_CHECK_RETURN(err);
+                }
             }
-            m_prevDstFaceSize = _dstFaceSize;
 
             #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                // Build filter area info.
-                float* filterArea = buildCubemapFilterArea(_faceIdx, _dstFaceSize, _filterSize, _edgeFixup, &g_crtAllocator);
+                // Build filter area info. Image holds a copy, so the table is released right away.
+                const float* filterArea = cubemapTableAcquire(CubemapTable::FilterArea, _dstFaceSize, _slot.m_rows.m_params->m_edgeFixup, _slot.m_rows.m_params->m_face, _slot.m_rows.m_params->m_filterSize);
                 const size_t width = _dstFaceSize*6;
                 const size_t height = _dstFaceSize;
-                cl_mem area = clCreateImage2D(m_clContext->m_context
-                                            , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
-                                            , &sc_imageFormat
-                                            , width
-                                            , height
-                                            , width*bytesPerPixel
-                                            , filterArea
-                                            , &err
-                                            );
+                const size_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+                _slot.m_area = clCreateImage2D(m_clContext->m_context
+                                             , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
+                                             , &sc_imageFormat
+                                             , width
+                                             , height
+                                             , width*bytesPerPixel
+                                             , const_cast<float*>(filterArea)
+                                             , &err
+                                             );
+                cubemapTableRelease(filterArea);
                 CL_CHECK_RETURN(err);
             #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
-            CMFT_UNUSED(_edgeFixup);
+
+            return true;
+        }
+
+        // Enqueues filter kernel of a slot. The first one waits for the source upload, events of the first and
+        // the last one are kept for profiling.
+        bool enqueueFilter(Slot& _slot, cl_kernel _kernel, const size_t _workOffset[2], const size_t _workSize[2])
+        {
+            const bool first = (NULL == _slot.m_filterBegin);
+            const cl_uint numWaitEvents = first ? m_numUploadEvents : 0;
+
+            cl_event event;
+            CL_CHECK_EXPR_RETURN(clEnqueueNDRangeKernel(m_clContext->m_commandQueue
+                                                      , _kernel
+                                                      , 2
+                                                      , _workOffset
+                                                      , _workSize
+                                                      , NULL
+                                                      , numWaitEvents
+                                                      , (0 == numWaitEvents) ? NULL : m_uploadEvents
+                                                      , &event
+                                                      ));
+            if (first)
+            {
+                _slot.m_filterBegin = event;
+            }
+            else
+            {
+                releaseEvent(_slot.m_filterEnd);
+                _slot.m_filterEnd = event;
+            }
+
+            return true;
+        }
+
+        // Reads rows of the slot output into _out on the transfer queue, after _waitEvent.
+        bool enqueueRead(Slot& _slot, void* _out, cl_event _waitEvent)
+        {
+            const RadianceFilterRows& rows = _slot.m_rows;
+            const size_t bytesPerPixel = 4 /*numChannels*/ * (_slot.m_outHalf ? 2 : 4) /*bytesPerChannel*/;
+            void* out = _slot.m_outHalf ? _slot.m_staging : _out;
+            const size_t origin[3] = { 0, rows.m_rowBegin, 0 };
+            const size_t region[3] = { _slot.m_faceSize, rows.m_rowEnd-rows.m_rowBegin, 1 };
+            CL_CHECK_EXPR_RETURN(clEnqueueReadImage(m_clContext->m_transferQueue
+                                                  , _slot.m_out
+                                                  , CL_FALSE
+                                                  , origin
+                                                  , region
+                                                  , _slot.m_faceSize*bytesPerPixel
+                                                  , 0
+                                                  , (uint8_t*)out + rows.m_rowBegin*_slot.m_faceSize*bytesPerPixel
+                                                  , 1
+                                                  , &_waitEvent
+                                                  , &_slot.m_read
+                                                  ));
+
+            // Start both queues, host is not waiting for any of them.
+            CL_CHECK_EXPR_RETURN(clFlush(m_clContext->m_commandQueue));
+            CL_CHECK_EXPR_RETURN(clFlush(m_clContext->m_transferQueue));
+
+            return true;
+        }
+
+        bool processAllAtOnce(Slot& _slot
+                            , void* _out
+                            , uint8_t _faceIdx
+                            , uint32_t _dstFaceSize
+                            , uint32_t _rowBegin
+                            , uint32_t _rowEnd
+                            , float _specularPower
+                            , float _specularAngle
+                            , float _filterSize
+                            )
+        {
+            const float warp = warpFixupFactor(float(int32_t(_dstFaceSize)));
+
+            if (!initSlotMemory(_slot, _dstFaceSize, false))
+            {
+                return false;
+            }
 
             // Set arguments.
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter,  0, sizeof(cl_mem),  (const void*)&m_memOut));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter,  0, sizeof(cl_mem),  (const void*)&_slot.m_out));
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter,  1, sizeof(int32_t), (const void*)&_dstFaceSize));
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter,  2, sizeof(float),   (const void*)&_specularPower));
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter,  3, sizeof(float),   (const void*)&_specularAngle));
@@ -1451,91 +3771,53 @@ namespace cmft
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter, 18, sizeof(cl_mem),  (const void*)&m_memNormalSolidAngle[4]));
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter, 19, sizeof(cl_mem),  (const void*)&m_memNormalSolidAngle[5]));
             #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter, 20, sizeof(cl_mem),  (const void*)&area));
+                CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter, 20, sizeof(cl_mem),  (const void*)&_slot.m_area));
             #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilter, 20+CMFT_COMPUTE_FILTER_AREA_ON_CPU, sizeof(float), (const void*)&m_srcWarp));
 
-            // Process in tiles of 64x64.
+            // Process rows [_rowBegin, _rowEnd) in tiles of 64x64. First work dimension is the row.
             const uint32_t tileSize = 64;
             const uint32_t count = ((_dstFaceSize-1)/tileSize)+1;
-            for (uint32_t yy = 0; yy < count; ++yy)
+            for (uint32_t yy = _rowBegin; yy < _rowEnd; yy += tileSize)
             {
                 for (uint32_t xx = 0; xx < count; ++xx)
                 {
-                    const size_t workOffset[2] = { xx*tileSize, yy*tileSize };
+                    const size_t workOffset[2] = { yy, xx*tileSize };
                     const size_t workSize[2] =
                     {
-                        CMFT_MIN(tileSize, _dstFaceSize-workOffset[0]),
-                        CMFT_MIN(tileSize, _dstFaceSize-workOffset[1]),
+                        CMFT_MIN(tileSize, _rowEnd-yy),
+                        CMFT_MIN(tileSize, _dstFaceSize-xx*tileSize),
                     };
-                    CL_CHECK_EXPR_RETURN(clEnqueueNDRangeKernel(m_clContext->m_commandQueue
-                                                              , m_radFilter
-                                                              , 2
-                                                              , workOffset
-                                                              , workSize
-                                                              , NULL
-                                                              , 0
-                                                              , NULL
-                                                              , &m_event
-                                                              ));
+                    if (!enqueueFilter(_slot, m_radFilter, workOffset, workSize))
+                    {
+                        return false;
+                    }
                 }
             }
 
-            const size_t origin[3] = { 0, 0, 0 };
-            const size_t region[3] = { _dstFaceSize, _dstFaceSize, 1 };
-            CL_CHECK_EXPR_RETURN(clEnqueueReadImage(m_clContext->m_commandQueue
-                                                  , m_memOut
-                                                  , CL_TRUE
-                                                  , origin
-                                                  , region
-                                                  , _dstFaceSize*bytesPerPixel
-                                                  , 0
-                                                  , _out
-                                                  , 0
-                                                  , NULL
-                                                  , &m_event
-                                                  ));
-
-            #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                clReleaseMemObject(area);
-                CMFT_FREE(g_allocator, filterArea);
-            #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
-
-            return true;
+            const cl_event lastKernel = (NULL != _slot.m_filterEnd) ? _slot.m_filterEnd : _slot.m_filterBegin;
+            return enqueueRead(_slot, _out, lastKernel);
         }
 
-        bool processFaceByFaceAndSum(void* _out
+        bool processFaceByFaceAndSum(Slot& _slot
+                                   , void* _out
                                    , uint8_t _faceIdx
                                    , uint32_t _dstFaceSize
+                                   , uint32_t _rowBegin
+                                   , uint32_t _rowEnd
                                    , float _specularPower
                                    , float _specularAngle
                                    , float _filterSize
-                                   , EdgeFixup::Enum _edgeFixup = EdgeFixup::None
                                    )
         {
-            cl_int err;
-            static const cl_image_format sc_imageFormat = { CL_RGBA, CL_FLOAT };
-
             const float warp = warpFixupFactor(float(int32_t(_dstFaceSize)));
-            const size_t workSize[2] = { _dstFaceSize, _dstFaceSize };
-            const size_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+            const size_t workOffset[2] = { _rowBegin, 0 };
+            const size_t workSize[2] = { _rowEnd-_rowBegin, _dstFaceSize };
 
-            #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                // Build filter area info.
-                float* filterArea = buildCubemapFilterArea(_faceIdx, _dstFaceSize, _filterSize, _edgeFixup, &g_crtAllocator);
-                const size_t width = _dstFaceSize*6;
-                const size_t height = _dstFaceSize;
-                cl_mem area = clCreateImage2D(m_clContext->m_context
-                                            , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
-                                            , &sc_imageFormat
-                                            , width
-                                            , height
-                                            , width*bytesPerPixel
-                                            , filterArea
-                                            , &err
-                                            );
-                CL_CHECK_RETURN(err);
-            #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
-            CMFT_UNUSED(_edgeFixup);
+            if (!initSlotMemory(_slot, _dstFaceSize, true))
+            {
+                return false;
+            }
 
             // Set arguments that do not change for the entire task.
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle,  4, sizeof(int32_t), (const void*)&_dstFaceSize));
@@ -1546,158 +3828,245 @@ namespace cmft
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle,  9, sizeof(int8_t),  (const void*)&_faceIdx));
             CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 10, sizeof(float),   (const void*)&m_srcFaceSize));
             #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 11, sizeof(cl_mem),  (const void*)&area));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 11, sizeof(cl_mem),  (const void*)&_slot.m_area));
             #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 11+CMFT_COMPUTE_FILTER_AREA_ON_CPU, sizeof(float), (const void*)&m_srcWarp));
 
-            // Process each face separately in tiles of 64x64.
+            // Process rows [_rowBegin, _rowEnd) of each face separately in tiles of 64x64. First work dimension is the row.
             const uint32_t tileSize = 64;
             const uint32_t count = ((_dstFaceSize-1)/tileSize)+1;
-            cl_mem faces[6];
             for (uint8_t ii = 0; ii < 6; ++ii)
             {
-                faces[ii] = clCreateImage2D(m_clContext->m_context
-                                          , CL_MEM_READ_WRITE
-                                          , &sc_imageFormat
-                                          , _dstFaceSize
-                                          , _dstFaceSize
-                                          , 0
-                                          , NULL
-                                          , &err
-                                          );
-                CL_CHECK_RETURN(err);
-
                 const uint8_t faceIdx = ii;
-                CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 0, sizeof(cl_mem), (const void*)&faces[ii]));
+                CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 0, sizeof(cl_mem), (const void*)&_slot.m_faces[ii]));
                 CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 1, sizeof(cl_mem), (const void*)&m_memFaceData[ii]));
                 CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 2, sizeof(cl_mem), (const void*)&m_memNormalSolidAngle[ii]));
                 CL_CHECK_EXPR_RETURN(clSetKernelArg(m_radFilterSingle, 3, sizeof(int8_t), (const void*)&faceIdx));
 
-                for (uint32_t yy = 0; yy < count; ++yy)
+                for (uint32_t yy = _rowBegin; yy < _rowEnd; yy += tileSize)
                 {
                     for (uint32_t xx = 0; xx < count; ++xx)
                     {
-                        const size_t tileWorkOffset[2] = { xx*tileSize, yy*tileSize };
+                        const size_t tileWorkOffset[2] = { yy, xx*tileSize };
                         const size_t tileWorkSize[2] =
                         {
-                            CMFT_MIN(tileSize, _dstFaceSize-tileWorkOffset[0]),
-                            CMFT_MIN(tileSize, _dstFaceSize-tileWorkOffset[1]),
+                            CMFT_MIN(tileSize, _rowEnd-yy),
+                            CMFT_MIN(tileSize, _dstFaceSize-xx*tileSize),
                         };
-                        CL_CHECK_EXPR_RETURN(clEnqueueNDRangeKernel(m_clContext->m_commandQueue
-                                                                  , m_radFilterSingle
-                                                                  , 2
-                                                                  , tileWorkOffset
-                                                                  , tileWorkSize
-                                                                  , NULL
-                                                                  , 0
-                                                                  , NULL
-                                                                  , &m_event
-                                                                  ));
+                        if (!enqueueFilter(_slot, m_radFilterSingle, tileWorkOffset, tileWorkSize))
+                        {
+                            return false;
+                        }
                     }
                 }
             }
 
             // Sum partial results.
-            if (m_prevDstFaceSize != _dstFaceSize)
-            {
-                if (NULL != m_memOut)
-                {
-                    clReleaseMemObject(m_memOut);
-                }
-
-                m_memOut = clCreateImage2D(m_clContext->m_context
-                                         , CL_MEM_WRITE_ONLY
-                                         , &sc_imageFormat
-                                         , _dstFaceSize
-                                         , _dstFaceSize
-                                         , 0
-                                         , NULL
-                                         , &err
-                                         );
-                CL_CHECK_RETURN(err);
-            }
-            m_prevDstFaceSize = _dstFaceSize;
-
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 0, sizeof(cl_mem), (const void*)&m_memOut));
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 1, sizeof(cl_mem), (const void*)&faces[0]));
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 2, sizeof(cl_mem), (const void*)&faces[1]));
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 3, sizeof(cl_mem), (const void*)&faces[2]));
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 4, sizeof(cl_mem), (const void*)&faces[3]));
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 5, sizeof(cl_mem), (const void*)&faces[4]));
-            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 6, sizeof(cl_mem), (const void*)&faces[5]));
-            CL_CHECK_EXPR_RETURN(clEnqueueNDRangeKernel(m_clContext->m_commandQueue, m_sum, 2, NULL, workSize, NULL, 0, NULL, &m_event));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 0, sizeof(cl_mem), (const void*)&_slot.m_out));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 1, sizeof(cl_mem), (const void*)&_slot.m_faces[0]));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 2, sizeof(cl_mem), (const void*)&_slot.m_faces[1]));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 3, sizeof(cl_mem), (const void*)&_slot.m_faces[2]));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 4, sizeof(cl_mem), (const void*)&_slot.m_faces[3]));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 5, sizeof(cl_mem), (const void*)&_slot.m_faces[4]));
+            CL_CHECK_EXPR_RETURN(clSetKernelArg(m_sum, 6, sizeof(cl_mem), (const void*)&_slot.m_faces[5]));
+            CL_CHECK_EXPR_RETURN(clEnqueueNDRangeKernel(m_clContext->m_commandQueue, m_sum, 2, workOffset, workSize, NULL, 0, NULL, &_slot.m_sum));
 
             // Read result.
-            const size_t origin[3] = { 0, 0, 0 };
-            const size_t region[3] = { _dstFaceSize, _dstFaceSize, 1 };
-            CL_CHECK_EXPR_RETURN(clEnqueueReadImage(m_clContext->m_commandQueue
-                                                  , m_memOut
-                                                  , CL_TRUE
-                                                  , origin
-                                                  , region
-                                                  , _dstFaceSize*bytesPerPixel
-                                                  , 0
-                                                  , _out
-                                                  , 0
-                                                  , NULL
-                                                  , &m_event
-                                                  ));
-
-            #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                clReleaseMemObject(area);
-                CMFT_FREE(&g_crtAllocator, filterArea);
-            #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
-
-            return true;
+            return enqueueRead(_slot, _out, _slot.m_sum);
         }
 
         #undef CL_CHECK_RETURN
         #undef CL_CHECK_EXPR_RETURN
 
-        bool run(void* _out, uint8_t _faceIdx, uint32_t _dstFaceSize, float _specularPower, float _specularAngle, float _filterSize, EdgeFixup::Enum _edgeFixup = EdgeFixup::None)
+        /// Starts filtering rows [_rowBegin, _rowEnd) of destination face. Results are written to
+        /// destination when complete() returns them. Expects hasFreeSlot().
+        bool submit(const RadianceFilterRows& _rows)
         {
+            Slot& slot = m_slots[(m_slotBegin + m_numInFlight) % MaxInFlight];
+            slot.m_rows = _rows;
+            slot.m_submitTime = cmft::getHPCounter();
+
+            // Slot is in flight even when enqueueing fails, cancel() returns its rows.
+            m_numInFlight++;
+
+            const RadianceFilterParams& params = *_rows.m_params;
+
             /// if (m_srcFaceSize > 512)
             /// {
             ///     // Prevents driver crash by running 6+1 smaller kernels instead of a big one.
-            ///     return processFaceByFaceAndSum(_out, _faceIdx, _dstFaceSize, _specularPower, _specularAngle, _filterSize, _edgeFixup);
+            ///     return processFaceByFaceAndSum(slot, params.m_dstPtr, params.m_face, params.m_mipFaceSize, _rows.m_rowBegin, _rows.m_rowEnd, params.m_specularPower, params.m_specularAngle, params.m_filterSize);
             /// }
             /// else
             /// {
-            ///     return processAllAtOnce(_out, _faceIdx, _dstFaceSize, _specularPower, _specularAngle, _filterSize, _edgeFixup);
+            ///     return processAllAtOnce(slot, params.m_dstPtr, params.m_face, params.m_mipFaceSize, _rows.m_rowBegin, _rows.m_rowEnd, params.m_specularPower, params.m_specularAngle, params.m_filterSize);
             /// }
 
-            return processFaceByFaceAndSum(_out, _faceIdx, _dstFaceSize, _specularPower, _specularAngle, _filterSize, _edgeFixup);
+            return processFaceByFaceAndSum(slot
+                                         , params.m_dstPtr
+                                         , params.m_face
+                                         , params.m_mipFaceSize
+                                         , _rows.m_rowBegin
+                                         , _rows.m_rowEnd
+                                         , params.m_specularPower
+                                         , params.m_specularAngle
+                                         , params.m_filterSize
+                                         );
         }
 
-        bool isIdle() const
+        /// Waits for the oldest rows in flight. _duration is device time from their first kernel to the end of
+        /// the readback, in timer ticks. Returns false when the device failed to filter them.
+        bool complete(RadianceFilterRows& _rows, uint64_t& _duration)
+        {
+            Slot& slot = m_slots[m_slotBegin];
+            m_slotBegin = (m_slotBegin + 1) % MaxInFlight;
+            m_numInFlight--;
+
+            _rows = slot.m_rows;
+
+            cl_int status = CL_COMPLETE;
+            bool success = (CL_SUCCESS == clWaitForEvents(1, &slot.m_read))
+                        && (CL_SUCCESS == clGetEventInfo(slot.m_read, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL))
+                        && (CL_COMPLETE == status);
+
+            if (success)
+            {
+                const cl_event filterEnd = (NULL != slot.m_filterEnd) ? slot.m_filterEnd : slot.m_filterBegin;
+                const uint64_t filter   = eventDuration(slot.m_filterBegin, filterEnd);
+                const uint64_t sum      = eventDuration(slot.m_sum, slot.m_sum);
+                const uint64_t readback = eventDuration(slot.m_read, slot.m_read);
+                const uint64_t total    = eventDuration(slot.m_filterBegin, slot.m_read);
+                m_stageTime[Stage::Filter]   += filter;
+                m_stageTime[Stage::Sum]      += sum;
+                m_stageTime[Stage::Readback] += readback;
+
+                if (slot.m_outHalf)
+                {
+                    const uint32_t begin = slot.m_rows.m_rowBegin*slot.m_faceSize*4;
+                    const uint32_t end   = slot.m_rows.m_rowEnd  *slot.m_faceSize*4;
+                    const uint16_t* src = (const uint16_t*)slot.m_staging;
+                    float* dst = slot.m_rows.m_params->m_dstPtr;
+                    for (uint32_t ii = begin; ii < end; ++ii)
+                    {
+                        dst[ii] = cmft::halfToFloat(src[ii]);
+                    }
+                }
+
+                // Without profiling info, fall back to host time, which includes the wait for other rows in flight.
+                _duration = (0 != total)
+                          ? uint64_t(double(total)*double(cmft::getHPFrequency())*1e-9)
+                          : cmft::getHPCounter() - slot.m_submitTime
+                          ;
+            }
+
+            releaseSlot(slot);
+
+            return success;
+        }
+
+        /// Drops rows in flight after a failure, returns them one by one to be filtered on cpu.
+        bool cancel(RadianceFilterRows& _rows)
+        {
+            if (0 == m_numInFlight)
+            {
+                return false;
+            }
+
+            finish();
+
+            Slot& slot = m_slots[m_slotBegin];
+            m_slotBegin = (m_slotBegin + 1) % MaxInFlight;
+            m_numInFlight--;
+
+            _rows = slot.m_rows;
+            releaseSlot(slot);
+
+            return true;
+        }
+
+        bool hasFreeSlot() const
+        {
+            return (m_numInFlight < MaxInFlight);
+        }
+
+        uint32_t numInFlight() const
         {
-            cl_int status;
-            clGetEventInfo(m_event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), (void*)&status, NULL);
+            return m_numInFlight;
+        }
 
-            return ((CL_COMPLETE == status) || (NULL == m_event));
+        bool isIdle() const
+        {
+            return (0 == m_numInFlight);
         }
 
         void finish() const
         {
             CL_CHECK(clFinish(m_clContext->m_commandQueue));
+            CL_CHECK(clFinish(m_clContext->m_transferQueue));
+        }
+
+        void resetStageTimes()
+        {
+            memset(m_stageTime, 0, sizeof(m_stageTime));
+        }
+
+        /// Device time spent in each stage, in nanoseconds, from OpenCL profiling events.
+        uint64_t stageTime(Stage::Enum _stage) const
+        {
+            return m_stageTime[_stage];
         }
 
         void releaseDeviceMemory()
         {
-        #define RELEASE_CL_MEM(_mem) do { if (NULL != _mem) { clReleaseMemObject(_mem); _mem = NULL; } } while (0)
-            RELEASE_CL_MEM(m_memOut);
-            RELEASE_CL_MEM(m_memFaceData[0]);
-            RELEASE_CL_MEM(m_memFaceData[1]);
-            RELEASE_CL_MEM(m_memFaceData[2]);
-            RELEASE_CL_MEM(m_memFaceData[3]);
-            RELEASE_CL_MEM(m_memFaceData[4]);
-            RELEASE_CL_MEM(m_memFaceData[5]);
-            RELEASE_CL_MEM(m_memNormalSolidAngle[0]);
-            RELEASE_CL_MEM(m_memNormalSolidAngle[1]);
-            RELEASE_CL_MEM(m_memNormalSolidAngle[2]);
-            RELEASE_CL_MEM(m_memNormalSolidAngle[3]);
-            RELEASE_CL_MEM(m_memNormalSolidAngle[4]);
-            RELEASE_CL_MEM(m_memNormalSolidAngle[5]);
-        #undef RELEASE_CL_MEM
+            releaseSource();
+
+            for (uint32_t ii = 0; ii < MaxInFlight; ++ii)
+            {
+                releaseSlotMemory(m_slots[ii]);
+            }
+        }
+
+        // Replaces device memory with the full resolution level of given source. Device reads the normal table
+        // and Rgba32f texels, or Rgba16f texels only when half float is set. Upload runs on the transfer queue while kernels of rows in flight
+        // are still reading the previous source, the runtime keeps its images alive until they are done.
+        bool upload(const RadianceFilterSource& _source, EdgeFixup::Enum _edgeFixup)
+        {
+            releaseSource();
+
+            const Image& image = *_source.m_image;
+            const bool planar = (NULL != _source.m_srcPlanes);
+            const CubemapTable::Enum tableType = planar ? CubemapTable::NormalPlanes : CubemapTable::NormalSolidAngle;
+            m_srcWarp = (EdgeFixup::Warp == _edgeFixup) ? warpFixupFactor(float(int32_t(image.m_width))) : 0.0f;
+
+            bool success;
+            if (m_half)
+            {
+                imageRefOrConvertHalf(m_uploadImage, image);
+                success = initDeviceMemoryHalf(m_uploadImage);
+            }
+            else if (planar)
+            {
+                m_uploadTable = cubemapTableAcquire(tableType, image.m_width, _edgeFixup);
+                success = initDeviceMemoryPlanar(m_uploadTable, _source.m_srcPlanes, image.m_width);
+            }
+            else
+            {
+                m_uploadTable = cubemapTableAcquire(tableType, image.m_width, _edgeFixup);
+                imageRefOrConvert(m_uploadImage, TextureFormat::RGBA32F, image, &g_crtAllocator);
+                success = initDeviceMemory(m_uploadImage, m_uploadTable);
+            }
+
+            if (success)
+            {
+                CL_CHECK(clFlush(m_clContext->m_transferQueue));
+            }
+
+            m_source = success ? &_source : NULL;
+            return success;
+        }
+
+        const RadianceFilterSource* uploadedSource() const
+        {
+            return m_source;
         }
 
         void destroy()
@@ -1712,73 +4081,402 @@ namespace cmft
         #undef RELEASE_CL_PROG
         }
 
-        const ClContext* m_clContext;
+    private:
+        static void releaseEvent(cl_event& _event)
+        {
+            if (NULL != _event)
+            {
+                clReleaseEvent(_event);
+                _event = NULL;
+            }
+        }
+
+        static void releaseMem(cl_mem& _mem)
+        {
+            if (NULL != _mem)
+            {
+                clReleaseMemObject(_mem);
+                _mem = NULL;
+            }
+        }
+
+        // Nanoseconds from the start of _begin to the end of _end, 0 when profiling info is not available.
+        static uint64_t eventDuration(cl_event _begin, cl_event _end)
+        {
+            cl_ulong start, end;
+            if (NULL == _begin
+            ||  NULL == _end
+            ||  CL_SUCCESS != clGetEventProfilingInfo(_begin, CL_PROFILING_COMMAND_START, sizeof(start), &start, NULL)
+            ||  CL_SUCCESS != clGetEventProfilingInfo(_end,   CL_PROFILING_COMMAND_END,   sizeof(end),   &end,   NULL)
+            ||  end < start)
+            {
+                return 0;
+            }
+
+            return uint64_t(end - start);
+        }
+
+        // Waits for the source upload and releases its host memory.
+        void waitUpload()
+        {
+            if (0 != m_numUploadEvents)
+            {
+                clWaitForEvents(m_numUploadEvents, m_uploadEvents);
+                for (uint32_t ii = 0; ii < m_numUploadEvents; ++ii)
+                {
+                    m_stageTime[Stage::Upload] += eventDuration(m_uploadEvents[ii], m_uploadEvents[ii]);
+                    releaseEvent(m_uploadEvents[ii]);
+                }
+                m_numUploadEvents = 0;
+            }
+
+            imageUnload(m_uploadImage, &g_crtAllocator);
+            if (NULL != m_uploadTable)
+            {
+                cubemapTableRelease(m_uploadTable);
+                m_uploadTable = NULL;
+            }
+        }
+
+        void releaseSource()
+        {
+            waitUpload();
+
+            for (uint8_t face = 0; face < 6; ++face)
+            {
+                releaseMem(m_memFaceData[face]);
+                releaseMem(m_memNormalSolidAngle[face]);
+            }
+
+            m_source = NULL;
+        }
+
+        void releaseSlot(Slot& _slot)
+        {
+            releaseEvent(_slot.m_filterBegin);
+            releaseEvent(_slot.m_filterEnd);
+            releaseEvent(_slot.m_sum);
+            releaseEvent(_slot.m_read);
+            releaseMem(_slot.m_area);
+        }
+
+        void releaseSlotMemory(Slot& _slot)
+        {
+            releaseMem(_slot.m_out);
+            for (uint8_t ii = 0; ii < 6; ++ii)
+            {
+                releaseMem(_slot.m_faces[ii]);
+            }
+            if (NULL != _slot.m_staging)
+            {
+                CMFT_FREE(&g_crtAllocator, _slot.m_staging);
+                _slot.m_staging = NULL;
+            }
+            _slot.m_faceSize = 0;
+            _slot.m_outHalf  = false;
+        }
+
+    public:
+        ClContext* m_clContext;
         cl_program m_program;
         cl_kernel m_radFilter;
         cl_kernel m_radFilterSingle;
         cl_kernel m_sum;
-        cl_event m_event;
-        cl_mem m_memOut;
-        uint32_t m_prevDstFaceSize;
         float m_srcFaceSize;
+        float m_srcWarp;
+        bool m_half;
         cl_mem m_memFaceData[6];
         cl_mem m_memNormalSolidAngle[6];
+        const RadianceFilterSource* m_source;
+
+        // Source upload in progress and host memory it reads from.
+        cl_event m_uploadEvents[12];
+        uint32_t m_numUploadEvents;
+        ImageSoftRef m_uploadImage;
+        const float* m_uploadTable;
+
+        Slot m_slots[MaxInFlight];
+        uint32_t m_slotBegin;
+        uint32_t m_numInFlight;
+        uint64_t m_stageTime[Stage::Count];
+    };
+
+    /// Resolves DeviceFormat::Auto for a batch. Float device memory is estimated from the largest cubemap, its
+    /// source and normal table and the output, partial face and filter area images of each slot in flight.
+    static bool radianceFilterDeviceHalf(DeviceFormat::Enum _format, const ClContext* _clContext, const Image* _src, uint32_t _count, uint32_t _dstFaceSize)
+    {
+        if (DeviceFormat::Auto != _format)
+        {
+            return (DeviceFormat::Half == _format);
+        }
+
+        bool allHalf = true;
+        uint64_t srcFaceSize = 0;
+        uint64_t dstFaceSize = 0;
+        for (uint32_t ii = 0; ii < _count; ++ii)
+        {
+            allHalf &= (TextureFormat::RGBA16F == _src[ii].m_format);
+            srcFaceSize = CMFT_MAX(srcFaceSize, uint64_t(_src[ii].m_width));
+            dstFaceSize = CMFT_MAX(dstFaceSize, uint64_t(0 == _dstFaceSize ? _src[ii].m_width : _dstFaceSize));
+        }
+
+        if (allHalf)
+        {
+            return true;
+        }
+
+        const uint64_t texelSize = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+        const uint64_t srcMemory = 6*srcFaceSize*srcFaceSize*texelSize;
+        const uint64_t dstMemory = dstFaceSize*dstFaceSize*texelSize;
+        const uint64_t total   = 2*srcMemory + RadianceProgram::MaxInFlight*(1+6+6)*dstMemory;
+        const uint64_t largest = CMFT_MAX(srcMemory/6, 6*dstMemory);
+
+        return (total > _clContext->m_globalMemSize/4*3)
+            || (largest > _clContext->m_maxAllocSize)
+            ;
+    }
+
+    /// Highest specular power reconstructed from SH bands 0..SH_MAX_BAND. Lobe energy above the last band stays
+    /// below 1% up to it and grows to several percent at 12, so RadianceFilterOptions::m_shPowerThreshold is clamped.
+    static const float s_radianceShMaxPower = 8.0f;
+
+    /// Filter parameters of a single destination mip.
+    struct RadianceMipFilter
+    {
+        uint32_t m_faceSize;
+        float m_filterSize;
+        float m_specularPower;
+        float m_cosAngle;
+        float m_roughness;
+        uint8_t m_srcLevel;
+        bool m_sh; // Reconstructed from SH coefficients of the source, see RadianceFilterOptions::m_shPowerThreshold.
+    };
+
+    /// Source pyramid with its precomputed tables, filter parameters and destination of one cubemap of a batch.
+    struct RadianceFilterProbe
+    {
+        ImageSoftRef m_srcImage;
+        Image m_srcLevelImage[MAX_MIP_NUM];
+        RadianceFilterSource m_source[MAX_MIP_NUM];
+        uint8_t m_srcLevelCount;
+        RadianceMipFilter m_mipFilter[MAX_MIP_NUM];
+        GgxSampleSet m_ggxSamples[MAX_MIP_NUM];
+        GgxSample* m_ggxSampleData;
+        uint32_t m_dstFaceSize;
+        uint8_t m_mipCount;
+        uint32_t m_dstOffsets[CUBE_FACE_NUM][MAX_MIP_NUM];
+        uint32_t m_dstDataSize;
+        void* m_dstData;
+    };
+
+    struct RadianceFilterContext
+    {
+        RadianceFilterContext()
+        {
+            m_probes    = NULL;
+            m_maxProbes = 0;
+            memset(&m_stats, 0, sizeof(m_stats));
+        }
+
+        ~RadianceFilterContext()
+        {
+            freeProbes();
+        }
+
+        // Probe storage grows to the largest batch and is reused by later calls.
+        RadianceFilterProbe* reserveProbes(uint32_t _count)
+        {
+            if (_count > m_maxProbes)
+            {
+                freeProbes();
+                m_probes = (RadianceFilterProbe*)CMFT_ALLOC(&g_crtAllocator, _count*sizeof(RadianceFilterProbe));
+                MALLOC_CHECK(m_probes);
+                m_maxProbes = _count;
+            }
+
+            return m_probes;
+        }
+
+        void freeProbes()
+        {
+            if (NULL != m_probes)
+            {
+                CMFT_FREE(&g_crtAllocator, m_probes);
+                m_probes    = NULL;
+                m_maxProbes = 0;
+            }
+        }
+
+        RadianceFilterState m_state;
+        RadianceProgram m_program;
+        RadianceFilterStats m_stats; // Of the last call.
+
+        // Source pyramids and destinations of a batch, valid while filtering.
+        RadianceFilterProbe* m_probes;
+        uint32_t m_maxProbes;
+    };
+
+    struct RadianceFilterContextStorage
+    {
+        RadianceFilterContext* alloc()
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+            if (m_handleAlloc.count() == MaxContexts)
+            {
+                return NULL;
+            }
+
+            return &m_context[m_handleAlloc.alloc()];
+        }
+
+        void free(RadianceFilterContext* _context)
+        {
+            std::lock_guard<std::mutex> lock(m_access);
+            if (&m_context[0] <= _context && _context < &m_context[MaxContexts])
+            {
+                uint32_t idx = uint32_t(_context - m_context);
+                if (m_handleAlloc.contains(idx))
+                {
+                    m_handleAlloc.free(idx);
+                }
+            }
+        }
+
+        enum { MaxContexts = 64 };
+
+        std::mutex m_access;
+        HandleAllocT<MaxContexts> m_handleAlloc;
+        RadianceFilterContext m_context[MaxContexts];
     };
-    RadianceProgram s_radianceProgram;
+    static RadianceFilterContextStorage s_radianceFilterContextStorage;
+
+    RadianceFilterContext* radianceFilterContextCreate()
+    {
+        RadianceFilterContext* context = s_radianceFilterContextStorage.alloc();
+        if (NULL == context)
+        {
+            WARN("Too many radiance filter contexts.");
+        }
+
+        return context;
+    }
+
+    void radianceFilterContextDestroy(RadianceFilterContext* _context)
+    {
+        if (NULL == _context)
+        {
+            return;
+        }
+
+        _context->freeProbes();
+        s_radianceFilterContextStorage.free(_context);
+    }
+
+    void radianceFilterContextGetStats(const RadianceFilterContext* _context, RadianceFilterStats& _stats)
+    {
+        _stats = _context->m_stats;
+    }
 
     int32_t radianceFilterGpu(void* _taskList)
     {
-        if (!s_radianceProgram.isValid())
+        RadianceFilterTaskList* taskList = (RadianceFilterTaskList*)_taskList;
+        RadianceProgram& program = taskList->program();
+        if (!program.isValid())
         {
             return EXIT_FAILURE;
         }
 
-        const double freq = double(cmft::getHPFrequency());
-        const double toSec = 1.0/freq;
+        const double freq = double(cmft::getHPFrequency());
+        const double toSec = 1.0/freq;
+
+        // Gpu is processing from the top level mip map to the bottom, one cubemap after another. Rows are
+        // submitted while the previous ones are still filtered or read back, so neither the device nor the
+        // host waits for the other one.
+        RadianceFilterRows rows;
+        bool success = true;
+        for (;;)
+        {
+            if (program.hasFreeSlot()
+            &&  taskList->getGpuRows(rows))
+            {
+                const RadianceFilterParams* params = rows.m_params;
+
+                // Device memory holds source of one cubemap at a time.
+                if (program.uploadedSource() != &params->m_srcLevels[0]
+                && !program.upload(params->m_srcLevels[0], params->m_edgeFixup))
+                {
+                    taskList->pushUnfinished(rows);
+                    success = false;
+                    break;
+                }
+
+                if (!program.submit(rows))
+                {
+                    success = false;
+                    break;
+                }
+
+                continue;
+            }
+
+            if (0 == program.numInFlight())
+            {
+                break;
+            }
 
-        RadianceFilterTaskList* taskList = (RadianceFilterTaskList*)_taskList;
+            uint64_t rowsDuration;
+            if (!program.complete(rows, rowsDuration))
+            {
+                taskList->pushUnfinished(rows);
+                success = false;
+                break;
+            }
 
-        // Gpu is processing from the top level mip map to the bottom.
-        const RadianceFilterParams* params;
-        while ((params = taskList->getFromTop()) != NULL)
-        {
-            // Start timer.
-            const uint64_t startTime = cmft::getHPCounter();
+            uint64_t faceTime;
+            if (taskList->gpuRowsDone(rows, rowsDuration, faceTime))
+            {
+                const uint64_t totalDuration = cmft::getHPCounter() - taskList->state().m_startTime;
 
-            // Run radiance program.
-            const bool result = s_radianceProgram.run(params->m_dstPtr
-                                                    , params->m_face
-                                                    , params->m_mipFaceSize
-                                                    , params->m_specularPower
-                                                    , params->m_specularAngle
-                                                    , params->m_filterSize
-                                                    , params->m_edgeFixup
-                                                    );
-            if (result)
-            {
-                // Determine task duration.
-                const uint64_t currentTime = cmft::getHPCounter();
-                const uint64_t taskDuration = currentTime - startTime;
-                const uint64_t totalDuration = currentTime - s_globalState.m_startTime;
-
-                // Output process info.
+                // Output process info. Face time is the sum over all devices that processed its rows.
                 INFO("Radiance ->  <GPU>  | %4u | %7.3fs | %7.3fs"
-                     , params->m_mipFaceSize
-                     , double(taskDuration)*toSec
+                     , rows.m_params->m_mipFaceSize
+                     , double(faceTime)*toSec
                      , double(totalDuration)*toSec
                     );
 
                 // Update task counter.
-                s_globalState.incrCompletedTasksGpu();
+                taskList->state().incrCompletedTasksGpu();
             }
-            else
+        }
+
+        // Rows that were in flight when the device failed are filtered on cpu.
+        if (!success)
+        {
+            WARN("Radiance -> OpenCL filtering failed, remaining faces are filtered on CPU.");
+            while (program.cancel(rows))
             {
-                taskList->pushUnfinished(params);
-                return EXIT_FAILURE;
+                taskList->pushUnfinished(rows);
             }
         }
 
-        return EXIT_SUCCESS;
+        // Waits for the last upload as well, so its stage time is known.
+        program.releaseDeviceMemory();
+
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Thread pool task. Gpu host is the first task, so it is started before cpu workers.
+    void radianceFilterTask(void* _taskList, uint32_t _index)
+    {
+        const RadianceFilterTaskList* taskList = (const RadianceFilterTaskList*)_taskList;
+        if (0 == _index && taskList->useGpu())
+        {
+            radianceFilterGpu(_taskList);
+        }
+        else
+        {
+            radianceFilterCpu(_taskList);
+        }
     }
 
     static const char* s_lightingModelStr[LightingModel::Count] =
@@ -1787,6 +4485,7 @@ namespace cmft
         "phongbrdf",
         "blinn",
         "blinnbrdf",
+        "ggx",
     };
 
     const char* getLightingModelStr(LightingModel::Enum _lightingModel)
@@ -1795,6 +4494,56 @@ namespace cmft
         return s_lightingModelStr[uint8_t(_lightingModel)];
     }
 
+    static const char* s_tableLayoutStr[TableLayout::Count] =
+    {
+        "interleaved",
+        "planar",
+    };
+
+    const char* getTableLayoutStr(TableLayout::Enum _tableLayout)
+    {
+        DEBUG_CHECK(_tableLayout < TableLayout::Count, "Reading array out of bounds!");
+        return s_tableLayoutStr[uint8_t(_tableLayout)];
+    }
+
+    static const char* s_lobeMathStr[LobeMath::Count] =
+    {
+        "precise",
+        "fast",
+    };
+
+    const char* getLobeMathStr(LobeMath::Enum _lobeMath)
+    {
+        DEBUG_CHECK(_lobeMath < LobeMath::Count, "Reading array out of bounds!");
+        return s_lobeMathStr[uint8_t(_lobeMath)];
+    }
+
+    static const char* s_texelNormalsStr[TexelNormals::Count] =
+    {
+        "auto",
+        "table",
+        "computed",
+    };
+
+    const char* getTexelNormalsStr(TexelNormals::Enum _texelNormals)
+    {
+        DEBUG_CHECK(_texelNormals < TexelNormals::Count, "Reading array out of bounds!");
+        return s_texelNormalsStr[uint8_t(_texelNormals)];
+    }
+
+    static const char* s_accumulationStr[Accumulation::Count] =
+    {
+        "float",
+        "double",
+        "compensated",
+    };
+
+    const char* getAccumulationStr(Accumulation::Enum _accumulation)
+    {
+        DEBUG_CHECK(_accumulation < Accumulation::Count, "Reading array out of bounds!");
+        return s_accumulationStr[uint8_t(_accumulation)];
+    }
+
     /// Returns the angle of cosine power function where the results are above a small empirical treshold.
     static float cosinePowerFilterAngle(float _cosinePower)
     {
@@ -1845,75 +4594,634 @@ namespace cmft
             }
         break;
 
+        case LightingModel::Ggx:
+            {
+                // Exponent of the half vector distribution, see ggxRoughness().
+                return _specularPower;
+            }
+        break;
+
         default:
             {
-                DEBUG_CHECK(false, "ERROR! This should never happen!");
-                return _specularPower;
+                DEBUG_CHECK(false, "ERROR! This should never happen!");
+                return _specularPower;
+            }
+        break;
+        };
+    }
+
+    /// Ggx roughness whose lobe matches Blinn-Phong distribution of the half vector with given exponent.
+    /// Ref: Walter et al., "Microfacet Models for Refraction through Rough Surfaces", EGSR 2007.
+    static inline float ggxRoughness(float _specularPower)
+    {
+        return sqrtf(2.0f/(_specularPower + 2.0f));
+    }
+
+    /// Resizes top level of _src into mip 0 of the destination by averaging source texels.
+    static void radianceFilterCopyBase(void* _dstData, const uint32_t _dstOffsets[CUBE_FACE_NUM][MAX_MIP_NUM], uint32_t _dstFaceSize, const Image& _src)
+    {
+        uint32_t srcFaceOffsets[CUBE_FACE_NUM];
+        imageGetFaceOffsets(srcFaceOffsets, _src);
+
+        const uint32_t bytesPerPixel  = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+        const float    dstToSrcRatiof = cmft::utof(_src.m_width)/cmft::utof(_dstFaceSize);
+        const uint32_t dstToSrcRatio  = CMFT_MAX(UINT32_C(1), cmft::ftou(dstToSrcRatiof));
+        const uint32_t dstFacePitch   = _dstFaceSize * bytesPerPixel;
+        const uint32_t srcBytesPerPixel = getImageDataInfo(_src.m_format).m_bytesPerPixel;
+        const uint32_t srcFacePitch   = _src.m_width * srcBytesPerPixel;
+
+        // For all top level cubemap faces:
+        for(uint8_t face = 0; face < 6; ++face)
+        {
+            const uint8_t* srcFaceData = (const uint8_t*)_src.m_data + srcFaceOffsets[face];
+            uint8_t* dstFaceData = (uint8_t*)_dstData + _dstOffsets[face][0];
+
+            // Iterate through destination pixels.
+            float yDstf = 0.0f;
+            for (uint32_t yDst = 0; yDst < _dstFaceSize; ++yDst, yDstf+=1.0f)
+            {
+                uint8_t* dstFaceRow = (uint8_t*)dstFaceData + yDst*dstFacePitch;
+
+                float xDstf = 0.0f;
+                for (uint32_t xDst = 0; xDst < _dstFaceSize; ++xDst, xDstf+=1.0f)
+                {
+                    float* dstFaceColumn = (float*)((uint8_t*)dstFaceRow + xDst*bytesPerPixel);
+
+                    // For each destination pixel, sample and accumulate color from source.
+                    float color[3] = { 0.0f, 0.0f, 0.0f };
+                    uint32_t weightAccum = 0;
+
+                    for (uint32_t ySrc = cmft::ftou(yDstf*dstToSrcRatiof)
+                        , yEnd = ySrc + dstToSrcRatio
+                        ; ySrc < yEnd ; ++ySrc)
+                    {
+                        const uint8_t* srcRowData = (const uint8_t*)srcFaceData + ySrc*srcFacePitch;
+
+                        for (uint32_t xSrc = cmft::ftou(xDstf*dstToSrcRatiof)
+                            , xEnd = xSrc + dstToSrcRatio
+                            ; xSrc < xEnd ; ++xSrc)
+                        {
+                            float srcColumnData[4];
+                            toRgba32f(srcColumnData, _src.m_format, (const uint8_t*)srcRowData + xSrc*srcBytesPerPixel);
+                            color[0] += srcColumnData[0];
+                            color[1] += srcColumnData[1];
+                            color[2] += srcColumnData[2];
+                            weightAccum++;
+                        }
+                    }
+
+                    // Divide by weight and save to destination pixel.
+                    const float invWeight = 1.0f/cmft::utof(CMFT_MAX(weightAccum, UINT32_C(1)));
+                    dstFaceColumn[0] = color[0] * invWeight;
+                    dstFaceColumn[1] = color[1] * invWeight;
+                    dstFaceColumn[2] = color[2] * invWeight;
+                    dstFaceColumn[3] = 1.0f;
+                }
+            }
+        }
+    }
+
+    /// Relative cost of evaluating one SH coefficient for a texel to reading one source texel in the exhaustive filter.
+    static const double s_radianceShCostRatio = 4.0;
+
+    /// Returns true when mips below _shPowerThreshold are cheaper to reconstruct from SH than to filter texel by texel.
+    /// The exhaustive filter reads the source texels of the lobe cap for each output texel, SH projects every source
+    /// texel once and evaluates every coefficient for each output texel. Projection dominates for a small source or
+    /// small rough mips, so the result depends on the source size as well as on the specular powers.
+    static bool radianceShPaysOff(uint32_t _srcFaceSize
+                                 , uint32_t _dstFaceSize
+                                 , uint8_t _mipStart
+                                 , uint8_t _mipCount
+                                 , float _glossScalef
+                                 , float _glossBiasf
+                                 , LightingModel::Enum _lightingModel
+                                 , float _shPowerThreshold
+                                 )
+    {
+        const double srcTexels = 6.0*double(_srcFaceSize)*double(_srcFaceSize);
+        const float mipCountf = float(int32_t(_mipCount));
+
+        double filterWork = 0.0;
+        double shWork = srcTexels*double(SH_MAX_COEFF_NUM);
+        for (uint32_t mip = _mipStart; mip < _mipCount; ++mip)
+        {
+            const float specularPowerRef = specularPowerFor(float(int32_t(mip)), mipCountf, _glossScalef, _glossBiasf);
+            const float specularPower = applyLightningModel(specularPowerRef, _lightingModel);
+            if (specularPower >= _shPowerThreshold)
+            {
+                continue;
+            }
+
+            const uint32_t mipFaceSize = CMFT_MAX(1, _dstFaceSize >> mip);
+            const double mipTexels = 6.0*double(mipFaceSize)*double(mipFaceSize);
+            const float filterAngle = CMFT_MIN(cosinePowerFilterAngle(specularPower), 0.5f*CMFT_PI);
+            const double capArea = 0.5*(1.0 - double(cosf(filterAngle)));
+
+            filterWork += mipTexels*srcTexels*capArea;
+            shWork += mipTexels*double(SH_MAX_COEFF_NUM);
+        }
+
+        return filterWork > shWork*s_radianceShCostRatio;
+    }
+
+    /// Allocates destination, derives filter parameters of each mip and builds the source pyramid of _src.
+    /// Only the first cubemap of a batch outputs info about its source.
+    static void radianceFilterProbeInit(RadianceFilterProbe& _probe
+                                      , const Image& _src
+                                      , TextureFormat::Enum _srcFormat
+                                      , uint32_t _dstFaceSize
+                                      , LightingModel::Enum _lightingModel
+                                      , bool _excludeBase
+                                      , uint8_t _mipCount
+                                      , uint8_t _glossScale
+                                      , uint8_t _glossBias
+                                      , EdgeFixup::Enum _edgeFixup
+                                      , const RadianceFilterOptions& _options
+                                      , SimdLevel::Enum _simdLevel
+                                      , bool _verbose
+                                      )
+    {
+        const bool ggx = (LightingModel::Ggx == _lightingModel);
+
+        // Must be allocated with crtAllocator. Otherwise, opencl gpu driver will crash.
+        _probe.m_srcImage = ImageSoftRef();
+        imageRefOrConvert(_probe.m_srcImage, _srcFormat, _src, &g_crtAllocator);
+        const ImageSoftRef& srcImage = _probe.m_srcImage;
+
+        // Alloc dst data.
+        const uint32_t dstFaceSize = (0 == _dstFaceSize) ? _src.m_width : _dstFaceSize;
+        const uint8_t mipMin = 1;
+        const uint8_t mipMax = uint8_t(cmft::ftou(cmft::log2f(cmft::utof(dstFaceSize))) + 1);
+        const uint8_t mipCount = CMFT_CLAMP(_mipCount, mipMin, mipMax);
+        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+        uint32_t dstDataSize = 0;
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            for (uint8_t mip = 0; mip < mipCount; ++mip)
+            {
+                _probe.m_dstOffsets[face][mip] = dstDataSize;
+                uint32_t faceSize = CMFT_MAX(1, dstFaceSize >> mip);
+                dstDataSize += faceSize * faceSize * bytesPerPixel;
+            }
+        }
+        _probe.m_dstFaceSize = dstFaceSize;
+        _probe.m_mipCount    = mipCount;
+        _probe.m_dstDataSize = dstDataSize;
+        _probe.m_dstData     = CMFT_ALLOC(&g_crtAllocator, dstDataSize);
+        MALLOC_CHECK(_probe.m_dstData);
+
+        _probe.m_srcLevelCount = 0;
+        _probe.m_ggxSampleData = NULL;
+        for (uint8_t level = 0; level < MAX_MIP_NUM; ++level)
+        {
+            _probe.m_srcLevelImage[level] = Image();
+        }
+
+        // Resize and copy base image.
+        if (_excludeBase)
+        {
+            if (_verbose)
+            {
+                INFO("Radiance -> Excluding base image.");
+            }
+
+            radianceFilterCopyBase(_probe.m_dstData, _probe.m_dstOffsets, dstFaceSize, srcImage);
+        }
+
+        const uint8_t mipStart = uint8_t(_excludeBase);
+        if (mipCount <= mipStart)
+        {
+            return;
+        }
+
+        const float mipCountf   = float(int32_t(mipCount));
+        const float glossScalef = float(int32_t(_glossScale));
+        const float glossBiasf  = float(int32_t(_glossBias));
+
+        const bool shPaysOff = !ggx
+                            && 0.0f < _options.m_shPowerThreshold
+                            && radianceShPaysOff(srcImage.m_width, dstFaceSize, mipStart, mipCount, glossScalef, glossBiasf, _lightingModel, _options.m_shPowerThreshold)
+                            ;
+        if (_verbose && !ggx && 0.0f < _options.m_shPowerThreshold && !shPaysOff)
+        {
+            INFO("Radiance -> SH reconstruction does not pay off for %ux%u source, every mip is filtered texel by texel.", srcImage.m_width, srcImage.m_width);
+        }
+
+        // Determine filter parameters.
+        RadianceMipFilter* mipFilter = _probe.m_mipFilter;
+        uint8_t srcLevelCount = 1;
+        for (uint32_t mip = mipStart; mip < mipCount; ++mip)
+        {
+            const uint32_t mipFaceSize = CMFT_MAX(1, dstFaceSize >> mip);
+            const float mipFaceSizef = float(int32_t(mipFaceSize));
+            const float minAngle = atan2f(1.0f, mipFaceSizef);
+            const float maxAngle = (0.5f*CMFT_PI);
+            const float toFilterSize = 1.0f/(minAngle*mipFaceSizef*2.0f);
+            const float specularPowerRef = specularPowerFor(float(int32_t(mip)), mipCountf, glossScalef, glossBiasf);
+            const float specularPower = applyLightningModel(specularPowerRef, _lightingModel);
+            const float filterAngle = CMFT_CLAMP(cosinePowerFilterAngle(specularPower), minAngle, maxAngle);
+            const float cosAngle = CMFT_MAX(0.0f, cosf(filterAngle));
+            const float texelSize = 1.0f/mipFaceSizef;
+            const float filterSize = CMFT_MAX(texelSize, filterAngle * toFilterSize);
+
+            const bool sh = shPaysOff && specularPower < _options.m_shPowerThreshold;
+
+            // Pick the coarsest source level that is still fine enough for the lobe and not smaller than the destination.
+            uint8_t srcLevel = 0;
+            if (0.0f < _options.m_sourceMipThreshold && !ggx && !sh)
+            {
+                const float maxTexelAngle = _options.m_sourceMipThreshold*filterAngle;
+                for (;;)
+                {
+                    const uint32_t levelFaceSize = srcImage.m_width >> (srcLevel+1);
+                    if (levelFaceSize < CMFT_MAX(mipFaceSize, UINT32_C(1))
+                    ||  atan2f(1.0f, float(int32_t(levelFaceSize))) > maxTexelAngle)
+                    {
+                        break;
+                    }
+                    ++srcLevel;
+                }
+            }
+
+            mipFilter[mip].m_faceSize      = mipFaceSize;
+            mipFilter[mip].m_filterSize    = filterSize;
+            mipFilter[mip].m_specularPower = specularPower;
+            mipFilter[mip].m_cosAngle      = cosAngle;
+            mipFilter[mip].m_roughness     = ggxRoughness(specularPower);
+            mipFilter[mip].m_srcLevel      = srcLevel;
+            mipFilter[mip].m_sh            = sh;
+
+            srcLevelCount = CMFT_MAX(srcLevelCount, uint8_t(srcLevel+1));
+        }
+
+        // Ggx samples are read from the whole source pyramid, down to 1x1 faces.
+        if (ggx)
+        {
+            srcLevelCount = uint8_t(CMFT_MIN(cmft::ftou(cmft::log2f(cmft::utof(srcImage.m_width))) + 1, uint32_t(MAX_MIP_NUM)));
+        }
+
+        // Build source pyramid and cubemap vectors for each level.
+        RadianceFilterSource* source = _probe.m_source;
+        Image* srcLevelImage = _probe.m_srcLevelImage;
+        _probe.m_srcLevelCount = srcLevelCount;
+        if (ggx)
+        {
+            radianceFilterSourceInitImage(source[0], srcImage);
+            for (uint8_t level = 1; level < srcLevelCount; ++level)
+            {
+                imageCubemapDownsample(srcLevelImage[level], *source[level-1].m_image, &g_crtAllocator);
+                radianceFilterSourceInitImage(source[level], srcLevelImage[level]);
+            }
+        }
+        else
+        {
+            radianceFilterSourceInit(source[0], srcImage, _edgeFixup, _options, _simdLevel);
+            for (uint8_t level = 1; level < srcLevelCount; ++level)
+            {
+                imageCubemapDownsample(srcLevelImage[level], *source[level-1].m_image, &g_crtAllocator);
+                radianceFilterSourceInit(source[level], srcLevelImage[level], _edgeFixup, _options, _simdLevel);
+            }
+
+            if (_verbose)
+            {
+                INFO("Radiance -> Using %s texel normals for %ux%u source.", getTexelNormalsStr(source[0].m_texelNormals), srcImage.m_width, srcImage.m_width);
+
+                if (TextureFormat::RGBA32F != _srcFormat)
+                {
+                    INFO("Radiance -> Reading %s source without conversion.", getTextureFormatStr(_srcFormat));
+                }
+            }
+        }
+
+        // Importance samples of each mip.
+        if (ggx)
+        {
+            const uint32_t numGgxSamples = CMFT_MAX(UINT32_C(1), uint32_t(_options.m_ggxSamples));
+            _probe.m_ggxSampleData = (GgxSample*)CMFT_ALLOC(&g_crtAllocator, mipCount*numGgxSamples*sizeof(GgxSample));
+            MALLOC_CHECK(_probe.m_ggxSampleData);
+
+            for (uint32_t mip = mipStart; mip < mipCount; ++mip)
+            {
+                GgxSample* samples = &_probe.m_ggxSampleData[mip*numGgxSamples];
+                _probe.m_ggxSamples[mip].m_samples    = samples;
+                _probe.m_ggxSamples[mip].m_numSamples = buildGgxSamples(samples, numGgxSamples, mipFilter[mip].m_roughness, srcImage.m_width, srcLevelCount);
+            }
+
+            if (_verbose)
+            {
+                INFO("Radiance -> Using %u Ggx samples per texel and %u source levels.", numGgxSamples, srcLevelCount);
+            }
+        }
+    }
+
+    /// Frees source pyramid and tables, destination is kept.
+    static void radianceFilterProbeFreeSource(RadianceFilterProbe& _probe)
+    {
+        for (uint8_t level = 0; level < _probe.m_srcLevelCount; ++level)
+        {
+            radianceFilterSourceFree(_probe.m_source[level]);
+            imageUnload(_probe.m_srcLevelImage[level], &g_crtAllocator);
+        }
+        _probe.m_srcLevelCount = 0;
+
+        if (NULL != _probe.m_ggxSampleData)
+        {
+            CMFT_FREE(&g_crtAllocator, _probe.m_ggxSampleData);
+            _probe.m_ggxSampleData = NULL;
+        }
+
+        imageUnload(_probe.m_srcImage, &g_crtAllocator);
+    }
+
+    /// Averages 1x1 faces of the last mip.
+    static void radianceFilterProbeAverageLastMip(RadianceFilterProbe& _probe)
+    {
+        const uint8_t lastMip = uint8_t(_probe.m_mipCount-1);
+        if ((_probe.m_dstFaceSize>>lastMip) > 1)
+        {
+            return;
+        }
+
+        float* face0 = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[0][lastMip]);
+        float* face1 = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[1][lastMip]);
+        float* face2 = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[2][lastMip]);
+        float* face3 = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[3][lastMip]);
+        float* face4 = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[4][lastMip]);
+        float* face5 = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[5][lastMip]);
+
+        const float color[3] =
+        {
+            (face0[0] + face1[0] + face2[0] + face3[0] + face4[0] + face5[0]) / 6.0f,
+            (face0[1] + face1[1] + face2[1] + face3[1] + face4[1] + face5[1]) / 6.0f,
+            (face0[2] + face1[2] + face2[2] + face3[2] + face4[2] + face5[2]) / 6.0f,
+        };
+
+        face0[0] = face1[0] = face2[0] = face3[0] = face4[0] = face5[0] = color[0];
+        face0[1] = face1[1] = face2[1] = face3[1] = face4[1] = face5[1] = color[1];
+        face0[2] = face1[2] = face2[2] = face3[2] = face4[2] = face5[2] = color[2];
+    }
+
+    /// Zonal coefficients of lobe dot^_specularPower cut at _cosAngle, normalized to unit integral over the sphere.
+    /// By Funk-Hecke, filtering with the lobe scales SH coefficients of band l by _lambda[l].
+    static void radianceLobeZonalCoeffs(double _lambda[SH_MAX_BAND+1], float _specularPower, float _cosAngle)
+    {
+        enum { NumSteps = 4096 };
+
+        const double cosAngle = double(_cosAngle);
+        const double step = (1.0 - cosAngle)/double(NumSteps);
+
+        double sum[SH_MAX_BAND+1];
+        memset(sum, 0, sizeof(sum));
+
+        // Midpoint rule, Legendre polynomials by recurrence.
+        for (uint32_t ii = 0; ii < NumSteps; ++ii)
+        {
+            const double tt = cosAngle + (double(ii)+0.5)*step;
+            const double lobe = pow(tt, double(_specularPower));
+
+            double p0 = 1.0;
+            double p1 = tt;
+            sum[0] += lobe;
+            sum[1] += lobe*p1;
+            for (uint8_t band = 2; band <= SH_MAX_BAND; ++band)
+            {
+                const double p2 = (double(2*band-1)*tt*p1 - double(band-1)*p0)/double(band);
+                sum[band] += lobe*p2;
+                p0 = p1;
+                p1 = p2;
+            }
+        }
+
+        for (uint8_t band = 0; band <= SH_MAX_BAND; ++band)
+        {
+            _lambda[band] = sum[band]/sum[0];
+        }
+    }
+
+    struct RadianceShTask
+    {
+        float m_shRgb[SH_MAX_COEFF_NUM][3]; // Source coefficients scaled by zonal coefficients of the lobe.
+        const float* m_cubemapVectors;
+        float* m_dstFace[6];
+        uint32_t m_faceSize;
+        uint32_t m_bandRows;
+        uint32_t m_bandsPerFace;
+    };
+
+    static void radianceShTask(void* _userData, uint32_t _bandIdx)
+    {
+        const RadianceShTask& task = *(const RadianceShTask*)_userData;
+
+        const uint8_t face = uint8_t(_bandIdx / task.m_bandsPerFace);
+        const uint32_t beginY = (_bandIdx % task.m_bandsPerFace) * task.m_bandRows;
+        const uint32_t endY = CMFT_MIN(beginY + task.m_bandRows, task.m_faceSize);
+        const uint32_t faceTexels = task.m_faceSize*task.m_faceSize;
+        const uint32_t begin = beginY * task.m_faceSize;
+        const uint32_t end = endY * task.m_faceSize;
+
+        const float* vecFace = task.m_cubemapVectors + uint32_t(face)*faceTexels*4;
+
+        float xx[ShBlockSize];
+        float yy[ShBlockSize];
+        float zz[ShBlockSize];
+        float rgb[3][ShBlockSize];
+        float shBasis[SH_MAX_COEFF_NUM][ShBlockSize];
+
+        for (uint32_t blockBegin = begin; blockBegin < end; blockBegin += ShBlockSize)
+        {
+            const uint32_t blockSize = CMFT_MIN(end - blockBegin, uint32_t(ShBlockSize));
+
+            const float* vecPtr = vecFace + blockBegin*4;
+            uint32_t ii = 0;
+            for (; ii < blockSize; ++ii, vecPtr+=4)
+            {
+                xx[ii] = vecPtr[0];
+                yy[ii] = vecPtr[1];
+                zz[ii] = vecPtr[2];
+            }
+            for (; ii < ShBlockSize; ++ii)
+            {
+                xx[ii] = 0.0f;
+                yy[ii] = 0.0f;
+                zz[ii] = 0.0f;
+            }
+
+            evalShBasisBlock(shBasis, SH_MAX_BAND, xx, yy, zz);
+
+            memset(rgb, 0, sizeof(rgb));
+            for (uint32_t coeff = 0; coeff < SH_MAX_COEFF_NUM; ++coeff)
+            {
+                const float rr = task.m_shRgb[coeff][0];
+                const float gg = task.m_shRgb[coeff][1];
+                const float bb = task.m_shRgb[coeff][2];
+                for (uint32_t jj = 0; jj < blockSize; ++jj)
+                {
+                    rgb[0][jj] += shBasis[coeff][jj]*rr;
+                    rgb[1][jj] += shBasis[coeff][jj]*gg;
+                    rgb[2][jj] += shBasis[coeff][jj]*bb;
+                }
+            }
+
+            float* dstPtr = task.m_dstFace[face] + blockBegin*4;
+            for (uint32_t jj = 0; jj < blockSize; ++jj, dstPtr+=4)
+            {
+                dstPtr[0] = rgb[0][jj];
+                dstPtr[1] = rgb[1][jj];
+                dstPtr[2] = rgb[2][jj];
+                dstPtr[3] = 1.0f;
+            }
+        }
+    }
+
+    /// Reconstructs mips of _probe flagged with RadianceMipFilter::m_sh from a single SH projection of its source.
+    static void radianceFilterProbeSh(RadianceFilterProbe& _probe, uint8_t _mipStart, EdgeFixup::Enum _edgeFixup)
+    {
+        ImageSoftRef imageRgba32f;
+        imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _probe.m_srcImage, &g_crtAllocator);
+
+        uint32_t faceOffsets[6];
+        imageGetFaceOffsets(faceOffsets, imageRgba32f);
+
+        double shRgb[SH_MAX_COEFF_NUM][3];
+        cubemapShCoeffs(shRgb, SH_MAX_BAND, imageRgba32f.m_data, imageRgba32f.m_width, faceOffsets, &g_crtAllocator);
+
+        imageUnload(imageRgba32f, &g_crtAllocator);
+
+        for (uint32_t mip = _mipStart; mip < _probe.m_mipCount; ++mip)
+        {
+            const RadianceMipFilter& filter = _probe.m_mipFilter[mip];
+            if (!filter.m_sh)
+            {
+                continue;
+            }
+
+            double lambda[SH_MAX_BAND+1];
+            radianceLobeZonalCoeffs(lambda, filter.m_specularPower, filter.m_cosAngle);
+
+            RadianceShTask task;
+            for (uint32_t coeff = 0; coeff < SH_MAX_COEFF_NUM; ++coeff)
+            {
+                const double factor = lambda[uint8_t(sqrt(double(coeff)))];
+                task.m_shRgb[coeff][0] = float(shRgb[coeff][0]*factor);
+                task.m_shRgb[coeff][1] = float(shRgb[coeff][1]*factor);
+                task.m_shRgb[coeff][2] = float(shRgb[coeff][2]*factor);
+            }
+            for (uint8_t face = 0; face < 6; ++face)
+            {
+                task.m_dstFace[face] = (float*)((uint8_t*)_probe.m_dstData + _probe.m_dstOffsets[face][mip]);
             }
-        break;
-        };
+            task.m_cubemapVectors = cubemapTableAcquire(CubemapTable::NormalSolidAngle, filter.m_faceSize, _edgeFixup);
+            task.m_faceSize       = filter.m_faceSize;
+            task.m_bandRows       = CMFT_MAX(uint32_t(IrradianceBandTexels)/filter.m_faceSize, UINT32_C(1));
+            task.m_bandsPerFace   = (filter.m_faceSize + task.m_bandRows - 1) / task.m_bandRows;
+
+            threadPoolRun(radianceShTask, (void*)&task, task.m_bandsPerFace*6);
+
+            cubemapTableRelease(task.m_cubemapVectors);
+        }
     }
 
-    bool imageRadianceFilter(Image& _dst
-                           , uint32_t _dstFaceSize
-                           , LightingModel::Enum _lightingModel
-                           , bool _excludeBase
-                           , uint8_t _mipCount
-                           , uint8_t _glossScale
-                           , uint8_t _glossBias
-                           , const Image& _src
-                           , EdgeFixup::Enum _edgeFixup
-                           , uint8_t _numCpuProcessingThreads
-                           , ClContext* _clContext
-                           , AllocatorI* _allocator
-                           )
+    bool imageRadianceFilterBatch(RadianceFilterContext* _context
+                                , Image* _dst
+                                , const Image* _src
+                                , uint32_t _count
+                                , uint32_t _dstFaceSize
+                                , LightingModel::Enum _lightingModel
+                                , bool _excludeBase
+                                , uint8_t _mipCount
+                                , uint8_t _glossScale
+                                , uint8_t _glossBias
+                                , EdgeFixup::Enum _edgeFixup
+                                , uint8_t _numCpuProcessingThreads
+                                , ClContext* _clContext
+                                , AllocatorI* _allocator
+                                , const RadianceFilterOptions* _options
+                                )
     {
-        // Input image must be a cubemap.
-        if (!imageIsCubemap(_src))
+        RadianceFilterState& state = _context->m_state;
+        RadianceProgram& program = _context->m_program;
+        memset(&_context->m_stats, 0, sizeof(_context->m_stats));
+
+        RadianceFilterOptions options;
+        if (NULL != _options)
+        {
+            options = *_options;
+        }
+
+        if (options.m_shPowerThreshold > s_radianceShMaxPower)
         {
-            WARN("Image is not cubemap.");
+            WARN("Radiance -> shPowerThreshold %.3f is above %.3f, where SH reconstruction error stays below 1%%, clamping."
+                , options.m_shPowerThreshold
+                , s_radianceShMaxPower
+                );
+            options.m_shPowerThreshold = s_radianceShMaxPower;
+        }
 
-            return false;
+        const bool planar = (TableLayout::Planar == options.m_tableLayout);
+        const bool ggx = (LightingModel::Ggx == _lightingModel);
+
+        if (0 == _count)
+        {
+            return true;
+        }
+
+        // Input images must be cubemaps.
+        for (uint32_t ii = 0; ii < _count; ++ii)
+        {
+            if (!imageIsCubemap(_src[ii]))
+            {
+                WARN("Image is not cubemap.");
+
+                return false;
+            }
         }
 
         // Multi-threading parameters.
-        std::thread cpuThreads[64];
-        uint32_t activeCpuThreads = 0;
         const uint32_t maxActiveCpuThreads = (uint32_t)CMFT_CLAMP(_numCpuProcessingThreads, 0, 64);
 
-        // Prepare OpenCL kernel and device memory.
-
-        s_radianceProgram.setDeviceContext(_clContext);
-        if (s_radianceProgram.hasValidDeviceContext())
+        // Prepare OpenCL kernel, device memory is filled with the source of each cubemap when gpu starts filtering it.
+        program.setDeviceContext(_clContext);
+        if (program.hasValidDeviceContext() && ggx)
         {
+            INFO("Radiance -> Ggx lighting model is filtered on CPU only.");
+        }
+        else if (program.hasValidDeviceContext())
+        {
+            const bool half = radianceFilterDeviceHalf(options.m_deviceFormat, _clContext, _src, _count, _dstFaceSize);
+            program.setHalfFloat(half);
+            if (half)
+            {
+                INFO("Radiance -> OpenCL device filters half float images.");
+            }
+
+            char header[256];
+            #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
+                strcpy(header, "#define CMFT_COMPUTE_FILTER_AREA_ON_CPU 1\n");
+            #else
+                strcpy(header, "#define CMFT_COMPUTE_FILTER_AREA_ON_CPU 0\n");
+            #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
+
             if (EdgeFixup::Warp == _edgeFixup)
             {
-                #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                    const char header[] = "#define CMFT_COMPUTE_FILTER_AREA_ON_CPU 1\n"
-                                          "#define WARP_FIXUP\n";
-                #else
-                    const char header[] = "#define CMFT_COMPUTE_FILTER_AREA_ON_CPU 0\n"
-                                          "#define WARP_FIXUP\n";
-                #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
+                strcat(header, "#define WARP_FIXUP\n");
+            }
 
-                s_radianceProgram.createFromStr((const char*)sc_radianceSource, sizeof(sc_radianceSource), header, sizeof(header));
-                //s_radianceProgram.createFromFile("radiance.cl", header, sizeof(header));
+            if (half)
+            {
+                strcat(header, "#define CMFT_COMPUTED_NORMALS\n");
             }
-            else
+            else if (planar)
             {
-                #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
-                    const char header[] = "#define CMFT_COMPUTE_FILTER_AREA_ON_CPU 1\n";
-                #else
-                    const char header[] = "#define CMFT_COMPUTE_FILTER_AREA_ON_CPU 0\n";
-                #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
-
-                s_radianceProgram.createFromStr((const char*)sc_radianceSource, sizeof(sc_radianceSource), header, sizeof(header));
-                //s_radianceProgram.createFromFile("radiance.cl", header, sizeof(header));
+                strcat(header, "#define CMFT_PLANAR_LAYOUT\n");
             }
+
+            program.createFromStr((const char*)sc_radianceSource, sizeof(sc_radianceSource), header, strlen(header)+1);
+            program.resetStageTimes();
+            //program.createFromFile("radiance.cl", header, strlen(header)+1);
         }
 
         // Check at least some processig device is valid and choosen for filtering.
-        if (0 == maxActiveCpuThreads && !s_radianceProgram.isValid())
+        if (0 == maxActiveCpuThreads && !program.isValid())
         {
             WARN("No hardware devices selected for processing."
                 " OpenCL context is invalid and 0 CPU processing theads are choosen for filtering."
@@ -1935,43 +5243,8 @@ namespace cmft
                  );
         }
 
-        // Processing is done in Rgba32f format.
-        ImageSoftRef imageRgba32f;
-        if (_allocator != &g_crtAllocator)
-        {
-            // Must be allocated with crtAllocator. Otherwise, opencl gpu driver will crash.
-            Image imageCrtMemory;
-            imageCopy(imageCrtMemory, _src, &g_crtAllocator);
-            imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _src, &g_crtAllocator);
-        }
-        else
-        {
-            imageRefOrConvert(imageRgba32f, TextureFormat::RGBA32F, _src, _allocator);
-        }
-
-        // Alloc dst data.
-        const uint32_t dstFaceSize = (0 == _dstFaceSize) ? _src.m_width : _dstFaceSize;
-        const uint8_t mipMin = 1;
-        const uint8_t mipMax = uint8_t(cmft::ftou(cmft::log2f(cmft::utof(dstFaceSize))) + 1);
-        const uint8_t mipCount = CMFT_CLAMP(_mipCount, mipMin, mipMax);
-        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
-        uint32_t dstOffsets[CUBE_FACE_NUM][MAX_MIP_NUM];
-        uint32_t dstDataSize = 0;
-        for (uint8_t face = 0; face < 6; ++face)
-        {
-            for (uint8_t mip = 0; mip < mipCount; ++mip)
-            {
-                dstOffsets[face][mip] = dstDataSize;
-                uint32_t faceSize = CMFT_MAX(1, dstFaceSize >> mip);
-                dstDataSize += faceSize * faceSize * bytesPerPixel;
-            }
-        }
-        void* dstData = CMFT_ALLOC(&g_crtAllocator, dstDataSize);
-        MALLOC_CHECK(dstData);
-
-        // Get source image offsets.
-        uint32_t srcFaceOffsets[CUBE_FACE_NUM];
-        imageGetFaceOffsets(srcFaceOffsets, imageRgba32f);
+        // Pick the widest cpu kernel supported by the host.
+        const SimdLevel::Enum simdLevel = simdLevelDetect();
 
         // Output info.
         INFO("Running radiance filter for:"
@@ -1982,273 +5255,439 @@ namespace cmft
              "\n\t[glossScale=%u]"
              "\n\t[glossBias=%u]"
              "\n\t[dstFaceSize=%u]"
-             , imageRgba32f.m_width
+             "\n\t[cpuKernel=%s]"
+             "\n\t[tableLayout=%s]"
+             "\n\t[sourceMipThreshold=%.3f]"
+             "\n\t[tileCulling=%s]"
+             "\n\t[lobeMath=%s]"
+             "\n\t[texelNormals=%s]"
+             "\n\t[accumulation=%s]"
+             "\n\t[ggxSamples=%u]"
+             "\n\t[shPowerThreshold=%.3f]"
+             "\n\t[cubemaps=%u]"
+             , _src[0].m_width
              , getLightingModelStr(_lightingModel)
              , &"false\0true"[6*_excludeBase]
-             , mipCount
+             , _mipCount
              , _glossScale
              , _glossBias
-             , dstFaceSize
+             , (0 == _dstFaceSize) ? _src[0].m_width : _dstFaceSize
+             , getSimdLevelStr(simdLevel)
+             , getTableLayoutStr(options.m_tableLayout)
+             , options.m_sourceMipThreshold
+             , &"false\0true"[6*options.m_tileCulling]
+             , getLobeMathStr(options.m_lobeMath)
+             , getTexelNormalsStr(options.m_texelNormals)
+             , getAccumulationStr(options.m_accumulation)
+             , options.m_ggxSamples
+             , options.m_shPowerThreshold
+             , _count
              );
 
-        // Resize and copy base image.
-        if (_excludeBase)
+        // Start global timer.
+        state.reset();
+        state.m_startTime = cmft::getHPCounter();
+
+        // Processing is done in Rgba32f format, except that cpu kernels read RGBA16F and RGBE sources as they are
+        // and decode them in registers instead of reading a 2-4x larger Rgba32f copy. Ggx samples Rgba32f only.
+        RadianceFilterProbe* probes = _context->reserveProbes(_count);
+        const uint8_t mipStart = uint8_t(_excludeBase);
+        uint32_t numFaces = 0;
+        uint32_t numShFaces = 0;
+        for (uint32_t ii = 0; ii < _count; ++ii)
         {
-            INFO("Radiance -> Excluding base image.");
-
-            const float    dstToSrcRatiof = cmft::utof(imageRgba32f.m_width)/cmft::utof(dstFaceSize);
-            const uint32_t dstToSrcRatio  = CMFT_MAX(UINT32_C(1), cmft::ftou(dstToSrcRatiof));
-            const uint32_t dstFacePitch   = dstFaceSize * bytesPerPixel;
-            const uint32_t srcFacePitch   = imageRgba32f.m_width * bytesPerPixel;
+            const bool compactSource = !ggx
+                                    && (TextureFormat::RGBA16F == _src[ii].m_format || TextureFormat::RGBE == _src[ii].m_format)
+                                    ;
+            const TextureFormat::Enum srcFormat = compactSource ? _src[ii].m_format : TextureFormat::RGBA32F;
 
-            // For all top level cubemap faces:
-            for(uint8_t face = 0; face < 6; ++face)
+            radianceFilterProbeInit(probes[ii], _src[ii], srcFormat, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _edgeFixup, options, simdLevel, 0 == ii);
+            for (uint32_t mip = mipStart; mip < probes[ii].m_mipCount; ++mip)
             {
-                const uint8_t* srcFaceData = (const uint8_t*)imageRgba32f.m_data + srcFaceOffsets[face];
-                uint8_t* dstFaceData = (uint8_t*)dstData + dstOffsets[face][0];
-
-                // Iterate through destination pixels.
-                float yDstf = 0.0f;
-                for (uint32_t yDst = 0; yDst < dstFaceSize; ++yDst, yDstf+=1.0f)
+                if (probes[ii].m_mipFilter[mip].m_sh)
                 {
-                    uint8_t* dstFaceRow = (uint8_t*)dstFaceData + yDst*dstFacePitch;
-
-                    float xDstf = 0.0f;
-                    for (uint32_t xDst = 0; xDst < dstFaceSize; ++xDst, xDstf+=1.0f)
-                    {
-                        float* dstFaceColumn = (float*)((uint8_t*)dstFaceRow + xDst*bytesPerPixel);
+                    numShFaces += 6;
+                }
+                else
+                {
+                    numFaces += 6;
+                }
+            }
+        }
 
-                        // For each destination pixel, sample and accumulate color from source.
-                        float color[3] = { 0.0f, 0.0f, 0.0f };
-                        uint32_t weightAccum = 0;
+        // Cpu filters cubemaps of equal source size and format in groups, filter area and spans of each texel are
+        // found once for the whole group. Gpu and Ggx filter one cubemap at a time. Cubemaps of a group are
+        // contiguous in order and groupSize is set at the position of the first one.
+        const bool groupProbes = !ggx && !program.isValid();
+        uint32_t* order = (uint32_t*)CMFT_ALLOC(&g_crtAllocator, _count*sizeof(uint32_t));
+        uint8_t* groupSize = (uint8_t*)CMFT_ALLOC(&g_crtAllocator, _count*sizeof(uint8_t));
+        uint8_t* grouped = (uint8_t*)CMFT_ALLOC(&g_crtAllocator, _count*sizeof(uint8_t));
+        MALLOC_CHECK(order);
+        MALLOC_CHECK(groupSize);
+        MALLOC_CHECK(grouped);
+        memset(groupSize, 0, _count*sizeof(uint8_t));
+        memset(grouped, 0, _count*sizeof(uint8_t));
+
+        uint32_t numGroups = 0;
+        for (uint32_t ii = 0, pos = 0; ii < _count; ++ii)
+        {
+            if (grouped[ii])
+            {
+                continue;
+            }
 
-                        for (uint32_t ySrc = cmft::ftou(yDstf*dstToSrcRatiof)
-                            , yEnd = ySrc + dstToSrcRatio
-                            ; ySrc < yEnd ; ++ySrc)
-                        {
-                            const uint8_t* srcRowData = (const uint8_t*)srcFaceData + ySrc*srcFacePitch;
-
-                            for (uint32_t xSrc = cmft::ftou(xDstf*dstToSrcRatiof)
-                                , xEnd = xSrc + dstToSrcRatio
-                                ; xSrc < xEnd ; ++xSrc)
-                            {
-                                const float* srcColumnData = (const float*)((const uint8_t*)srcRowData + xSrc*bytesPerPixel);
-                                color[0] += srcColumnData[0];
-                                color[1] += srcColumnData[1];
-                                color[2] += srcColumnData[2];
-                                weightAccum++;
-                            }
-                        }
+            const uint32_t first = pos;
+            order[pos++] = ii;
+            grouped[ii] = 1;
 
-                        // Divide by weight and save to destination pixel.
-                        const float invWeight = 1.0f/cmft::utof(CMFT_MAX(weightAccum, UINT32_C(1)));
-                        dstFaceColumn[0] = color[0] * invWeight;
-                        dstFaceColumn[1] = color[1] * invWeight;
-                        dstFaceColumn[2] = color[2] * invWeight;
-                        dstFaceColumn[3] = 1.0f;
-                    }
+            for (uint32_t jj = ii+1; groupProbes && jj < _count && pos-first < RADIANCE_KERNEL_MAX_GROUP; ++jj)
+            {
+                if (!grouped[jj]
+                &&  probes[jj].m_srcImage.m_width  == probes[ii].m_srcImage.m_width
+                &&  probes[jj].m_srcImage.m_format == probes[ii].m_srcImage.m_format)
+                {
+                    order[pos++] = jj;
+                    grouped[jj] = 1;
                 }
             }
+
+            groupSize[first] = uint8_t(pos-first);
+            numGroups++;
+        }
+
+        // Each face of the first cubemap of a group is a task, faces of the others are its siblings.
+        uint32_t numTasks = 0;
+        for (uint32_t pos = 0; pos < _count; pos += groupSize[pos])
+        {
+            const RadianceFilterProbe& probe = probes[order[pos]];
+            for (uint32_t mip = mipStart; mip < probe.m_mipCount; ++mip)
+            {
+                numTasks += probe.m_mipFilter[mip].m_sh ? 0 : 6;
+            }
         }
 
-        if (mipCount - uint8_t(_excludeBase) <= 0)
+        if (numGroups < _count)
         {
-            INFO("Radiance -> Nothing left for processing... Increase mip count or do not exclude base image.");
+            INFO("Radiance -> Filtering %u cubemaps in %u groups of equal source size and format.", _count, numGroups);
         }
-        else
+
+        bool success = true;
+        if (0 == numTasks && 0 == numShFaces)
         {
-            // Build cubemap vectors.
-            float* cubemapVectors = buildCubemapNormalSolidAngle(imageRgba32f.m_width, _edgeFixup, &g_crtAllocator);
+            INFO("Radiance -> Nothing left for processing... Increase mip count or do not exclude base image.");
+        }
 
-            // Enqueue memory transfer for cl device.
-            if (s_radianceProgram.isValid())
+        // Mips below the SH power threshold are cheap, they are reconstructed before the filter starts.
+        if (0 != numShFaces)
+        {
+            for (uint32_t mip = mipStart; mip < probes[0].m_mipCount; ++mip)
             {
-                const bool success = s_radianceProgram.initDeviceMemory(imageRgba32f, cubemapVectors);
-                if (!success)
+                if (probes[0].m_mipFilter[mip].m_sh)
                 {
-                    s_radianceProgram.invalidate();
+                    INFO("Radiance -> Mip %u (specular power %.2f) is reconstructed from SH.", mip, probes[0].m_mipFilter[mip].m_specularPower);
                 }
             }
 
-            // Start global timer.
-            s_globalState.reset();
-            s_globalState.m_startTime = cmft::getHPCounter();
-            s_globalState.m_totalTasks = mipCount*6;
+            const uint64_t shTime = cmft::getHPCounter();
+            for (uint32_t ii = 0; ii < _count; ++ii)
+            {
+                radianceFilterProbeSh(probes[ii], mipStart, _edgeFixup);
+            }
+
+            INFO("Radiance -> %u faces reconstructed from SH in %.3f seconds.", numShFaces, double(cmft::getHPCounter() - shTime)/double(cmft::getHPFrequency()));
+        }
+
+        if (0 != numTasks)
+        {
+            state.m_totalTasks = numFaces;
             INFO("Radiance -> Starting filter...");
 
+            // Cpu workers run on the shared thread pool and the calling thread, one of which hosts the gpu.
+            // One worker slot is kept free for the cpu pass that finishes tasks left over by a failed gpu.
+            const bool useGpu = program.isValid() && program.isIdle();
+            const uint32_t numPoolThreads = uint32_t(threadPoolNumWorkers()) + 1;
+            const uint32_t numCpuThreads  = CMFT_MIN(CMFT_MIN(maxActiveCpuThreads, uint32_t(RadianceFilterTaskList::MaxWorkers) - 1)
+                                                   , CMFT_MAX(numPoolThreads - uint32_t(useGpu), 1u)
+                                                   );
+
             INFO("Radiance -> Utilizing %u CPU processing thread%s%s%s."
-                , maxActiveCpuThreads
-                , maxActiveCpuThreads==1?"":"s"
-                , !s_radianceProgram.isValid()?"":" and "
-                , !s_radianceProgram.isValid()?"":s_radianceProgram.m_clContext->m_deviceName
+                , numCpuThreads
+                , numCpuThreads==1?"":"s"
+                , !program.isValid()?"":" and "
+                , !program.isValid()?"":program.m_clContext->m_deviceName
                 );
 
             // Alloc data for tasks parameters.
-            const uint8_t mipStart = uint8_t(_excludeBase);
-            RadianceFilterTaskList taskList(mipStart, mipCount);
-
-            const float mipCountf   = float(int32_t(mipCount));
-            const float glossScalef = float(int32_t(_glossScale));
-            const float glossBiasf  = float(int32_t(_glossBias));
+            RadianceFilterTaskList taskList(state, program, numTasks);
+            RadianceFilterSibling* siblings = (RadianceFilterSibling*)CMFT_ALLOC(&g_crtAllocator, CMFT_MAX(numFaces-numTasks, 1u)*sizeof(RadianceFilterSibling));
+            MALLOC_CHECK(siblings);
 
             //Prepare processing tasks parameters.
-            for (uint32_t mip = mipStart; mip < mipCount; ++mip)
+            uint32_t task = 0;
+            uint32_t numSiblings = 0;
+            for (uint32_t pos = 0; pos < _count; pos += groupSize[pos])
             {
-                // Determine filter parameters.
-                const uint32_t mipFaceSize = CMFT_MAX(1, dstFaceSize >> mip);
-                const float mipFaceSizef = float(int32_t(mipFaceSize));
-                const float minAngle = atan2f(1.0f, mipFaceSizef);
-                const float maxAngle = (0.5f*CMFT_PI);
-                const float toFilterSize = 1.0f/(minAngle*mipFaceSizef*2.0f);
-                const float specularPowerRef = specularPowerFor(float(int32_t(mip)), mipCountf, glossScalef, glossBiasf);
-                const float specularPower = applyLightningModel(specularPowerRef, _lightingModel);
-                const float filterAngle = CMFT_CLAMP(cosinePowerFilterAngle(specularPower), minAngle, maxAngle);
-                const float cosAngle = CMFT_MAX(0.0f, cosf(filterAngle));
-                const float texelSize = 1.0f/mipFaceSizef;
-                const float filterSize = CMFT_MAX(texelSize, filterAngle * toFilterSize);
-
-                for (uint8_t face = 0; face < 6; ++face)
+                const uint32_t ii = order[pos];
+                const RadianceFilterProbe& probe = probes[ii];
+                for (uint32_t mip = mipStart; mip < probe.m_mipCount; ++mip)
                 {
-                    float* dstPtr = (float*)((uint8_t*)dstData + dstOffsets[face][mip]);
+                    const RadianceMipFilter& filter = probe.m_mipFilter[mip];
+                    if (filter.m_sh)
+                    {
+                        continue;
+                    }
+
+                    const RadianceFilterSource& src = probe.m_source[filter.m_srcLevel];
 
-                    RadianceFilterParams taskParams =
+                    if (0 != filter.m_srcLevel && 0 == pos)
                     {
-                        dstPtr,
-                        face,
-                        mipFaceSize,
-                        filterSize,
-                        specularPower,
-                        cosAngle,
-                        cubemapVectors,
-                        &imageRgba32f,
-                        srcFaceOffsets,
-                        _edgeFixup,
-                    };
+                        INFO("Radiance -> Mip %u is filtered from %ux%u source.", mip, src.m_image->m_width, src.m_image->m_width);
+                    }
+
+                    for (uint8_t face = 0; face < 6; ++face)
+                    {
+                        float* dstPtr = (float*)((uint8_t*)probe.m_dstData + probe.m_dstOffsets[face][mip]);
+
+                        RadianceFilterSibling* faceSiblings = &siblings[numSiblings];
+                        const uint32_t groupEnd = CMFT_MIN(pos + groupSize[pos], _count);
+                        for (uint32_t jj = pos+1; jj < groupEnd; ++jj)
+                        {
+                            const RadianceFilterProbe& other = probes[order[jj]];
+                            const RadianceFilterSource& otherSrc = other.m_source[filter.m_srcLevel];
+
+                            RadianceFilterSibling& sibling = siblings[numSiblings++];
+                            sibling.m_dstPtr      = (float*)((uint8_t*)other.m_dstData + other.m_dstOffsets[face][mip]);
+                            sibling.m_image       = otherSrc.m_image;
+                            sibling.m_faceOffsets = otherSrc.m_faceOffsets;
+                            sibling.m_srcPlanes   = otherSrc.m_srcPlanes;
+                        }
+
+                        RadianceFilterParams taskParams =
+                        {
+                            dstPtr,
+                            face,
+                            filter.m_faceSize,
+                            filter.m_filterSize,
+                            filter.m_specularPower,
+                            filter.m_cosAngle,
+                            src.m_cubemapVectors,
+                            src.m_image,
+                            src.m_faceOffsets,
+                            src.m_normalPlanes,
+                            src.m_srcPlanes,
+                            src.m_tiles,
+                            _edgeFixup,
+                            src.m_kernel,
+                            src.m_groupKernel,
+                            ggx ? &probe.m_ggxSamples[mip] : NULL,
+                            probe.m_source,
+                            probe.m_srcLevelCount,
+                            radianceFilterFn(ggx, _edgeFixup, NULL != src.m_tiles, options.m_accumulation),
+                            _src[ii].m_format,
+                            faceSiblings,
+                            uint8_t(groupSize[pos]-1),
+                        };
 
-                    // Enqueue processing parameters.
-                    taskList.set(mip, face, &taskParams);
+                        // Enqueue processing parameters.
+                        taskList.set(task++, &taskParams);
+                    }
                 }
             }
 
-
             // Output process header info.
             INFO("Radiance -> ------------------------------------");
             INFO("Radiance ->  Device / Face /     Time /    Total");
             INFO("Radiance -> ------------------------------------");
 
             // Single thread, no OpenCL.
-            if (maxActiveCpuThreads == 1 && !s_radianceProgram.isValid())
+            if (numCpuThreads == 1 && !useGpu)
             {
                 radianceFilterCpu((void*)&taskList);
             }
             // Multi thread (with or without OpenCL).
             else
             {
-                // Start CPU processing threads.
-                while (activeCpuThreads < maxActiveCpuThreads - 1)
-                {
-                    cpuThreads[activeCpuThreads++] = std::thread(radianceFilterCpu, (void*)&taskList);
-                }
-
-                // Start one GPU host thread.
-                if (s_radianceProgram.isValid() && s_radianceProgram.isIdle())
-                {
-                    cpuThreads[activeCpuThreads++] = std::thread(radianceFilterGpu, (void*)&taskList);
-                }
-
-                // Wait for everything to finish.
-                for (uint32_t ii = 0; ii < activeCpuThreads; ++ii)
-                {
-                    cpuThreads[ii].join();
-                }
-
-                // OpenCL failed and no CPU threads were selected for procesing.
-                const uint16_t unfinished = taskList.unfinishedCount();
-                if (unfinished > 0 && 0 == maxActiveCpuThreads)
-                {
-                    return false;
-                }
+                // Run cpu workers and gpu host on the thread pool and wait for everything to finish.
+                taskList.setUseGpu(useGpu);
+                threadPoolRun(radianceFilterTask, (void*)&taskList, numCpuThreads + uint32_t(useGpu));
 
-                // Process unfinished tasks on CPU.
-                const uint8_t numThreads = CMFT_MIN(unfinished, maxActiveCpuThreads);
-                for (uint8_t ii = 0; ii < numThreads; ++ii)
+                // Process tasks that OpenCL failed to finish on CPU.
+                if (state.m_completedTasksCpu + state.m_completedTasksGpu < state.m_totalTasks)
                 {
-                    radianceFilterCpu((void*)&taskList);
+                    if (0 == maxActiveCpuThreads)
+                    {
+                        // OpenCL failed and no CPU threads were selected for procesing.
+                        success = false;
+                    }
+                    else
+                    {
+                        radianceFilterCpu((void*)&taskList);
+                    }
                 }
             }
 
-            // Average 1x1 face size.
-            if ((dstFaceSize>>(mipCount-1)) <= 1)
-            {
-                float* face0 = (float*)((uint8_t*)dstData + dstOffsets[0][mipCount-1]);
-                float* face1 = (float*)((uint8_t*)dstData + dstOffsets[1][mipCount-1]);
-                float* face2 = (float*)((uint8_t*)dstData + dstOffsets[2][mipCount-1]);
-                float* face3 = (float*)((uint8_t*)dstData + dstOffsets[3][mipCount-1]);
-                float* face4 = (float*)((uint8_t*)dstData + dstOffsets[4][mipCount-1]);
-                float* face5 = (float*)((uint8_t*)dstData + dstOffsets[5][mipCount-1]);
-
-                const float color[3] =
-                {
-                    (face0[0] + face1[0] + face2[0] + face3[0] + face4[0] + face5[0]) / 6.0f,
-                    (face0[1] + face1[1] + face2[1] + face3[1] + face4[1] + face5[1]) / 6.0f,
-                    (face0[2] + face1[2] + face2[2] + face3[2] + face4[2] + face5[2]) / 6.0f,
-                };
-
-                face0[0] = face1[0] = face2[0] = face3[0] = face4[0] = face5[0] = color[0];
-                face0[1] = face1[1] = face2[1] = face3[1] = face4[1] = face5[1] = color[1];
-                face0[2] = face1[2] = face2[2] = face3[2] = face4[2] = face5[2] = color[2];
-            }
-
             // Get filter duration.
             const double freq = double(cmft::getHPFrequency());
             const double toSec = 1.0/freq;
-            const uint64_t totalTime = cmft::getHPCounter() - s_globalState.m_startTime;
+            const uint64_t totalTime = cmft::getHPCounter() - state.m_startTime;
 
             // Output progress info.
             INFO("Radiance -> ------------------------------------");
-            INFO("Radiance -> Total faces processed on [CPU]: %u", s_globalState.m_completedTasksCpu);
-            INFO("Radiance -> Total faces processed on <GPU>: %u", s_globalState.m_completedTasksGpu);
+            INFO("Radiance -> Total faces processed on [CPU]: %u", state.m_completedTasksCpu);
+            INFO("Radiance -> Total faces processed on <GPU>: %u", state.m_completedTasksGpu);
             INFO("Radiance -> Total time: %.3f seconds.", double(totalTime)*toSec);
+            if (_count > 1)
+            {
+                INFO("Radiance -> Throughput: %.2f cubemaps per second.", double(_count)/CMFT_MAX(double(totalTime)*toSec, 1e-9));
+            }
 
-            // Cleanup.
-            if (s_radianceProgram.isValid())
+            // Output per device utilization.
+            INFO("Radiance -> ------------------------------------");
+            INFO("Radiance ->  Device /     Busy /     Idle");
+            INFO("Radiance -> ------------------------------------");
+            for (uint8_t ii = 0, end = taskList.numWorkers(); ii < end; ++ii)
+            {
+                const uint64_t busyTime = taskList.busyTime(ii);
+                char cpuId[16];
+                sprintf(cpuId, "[CPU%u]", ii);
+                INFO("Radiance -> %-8s| %7.3fs | %7.3fs"
+                    , cpuId
+                    , double(busyTime)*toSec
+                    , double(totalTime-CMFT_MIN(busyTime, totalTime))*toSec
+                    );
+            }
+            if (state.m_completedTasksGpu > 0)
             {
-                s_radianceProgram.releaseDeviceMemory();
-                s_radianceProgram.destroy();
+                const uint64_t busyTime = taskList.gpuBusyTime();
+                INFO("Radiance -> %-8s| %7.3fs | %7.3fs"
+                    , "<GPU>"
+                    , double(busyTime)*toSec
+                    , double(totalTime-CMFT_MIN(busyTime, totalTime))*toSec
+                    );
+
+                // Device time of each stage, from OpenCL profiling events.
+                INFO("Radiance -> ------------------------------------");
+                INFO("Radiance -> <GPU> upload:   %7.3fs", double(program.stageTime(RadianceProgram::Stage::Upload))*1e-9);
+                INFO("Radiance -> <GPU> filter:   %7.3fs", double(program.stageTime(RadianceProgram::Stage::Filter))*1e-9);
+                INFO("Radiance -> <GPU> sum:      %7.3fs", double(program.stageTime(RadianceProgram::Stage::Sum))*1e-9);
+                INFO("Radiance -> <GPU> readback: %7.3fs", double(program.stageTime(RadianceProgram::Stage::Readback))*1e-9);
             }
-            s_globalState.reset();
 
-            CMFT_FREE(&g_crtAllocator, cubemapVectors);
+            CMFT_FREE(&g_crtAllocator, siblings);
         }
 
-        // Fill result structure.
-        Image result;
-        result.m_width = dstFaceSize;
-        result.m_height = dstFaceSize;
-        result.m_dataSize = dstDataSize;
-        result.m_format = TextureFormat::RGBA32F;
-        result.m_numMips = mipCount;
-        result.m_numFaces = 6;
-        result.m_data = dstData;
+        CMFT_FREE(&g_crtAllocator, order);
+        CMFT_FREE(&g_crtAllocator, groupSize);
+        CMFT_FREE(&g_crtAllocator, grouped);
 
-        // Convert back to source format.
-        if (TextureFormat::RGBA32F == _src.m_format)
+        // Average 1x1 face size.
+        for (uint32_t ii = 0; ii < _count; ++ii)
         {
-            imageMove(_dst, result, _allocator);
+            if (probes[ii].m_mipCount > mipStart)
+            {
+                radianceFilterProbeAverageLastMip(probes[ii]);
+            }
         }
-        else
+
+        RadianceFilterStats& stats = _context->m_stats;
+        stats.m_cpuFaces = state.m_completedTasksCpu;
+        stats.m_gpuFaces = state.m_completedTasksGpu;
+        stats.m_cpuRows  = state.m_rowsCpu;
+        stats.m_gpuRows  = state.m_rowsGpu;
+        if (0 != stats.m_gpuRows)
         {
-            imageConvert(_dst, (TextureFormat::Enum)_src.m_format, result, _allocator);
-            imageUnload(result, _allocator);
+            stats.m_deviceFormat = program.isHalfFloat() ? DeviceFormat::Half : DeviceFormat::Float;
         }
+        state.reset();
 
         // Cleanup.
-        imageUnload(imageRgba32f, _allocator);
+        if (program.isValid())
+        {
+            program.releaseDeviceMemory();
+            program.destroy();
+        }
 
-        return true;
+        // Sources are freed before destinations are written, so _dst may be _src.
+        for (uint32_t ii = 0; ii < _count; ++ii)
+        {
+            radianceFilterProbeFreeSource(probes[ii]);
+        }
+
+        for (uint32_t ii = 0; ii < _count; ++ii)
+        {
+            RadianceFilterProbe& probe = probes[ii];
+            if (!success)
+            {
+                CMFT_FREE(&g_crtAllocator, probe.m_dstData);
+                continue;
+            }
+
+            // Fill result structure.
+            Image result;
+            result.m_width = probe.m_dstFaceSize;
+            result.m_height = probe.m_dstFaceSize;
+            result.m_dataSize = probe.m_dstDataSize;
+            result.m_format = TextureFormat::RGBA32F;
+            result.m_numMips = probe.m_mipCount;
+            result.m_numFaces = 6;
+            result.m_data = probe.m_dstData;
+
+            // Convert back to source format.
+            const TextureFormat::Enum srcFormat = _src[ii].m_format;
+            if (TextureFormat::RGBA32F == srcFormat)
+            {
+                imageMove(_dst[ii], result, _allocator);
+            }
+            else
+            {
+                imageConvert(_dst[ii], srcFormat, result, _allocator);
+                imageUnload(result, _allocator);
+            }
+        }
+
+        return success;
     }
 
-    bool imageRadianceFilter(Image& _image
+    bool imageRadianceFilter(RadianceFilterContext* _context
+                           , Image& _dst
+                           , uint32_t _dstFaceSize
+                           , LightingModel::Enum _lightingModel
+                           , bool _excludeBase
+                           , uint8_t _mipCount
+                           , uint8_t _glossScale
+                           , uint8_t _glossBias
+                           , const Image& _src
+                           , EdgeFixup::Enum _edgeFixup
+                           , uint8_t _numCpuProcessingThreads
+                           , ClContext* _clContext
+                           , AllocatorI* _allocator
+                           , const RadianceFilterOptions* _options
+                           )
+    {
+        return imageRadianceFilterBatch(_context, &_dst, &_src, 1, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _edgeFixup, _numCpuProcessingThreads, _clContext, _allocator, _options);
+    }
+
+    bool imageRadianceFilter(Image& _dst
+                           , uint32_t _dstFaceSize
+                           , LightingModel::Enum _lightingModel
+                           , bool _excludeBase
+                           , uint8_t _mipCount
+                           , uint8_t _glossScale
+                           , uint8_t _glossBias
+                           , const Image& _src
+                           , EdgeFixup::Enum _edgeFixup
+                           , uint8_t _numCpuProcessingThreads
+                           , ClContext* _clContext
+                           , AllocatorI* _allocator
+                           , const RadianceFilterOptions* _options
+                           )
+    {
+        RadianceFilterContext context;
+        return imageRadianceFilter(&context, _dst, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _src, _edgeFixup, _numCpuProcessingThreads, _clContext, _allocator, _options);
+    }
+
+    bool imageRadianceFilter(RadianceFilterContext* _context
+                           , Image& _image
                            , uint32_t _dstFaceSize
                            , LightingModel::Enum _lightingModel
                            , bool _excludeBase
@@ -2259,10 +5698,11 @@ namespace cmft
                            , uint8_t _numCpuProcessingThreads
                            , ClContext* _clContext
                            , AllocatorI* _allocator
+                           , const RadianceFilterOptions* _options
                            )
     {
         Image tmp;
-        if (imageRadianceFilter(tmp, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _image, _edgeFixup, _numCpuProcessingThreads, _clContext, _allocator))
+        if (imageRadianceFilter(_context, tmp, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _image, _edgeFixup, _numCpuProcessingThreads, _clContext, _allocator, _options))
         {
             imageMove(_image, tmp, _allocator);
             return true;
@@ -2271,6 +5711,44 @@ namespace cmft
         return false;
     }
 
+    bool imageRadianceFilter(Image& _image
+                           , uint32_t _dstFaceSize
+                           , LightingModel::Enum _lightingModel
+                           , bool _excludeBase
+                           , uint8_t _mipCount
+                           , uint8_t _glossScale
+                           , uint8_t _glossBias
+                           , EdgeFixup::Enum _edgeFixup
+                           , uint8_t _numCpuProcessingThreads
+                           , ClContext* _clContext
+                           , AllocatorI* _allocator
+                           , const RadianceFilterOptions* _options
+                           )
+    {
+        RadianceFilterContext context;
+        return imageRadianceFilter(&context, _image, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _edgeFixup, _numCpuProcessingThreads, _clContext, _allocator, _options);
+    }
+
+    bool imageRadianceFilterBatch(Image* _dst
+                                , const Image* _src
+                                , uint32_t _count
+                                , uint32_t _dstFaceSize
+                                , LightingModel::Enum _lightingModel
+                                , bool _excludeBase
+                                , uint8_t _mipCount
+                                , uint8_t _glossScale
+                                , uint8_t _glossBias
+                                , EdgeFixup::Enum _edgeFixup
+                                , uint8_t _numCpuProcessingThreads
+                                , ClContext* _clContext
+                                , AllocatorI* _allocator
+                                , const RadianceFilterOptions* _options
+                                )
+    {
+        RadianceFilterContext context;
+        return imageRadianceFilterBatch(&context, _dst, _src, _count, _dstFaceSize, _lightingModel, _excludeBase, _mipCount, _glossScale, _glossBias, _edgeFixup, _numCpuProcessingThreads, _clContext, _allocator, _options);
+    }
+
 } // namespace cmft
 
 /* vim: set sw=4 ts=4 expandtab: */
@@ -5,16 +5,22 @@
 
 #include <cmft/image.h>
 #include <cmft/allocator.h>
+#include <cmft/threadpool.h>
 
 #include "common/config.h"
 #include "common/utils.h"
 #include "common/halffloat.h"
+#include "common/cpu.h"
 #include "common/stb_image.h"
 
 #include "cubemaputils.h"
 
 #include <string.h>
 
+#if CMFT_SIMD_SSE41 || CMFT_SIMD_AVX2
+#   include <immintrin.h>
+#endif
+
 namespace cmft
 {
     // Read/write.
@@ -1449,9 +1455,503 @@ namespace cmft
         }
     }
 
+    // Simd conversion.
+    //-----
+
+    /// Bulk converters convert the leading pixels of _numPixels and return how many of them were converted, the
+    /// rest is left to the scalar loop. They never read or write past the end of a row, so 3 channel formats stop
+    /// a few pixels before it. Results are bit identical to the scalar functions, except that half floats are
+    /// encoded with F16C, which rounds ties to even and flushes values below the half range to zero.
+    typedef uint32_t (*BulkToRgba32fFn)(float* _dst, const void* _src, uint32_t _numPixels);
+    typedef uint32_t (*BulkFromRgba32fFn)(void* _dst, const float* _src, uint32_t _numPixels);
+
+#if CMFT_SIMD_SSE41
+#   if defined(__clang__)
+#       pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#   elif defined(__GNUC__)
+#       pragma GCC push_options
+#       pragma GCC target("sse4.1")
+#   endif
+
+    namespace sse41
+    {
+        // Pshufb masks, -1 zeroes the byte.
+        #define CMFT_SHUFFLE_MASK(_b0, _b1, _b2, _b3, _b4, _b5, _b6, _b7, _b8, _b9, _b10, _b11, _b12, _b13, _b14, _b15) \
+            _mm_setr_epi8(_b0, _b1, _b2, _b3, _b4, _b5, _b6, _b7, _b8, _b9, _b10, _b11, _b12, _b13, _b14, _b15)
+
+        static inline __m128i rgba8Shuffle(TextureFormat::Enum _format)
+        {
+            switch (_format)
+            {
+            case TextureFormat::BGR8:  return CMFT_SHUFFLE_MASK(2, 1,  0, -1, 5,  4,  3, -1,  8,  7,  6, -1, 11, 10,  9, -1);
+            case TextureFormat::RGB8:  return CMFT_SHUFFLE_MASK(0, 1,  2, -1, 3,  4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1);
+            case TextureFormat::BGRA8: return CMFT_SHUFFLE_MASK(2, 1,  0,  3, 6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15);
+            default:                   return CMFT_SHUFFLE_MASK(0, 1,  2,  3, 4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15);
+            }
+        }
+
+        /// Inverse of rgba8Shuffle(), 3 channel formats are packed into the first 12 bytes.
+        static inline __m128i rgba8Unshuffle(TextureFormat::Enum _format)
+        {
+            switch (_format)
+            {
+            case TextureFormat::BGR8:  return CMFT_SHUFFLE_MASK(2, 1,  0,  6, 5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1);
+            case TextureFormat::RGB8:  return CMFT_SHUFFLE_MASK(0, 1,  2,  4, 5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1);
+            case TextureFormat::BGRA8: return CMFT_SHUFFLE_MASK(2, 1,  0,  3, 6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15);
+            default:                   return CMFT_SHUFFLE_MASK(0, 1,  2,  3, 4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15);
+            }
+        }
+
+        /// Stores 4 channels of a pixel scaled to [0.0, 1.0], alpha is 1.0 for 3 channel formats.
+        template <bool AlphaT>
+        static inline void storeUnorm(float* _dst, __m128i _rgba32i, __m128 _scale)
+        {
+            __m128 rgba = _mm_mul_ps(_mm_cvtepi32_ps(_rgba32i), _scale);
+            if (!AlphaT)
+            {
+                rgba = _mm_blend_ps(rgba, _mm_set1_ps(1.0f), 0x8);
+            }
+            _mm_storeu_ps(_dst, rgba);
+        }
+
+        /// Clamps 4 pixels to [0.0, 1.0], scales them by _scale and truncates them to integers.
+        static inline void loadUnorm(__m128i _rgba32i[4], const float* _src, __m128 _scale)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one  = _mm_set1_ps(1.0f);
+            for (uint32_t ii = 0; ii < 4; ++ii)
+            {
+                const __m128 rgba = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(_src + ii*4), zero), one);
+                _rgba32i[ii] = _mm_cvttps_epi32(_mm_mul_ps(rgba, _scale));
+            }
+        }
+
+        template <TextureFormat::Enum FormatT>
+        static uint32_t unorm8ToRgba32f(float* _dst, const void* _src, uint32_t _numPixels)
+        {
+            enum
+            {
+                Alpha        = (TextureFormat::RGBA8 == FormatT || TextureFormat::BGRA8 == FormatT),
+                BytesPerPixel = Alpha ? 4 : 3,
+            };
+
+            const __m128i shuffle = rgba8Shuffle(FormatT);
+            const __m128 scale = _mm_set1_ps(1.0f/255.0f);
+            const uint8_t* src = (const uint8_t*)_src;
+
+            // 16 bytes are read for every 4 pixels.
+            uint32_t ii = 0;
+            for (; ii*BytesPerPixel + 16 <= _numPixels*BytesPerPixel; ii += 4, src += 4*BytesPerPixel, _dst += 16)
+            {
+                const __m128i rgba8 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), shuffle);
+                storeUnorm<bool(Alpha)>(_dst,    _mm_cvtepu8_epi32(rgba8),                     scale);
+                storeUnorm<bool(Alpha)>(_dst+4,  _mm_cvtepu8_epi32(_mm_srli_si128(rgba8,  4)), scale);
+                storeUnorm<bool(Alpha)>(_dst+8,  _mm_cvtepu8_epi32(_mm_srli_si128(rgba8,  8)), scale);
+                storeUnorm<bool(Alpha)>(_dst+12, _mm_cvtepu8_epi32(_mm_srli_si128(rgba8, 12)), scale);
+            }
+
+            return ii;
+        }
+
+        template <TextureFormat::Enum FormatT>
+        static uint32_t unorm8FromRgba32f(void* _dst, const float* _src, uint32_t _numPixels)
+        {
+            enum
+            {
+                Alpha        = (TextureFormat::RGBA8 == FormatT || TextureFormat::BGRA8 == FormatT),
+                BytesPerPixel = Alpha ? 4 : 3,
+            };
+
+            const __m128i unshuffle = rgba8Unshuffle(FormatT);
+            const __m128 scale = _mm_set1_ps(255.0f);
+            uint8_t* dst = (uint8_t*)_dst;
+
+            uint32_t ii = 0;
+            for (; ii + 4 <= _numPixels; ii += 4, _src += 16, dst += 4*BytesPerPixel)
+            {
+                __m128i rgba32i[4];
+                loadUnorm(rgba32i, _src, scale);
+
+                const __m128i rgba8 = _mm_packus_epi16(_mm_packus_epi32(rgba32i[0], rgba32i[1]), _mm_packus_epi32(rgba32i[2], rgba32i[3]));
+                const __m128i packed = _mm_shuffle_epi8(rgba8, unshuffle);
+                if (Alpha)
+                {
+                    _mm_storeu_si128((__m128i*)dst, packed);
+                }
+                else
+                {
+                    _mm_storel_epi64((__m128i*)dst, packed);
+                    const int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+                    memcpy(dst + 8, &last, 4);
+                }
+            }
+
+            return ii;
+        }
+
+        template <TextureFormat::Enum FormatT>
+        static uint32_t unorm16ToRgba32f(float* _dst, const void* _src, uint32_t _numPixels)
+        {
+            enum
+            {
+                Alpha        = (TextureFormat::RGBA16 == FormatT),
+                BytesPerPixel = Alpha ? 8 : 6,
+            };
+
+            const __m128i shuffle = Alpha
+                                  ? CMFT_SHUFFLE_MASK(0, 1, 2, 3, 4, 5,  6,  7, 8, 9, 10, 11, 12, 13, 14, 15)
+                                  : CMFT_SHUFFLE_MASK(0, 1, 2, 3, 4, 5, -1, -1, 6, 7,  8,  9, 10, 11, -1, -1)
+                                  ;
+            const __m128 scale = _mm_set1_ps(1.0f/65535.0f);
+            const uint8_t* src = (const uint8_t*)_src;
+
+            // 16 bytes are read for every 2 pixels.
+            uint32_t ii = 0;
+            for (; ii*BytesPerPixel + 16 <= _numPixels*BytesPerPixel; ii += 2, src += 2*BytesPerPixel, _dst += 8)
+            {
+                const __m128i rgba16 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), shuffle);
+                storeUnorm<bool(Alpha)>(_dst,   _mm_cvtepu16_epi32(rgba16),                    scale);
+                storeUnorm<bool(Alpha)>(_dst+4, _mm_cvtepu16_epi32(_mm_srli_si128(rgba16, 8)), scale);
+            }
+
+            return ii;
+        }
+
+        template <TextureFormat::Enum FormatT>
+        static uint32_t unorm16FromRgba32f(void* _dst, const float* _src, uint32_t _numPixels)
+        {
+            enum
+            {
+                Alpha        = (TextureFormat::RGBA16 == FormatT),
+                BytesPerPixel = Alpha ? 8 : 6,
+            };
+
+            const __m128i unshuffle = CMFT_SHUFFLE_MASK(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+            const __m128 scale = _mm_set1_ps(65535.0f);
+            uint8_t* dst = (uint8_t*)_dst;
+
+            uint32_t ii = 0;
+            for (; ii + 4 <= _numPixels; ii += 4, _src += 16, dst += 4*BytesPerPixel)
+            {
+                __m128i rgba32i[4];
+                loadUnorm(rgba32i, _src, scale);
+
+                const __m128i rgba16[2] =
+                {
+                    _mm_packus_epi32(rgba32i[0], rgba32i[1]),
+                    _mm_packus_epi32(rgba32i[2], rgba32i[3]),
+                };
+
+                if (Alpha)
+                {
+                    _mm_storeu_si128((__m128i*)dst,      rgba16[0]);
+                    _mm_storeu_si128((__m128i*)dst + 1,  rgba16[1]);
+                }
+                else
+                {
+                    // 12 bytes per pair of pixels, second store overwrites the last 4 bytes of the first one.
+                    const __m128i rgb16[2] =
+                    {
+                        _mm_shuffle_epi8(rgba16[0], unshuffle),
+                        _mm_shuffle_epi8(rgba16[1], unshuffle),
+                    };
+                    _mm_storeu_si128((__m128i*)dst, rgb16[0]);
+                    _mm_storel_epi64((__m128i*)(dst + 12), rgb16[1]);
+                    const int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(rgb16[1], 8));
+                    memcpy(dst + 20, &last, 4);
+                }
+            }
+
+            return ii;
+        }
+
+        static uint32_t rgb32fToRgba32f(float* _dst, const void* _src, uint32_t _numPixels)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const float* src = (const float*)_src;
+
+            uint32_t ii = 0;
+            for (; ii + 4 <= _numPixels; ii += 4, src += 12, _dst += 16)
+            {
+                // r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3
+                const __m128i aa = _mm_castps_si128(_mm_loadu_ps(src));
+                const __m128i bb = _mm_castps_si128(_mm_loadu_ps(src + 4));
+                const __m128i cc = _mm_castps_si128(_mm_loadu_ps(src + 8));
+                _mm_storeu_ps(_dst,    _mm_blend_ps(_mm_castsi128_ps(aa),                         one, 0x8));
+                _mm_storeu_ps(_dst+4,  _mm_blend_ps(_mm_castsi128_ps(_mm_alignr_epi8(bb, aa, 12)), one, 0x8));
+                _mm_storeu_ps(_dst+8,  _mm_blend_ps(_mm_castsi128_ps(_mm_alignr_epi8(cc, bb,  8)), one, 0x8));
+                _mm_storeu_ps(_dst+12, _mm_blend_ps(_mm_castsi128_ps(_mm_srli_si128(cc, 4)),       one, 0x8));
+            }
+
+            return ii;
+        }
+
+        static uint32_t rgb32fFromRgba32f(void* _dst, const float* _src, uint32_t _numPixels)
+        {
+            float* dst = (float*)_dst;
+
+            uint32_t ii = 0;
+            for (; ii + 4 <= _numPixels; ii += 4, _src += 16, dst += 12)
+            {
+                const __m128 p0 = _mm_loadu_ps(_src);
+                const __m128 p1 = _mm_loadu_ps(_src + 4);
+                const __m128 p2 = _mm_loadu_ps(_src + 8);
+                const __m128 p3 = _mm_loadu_ps(_src + 12);
+                _mm_storeu_ps(dst,     _mm_blend_ps(p0, _mm_shuffle_ps(p1, p1, _MM_SHUFFLE(0, 0, 0, 0)), 0x8));
+                _mm_storeu_ps(dst + 4, _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(1, 0, 2, 1)));
+                _mm_storeu_ps(dst + 8, _mm_blend_ps(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(p3), 4)), _mm_shuffle_ps(p2, p2, _MM_SHUFFLE(2, 2, 2, 2)), 0x1));
+            }
+
+            return ii;
+        }
+
+        /// Decodes 4 pixels as rgbeToRgba32f(). Scale of exponents 1..9 is a denormal float, it is built from two
+        /// normal ones, so the result is exact.
+        static uint32_t rgbeToRgba32f(float* _dst, const void* _src, uint32_t _numPixels)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const uint8_t* src = (const uint8_t*)_src;
+
+            uint32_t ii = 0;
+            for (; ii + 4 <= _numPixels; ii += 4, src += 16, _dst += 16)
+            {
+                const __m128i rgbe = _mm_loadu_si128((const __m128i*)src);
+                const __m128i exp  = _mm_srli_epi32(rgbe, 24);
+
+                // 2^(exp-136).
+                const __m128 normal   = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(exp, _mm_set1_epi32(9)), 23));
+                const __m128 denormal = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exp, _mm_set1_epi32(55)), 23)), _mm_castsi128_ps(_mm_set1_epi32((127-64)<<23)) /*2^-64*/);
+                const __m128 isNormal = _mm_castsi128_ps(_mm_cmpgt_epi32(exp, _mm_set1_epi32(9)));
+                const __m128 nonZero  = _mm_castsi128_ps(_mm_cmpgt_epi32(exp, _mm_setzero_si128()));
+                const __m128 scale    = _mm_and_ps(_mm_blendv_ps(denormal, normal, isNormal), nonZero);
+
+                _mm_storeu_ps(_dst,    _mm_blend_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(rgbe)),                     _mm_shuffle_ps(scale, scale, 0x00)), one, 0x8));
+                _mm_storeu_ps(_dst+4,  _mm_blend_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(rgbe,  4))), _mm_shuffle_ps(scale, scale, 0x55)), one, 0x8));
+                _mm_storeu_ps(_dst+8,  _mm_blend_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(rgbe,  8))), _mm_shuffle_ps(scale, scale, 0xaa)), one, 0x8));
+                _mm_storeu_ps(_dst+12, _mm_blend_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(rgbe, 12))), _mm_shuffle_ps(scale, scale, 0xff)), one, 0x8));
+            }
+
+            return ii;
+        }
+
+        /// Encodes 4 pixels as rgbeFromRgba32f().
+        static uint32_t rgbeFromRgba32f(void* _dst, const float* _src, uint32_t _numPixels)
+        {
+            uint8_t* dst = (uint8_t*)_dst;
+
+            uint32_t ii = 0;
+            for (; ii + 4 <= _numPixels; ii += 4, _src += 16, dst += 16)
+            {
+                __m128 rr = _mm_loadu_ps(_src);
+                __m128 gg = _mm_loadu_ps(_src + 4);
+                __m128 bb = _mm_loadu_ps(_src + 8);
+                __m128 aa = _mm_loadu_ps(_src + 12);
+                _MM_TRANSPOSE4_PS(rr, gg, bb, aa);
+
+                const __m128i maxVal = _mm_castps_si128(_mm_max_ps(_mm_max_ps(rr, gg), bb));
+                const __m128i valid  = _mm_cmpgt_epi32(maxVal, _mm_set1_epi32(0x007fffff));
+                const __m128i roundUp = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(maxVal, _mm_set1_epi32(0x7fffff)), _mm_setzero_si128()), _mm_set1_epi32(1));
+                const __m128i exp    = _mm_min_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(maxVal, 23), _mm_set1_epi32(127)), roundUp), _mm_set1_epi32(126));
+                const __m128  scale  = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(127), exp), 23));
+
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 max8 = _mm_set1_ps(255.0f);
+                const __m128i r8 = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_mul_ps(_mm_max_ps(rr, zero), scale), max8), max8));
+                const __m128i g8 = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_mul_ps(_mm_max_ps(gg, zero), scale), max8), max8));
+                const __m128i b8 = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_mul_ps(_mm_max_ps(bb, zero), scale), max8), max8));
+                const __m128i e8 = _mm_add_epi32(exp, _mm_set1_epi32(128));
+
+                const __m128i rgbe = _mm_or_si128(_mm_or_si128(r8, _mm_slli_epi32(g8, 8)), _mm_or_si128(_mm_slli_epi32(b8, 16), _mm_slli_epi32(e8, 24)));
+                _mm_storeu_si128((__m128i*)dst, _mm_and_si128(rgbe, valid));
+            }
+
+            return ii;
+        }
+
+        #undef CMFT_SHUFFLE_MASK
+
+    } // namespace sse41
+
+#   if defined(__clang__)
+#       pragma clang attribute pop
+#   elif defined(__GNUC__)
+#       pragma GCC pop_options
+#   endif
+#endif //CMFT_SIMD_SSE41
+
+#if CMFT_SIMD_AVX2
+#   if defined(__clang__)
+#       pragma clang attribute push(__attribute__((target("avx2,f16c"))), apply_to = function)
+#   elif defined(__GNUC__)
+#       pragma GCC push_options
+#       pragma GCC target("avx2,f16c")
+#   endif
+
+    namespace avx2
+    {
+        static uint32_t rgba16fToRgba32f(float* _dst, const void* _src, uint32_t _numPixels)
+        {
+            const uint16_t* src = (const uint16_t*)_src;
+
+            uint32_t ii = 0;
+            for (; ii + 2 <= _numPixels; ii += 2, src += 8, _dst += 8)
+            {
+                _mm256_storeu_ps(_dst, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)src)));
+            }
+
+            return ii;
+        }
+
+        static uint32_t rgb16fToRgba32f(float* _dst, const void* _src, uint32_t _numPixels)
+        {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1);
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const uint16_t* src = (const uint16_t*)_src;
+
+            // 16 bytes are read for every 2 pixels.
+            uint32_t ii = 0;
+            for (; ii*6 + 16 <= _numPixels*6; ii += 2, src += 6, _dst += 8)
+            {
+                const __m128i rgba16f = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), shuffle);
+                _mm256_storeu_ps(_dst, _mm256_blend_ps(_mm256_cvtph_ps(rgba16f), one, 0x88));
+            }
+
+            return ii;
+        }
+
+        static uint32_t rgba16fFromRgba32f(void* _dst, const float* _src, uint32_t _numPixels)
+        {
+            uint16_t* dst = (uint16_t*)_dst;
+
+            uint32_t ii = 0;
+            for (; ii + 2 <= _numPixels; ii += 2, _src += 8, dst += 8)
+            {
+                _mm_storeu_si128((__m128i*)dst, _mm256_cvtps_ph(_mm256_loadu_ps(_src), _MM_FROUND_TO_NEAREST_INT));
+            }
+
+            return ii;
+        }
+
+        static uint32_t rgb16fFromRgba32f(void* _dst, const float* _src, uint32_t _numPixels)
+        {
+            const __m128i unshuffle = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+            uint16_t* dst = (uint16_t*)_dst;
+
+            uint32_t ii = 0;
+            for (; ii + 2 <= _numPixels; ii += 2, _src += 8, dst += 6)
+            {
+                const __m128i rgb16f = _mm_shuffle_epi8(_mm256_cvtps_ph(_mm256_loadu_ps(_src), _MM_FROUND_TO_NEAREST_INT), unshuffle);
+                _mm_storel_epi64((__m128i*)dst, rgb16f);
+                const int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(rgb16f, 8));
+                memcpy(dst + 4, &last, 4);
+            }
+
+            return ii;
+        }
+
+    } // namespace avx2
+
+#   if defined(__clang__)
+#       pragma clang attribute pop
+#   elif defined(__GNUC__)
+#       pragma GCC pop_options
+#   endif
+#endif //CMFT_SIMD_AVX2
+
+    static uint32_t convertCpuFeatures()
+    {
+        static const uint32_t s_features = cpuFeatures();
+        return s_features;
+    }
+
+    /// Returns bulk converter of _srcFormat supported by the host cpu or NULL.
+    static BulkToRgba32fFn bulkToRgba32f(TextureFormat::Enum _srcFormat)
+    {
+        const uint32_t features = convertCpuFeatures();
+        CMFT_UNUSED(features);
+        CMFT_UNUSED(_srcFormat);
+
+        #if CMFT_SIMD_AVX2
+        if ((features&CpuFeature::Avx2)
+        &&  (features&CpuFeature::F16c))
+        {
+            switch (_srcFormat)
+            {
+            case TextureFormat::RGB16F:  return avx2::rgb16fToRgba32f;
+            case TextureFormat::RGBA16F: return avx2::rgba16fToRgba32f;
+            default: break;
+            }
+        }
+        #endif //CMFT_SIMD_AVX2
+
+        #if CMFT_SIMD_SSE41
+        if (features&CpuFeature::Sse41)
+        {
+            switch (_srcFormat)
+            {
+            case TextureFormat::BGR8:    return sse41::unorm8ToRgba32f<TextureFormat::BGR8>;
+            case TextureFormat::RGB8:    return sse41::unorm8ToRgba32f<TextureFormat::RGB8>;
+            case TextureFormat::RGB16:   return sse41::unorm16ToRgba32f<TextureFormat::RGB16>;
+            case TextureFormat::RGB32F:  return sse41::rgb32fToRgba32f;
+            case TextureFormat::RGBE:    return sse41::rgbeToRgba32f;
+            case TextureFormat::BGRA8:   return sse41::unorm8ToRgba32f<TextureFormat::BGRA8>;
+            case TextureFormat::RGBA8:   return sse41::unorm8ToRgba32f<TextureFormat::RGBA8>;
+            case TextureFormat::RGBA16:  return sse41::unorm16ToRgba32f<TextureFormat::RGBA16>;
+            default: break;
+            }
+        }
+        #endif //CMFT_SIMD_SSE41
+
+        return NULL;
+    }
+
+    /// Returns bulk converter to _dstFormat supported by the host cpu or NULL.
+    static BulkFromRgba32fFn bulkFromRgba32f(TextureFormat::Enum _dstFormat)
+    {
+        const uint32_t features = convertCpuFeatures();
+        CMFT_UNUSED(features);
+        CMFT_UNUSED(_dstFormat);
+
+        #if CMFT_SIMD_AVX2
+        if ((features&CpuFeature::Avx2)
+        &&  (features&CpuFeature::F16c))
+        {
+            switch (_dstFormat)
+            {
+            case TextureFormat::RGB16F:  return avx2::rgb16fFromRgba32f;
+            case TextureFormat::RGBA16F: return avx2::rgba16fFromRgba32f;
+            default: break;
+            }
+        }
+        #endif //CMFT_SIMD_AVX2
+
+        #if CMFT_SIMD_SSE41
+        if (features&CpuFeature::Sse41)
+        {
+            switch (_dstFormat)
+            {
+            case TextureFormat::BGR8:    return sse41::unorm8FromRgba32f<TextureFormat::BGR8>;
+            case TextureFormat::RGB8:    return sse41::unorm8FromRgba32f<TextureFormat::RGB8>;
+            case TextureFormat::RGB16:   return sse41::unorm16FromRgba32f<TextureFormat::RGB16>;
+            case TextureFormat::RGB32F:  return sse41::rgb32fFromRgba32f;
+            case TextureFormat::RGBE:    return sse41::rgbeFromRgba32f;
+            case TextureFormat::BGRA8:   return sse41::unorm8FromRgba32f<TextureFormat::BGRA8>;
+            case TextureFormat::RGBA8:   return sse41::unorm8FromRgba32f<TextureFormat::RGBA8>;
+            case TextureFormat::RGBA16:  return sse41::unorm16FromRgba32f<TextureFormat::RGBA16>;
+            default: break;
+            }
+        }
+        #endif //CMFT_SIMD_SSE41
+
+        return NULL;
+    }
+
     // To rgba32f.
     //-----
 
+    // Number of pixels converted by a single thread pool task.
+    #define CMFT_CONVERT_TASK_PIXELS (64*1024)
+
     inline void bgr8ToRgba32f(float* _rgba32f, const uint8_t* _bgr8)
     {
         _rgba32f[0] = float(_bgr8[2]) * (1.0f/255.0f);
@@ -1567,27 +2067,16 @@ namespace cmft
         };
     }
 
-    void imageToRgba32f(Image& _dst, const Image& _src, AllocatorI* _allocator)
+    // Converts _numPixels pixels of _srcFormat to rgba32f.
+    static void toRgba32f(float* _dst, const void* _src, uint32_t _numPixels, TextureFormat::Enum _srcFormat)
     {
-        // Alloc dst data.
-        const uint32_t pixelCount = imageGetNumPixels(_src);
-        const uint8_t dstBytesPerPixel = getImageDataInfo(TextureFormat::RGBA32F).m_bytesPerPixel;
-        const uint32_t dataSize = pixelCount*dstBytesPerPixel;
-        void* data = CMFT_ALLOC(_allocator, dataSize);
-        MALLOC_CHECK(data);
-
-        // Get total number of channels.
-        const uint8_t numChannelsPerPixel = getImageDataInfo(TextureFormat::RGBA32F).m_numChanels;
-        const uint32_t totalNumChannels = pixelCount*numChannelsPerPixel;
-
-        // Convert each channel.
-        float* dst = (float*)data;
-        const float* end = (float*)dst + totalNumChannels;
-        switch(_src.m_format)
+        float* dst = _dst;
+        const float* end = _dst + _numPixels*4;
+        switch(_srcFormat)
         {
         case TextureFormat::BGR8:
             {
-                const uint8_t* src = (const uint8_t*)_src.m_data;
+                const uint8_t* src = (const uint8_t*)_src;
 
                 for (;dst < end; dst+=4, src+=3)
                 {
@@ -1598,7 +2087,7 @@ namespace cmft
 
         case TextureFormat::RGB8:
             {
-                const uint8_t* src = (const uint8_t*)_src.m_data;
+                const uint8_t* src = (const uint8_t*)_src;
 
                 for (;dst < end; dst+=4, src+=3)
                 {
@@ -1609,7 +2098,7 @@ namespace cmft
 
         case TextureFormat::RGB16:
             {
-                const uint16_t* src = (const uint16_t*)_src.m_data;
+                const uint16_t* src = (const uint16_t*)_src;
 
                 for (;dst < end; dst+=4, src+=3)
                 {
@@ -1620,7 +2109,7 @@ namespace cmft
 
         case TextureFormat::RGB16F:
             {
-                const uint16_t* src = (const uint16_t*)_src.m_data;
+                const uint16_t* src = (const uint16_t*)_src;
 
                 for (;dst < end; dst+=4, src+=3)
                 {
@@ -1631,7 +2120,7 @@ namespace cmft
 
         case TextureFormat::RGB32F:
             {
-                const float* src = (const float*)_src.m_data;
+                const float* src = (const float*)_src;
 
                 for (;dst < end; dst+=4, src+=3)
                 {
@@ -1642,7 +2131,7 @@ namespace cmft
 
         case TextureFormat::RGBE:
             {
-                const uint8_t* src = (const uint8_t*)_src.m_data;
+                const uint8_t* src = (const uint8_t*)_src;
 
                 for (;dst < end; dst+=4, src+=4)
                 {
@@ -1653,7 +2142,7 @@ namespace cmft
 
         case TextureFormat::BGRA8:
             {
-                const uint8_t* src = (const uint8_t*)_src.m_data;
+                const uint8_t* src = (const uint8_t*)_src;
 
                 for (;dst < end; dst+=4, src+=4)
                 {
@@ -1664,7 +2153,7 @@ namespace cmft
 
         case TextureFormat::RGBA8:
             {
-                const uint8_t* src = (const uint8_t*)_src.m_data;
+                const uint8_t* src = (const uint8_t*)_src;
 
                 for (;dst < end; dst+=4, src+=4)
                 {
@@ -1675,7 +2164,7 @@ namespace cmft
 
         case TextureFormat::RGBA16:
             {
-                const uint16_t* src = (const uint16_t*)_src.m_data;
+                const uint16_t* src = (const uint16_t*)_src;
 
                 for (;dst < end; dst+=4, src+=4)
                 {
@@ -1686,7 +2175,7 @@ namespace cmft
 
         case TextureFormat::RGBA16F:
             {
-                const uint16_t* src = (const uint16_t*)_src.m_data;
+                const uint16_t* src = (const uint16_t*)_src;
 
                 for (;dst < end; dst+=4, src+=4)
                 {
@@ -1698,7 +2187,7 @@ namespace cmft
         case TextureFormat::RGBA32F:
             {
                 // Copy data.
-                memcpy(data, _src.m_data, dataSize);
+                memcpy(_dst, _src, _numPixels*4*sizeof(float));
             }
         break;
 
@@ -1708,6 +2197,49 @@ namespace cmft
             }
         break;
         };
+    }
+
+    struct ToRgba32fTask
+    {
+        float* m_dst;
+        const uint8_t* m_src;
+        uint32_t m_numPixels;
+        uint32_t m_srcBytesPerPixel;
+        TextureFormat::Enum m_srcFormat;
+        BulkToRgba32fFn m_bulk;
+    };
+
+    static void toRgba32fTask(void* _task, uint32_t _index)
+    {
+        const ToRgba32fTask* task = (const ToRgba32fTask*)_task;
+
+        const uint32_t begin = _index*CMFT_CONVERT_TASK_PIXELS;
+        const uint32_t count = CMFT_MIN(task->m_numPixels - begin, uint32_t(CMFT_CONVERT_TASK_PIXELS));
+        float* dst = task->m_dst + begin*4;
+        const uint8_t* src = task->m_src + begin*task->m_srcBytesPerPixel;
+
+        const uint32_t done = (NULL != task->m_bulk) ? task->m_bulk(dst, src, count) : 0;
+        toRgba32f(dst + done*4, src + done*task->m_srcBytesPerPixel, count - done, task->m_srcFormat);
+    }
+
+    void imageToRgba32f(Image& _dst, const Image& _src, AllocatorI* _allocator)
+    {
+        // Alloc dst data.
+        const uint32_t pixelCount = imageGetNumPixels(_src);
+        const uint8_t dstBytesPerPixel = getImageDataInfo(TextureFormat::RGBA32F).m_bytesPerPixel;
+        const uint32_t dataSize = pixelCount*dstBytesPerPixel;
+        void* data = CMFT_ALLOC(_allocator, dataSize);
+        MALLOC_CHECK(data);
+
+        // Convert pixels in parallel.
+        ToRgba32fTask task;
+        task.m_dst = (float*)data;
+        task.m_src = (const uint8_t*)_src.m_data;
+        task.m_numPixels = pixelCount;
+        task.m_srcBytesPerPixel = getImageDataInfo((TextureFormat::Enum)_src.m_format).m_bytesPerPixel;
+        task.m_srcFormat = (TextureFormat::Enum)_src.m_format;
+        task.m_bulk = bulkToRgba32f(task.m_srcFormat);
+        threadPoolRun(toRgba32fTask, &task, (pixelCount + CMFT_CONVERT_TASK_PIXELS-1)/CMFT_CONVERT_TASK_PIXELS);
 
         // Fill image structure.
         Image result;
@@ -1805,15 +2337,28 @@ namespace cmft
         memcpy(_dst, _src, 4*sizeof(float));
     }
 
+    /// Shared exponent is the smallest power of two that is not below the largest channel, taken from its float bits,
+    /// so channels never exceed 255. Largest channels below FLT_MIN encode to zero, exponent is clamped to 2^126.
     inline void rgbeFromRgba32f(uint8_t* _rgbe, const float* _rgba32f)
     {
-        const float maxVal = CMFT_MAX(CMFT_MAX(_rgba32f[0], _rgba32f[1]), _rgba32f[2]);
-        const float exp = ceilf(cmft::log2f(maxVal));
-        const float toRgb8 = 255.0f * 1.0f/ldexp(1.0f, int(exp)); //ldexp -> exp2 (c++11 - <cmath.h>)
-        _rgbe[0] = uint8_t(_rgba32f[0] * toRgb8);
-        _rgbe[1] = uint8_t(_rgba32f[1] * toRgb8);
-        _rgbe[2] = uint8_t(_rgba32f[2] * toRgb8);
-        _rgbe[3] = uint8_t(exp+128.0f);
+        union { float flt; int32_t i32; } maxVal;
+        maxVal.flt = CMFT_MAX(CMFT_MAX(_rgba32f[0], _rgba32f[1]), _rgba32f[2]);
+        if (maxVal.i32 < 0x00800000)
+        {
+            _rgbe[0] = 0;
+            _rgbe[1] = 0;
+            _rgbe[2] = 0;
+            _rgbe[3] = 0;
+            return;
+        }
+
+        const int32_t exp = CMFT_MIN((maxVal.i32>>23) - 127 + int32_t(0 != (maxVal.i32&0x7fffff)), 126);
+        union { int32_t i32; float flt; } scale;
+        scale.i32 = (127-exp)<<23;
+        _rgbe[0] = uint8_t(CMFT_MIN(CMFT_MAX(_rgba32f[0], 0.0f)*scale.flt*255.0f, 255.0f));
+        _rgbe[1] = uint8_t(CMFT_MIN(CMFT_MAX(_rgba32f[1], 0.0f)*scale.flt*255.0f, 255.0f));
+        _rgbe[2] = uint8_t(CMFT_MIN(CMFT_MAX(_rgba32f[2], 0.0f)*scale.flt*255.0f, 255.0f));
+        _rgbe[3] = uint8_t(exp+128);
     }
 
     void fromRgba32f(void* _out, TextureFormat::Enum _format, const float _rgba32f[4])
@@ -1835,29 +2380,16 @@ namespace cmft
         };
     }
 
-    void imageFromRgba32f(Image& _dst, TextureFormat::Enum _dstFormat, const Image& _src, AllocatorI* _allocator)
+    // Converts _numPixels rgba32f pixels to _dstFormat.
+    static void pixelsFromRgba32f(void* _dst, const float* _src, uint32_t _numPixels, TextureFormat::Enum _dstFormat)
     {
-        DEBUG_CHECK(TextureFormat::RGBA32F == _src.m_format, "Source image is not in RGBA32F format!");
-
-        // Alloc dst data.
-        const uint32_t pixelCount = imageGetNumPixels(_src);
-        const uint8_t dstBytesPerPixel = getImageDataInfo(_dstFormat).m_bytesPerPixel;
-        const uint32_t dstDataSize = pixelCount*dstBytesPerPixel;
-        void* dstData = CMFT_ALLOC(_allocator, dstDataSize);
-        MALLOC_CHECK(dstData);
-
-        // Get total number of channels.
-        const uint8_t srcNumChannels = getImageDataInfo(_src.m_format).m_numChanels;
-        const uint32_t totalNumChannels = pixelCount*srcNumChannels;
-
-        // Convert data.
-        const float* src = (const float*)_src.m_data;
-        const float* end = (const float*)_src.m_data + totalNumChannels;
+        const float* src = _src;
+        const float* end = _src + _numPixels*4;
         switch(_dstFormat)
         {
         case TextureFormat::BGR8:
             {
-                uint8_t* dst = (uint8_t*)dstData;
+                uint8_t* dst = (uint8_t*)_dst;
 
                 for (;src < end; src+=4, dst+=3)
                 {
@@ -1868,7 +2400,7 @@ namespace cmft
 
         case TextureFormat::RGB8:
             {
-                uint8_t* dst = (uint8_t*)dstData;
+                uint8_t* dst = (uint8_t*)_dst;
 
                 for (;src < end; src+=4, dst+=3)
                 {
@@ -1879,7 +2411,7 @@ namespace cmft
 
         case TextureFormat::RGB16:
             {
-                uint16_t* dst = (uint16_t*)dstData;
+                uint16_t* dst = (uint16_t*)_dst;
 
                 for (;src < end; src+=4, dst+=3)
                 {
@@ -1890,7 +2422,7 @@ namespace cmft
 
         case TextureFormat::RGB16F:
             {
-                uint16_t* dst = (uint16_t*)dstData;
+                uint16_t* dst = (uint16_t*)_dst;
 
                 for (;src < end; src+=4, dst+=3)
                 {
@@ -1901,7 +2433,7 @@ namespace cmft
 
         case TextureFormat::RGB32F:
             {
-                float* dst = (float*)dstData;
+                float* dst = (float*)_dst;
 
                 for (;src < end; src+=4, dst+=3)
                 {
@@ -1912,7 +2444,7 @@ namespace cmft
 
         case TextureFormat::RGBE:
             {
-                uint8_t* dst = (uint8_t*)dstData;
+                uint8_t* dst = (uint8_t*)_dst;
 
                 for (;src < end; src+=4, dst+=4)
                 {
@@ -1923,7 +2455,7 @@ namespace cmft
 
         case TextureFormat::BGRA8:
             {
-                uint8_t* dst = (uint8_t*)dstData;
+                uint8_t* dst = (uint8_t*)_dst;
 
                 for (;src < end; src+=4, dst+=4)
                 {
@@ -1934,7 +2466,7 @@ namespace cmft
 
         case TextureFormat::RGBA8:
             {
-                uint8_t* dst = (uint8_t*)dstData;
+                uint8_t* dst = (uint8_t*)_dst;
 
                 for (;src < end; src+=4, dst+=4)
                 {
@@ -1945,7 +2477,7 @@ namespace cmft
 
         case TextureFormat::RGBA16:
             {
-                uint16_t* dst = (uint16_t*)dstData;
+                uint16_t* dst = (uint16_t*)_dst;
 
                 for (;src < end; src+=4, dst+=4)
                 {
@@ -1956,7 +2488,7 @@ namespace cmft
 
         case TextureFormat::RGBA16F:
             {
-                uint16_t* dst = (uint16_t*)dstData;
+                uint16_t* dst = (uint16_t*)_dst;
 
                 for (;src < end; src+=4, dst+=4)
                 {
@@ -1967,7 +2499,7 @@ namespace cmft
 
         case TextureFormat::RGBA32F:
             {
-                float* dst = (float*)dstData;
+                float* dst = (float*)_dst;
 
                 for (;src < end; src+=4, dst+=4)
                 {
@@ -1982,6 +2514,51 @@ namespace cmft
             }
         break;
         };
+    }
+
+    struct FromRgba32fTask
+    {
+        uint8_t* m_dst;
+        const float* m_src;
+        uint32_t m_numPixels;
+        uint32_t m_dstBytesPerPixel;
+        TextureFormat::Enum m_dstFormat;
+        BulkFromRgba32fFn m_bulk;
+    };
+
+    static void fromRgba32fTask(void* _task, uint32_t _index)
+    {
+        const FromRgba32fTask* task = (const FromRgba32fTask*)_task;
+
+        const uint32_t begin = _index*CMFT_CONVERT_TASK_PIXELS;
+        const uint32_t count = CMFT_MIN(task->m_numPixels - begin, uint32_t(CMFT_CONVERT_TASK_PIXELS));
+        uint8_t* dst = task->m_dst + begin*task->m_dstBytesPerPixel;
+        const float* src = task->m_src + begin*4;
+
+        const uint32_t done = (NULL != task->m_bulk) ? task->m_bulk(dst, src, count) : 0;
+        pixelsFromRgba32f(dst + done*task->m_dstBytesPerPixel, src + done*4, count - done, task->m_dstFormat);
+    }
+
+    void imageFromRgba32f(Image& _dst, TextureFormat::Enum _dstFormat, const Image& _src, AllocatorI* _allocator)
+    {
+        DEBUG_CHECK(TextureFormat::RGBA32F == _src.m_format, "Source image is not in RGBA32F format!");
+
+        // Alloc dst data.
+        const uint32_t pixelCount = imageGetNumPixels(_src);
+        const uint8_t dstBytesPerPixel = getImageDataInfo(_dstFormat).m_bytesPerPixel;
+        const uint32_t dstDataSize = pixelCount*dstBytesPerPixel;
+        void* dstData = CMFT_ALLOC(_allocator, dstDataSize);
+        MALLOC_CHECK(dstData);
+
+        // Convert pixels in parallel.
+        FromRgba32fTask task;
+        task.m_dst = (uint8_t*)dstData;
+        task.m_src = (const float*)_src.m_data;
+        task.m_numPixels = pixelCount;
+        task.m_dstBytesPerPixel = dstBytesPerPixel;
+        task.m_dstFormat = _dstFormat;
+        task.m_bulk = bulkFromRgba32f(_dstFormat);
+        threadPoolRun(fromRgba32fTask, &task, (pixelCount + CMFT_CONVERT_TASK_PIXELS-1)/CMFT_CONVERT_TASK_PIXELS);
 
         // Fill image structure.
         Image result;
@@ -2111,6 +2688,62 @@ namespace cmft
         imageGetPixel(_out, _format, xx, yy, face, _mip, _image);
     }
 
+    struct ResizeTask
+    {
+        uint8_t* m_dstMipData;
+        uint32_t m_dstMipWidth;
+        uint32_t m_dstMipPitch;
+        const uint8_t* m_srcMipData;
+        uint32_t m_srcMipPitch;
+        float m_dstToSrcRatioXf;
+        float m_dstToSrcRatioYf;
+        uint32_t m_dstToSrcRatioX;
+        uint32_t m_dstToSrcRatioY;
+    };
+
+    // Fills a single row of the destination mip, _index is the row.
+    static void resizeTask(void* _task, uint32_t _index)
+    {
+        const ResizeTask* task = (const ResizeTask*)_task;
+        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+
+        const int32_t yDst = int32_t(_index);
+        uint8_t* dstFaceRow = task->m_dstMipData + yDst*task->m_dstMipPitch;
+
+        for (int32_t xDst = 0; xDst < int32_t(task->m_dstMipWidth); ++xDst)
+        {
+            float* dstFaceColumn = (float*)((uint8_t*)dstFaceRow + xDst*bytesPerPixel);
+
+            float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            uint32_t weight = 0;
+
+            uint32_t       ySrc    = cmft::ftou(float(yDst)*task->m_dstToSrcRatioYf);
+            uint32_t const ySrcEnd = ySrc + CMFT_MAX(1, task->m_dstToSrcRatioY);
+            for (; ySrc < ySrcEnd; ++ySrc)
+            {
+                const uint8_t* srcRowData = task->m_srcMipData + ySrc*task->m_srcMipPitch;
+
+                uint32_t       xSrc    = cmft::ftou(float(xDst)*task->m_dstToSrcRatioXf);
+                uint32_t const xSrcEnd = xSrc + CMFT_MAX(1, task->m_dstToSrcRatioX);
+                for (; xSrc < xSrcEnd; ++xSrc)
+                {
+                    const float* srcColumnData = (const float*)((const uint8_t*)srcRowData + xSrc*bytesPerPixel);
+                    color[0] += srcColumnData[0];
+                    color[1] += srcColumnData[1];
+                    color[2] += srcColumnData[2];
+                    color[3] += srcColumnData[3];
+                    weight++;
+                }
+            }
+
+            const float invWeight = 1.0f/cmft::utof(CMFT_MAX(weight, UINT32_C(1)));
+            dstFaceColumn[0] = color[0] * invWeight;
+            dstFaceColumn[1] = color[1] * invWeight;
+            dstFaceColumn[2] = color[2] * invWeight;
+            dstFaceColumn[3] = color[3] * invWeight;
+        }
+    }
+
     // Notice: this is the most trivial image resampling implementation. Use this only for testing/debugging purposes!
     void imageResize(Image& _dst, uint32_t _width, uint32_t _height, const Image& _src, AllocatorI* _allocator)
     {
@@ -2139,7 +2772,7 @@ namespace cmft
         uint32_t srcOffsets[CUBE_FACE_NUM][MAX_MIP_NUM];
         imageGetMipOffsets(srcOffsets, imageRgba32f);
 
-        // Resample.
+        // Resample, rows of each mip are processed on the thread pool.
         for (uint8_t face = 0; face < imageRgba32f.m_numFaces; ++face)
         {
             for (uint8_t mip = 0; mip < imageRgba32f.m_numMips; ++mip)
@@ -2147,57 +2780,21 @@ namespace cmft
                 const uint8_t  srcMip       = CMFT_MIN(mip, uint8_t(_src.m_numMips-1));
                 const uint32_t srcMipWidth  = CMFT_MAX(UINT32_C(1), imageRgba32f.m_width  >> srcMip);
                 const uint32_t srcMipHeight = CMFT_MAX(UINT32_C(1), imageRgba32f.m_height >> srcMip);
-                const uint32_t srcMipPitch  = srcMipWidth * bytesPerPixel;
-                const uint8_t* srcMipData   = (const uint8_t*)imageRgba32f.m_data + srcOffsets[face][srcMip];
 
                 const uint32_t dstMipWidth  = CMFT_MAX(UINT32_C(1), _width  >> mip);
                 const uint32_t dstMipHeight = CMFT_MAX(UINT32_C(1), _height >> mip);
-                const uint32_t dstMipPitch  = dstMipWidth * bytesPerPixel;
-
-                const float    dstToSrcRatioXf = cmft::utof(srcMipWidth) /cmft::utof(dstMipWidth);
-                const float    dstToSrcRatioYf = cmft::utof(srcMipHeight)/cmft::utof(dstMipHeight);
-                const uint32_t dstToSrcRatioX  = cmft::ftou(dstToSrcRatioXf);
-                const uint32_t dstToSrcRatioY  = cmft::ftou(dstToSrcRatioYf);
-
-                uint8_t* dstMipData = (uint8_t*)dstData + dstOffsets[face][mip];
-
-                for (int32_t yDst = 0; yDst < int32_t(dstMipHeight); ++yDst)
-                {
-                    uint8_t* dstFaceRow = (uint8_t*)dstMipData + yDst*dstMipPitch;
-
-                    for (int32_t xDst = 0; xDst < int32_t(dstMipWidth); ++xDst)
-                    {
-                        float* dstFaceColumn = (float*)((uint8_t*)dstFaceRow + xDst*bytesPerPixel);
 
-                        float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-                        uint32_t weight = 0;
-
-                        uint32_t       ySrc    = cmft::ftou(float(yDst)*dstToSrcRatioYf);
-                        uint32_t const ySrcEnd = ySrc + CMFT_MAX(1, dstToSrcRatioY);
-                        for (; ySrc < ySrcEnd; ++ySrc)
-                        {
-                            const uint8_t* srcRowData = (const uint8_t*)srcMipData + ySrc*srcMipPitch;
-
-                            uint32_t       xSrc    = cmft::ftou(float(xDst)*dstToSrcRatioXf);
-                            uint32_t const xSrcEnd = xSrc + CMFT_MAX(1, dstToSrcRatioX);
-                            for (; xSrc < xSrcEnd; ++xSrc)
-                            {
-                                const float* srcColumnData = (const float*)((const uint8_t*)srcRowData + xSrc*bytesPerPixel);
-                                color[0] += srcColumnData[0];
-                                color[1] += srcColumnData[1];
-                                color[2] += srcColumnData[2];
-                                color[3] += srcColumnData[3];
-                                weight++;
-                            }
-                        }
-
-                        const float invWeight = 1.0f/cmft::utof(CMFT_MAX(weight, UINT32_C(1)));
-                        dstFaceColumn[0] = color[0] * invWeight;
-                        dstFaceColumn[1] = color[1] * invWeight;
-                        dstFaceColumn[2] = color[2] * invWeight;
-                        dstFaceColumn[3] = color[3] * invWeight;
-                    }
-                }
+                ResizeTask task;
+                task.m_dstMipData      = (uint8_t*)dstData + dstOffsets[face][mip];
+                task.m_dstMipWidth     = dstMipWidth;
+                task.m_dstMipPitch     = dstMipWidth * bytesPerPixel;
+                task.m_srcMipData      = (const uint8_t*)imageRgba32f.m_data + srcOffsets[face][srcMip];
+                task.m_srcMipPitch     = srcMipWidth * bytesPerPixel;
+                task.m_dstToSrcRatioXf = cmft::utof(srcMipWidth) /cmft::utof(dstMipWidth);
+                task.m_dstToSrcRatioYf = cmft::utof(srcMipHeight)/cmft::utof(dstMipHeight);
+                task.m_dstToSrcRatioX  = cmft::ftou(task.m_dstToSrcRatioXf);
+                task.m_dstToSrcRatioY  = cmft::ftou(task.m_dstToSrcRatioYf);
+                threadPoolRun(resizeTask, &task, dstMipHeight);
             }
         }
 
@@ -2513,6 +3110,63 @@ namespace cmft
         }
     }
 
+    struct MipMapChainTask
+    {
+        uint8_t* m_dstMipData[CUBE_FACE_NUM];
+        const uint8_t* m_srcMipData[CUBE_FACE_NUM]; // Present mip to copy or parent mip to downsample.
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_parentPitch;
+        bool m_copy;
+    };
+
+    // Fills a single row of the mip, _index is face*height + row.
+    static void mipMapChainTask(void* _task, uint32_t _index)
+    {
+        const MipMapChainTask* task = (const MipMapChainTask*)_task;
+        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+
+        const uint8_t face = uint8_t(_index/task->m_height);
+        const uint32_t yy = _index%task->m_height;
+        const uint32_t pitch = task->m_width * bytesPerPixel;
+
+        uint8_t* dstRowData = task->m_dstMipData[face] + pitch*yy;
+
+        // If mip is present, copy data.
+        if (task->m_copy)
+        {
+            memcpy(dstRowData, task->m_srcMipData[face] + pitch*yy, pitch);
+            return;
+        }
+
+        // Else generate it.
+        const uint32_t parentPitch = task->m_parentPitch;
+        const uint8_t* parentMipData = task->m_srcMipData[face];
+        for (uint32_t xx = 0; xx < task->m_width; ++xx)
+        {
+            float* dstColumnData = (float*)((uint8_t*)dstRowData + xx*bytesPerPixel);
+
+            float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (uint32_t yParent = yy*2, yEnd = yParent+2; yParent < yEnd; ++yParent)
+            {
+                const uint8_t* parentRowData = (const uint8_t*)parentMipData + parentPitch*yParent;
+                for (uint32_t xParent = xx*2, xEnd = xParent+2; xParent < xEnd; ++xParent)
+                {
+                    const float* parentColumnData = (const float*)((const uint8_t*)parentRowData + xParent*bytesPerPixel);
+                    color[0] += parentColumnData[0];
+                    color[1] += parentColumnData[1];
+                    color[2] += parentColumnData[2];
+                    color[3] += parentColumnData[3];
+                }
+            }
+
+            dstColumnData[0] = color[0] * 0.25f;
+            dstColumnData[1] = color[1] * 0.25f;
+            dstColumnData[2] = color[2] * 0.25f;
+            dstColumnData[3] = color[3] * 0.25f;
+        }
+    }
+
     void imageGenerateMipMapChain(Image& _image, uint8_t _numMips, AllocatorI* _allocator)
     {
         // Processing is done in rgba32f format.
@@ -2548,65 +3202,26 @@ namespace cmft
         uint32_t srcOffsets[CUBE_FACE_NUM][MAX_MIP_NUM];
         imageGetMipOffsets(srcOffsets, imageRgba32f);
 
-        // Generate mip chain.
-        for (uint8_t face = 0; face < imageRgba32f.m_numFaces; ++face)
+        // Generate mip chain. Each mip is downsampled from its parent, so mips are processed in order,
+        // rows of all faces of a mip on the thread pool.
+        for (uint8_t mip = 0; mip < mipCount; ++mip)
         {
-            for (uint8_t mip = 0; mip < mipCount; ++mip)
-            {
-                const uint32_t width  = CMFT_MAX(UINT32_C(1), imageRgba32f.m_width  >> mip);
-                const uint32_t height = CMFT_MAX(UINT32_C(1), imageRgba32f.m_height >> mip);
-                const uint32_t pitch = width * bytesPerPixel;
-
-                uint8_t* dstMipData       = (uint8_t*)dstData                   + dstOffsets[face][mip];
-                const uint8_t* srcMipData = (const uint8_t*)imageRgba32f.m_data + srcOffsets[face][mip];
-
-                // If mip is present, copy data.
-                if (mip < imageRgba32f.m_numMips)
-                {
-                    for (uint32_t yy = 0; yy < height; ++yy)
-                    {
-                        uint8_t* dst       = (uint8_t*)dstMipData       + yy*pitch;
-                        const uint8_t* src = (const uint8_t*)srcMipData + yy*pitch;
-                        memcpy(dst, src, pitch);
-                    }
-                }
-                // Else generate it.
-                else
-                {
-                    const uint8_t parentMip = mip - 1;
-                    const uint32_t parentWidth = CMFT_MAX(UINT32_C(1), imageRgba32f.m_width >> parentMip);
-                    const uint32_t parentPitch = parentWidth * bytesPerPixel;
-                    const uint8_t* parentMipData = (const uint8_t*)dstData + dstOffsets[face][parentMip];
-
-                    for (uint32_t yy = 0; yy < height; ++yy)
-                    {
-                        uint8_t* dstRowData = (uint8_t*)dstMipData + pitch*yy;
-                        for (uint32_t xx = 0; xx < width; ++xx)
-                        {
-                            float* dstColumnData = (float*)((uint8_t*)dstRowData + xx*bytesPerPixel);
-
-                            float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-                            for (uint32_t yParent = yy*2, yEnd = yParent+2; yParent < yEnd; ++yParent)
-                            {
-                                const uint8_t* parentRowData = (const uint8_t*)parentMipData + parentPitch*yParent;
-                                for (uint32_t xParent = xx*2, xEnd = xParent+2; xParent < xEnd; ++xParent)
-                                {
-                                    const float* parentColumnData = (const float*)((const uint8_t*)parentRowData + xParent*bytesPerPixel);
-                                    color[0] += parentColumnData[0];
-                                    color[1] += parentColumnData[1];
-                                    color[2] += parentColumnData[2];
-                                    color[3] += parentColumnData[3];
-                                }
-                            }
+            MipMapChainTask task;
+            task.m_width       = CMFT_MAX(UINT32_C(1), imageRgba32f.m_width  >> mip);
+            task.m_height      = CMFT_MAX(UINT32_C(1), imageRgba32f.m_height >> mip);
+            task.m_copy        = (mip < imageRgba32f.m_numMips);
+            task.m_parentPitch = task.m_copy ? 0 : CMFT_MAX(UINT32_C(1), imageRgba32f.m_width >> (mip-1)) * bytesPerPixel;
 
-                            dstColumnData[0] = color[0] * 0.25f;
-                            dstColumnData[1] = color[1] * 0.25f;
-                            dstColumnData[2] = color[2] * 0.25f;
-                            dstColumnData[3] = color[3] * 0.25f;
-                        }
-                    }
-                }
+            for (uint8_t face = 0; face < imageRgba32f.m_numFaces; ++face)
+            {
+                task.m_dstMipData[face] = (uint8_t*)dstData + dstOffsets[face][mip];
+                task.m_srcMipData[face] = task.m_copy
+                                        ? (const uint8_t*)imageRgba32f.m_data + srcOffsets[face][mip]
+                                        : (const uint8_t*)dstData             + dstOffsets[face][mip-1]
+                                        ;
             }
+
+            threadPoolRun(mipMapChainTask, &task, task.m_height*imageRgba32f.m_numFaces);
         }
 
         // Fill image structure.
@@ -3127,6 +3742,104 @@ namespace cmft
         return false;
     }
 
+    struct CubemapFromLatLongTask
+    {
+        uint8_t* m_dstData;
+        uint32_t m_dstFaceSize;
+        uint32_t m_dstPitch;
+        float m_invDstFaceSizef;
+        const void* m_srcData;
+        uint32_t m_srcWidth;
+        uint32_t m_srcHeight;
+        uint32_t m_srcPitch;
+        float m_srcWidthMinusOne;
+        float m_srcHeightMinusOne;
+        bool m_useBilinearInterpolation;
+    };
+
+    // Fills a single row of the cubemap, _index is face*faceSize + row.
+    static void cubemapFromLatLongTask(void* _task, uint32_t _index)
+    {
+        const CubemapFromLatLongTask* task = (const CubemapFromLatLongTask*)_task;
+        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+
+        const uint8_t face = uint8_t(_index/task->m_dstFaceSize);
+        const uint32_t yy = _index%task->m_dstFaceSize;
+
+        uint8_t* dstRowData = task->m_dstData + (face*task->m_dstFaceSize + yy)*task->m_dstPitch;
+        for (uint32_t xx = 0; xx < task->m_dstFaceSize; ++xx)
+        {
+            float* dstColumnData = (float*)((uint8_t*)dstRowData + xx*bytesPerPixel);
+
+            // Cubemap (u,v) on current face.
+            const float uu = 2.0f*xx*task->m_invDstFaceSizef-1.0f;
+            const float vv = 2.0f*yy*task->m_invDstFaceSizef-1.0f;
+
+            // Get cubemap vector (x,y,z) from (u,v,faceIdx).
+            float vec[3];
+            texelCoordToVec(vec, uu, vv, face);
+
+            // Convert cubemap vector (x,y,z) to latlong (u,v).
+            float xSrcf;
+            float ySrcf;
+            latLongFromVec(xSrcf, ySrcf, vec);
+
+            // Convert from [0..1] to [0..(size-1)] range.
+            xSrcf *= task->m_srcWidthMinusOne;
+            ySrcf *= task->m_srcHeightMinusOne;
+
+            // Sample from latlong (u,v).
+            if (task->m_useBilinearInterpolation)
+            {
+                const uint32_t x0 = cmft::ftou(xSrcf);
+                const uint32_t y0 = cmft::ftou(ySrcf);
+                const uint32_t x1 = CMFT_MIN(x0+1, task->m_srcWidth-1);
+                const uint32_t y1 = CMFT_MIN(y0+1, task->m_srcHeight-1);
+
+                const float *src0 = (const float*)((const uint8_t*)task->m_srcData + y0*task->m_srcPitch + x0*bytesPerPixel);
+                const float *src1 = (const float*)((const uint8_t*)task->m_srcData + y0*task->m_srcPitch + x1*bytesPerPixel);
+                const float *src2 = (const float*)((const uint8_t*)task->m_srcData + y1*task->m_srcPitch + x0*bytesPerPixel);
+                const float *src3 = (const float*)((const uint8_t*)task->m_srcData + y1*task->m_srcPitch + x1*bytesPerPixel);
+
+                const float tx = xSrcf - float(int32_t(x0));
+                const float ty = ySrcf - float(int32_t(y0));
+                const float invTx = 1.0f - tx;
+                const float invTy = 1.0f - ty;
+
+                float p0[4];
+                float p1[4];
+                float p2[4];
+                float p3[4];
+                vec4Mul(p0, src0, invTx*invTy);
+                vec4Mul(p1, src1,    tx*invTy);
+                vec4Mul(p2, src2, invTx*   ty);
+                vec4Mul(p3, src3,    tx*   ty);
+
+                const float rr = p0[0] + p1[0] + p2[0] + p3[0];
+                const float gg = p0[1] + p1[1] + p2[1] + p3[1];
+                const float bb = p0[2] + p1[2] + p2[2] + p3[2];
+                const float aa = p0[3] + p1[3] + p2[3] + p3[3];
+
+                dstColumnData[0] = rr;
+                dstColumnData[1] = gg;
+                dstColumnData[2] = bb;
+                dstColumnData[3] = aa;
+            }
+            else
+            {
+                const uint32_t xSrc = cmft::ftou(xSrcf);
+                const uint32_t ySrc = cmft::ftou(ySrcf);
+                const float *src = (const float*)((const uint8_t*)task->m_srcData + ySrc*task->m_srcPitch + xSrc*bytesPerPixel);
+
+                dstColumnData[0] = src[0];
+                dstColumnData[1] = src[1];
+                dstColumnData[2] = src[2];
+                dstColumnData[3] = src[3];
+            }
+
+        }
+    }
+
     bool imageCubemapFromLatLong(Image& _dst, const Image& _src, bool _useBilinearInterpolation, AllocatorI* _allocator)
     {
         if (!imageIsLatLong(_src))
@@ -3153,86 +3866,20 @@ namespace cmft
         const uint32_t srcPitch = imageRgba32f.m_width * bytesPerPixel;
         const float invDstFaceSizef = 1.0f/float(dstFaceSize);
 
-        // Iterate over destination image (cubemap).
-        for (uint8_t face = 0; face < 6; ++face)
-        {
-            uint8_t* dstFaceData = (uint8_t*)dstData + face*dstFaceDataSize;
-            for (uint32_t yy = 0; yy < dstFaceSize; ++yy)
-            {
-                uint8_t* dstRowData = (uint8_t*)dstFaceData + yy*dstPitch;
-                for (uint32_t xx = 0; xx < dstFaceSize; ++xx)
-                {
-                    float* dstColumnData = (float*)((uint8_t*)dstRowData + xx*bytesPerPixel);
-
-                    // Cubemap (u,v) on current face.
-                    const float uu = 2.0f*xx*invDstFaceSizef-1.0f;
-                    const float vv = 2.0f*yy*invDstFaceSizef-1.0f;
-
-                    // Get cubemap vector (x,y,z) from (u,v,faceIdx).
-                    float vec[3];
-                    texelCoordToVec(vec, uu, vv, face);
-
-                    // Convert cubemap vector (x,y,z) to latlong (u,v).
-                    float xSrcf;
-                    float ySrcf;
-                    latLongFromVec(xSrcf, ySrcf, vec);
-
-                    // Convert from [0..1] to [0..(size-1)] range.
-                    xSrcf *= srcWidthMinusOne;
-                    ySrcf *= srcHeightMinusOne;
-
-                    // Sample from latlong (u,v).
-                    if (_useBilinearInterpolation)
-                    {
-                        const uint32_t x0 = cmft::ftou(xSrcf);
-                        const uint32_t y0 = cmft::ftou(ySrcf);
-                        const uint32_t x1 = CMFT_MIN(x0+1, imageRgba32f.m_width-1);
-                        const uint32_t y1 = CMFT_MIN(y0+1, imageRgba32f.m_height-1);
-
-                        const float *src0 = (const float*)((const uint8_t*)imageRgba32f.m_data + y0*srcPitch + x0*bytesPerPixel);
-                        const float *src1 = (const float*)((const uint8_t*)imageRgba32f.m_data + y0*srcPitch + x1*bytesPerPixel);
-                        const float *src2 = (const float*)((const uint8_t*)imageRgba32f.m_data + y1*srcPitch + x0*bytesPerPixel);
-                        const float *src3 = (const float*)((const uint8_t*)imageRgba32f.m_data + y1*srcPitch + x1*bytesPerPixel);
-
-                        const float tx = xSrcf - float(int32_t(x0));
-                        const float ty = ySrcf - float(int32_t(y0));
-                        const float invTx = 1.0f - tx;
-                        const float invTy = 1.0f - ty;
-
-                        float p0[4];
-                        float p1[4];
-                        float p2[4];
-                        float p3[4];
-                        vec4Mul(p0, src0, invTx*invTy);
-                        vec4Mul(p1, src1,    tx*invTy);
-                        vec4Mul(p2, src2, invTx*   ty);
-                        vec4Mul(p3, src3,    tx*   ty);
-
-                        const float rr = p0[0] + p1[0] + p2[0] + p3[0];
-                        const float gg = p0[1] + p1[1] + p2[1] + p3[1];
-                        const float bb = p0[2] + p1[2] + p2[2] + p3[2];
-                        const float aa = p0[3] + p1[3] + p2[3] + p3[3];
-
-                        dstColumnData[0] = rr;
-                        dstColumnData[1] = gg;
-                        dstColumnData[2] = bb;
-                        dstColumnData[3] = aa;
-                    }
-                    else
-                    {
-                        const uint32_t xSrc = cmft::ftou(xSrcf);
-                        const uint32_t ySrc = cmft::ftou(ySrcf);
-                        const float *src = (const float*)((const uint8_t*)imageRgba32f.m_data + ySrc*srcPitch + xSrc*bytesPerPixel);
-
-                        dstColumnData[0] = src[0];
-                        dstColumnData[1] = src[1];
-                        dstColumnData[2] = src[2];
-                        dstColumnData[3] = src[3];
-                    }
-
-                }
-            }
-        }
+        // Iterate over destination image (cubemap), one row per task.
+        CubemapFromLatLongTask task;
+        task.m_dstData = (uint8_t*)dstData;
+        task.m_dstFaceSize = dstFaceSize;
+        task.m_dstPitch = dstPitch;
+        task.m_invDstFaceSizef = invDstFaceSizef;
+        task.m_srcData = imageRgba32f.m_data;
+        task.m_srcWidth = imageRgba32f.m_width;
+        task.m_srcHeight = imageRgba32f.m_height;
+        task.m_srcPitch = srcPitch;
+        task.m_srcWidthMinusOne = srcWidthMinusOne;
+        task.m_srcHeightMinusOne = srcHeightMinusOne;
+        task.m_useBilinearInterpolation = _useBilinearInterpolation;
+        threadPoolRun(cubemapFromLatLongTask, &task, dstFaceSize*CUBE_FACE_NUM);
 
         // Fill image structure.
         Image result;
@@ -47,6 +47,42 @@ __constant float4 s_faceUvVectors[6][3] =
     }
 };
 
+#ifdef CMFT_PLANAR_LAYOUT
+    // Single channel images with x,y,z,solidAngle (or r,g,b) planes stacked vertically, _faceSize rows each.
+    static float4 readNormalSolidAngle(__read_only image2d_t _img, int2 _coord, int32_t _faceSize)
+    {
+        const int2 c1 = { _coord.x, _coord.y +   _faceSize };
+        const int2 c2 = { _coord.x, _coord.y + 2*_faceSize };
+        const int2 c3 = { _coord.x, _coord.y + 3*_faceSize };
+        return (float4)(read_imagef(_img, s_sampler, _coord).x
+                      , read_imagef(_img, s_sampler, c1).x
+                      , read_imagef(_img, s_sampler, c2).x
+                      , read_imagef(_img, s_sampler, c3).x
+                      );
+    }
+
+    static float4 readSrcData(__read_only image2d_t _img, int2 _coord, int32_t _faceSize)
+    {
+        const int2 c1 = { _coord.x, _coord.y +   _faceSize };
+        const int2 c2 = { _coord.x, _coord.y + 2*_faceSize };
+        return (float4)(read_imagef(_img, s_sampler, _coord).x
+                      , read_imagef(_img, s_sampler, c1).x
+                      , read_imagef(_img, s_sampler, c2).x
+                      , 1.0f
+                      );
+    }
+#else
+    static float4 readNormalSolidAngle(__read_only image2d_t _img, int2 _coord, int32_t _faceSize)
+    {
+        return read_imagef(_img, s_sampler, _coord);
+    }
+
+    static float4 readSrcData(__read_only image2d_t _img, int2 _coord, int32_t _faceSize)
+    {
+        return read_imagef(_img, s_sampler, _coord);
+    }
+#endif //CMFT_PLANAR_LAYOUT
+
 static float4 texelCoordToVecWarp(float _u, float _v, int8_t _faceIdx, float _warp)
 {
     #ifdef WARP_FIXUP
@@ -60,6 +96,29 @@ static float4 texelCoordToVecWarp(float _u, float _v, int8_t _faceIdx, float _wa
     return normalize(_u*aa + _v*bb + cc);
 }
 
+#ifdef CMFT_COMPUTED_NORMALS
+    // Texel direction and solid angle at texel center, same as TexelNormals::Computed in cpu kernels.
+    // _srcWarp is the warp fixup factor of the source face size.
+    static float4 computeNormalSolidAngle(int2 _coord, int8_t _faceIdx, float _srcFaceSize, float _srcWarp)
+    {
+        const float invFaceSize = 1.0f/_srcFaceSize;
+        const float step = 2.0f*invFaceSize;
+        const float offset = invFaceSize - 1.0f;
+        const float uu = (float)_coord.x*step + offset;
+        const float vv = (float)_coord.y*step + offset;
+
+        float4 normal = texelCoordToVecWarp(uu, vv, _faceIdx, _srcWarp);
+
+        const float invArea = rsqrt(uu*uu + vv*vv + 1.0f);
+        normal.w = step*step*invArea*invArea*invArea;
+        return normal;
+    }
+
+    #define READ_NORMAL_SOLID_ANGLE(_img, _coord, _faceIdx) computeNormalSolidAngle(_coord, _faceIdx, _srcFaceSize, _srcWarp)
+#else
+    #define READ_NORMAL_SOLID_ANGLE(_img, _coord, _faceIdx) readNormalSolidAngle(_img, _coord, srcFaceSize)
+#endif //CMFT_COMPUTED_NORMALS
+
 #if !CMFT_COMPUTE_FILTER_AREA_ON_CPU
     static void aabbAdd(float4* _aabb, float _x, float _y)
     {
@@ -285,6 +344,7 @@ __kernel void radianceFilterSingleFace(__write_only image2d_t _out
                                      #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
                                      , __read_only image2d_t _area
                                      #endif //!CMFT_COMPUTE_FILTER_AREA_ON_CPU
+                                     , float _srcWarp
                                      )
 {
 
@@ -315,6 +375,7 @@ __kernel void radianceFilterSingleFace(__write_only image2d_t _out
     const float4 area = filterArea[_dstFaceId];
 #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
 
+    const int32_t srcFaceSize = (int32_t)_srcFaceSize;
     const int4 minmax = convert_int4(area*_srcFaceSize);
     const int32_t minX = minmax.x;
     const int32_t minY = minmax.y;
@@ -326,11 +387,11 @@ __kernel void radianceFilterSingleFace(__write_only image2d_t _out
         for (int32_t xx = minX; xx < maxX; ++xx)
         {
             const int2 coord = { xx, yy };
-            const float4 normal = read_imagef(_normalSolidAngle, s_sampler, coord);
+            const float4 normal = READ_NORMAL_SOLID_ANGLE(_normalSolidAngle, coord, _dstFaceId);
             const float dp = dot(normal, tapVec);
             if (dp >= _specularAngle)
             {
-                float4 sample = read_imagef(_srcData, s_sampler, coord);
+                float4 sample = readSrcData(_srcData, coord, srcFaceSize);
                 sample.w = 1.0f;
                 colorWeight += sample
                              * normal.w
@@ -395,6 +456,7 @@ __kernel void radianceFilter(__write_only image2d_t _out
                            #if CMFT_COMPUTE_FILTER_AREA_ON_CPU
                            , __read_only image2d_t _area
                            #endif //!CMFT_COMPUTE_FILTER_AREA_ON_CPU
+                           , float _srcWarp
                            )
 {
     const int xx = get_global_id(1);
@@ -423,33 +485,35 @@ __kernel void radianceFilter(__write_only image2d_t _out
     #define FLOAT4_AREA(_face) const float4 area = filterArea[_face];
 #endif //CMFT_COMPUTE_FILTER_AREA_ON_CPU
 
-    #define PROCESS_FACE(_ii)                                                                  \
-    {                                                                                          \
-        FLOAT4_AREA(_ii)                                                                       \
-                                                                                               \
-        const int4 minmax = convert_int4(area*_srcFaceSize);                                   \
-        const int32_t minX = minmax.x;                                                         \
-        const int32_t minY = minmax.y;                                                         \
-        const int32_t maxX = minmax.z;                                                         \
-        const int32_t maxY = minmax.w;                                                         \
-                                                                                               \
-        for (int32_t yy = minY; yy < maxY; ++yy)                                               \
-        {                                                                                      \
-            for (int32_t xx = minX; xx < maxX; ++xx)                                           \
-            {                                                                                  \
-                const int2 coord = { xx, yy };                                                 \
-                const float4 normal = read_imagef(_normalSolidAngle ## _ii, s_sampler, coord); \
-                const float dp = dot(normal, tapVec);                                          \
-                if (dp >= _specularAngle)                                                      \
-                {                                                                              \
-                    float4 sample = read_imagef(_srcData ## _ii, s_sampler, coord);            \
-                    sample.w = 1.0f;                                                           \
-                    colorWeight += sample                                                      \
-                                 * normal.w                                                    \
-                                 * native_powr(dp, _specularPower);                            \
-                }                                                                              \
-            }                                                                                  \
-        }                                                                                      \
+    const int32_t srcFaceSize = (int32_t)_srcFaceSize;
+
+    #define PROCESS_FACE(_ii)                                                                             \
+    {                                                                                                     \
+        FLOAT4_AREA(_ii)                                                                                  \
+                                                                                                          \
+        const int4 minmax = convert_int4(area*_srcFaceSize);                                              \
+        const int32_t minX = minmax.x;                                                                    \
+        const int32_t minY = minmax.y;                                                                    \
+        const int32_t maxX = minmax.z;                                                                    \
+        const int32_t maxY = minmax.w;                                                                    \
+                                                                                                          \
+        for (int32_t yy = minY; yy < maxY; ++yy)                                                          \
+        {                                                                                                 \
+            for (int32_t xx = minX; xx < maxX; ++xx)                                                      \
+            {                                                                                             \
+                const int2 coord = { xx, yy };                                                            \
+                const float4 normal = READ_NORMAL_SOLID_ANGLE(_normalSolidAngle ## _ii, coord, _ii);      \
+                const float dp = dot(normal, tapVec);                                                     \
+                if (dp >= _specularAngle)                                                                 \
+                {                                                                                         \
+                    float4 sample = readSrcData(_srcData ## _ii, coord, srcFaceSize);                     \
+                    sample.w = 1.0f;                                                                      \
+                    colorWeight += sample                                                                 \
+                                 * normal.w                                                               \
+                                 * native_powr(dp, _specularPower);                                       \
+                }                                                                                         \
+            }                                                                                             \
+        }                                                                                                 \
     }
 
     PROCESS_FACE(0);
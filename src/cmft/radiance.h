@@ -1,4 +1,4 @@
-static const uint8_t sc_radianceSource[17634] =
+static const uint8_t sc_radianceSource[20731] =
 {
 	0x2f, 0x2a, 0x0a, 0x20, 0x2a, 0x20, 0x43, 0x6f, 0x70, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, // /*. * Copyright
 	0x32, 0x30, 0x31, 0x34, 0x2d, 0x32, 0x30, 0x31, 0x35, 0x20, 0x44, 0x61, 0x72, 0x69, 0x6f, 0x20, // 2014-2015 Dario
@@ -93,31 +93,192 @@ static const uint8_t sc_radianceSource[17634] =
 	0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x2d, 0x31, 0x2e, // 0.0f,  0.0f, -1.
 	0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x20, 0x2f, 0x2f, 0x20, 0x2d, // 0f, 0.0f }, // -
 	0x7a, 0x20, 0x66, 0x61, 0x63, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x7d, 0x3b, 0x0a, // z face.    }.};.
-	0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x74, // .static float4 t
-	0x65, 0x78, 0x65, 0x6c, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x54, 0x6f, 0x56, 0x65, 0x63, 0x57, 0x61, // exelCoordToVecWa
-	0x72, 0x70, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x75, 0x2c, 0x20, 0x66, 0x6c, 0x6f, // rp(float _u, flo
-	0x61, 0x74, 0x20, 0x5f, 0x76, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x38, 0x5f, 0x74, 0x20, 0x5f, 0x66, // at _v, int8_t _f
-	0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x77, // aceIdx, float _w
-	0x61, 0x72, 0x70, 0x29, 0x0a, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x69, 0x66, 0x64, 0x65, // arp).{.    #ifde
-	0x66, 0x20, 0x57, 0x41, 0x52, 0x50, 0x5f, 0x46, 0x49, 0x58, 0x55, 0x50, 0x0a, 0x20, 0x20, 0x20, // f WARP_FIXUP.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x5f, 0x75, 0x20, 0x3d, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x2a, //      _u = _warp*
-	0x28, 0x5f, 0x75, 0x2a, 0x5f, 0x75, 0x2a, 0x5f, 0x75, 0x29, 0x20, 0x2b, 0x20, 0x5f, 0x75, 0x3b, // (_u*_u*_u) + _u;
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5f, 0x76, 0x20, 0x3d, 0x20, 0x5f, 0x77, // .        _v = _w
-	0x61, 0x72, 0x70, 0x2a, 0x28, 0x5f, 0x76, 0x2a, 0x5f, 0x76, 0x2a, 0x5f, 0x76, 0x29, 0x20, 0x2b, // arp*(_v*_v*_v) +
-	0x20, 0x5f, 0x76, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, //  _v;.    #endif
-	0x2f, 0x2f, 0x57, 0x41, 0x52, 0x50, 0x5f, 0x46, 0x49, 0x58, 0x55, 0x50, 0x0a, 0x0a, 0x20, 0x20, // //WARP_FIXUP..
-	0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x61, 0x20, 0x3d, 0x20, 0x73, 0x5f, //   float4 aa = s_
-	0x66, 0x61, 0x63, 0x65, 0x55, 0x76, 0x56, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x73, 0x5b, 0x5f, 0x66, // faceUvVectors[_f
-	0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x5d, 0x5b, 0x30, 0x5d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // aceIdx][0];.
-	0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x62, 0x62, 0x20, 0x3d, 0x20, 0x73, 0x5f, 0x66, 0x61, // float4 bb = s_fa
-	0x63, 0x65, 0x55, 0x76, 0x56, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x73, 0x5b, 0x5f, 0x66, 0x61, 0x63, // ceUvVectors[_fac
-	0x65, 0x49, 0x64, 0x78, 0x5d, 0x5b, 0x31, 0x5d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, // eIdx][1];.    fl
-	0x6f, 0x61, 0x74, 0x34, 0x20, 0x63, 0x63, 0x20, 0x3d, 0x20, 0x73, 0x5f, 0x66, 0x61, 0x63, 0x65, // oat4 cc = s_face
-	0x55, 0x76, 0x56, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x73, 0x5b, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, // UvVectors[_faceI
-	0x64, 0x78, 0x5d, 0x5b, 0x32, 0x5d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, // dx][2];.    retu
-	0x72, 0x6e, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x69, 0x7a, 0x65, 0x28, 0x5f, 0x75, 0x2a, // rn normalize(_u*
-	0x61, 0x61, 0x20, 0x2b, 0x20, 0x5f, 0x76, 0x2a, 0x62, 0x62, 0x20, 0x2b, 0x20, 0x63, 0x63, 0x29, // aa + _v*bb + cc)
-	0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x21, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, // ;.}..#if !CMFT_C
+	0x0a, 0x23, 0x69, 0x66, 0x64, 0x65, 0x66, 0x20, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x50, 0x4c, 0x41, // .#ifdef CMFT_PLA
+	0x4e, 0x41, 0x52, 0x5f, 0x4c, 0x41, 0x59, 0x4f, 0x55, 0x54, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, // NAR_LAYOUT.    /
+	0x2f, 0x20, 0x53, 0x69, 0x6e, 0x67, 0x6c, 0x65, 0x20, 0x63, 0x68, 0x61, 0x6e, 0x6e, 0x65, 0x6c, // / Single channel
+	0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x73, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x78, 0x2c, 0x79, //  images with x,y
+	0x2c, 0x7a, 0x2c, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x20, 0x28, 0x6f, // ,z,solidAngle (o
+	0x72, 0x20, 0x72, 0x2c, 0x67, 0x2c, 0x62, 0x29, 0x20, 0x70, 0x6c, 0x61, 0x6e, 0x65, 0x73, 0x20, // r r,g,b) planes
+	0x73, 0x74, 0x61, 0x63, 0x6b, 0x65, 0x64, 0x20, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x61, 0x6c, // stacked vertical
+	0x6c, 0x79, 0x2c, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x20, 0x72, 0x6f, // ly, _faceSize ro
+	0x77, 0x73, 0x20, 0x65, 0x61, 0x63, 0x68, 0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x61, // ws each..    sta
+	0x74, 0x69, 0x63, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x72, 0x65, 0x61, 0x64, 0x4e, // tic float4 readN
+	0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x28, // ormalSolidAngle(
+	0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, // __read_only imag
+	0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x32, // e2d_t _img, int2
+	0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, //  _coord, int32_t
+	0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, //  _faceSize).
+	0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, // {.        const
+	0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x31, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x5f, 0x63, 0x6f, 0x6f, // int2 c1 = { _coo
+	0x72, 0x64, 0x2e, 0x78, 0x2c, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x20, 0x2b, // rd.x, _coord.y +
+	0x20, 0x20, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x20, 0x7d, 0x3b, 0x0a, //    _faceSize };.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, //         const in
+	0x74, 0x32, 0x20, 0x63, 0x32, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, // t2 c2 = { _coord
+	0x2e, 0x78, 0x2c, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x20, 0x2b, 0x20, 0x32, // .x, _coord.y + 2
+	0x2a, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, // *_faceSize };.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, //       const int2
+	0x20, 0x63, 0x33, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x78, //  c3 = { _coord.x
+	0x2c, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x20, 0x2b, 0x20, 0x33, 0x2a, 0x5f, // , _coord.y + 3*_
+	0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // faceSize };.
+	0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x28, 0x66, 0x6c, 0x6f, 0x61, //     return (floa
+	0x74, 0x34, 0x29, 0x28, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, // t4)(read_imagef(
+	0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, // _img, s_sampler,
+	0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x2e, 0x78, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, //  _coord).x.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x2c, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, //  , read_imagef(_
+	0x69, 0x6d, 0x67, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, // img, s_sampler,
+	0x63, 0x31, 0x29, 0x2e, 0x78, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // c1).x.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x72, 0x65, //             , re
+	0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, // ad_imagef(_img,
+	0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x32, 0x29, 0x2e, 0x78, // s_sampler, c2).x
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, //        , read_im
+	0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, // agef(_img, s_sam
+	0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x33, 0x29, 0x2e, 0x78, 0x0a, 0x20, 0x20, 0x20, 0x20, // pler, c3).x.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, //   );.    }..
+	0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x72, 0x65, // static float4 re
+	0x61, 0x64, 0x53, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x28, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, // adSrcData(__read
+	0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, // _only image2d_t
+	0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, // _img, int2 _coor
+	0x64, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, // d, int32_t _face
+	0x53, 0x69, 0x7a, 0x65, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, // Size).    {.
+	0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, //     const int2 c
+	0x31, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x78, 0x2c, 0x20, // 1 = { _coord.x,
+	0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x20, 0x2b, 0x20, 0x20, 0x20, 0x5f, 0x66, 0x61, // _coord.y +   _fa
+	0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ceSize };.
+	0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x32, 0x20, //   const int2 c2
+	0x3d, 0x20, 0x7b, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x78, 0x2c, 0x20, 0x5f, 0x63, // = { _coord.x, _c
+	0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x20, 0x2b, 0x20, 0x32, 0x2a, 0x5f, 0x66, 0x61, 0x63, 0x65, // oord.y + 2*_face
+	0x53, 0x69, 0x7a, 0x65, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // Size };.
+	0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x29, 0x28, // return (float4)(
+	0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x69, 0x6d, 0x67, // read_imagef(_img
+	0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x5f, 0x63, 0x6f, // , s_sampler, _co
+	0x6f, 0x72, 0x64, 0x29, 0x2e, 0x78, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ord).x.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x72, //              , r
+	0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, // ead_imagef(_img,
+	0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x31, 0x29, 0x2e, //  s_sampler, c1).
+	0x78, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // x.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, //         , read_i
+	0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, // magef(_img, s_sa
+	0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x32, 0x29, 0x2e, 0x78, 0x0a, 0x20, 0x20, 0x20, // mpler, c2).x.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //    , 1.0f.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0a, 0x20, // );.    }.#else.
+	0x20, 0x20, 0x20, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, //    static float4
+	0x20, 0x72, 0x65, 0x61, 0x64, 0x4e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, //  readNormalSolid
+	0x41, 0x6e, 0x67, 0x6c, 0x65, 0x28, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, // Angle(__read_onl
+	0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x69, 0x6d, 0x67, // y image2d_t _img
+	0x2c, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x69, // , int2 _coord, i
+	0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, // nt32_t _faceSize
+	0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ).    {.
+	0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, // return read_imag
+	0x65, 0x66, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, // ef(_img, s_sampl
+	0x65, 0x72, 0x2c, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, // er, _coord);.
+	0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x66, //  }..    static f
+	0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x72, 0x65, 0x61, 0x64, 0x53, 0x72, 0x63, 0x44, 0x61, 0x74, // loat4 readSrcDat
+	0x61, 0x28, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, // a(__read_only im
+	0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x69, 0x6e, // age2d_t _img, in
+	0x74, 0x32, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, // t2 _coord, int32
+	0x5f, 0x74, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x0a, 0x20, 0x20, // _t _faceSize).
+	0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, //   {.        retu
+	0x72, 0x6e, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, // rn read_imagef(_
+	0x69, 0x6d, 0x67, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, // img, s_sampler,
+	0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x23, // _coord);.    }.#
+	0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2f, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x50, 0x4c, 0x41, // endif //CMFT_PLA
+	0x4e, 0x41, 0x52, 0x5f, 0x4c, 0x41, 0x59, 0x4f, 0x55, 0x54, 0x0a, 0x0a, 0x73, 0x74, 0x61, 0x74, // NAR_LAYOUT..stat
+	0x69, 0x63, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x43, // ic float4 texelC
+	0x6f, 0x6f, 0x72, 0x64, 0x54, 0x6f, 0x56, 0x65, 0x63, 0x57, 0x61, 0x72, 0x70, 0x28, 0x66, 0x6c, // oordToVecWarp(fl
+	0x6f, 0x61, 0x74, 0x20, 0x5f, 0x75, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x76, // oat _u, float _v
+	0x2c, 0x20, 0x69, 0x6e, 0x74, 0x38, 0x5f, 0x74, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, // , int8_t _faceId
+	0x78, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x29, 0x0a, // x, float _warp).
+	0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x69, 0x66, 0x64, 0x65, 0x66, 0x20, 0x57, 0x41, 0x52, // {.    #ifdef WAR
+	0x50, 0x5f, 0x46, 0x49, 0x58, 0x55, 0x50, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // P_FIXUP.
+	0x5f, 0x75, 0x20, 0x3d, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x2a, 0x28, 0x5f, 0x75, 0x2a, 0x5f, // _u = _warp*(_u*_
+	0x75, 0x2a, 0x5f, 0x75, 0x29, 0x20, 0x2b, 0x20, 0x5f, 0x75, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // u*_u) + _u;.
+	0x20, 0x20, 0x20, 0x20, 0x5f, 0x76, 0x20, 0x3d, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x2a, 0x28, //     _v = _warp*(
+	0x5f, 0x76, 0x2a, 0x5f, 0x76, 0x2a, 0x5f, 0x76, 0x29, 0x20, 0x2b, 0x20, 0x5f, 0x76, 0x3b, 0x0a, // _v*_v*_v) + _v;.
+	0x20, 0x20, 0x20, 0x20, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2f, 0x57, 0x41, 0x52, //     #endif //WAR
+	0x50, 0x5f, 0x46, 0x49, 0x58, 0x55, 0x50, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, // P_FIXUP..    flo
+	0x61, 0x74, 0x34, 0x20, 0x61, 0x61, 0x20, 0x3d, 0x20, 0x73, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x55, // at4 aa = s_faceU
+	0x76, 0x56, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x73, 0x5b, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, // vVectors[_faceId
+	0x78, 0x5d, 0x5b, 0x30, 0x5d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, // x][0];.    float
+	0x34, 0x20, 0x62, 0x62, 0x20, 0x3d, 0x20, 0x73, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x55, 0x76, 0x56, // 4 bb = s_faceUvV
+	0x65, 0x63, 0x74, 0x6f, 0x72, 0x73, 0x5b, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x5d, // ectors[_faceIdx]
+	0x5b, 0x31, 0x5d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, // [1];.    float4
+	0x63, 0x63, 0x20, 0x3d, 0x20, 0x73, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x55, 0x76, 0x56, 0x65, 0x63, // cc = s_faceUvVec
+	0x74, 0x6f, 0x72, 0x73, 0x5b, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x5d, 0x5b, 0x32, // tors[_faceIdx][2
+	0x5d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x6e, 0x6f, // ];.    return no
+	0x72, 0x6d, 0x61, 0x6c, 0x69, 0x7a, 0x65, 0x28, 0x5f, 0x75, 0x2a, 0x61, 0x61, 0x20, 0x2b, 0x20, // rmalize(_u*aa +
+	0x5f, 0x76, 0x2a, 0x62, 0x62, 0x20, 0x2b, 0x20, 0x63, 0x63, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, // _v*bb + cc);.}..
+	0x23, 0x69, 0x66, 0x64, 0x65, 0x66, 0x20, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, // #ifdef CMFT_COMP
+	0x55, 0x54, 0x45, 0x44, 0x5f, 0x4e, 0x4f, 0x52, 0x4d, 0x41, 0x4c, 0x53, 0x0a, 0x20, 0x20, 0x20, // UTED_NORMALS.
+	0x20, 0x2f, 0x2f, 0x20, 0x54, 0x65, 0x78, 0x65, 0x6c, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, //  // Texel direct
+	0x69, 0x6f, 0x6e, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20, 0x61, 0x6e, // ion and solid an
+	0x67, 0x6c, 0x65, 0x20, 0x61, 0x74, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x20, 0x63, 0x65, 0x6e, // gle at texel cen
+	0x74, 0x65, 0x72, 0x2c, 0x20, 0x73, 0x61, 0x6d, 0x65, 0x20, 0x61, 0x73, 0x20, 0x54, 0x65, 0x78, // ter, same as Tex
+	0x65, 0x6c, 0x4e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x73, 0x3a, 0x3a, 0x43, 0x6f, 0x6d, 0x70, 0x75, // elNormals::Compu
+	0x74, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x63, 0x70, 0x75, 0x20, 0x6b, 0x65, 0x72, 0x6e, 0x65, // ted in cpu kerne
+	0x6c, 0x73, 0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x57, // ls..    // _srcW
+	0x61, 0x72, 0x70, 0x20, 0x69, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x77, 0x61, 0x72, 0x70, 0x20, // arp is the warp
+	0x66, 0x69, 0x78, 0x75, 0x70, 0x20, 0x66, 0x61, 0x63, 0x74, 0x6f, 0x72, 0x20, 0x6f, 0x66, 0x20, // fixup factor of
+	0x74, 0x68, 0x65, 0x20, 0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x20, 0x66, 0x61, 0x63, 0x65, 0x20, // the source face
+	0x73, 0x69, 0x7a, 0x65, 0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, // size..    static
+	0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x75, 0x74, 0x65, 0x4e, //  float4 computeN
+	0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x28, // ormalSolidAngle(
+	0x69, 0x6e, 0x74, 0x32, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x69, 0x6e, 0x74, // int2 _coord, int
+	0x38, 0x5f, 0x74, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x66, 0x6c, // 8_t _faceIdx, fl
+	0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, // oat _srcFaceSize
+	0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x57, 0x61, 0x72, 0x70, // , float _srcWarp
+	0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ).    {.
+	0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x69, 0x6e, 0x76, 0x46, // const float invF
+	0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x20, 0x3d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x2f, 0x5f, // aceSize = 1.0f/_
+	0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, // srcFaceSize;.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, //      const float
+	0x20, 0x73, 0x74, 0x65, 0x70, 0x20, 0x3d, 0x20, 0x32, 0x2e, 0x30, 0x66, 0x2a, 0x69, 0x6e, 0x76, //  step = 2.0f*inv
+	0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // FaceSize;.
+	0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x6f, 0x66, //   const float of
+	0x66, 0x73, 0x65, 0x74, 0x20, 0x3d, 0x20, 0x69, 0x6e, 0x76, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, // fset = invFaceSi
+	0x7a, 0x65, 0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, // ze - 1.0f;.
+	0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x75, //    const float u
+	0x75, 0x20, 0x3d, 0x20, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x29, 0x5f, 0x63, 0x6f, 0x6f, 0x72, // u = (float)_coor
+	0x64, 0x2e, 0x78, 0x2a, 0x73, 0x74, 0x65, 0x70, 0x20, 0x2b, 0x20, 0x6f, 0x66, 0x66, 0x73, 0x65, // d.x*step + offse
+	0x74, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, // t;.        const
+	0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x76, 0x76, 0x20, 0x3d, 0x20, 0x28, 0x66, 0x6c, 0x6f, //  float vv = (flo
+	0x61, 0x74, 0x29, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x2a, 0x73, 0x74, 0x65, 0x70, // at)_coord.y*step
+	0x20, 0x2b, 0x20, 0x6f, 0x66, 0x66, 0x73, 0x65, 0x74, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, //  + offset;..
+	0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, //     float4 norma
+	0x6c, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x54, 0x6f, // l = texelCoordTo
+	0x56, 0x65, 0x63, 0x57, 0x61, 0x72, 0x70, 0x28, 0x75, 0x75, 0x2c, 0x20, 0x76, 0x76, 0x2c, 0x20, // VecWarp(uu, vv,
+	0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x57, 0x61, // _faceIdx, _srcWa
+	0x72, 0x70, 0x29, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, // rp);..        co
+	0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x69, 0x6e, 0x76, 0x41, 0x72, 0x65, // nst float invAre
+	0x61, 0x20, 0x3d, 0x20, 0x72, 0x73, 0x71, 0x72, 0x74, 0x28, 0x75, 0x75, 0x2a, 0x75, 0x75, 0x20, // a = rsqrt(uu*uu
+	0x2b, 0x20, 0x76, 0x76, 0x2a, 0x76, 0x76, 0x20, 0x2b, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x29, 0x3b, // + vv*vv + 1.0f);
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2e, // .        normal.
+	0x77, 0x20, 0x3d, 0x20, 0x73, 0x74, 0x65, 0x70, 0x2a, 0x73, 0x74, 0x65, 0x70, 0x2a, 0x69, 0x6e, // w = step*step*in
+	0x76, 0x41, 0x72, 0x65, 0x61, 0x2a, 0x69, 0x6e, 0x76, 0x41, 0x72, 0x65, 0x61, 0x2a, 0x69, 0x6e, // vArea*invArea*in
+	0x76, 0x41, 0x72, 0x65, 0x61, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x72, // vArea;.        r
+	0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x3b, 0x0a, 0x20, 0x20, // eturn normal;.
+	0x20, 0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, //   }..    #define
+	0x20, 0x52, 0x45, 0x41, 0x44, 0x5f, 0x4e, 0x4f, 0x52, 0x4d, 0x41, 0x4c, 0x5f, 0x53, 0x4f, 0x4c, //  READ_NORMAL_SOL
+	0x49, 0x44, 0x5f, 0x41, 0x4e, 0x47, 0x4c, 0x45, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, 0x5f, // ID_ANGLE(_img, _
+	0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x29, // coord, _faceIdx)
+	0x20, 0x63, 0x6f, 0x6d, 0x70, 0x75, 0x74, 0x65, 0x4e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, //  computeNormalSo
+	0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x28, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, // lidAngle(_coord,
+	0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, //  _faceIdx, _srcF
+	0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x57, 0x61, 0x72, // aceSize, _srcWar
+	0x70, 0x29, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x64, 0x65, // p).#else.    #de
+	0x66, 0x69, 0x6e, 0x65, 0x20, 0x52, 0x45, 0x41, 0x44, 0x5f, 0x4e, 0x4f, 0x52, 0x4d, 0x41, 0x4c, // fine READ_NORMAL
+	0x5f, 0x53, 0x4f, 0x4c, 0x49, 0x44, 0x5f, 0x41, 0x4e, 0x47, 0x4c, 0x45, 0x28, 0x5f, 0x69, 0x6d, // _SOLID_ANGLE(_im
+	0x67, 0x2c, 0x20, 0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, // g, _coord, _face
+	0x49, 0x64, 0x78, 0x29, 0x20, 0x72, 0x65, 0x61, 0x64, 0x4e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, // Idx) readNormalS
+	0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x28, 0x5f, 0x69, 0x6d, 0x67, 0x2c, 0x20, // olidAngle(_img,
+	0x5f, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, // _coord, srcFaceS
+	0x69, 0x7a, 0x65, 0x29, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2f, 0x43, 0x4d, // ize).#endif //CM
+	0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x44, 0x5f, 0x4e, 0x4f, 0x52, 0x4d, // FT_COMPUTED_NORM
+	0x41, 0x4c, 0x53, 0x0a, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x21, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, // ALS..#if !CMFT_C
 	0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, // OMPUTE_FILTER_AR
 	0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, // EA_ON_CPU.    st
 	0x61, 0x74, 0x69, 0x63, 0x20, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x61, 0x61, 0x62, 0x62, 0x41, 0x64, // atic void aabbAd
@@ -594,310 +755,316 @@ static const uint8_t sc_radianceSource[17634] =
 	0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, // LTER_AREA_ON_CPU
 	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0a, 0x7b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, //       ).{..    c
-	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x67, 0x65, // onst int xx = ge
-	0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, 0x31, 0x29, 0x3b, 0x0a, // t_global_id(1);.
-	0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x79, 0x79, //     const int yy
-	0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, //  = get_global_id
-	0x28, 0x30, 0x29, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, // (0);..    float4
-	0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x3d, 0x20, 0x7b, //  colorWeight = {
-	0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, //  0.0f, 0.0f, 0.0
-	0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, // f, 0.0f };..
-	0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x69, 0x6e, 0x76, 0x44, // const float invD
-	0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, // stFaceSize_Mul2
-	0x3d, 0x20, 0x32, 0x2e, 0x30, 0x66, 0x2f, 0x5f, 0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, // = 2.0f/_dstFaceS
-	0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, // ize;.    const f
-	0x6c, 0x6f, 0x61, 0x74, 0x20, 0x76, 0x76, 0x20, 0x3d, 0x20, 0x28, 0x28, 0x66, 0x6c, 0x6f, 0x61, // loat vv = ((floa
-	0x74, 0x29, 0x79, 0x79, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x35, 0x66, 0x29, 0x2a, 0x69, 0x6e, 0x76, // t)yy + 0.5f)*inv
-	0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, // DstFaceSize_Mul2
-	0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, //  - 1.0f;.    con
-	0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x75, 0x75, 0x20, 0x3d, 0x20, 0x28, 0x28, // st float uu = ((
-	0x66, 0x6c, 0x6f, 0x61, 0x74, 0x29, 0x78, 0x78, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x35, 0x66, 0x29, // float)xx + 0.5f)
-	0x2a, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, // *invDstFaceSize_
-	0x4d, 0x75, 0x6c, 0x32, 0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, // Mul2 - 1.0f;.
-	0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x74, 0x61, //  const float4 ta
-	0x70, 0x56, 0x65, 0x63, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x43, 0x6f, 0x6f, 0x72, // pVec = texelCoor
-	0x64, 0x54, 0x6f, 0x56, 0x65, 0x63, 0x57, 0x61, 0x72, 0x70, 0x28, 0x75, 0x75, 0x2c, 0x20, 0x76, // dToVecWarp(uu, v
-	0x76, 0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, // v, _srcFaceIdx,
-	0x5f, 0x77, 0x61, 0x72, 0x70, 0x29, 0x3b, 0x0a, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x43, 0x4d, 0x46, // _warp);..#if CMF
-	0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, // T_COMPUTE_FILTER
-	0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, // _AREA_ON_CPU.
-	0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x61, 0x72, 0x65, 0x61, //  const int2 area
-	0x43, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2a, 0x36, 0x20, 0x2b, // Coord = { xx*6 +
-	0x20, 0x5f, 0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x49, 0x64, 0x2c, 0x20, 0x79, 0x79, 0x20, //  _dstFaceId, yy
-	0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, // };.    const flo
-	0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, // at4 area = read_
-	0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x61, 0x72, 0x65, 0x61, 0x2c, 0x20, 0x73, 0x5f, // imagef(_area, s_
-	0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x61, 0x72, 0x65, 0x61, 0x43, 0x6f, 0x6f, // sampler, areaCoo
-	0x72, 0x64, 0x29, 0x3b, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, // rd);.#else.    f
-	0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, // loat4 filterArea
-	0x5b, 0x36, 0x5d, 0x20, 0x3d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, // [6] =.    {.
-	0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, //     { 0.0f, 0.0f
-	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, // , 0.0f, 0.0f },.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, //         { 0.0f,
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, //       , float _s
+	0x72, 0x63, 0x57, 0x61, 0x72, 0x70, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // rcWarp.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0a, 0x7b, 0x0a, //             ).{.
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x78, // .    const int x
+	0x78, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, // x = get_global_i
+	0x64, 0x28, 0x31, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, // d(1);.    const
+	0x69, 0x6e, 0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, // int yy = get_glo
+	0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, 0x30, 0x29, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, // bal_id(0);..
+	0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, // float4 colorWeig
+	0x68, 0x74, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, // ht = { 0.0f, 0.0
+	0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x3b, // f, 0.0f, 0.0f };
+	0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, // ..    const floa
+	0x74, 0x20, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, // t invDstFaceSize
+	0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x3d, 0x20, 0x32, 0x2e, 0x30, 0x66, 0x2f, 0x5f, 0x64, 0x73, // _Mul2 = 2.0f/_ds
+	0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, // tFaceSize;.    c
+	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x76, 0x76, 0x20, 0x3d, 0x20, // onst float vv =
+	0x28, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x29, 0x79, 0x79, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x35, // ((float)yy + 0.5
+	0x66, 0x29, 0x2a, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, // f)*invDstFaceSiz
+	0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, // e_Mul2 - 1.0f;.
+	0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x75, //    const float u
+	0x75, 0x20, 0x3d, 0x20, 0x28, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x29, 0x78, 0x78, 0x20, 0x2b, // u = ((float)xx +
+	0x20, 0x30, 0x2e, 0x35, 0x66, 0x29, 0x2a, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, //  0.5f)*invDstFac
+	0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, // eSize_Mul2 - 1.0
+	0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, // f;.    const flo
+	0x61, 0x74, 0x34, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, 0x63, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, // at4 tapVec = tex
+	0x65, 0x6c, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x54, 0x6f, 0x56, 0x65, 0x63, 0x57, 0x61, 0x72, 0x70, // elCoordToVecWarp
+	0x28, 0x75, 0x75, 0x2c, 0x20, 0x76, 0x76, 0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, // (uu, vv, _srcFac
+	0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x29, 0x3b, 0x0a, 0x0a, 0x23, // eIdx, _warp);..#
+	0x69, 0x66, 0x20, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, // if CMFT_COMPUTE_
+	0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, // FILTER_AREA_ON_C
+	0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, // PU.    const int
+	0x32, 0x20, 0x61, 0x72, 0x65, 0x61, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x7b, 0x20, // 2 areaCoord = {
+	0x78, 0x78, 0x2a, 0x36, 0x20, 0x2b, 0x20, 0x5f, 0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x49, // xx*6 + _dstFaceI
+	0x64, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, // d, yy };.    con
+	0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x3d, // st float4 area =
+	0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x61, 0x72, //  read_imagef(_ar
+	0x65, 0x61, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x61, // ea, s_sampler, a
+	0x72, 0x65, 0x61, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, // reaCoord);.#else
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x66, 0x69, 0x6c, 0x74, // .    float4 filt
+	0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x5b, 0x36, 0x5d, 0x20, 0x3d, 0x0a, 0x20, 0x20, 0x20, 0x20, // erArea[6] =.
+	0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, // {.        { 0.0f
+	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, // , 0.0f, 0.0f, 0.
+	0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, // 0f },.        {
 	0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, // 0.0f, 0.0f, 0.0f
-	0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, //  },.        { 0.
-	0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, // 0f, 0.0f, 0.0f,
-	0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // 0.0f },.
-	0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, // { 0.0f, 0.0f, 0.
-	0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, // 0f, 0.0f },.
-	0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, //     { 0.0f, 0.0f
-	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, // , 0.0f, 0.0f },.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, //         { 0.0f,
+	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // , 0.0f },.
+	0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, //   { 0.0f, 0.0f,
+	0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, // 0.0f, 0.0f },.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, //       { 0.0f, 0.
+	0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, // 0f, 0.0f, 0.0f }
+	0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, // ,.        { 0.0f
+	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, // , 0.0f, 0.0f, 0.
+	0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, // 0f },.        {
 	0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, // 0.0f, 0.0f, 0.0f
-	0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, //  },.    };.    d
-	0x65, 0x74, 0x65, 0x72, 0x6d, 0x69, 0x6e, 0x65, 0x46, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, // etermineFilterAr
-	0x65, 0x61, 0x28, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x2c, 0x20, 0x74, // ea(filterArea, t
-	0x61, 0x70, 0x56, 0x65, 0x63, 0x2c, 0x20, 0x5f, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x53, 0x69, // apVec, _filterSi
-	0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, // ze);.    const f
-	0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x3d, 0x20, 0x66, 0x69, 0x6c, // loat4 area = fil
-	0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x5b, 0x5f, 0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, // terArea[_dstFace
-	0x49, 0x64, 0x5d, 0x3b, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2f, 0x43, 0x4d, // Id];.#endif //CM
-	0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, // FT_COMPUTE_FILTE
-	0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, 0x0a, 0x0a, 0x20, // R_AREA_ON_CPU..
-	0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x34, 0x20, 0x6d, 0x69, //    const int4 mi
-	0x6e, 0x6d, 0x61, 0x78, 0x20, 0x3d, 0x20, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x5f, 0x69, // nmax = convert_i
-	0x6e, 0x74, 0x34, 0x28, 0x61, 0x72, 0x65, 0x61, 0x2a, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, // nt4(area*_srcFac
-	0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, // eSize);.    cons
-	0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, 0x58, 0x20, 0x3d, // t int32_t minX =
-	0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x78, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, //  minmax.x;.    c
-	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, // onst int32_t min
-	0x59, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x79, 0x3b, 0x0a, 0x20, 0x20, // Y = minmax.y;.
+	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x3b, // , 0.0f },.    };
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x65, 0x74, 0x65, 0x72, 0x6d, 0x69, 0x6e, 0x65, 0x46, 0x69, // .    determineFi
+	0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x28, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, // lterArea(filterA
+	0x72, 0x65, 0x61, 0x2c, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, 0x63, 0x2c, 0x20, 0x5f, 0x66, 0x69, // rea, tapVec, _fi
+	0x6c, 0x74, 0x65, 0x72, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, // lterSize);.    c
+	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, 0x61, // onst float4 area
+	0x20, 0x3d, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x5b, 0x5f, 0x64, //  = filterArea[_d
+	0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x49, 0x64, 0x5d, 0x3b, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, // stFaceId];.#endi
+	0x66, 0x20, 0x2f, 0x2f, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, // f //CMFT_COMPUTE
+	0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, // _FILTER_AREA_ON_
+	0x43, 0x50, 0x55, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, // CPU..    const i
+	0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, // nt32_t srcFaceSi
+	0x7a, 0x65, 0x20, 0x3d, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x29, 0x5f, 0x73, // ze = (int32_t)_s
+	0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // rcFaceSize;.
+	0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x34, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, // const int4 minma
+	0x78, 0x20, 0x3d, 0x20, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x5f, 0x69, 0x6e, 0x74, 0x34, // x = convert_int4
+	0x28, 0x61, 0x72, 0x65, 0x61, 0x2a, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, // (area*_srcFaceSi
+	0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, // ze);.    const i
+	0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, 0x58, 0x20, 0x3d, 0x20, 0x6d, 0x69, // nt32_t minX = mi
+	0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x78, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, // nmax.x;.    cons
+	0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, 0x59, 0x20, 0x3d, // t int32_t minY =
+	0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x79, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, //  minmax.y;.    c
+	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x61, 0x78, // onst int32_t max
+	0x58, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x7a, 0x3b, 0x0a, 0x20, 0x20, // X = minmax.z;.
 	0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, //   const int32_t
-	0x6d, 0x61, 0x78, 0x58, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x7a, 0x3b, // maxX = minmax.z;
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, // .    const int32
-	0x5f, 0x74, 0x20, 0x6d, 0x61, 0x78, 0x59, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, // _t maxY = minmax
-	0x2e, 0x77, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, // .w;..    for (in
-	0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x59, 0x3b, // t32_t yy = minY;
-	0x20, 0x79, 0x79, 0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, 0x59, 0x3b, 0x20, 0x2b, 0x2b, 0x79, 0x79, //  yy < maxY; ++yy
-	0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ).    {.
-	0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x78, 0x78, 0x20, // for (int32_t xx
-	0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x58, 0x3b, 0x20, 0x78, 0x78, 0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, // = minX; xx < max
-	0x58, 0x3b, 0x20, 0x2b, 0x2b, 0x78, 0x78, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // X; ++xx).
-	0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, //  {.            c
-	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, // onst int2 coord
-	0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, // = { xx, yy };.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, //           const
-	0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x20, 0x3d, 0x20, // float4 normal =
-	0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x6e, 0x6f, 0x72, // read_imagef(_nor
-	0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x2c, 0x20, 0x73, // malSolidAngle, s
-	0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, // _sampler, coord)
-	0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, // ;.            co
-	0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x64, 0x70, 0x20, 0x3d, 0x20, 0x64, // nst float dp = d
-	0x6f, 0x74, 0x28, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2c, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, // ot(normal, tapVe
-	0x63, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // c);.
-	0x69, 0x66, 0x20, 0x28, 0x64, 0x70, 0x20, 0x3e, 0x3d, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, // if (dp >= _specu
-	0x6c, 0x61, 0x72, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // larAngle).
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       {.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x73, //         float4 s
-	0x61, 0x6d, 0x70, 0x6c, 0x65, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, // ample = read_ima
-	0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x2c, 0x20, 0x73, 0x5f, // gef(_srcData, s_
-	0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, // sampler, coord);
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
-	0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x2e, 0x77, 0x20, 0x3d, 0x20, 0x31, 0x2e, 0x30, 0x66, //  sample.w = 1.0f
-	0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ;.
-	0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x2b, 0x3d, //   colorWeight +=
-	0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  sample.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2e, 0x77, 0x0a, //      * normal.w.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, //              * n
-	0x61, 0x74, 0x69, 0x76, 0x65, 0x5f, 0x70, 0x6f, 0x77, 0x72, 0x28, 0x64, 0x70, 0x2c, 0x20, 0x5f, // ative_powr(dp, _
-	0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, 0x61, 0x72, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x29, 0x3b, 0x0a, // specularPower);.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, //             }.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, 0x20, //       }.    }..
-	0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x64, 0x73, //    const int2 ds
-	0x74, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, // t = { xx, yy };.
-	0x20, 0x20, 0x20, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, //     write_imagef
-	0x28, 0x5f, 0x6f, 0x75, 0x74, 0x2c, 0x20, 0x64, 0x73, 0x74, 0x2c, 0x20, 0x63, 0x6f, 0x6c, 0x6f, // (_out, dst, colo
-	0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x5f, 0x5f, 0x6b, // rWeight);.}..__k
-	0x65, 0x72, 0x6e, 0x65, 0x6c, 0x20, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x73, 0x75, 0x6d, 0x28, 0x5f, // ernel void sum(_
-	0x5f, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, // _write_only imag
-	0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6f, 0x75, 0x74, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, // e2d_t _out.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, //            , __r
-	0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, // ead_only image2d
-	0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x30, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // _t _src0.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, //          , __rea
-	0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, // d_only image2d_t
-	0x20, 0x5f, 0x73, 0x72, 0x63, 0x31, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  _src1.
+	0x6d, 0x61, 0x78, 0x59, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x77, 0x3b, // maxY = minmax.w;
+	0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, // ..    for (int32
+	0x5f, 0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x59, 0x3b, 0x20, 0x79, 0x79, // _t yy = minY; yy
+	0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, 0x59, 0x3b, 0x20, 0x2b, 0x2b, 0x79, 0x79, 0x29, 0x0a, 0x20, //  < maxY; ++yy).
+	0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, //    {.        for
+	0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x6d, //  (int32_t xx = m
+	0x69, 0x6e, 0x58, 0x3b, 0x20, 0x78, 0x78, 0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, 0x58, 0x3b, 0x20, // inX; xx < maxX;
+	0x2b, 0x2b, 0x78, 0x78, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, // ++xx).        {.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, //             cons
+	0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x7b, // t int2 coord = {
+	0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, //  xx, yy };.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, //        const flo
+	0x61, 0x74, 0x34, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x20, 0x3d, 0x20, 0x52, 0x45, 0x41, // at4 normal = REA
+	0x44, 0x5f, 0x4e, 0x4f, 0x52, 0x4d, 0x41, 0x4c, 0x5f, 0x53, 0x4f, 0x4c, 0x49, 0x44, 0x5f, 0x41, // D_NORMAL_SOLID_A
+	0x4e, 0x47, 0x4c, 0x45, 0x28, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, // NGLE(_normalSoli
+	0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x5f, // dAngle, coord, _
+	0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x49, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // dstFaceId);.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, //         const fl
+	0x6f, 0x61, 0x74, 0x20, 0x64, 0x70, 0x20, 0x3d, 0x20, 0x64, 0x6f, 0x74, 0x28, 0x6e, 0x6f, 0x72, // oat dp = dot(nor
+	0x6d, 0x61, 0x6c, 0x2c, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, 0x63, 0x29, 0x3b, 0x0a, 0x20, 0x20, // mal, tapVec);.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x64, 0x70, //           if (dp
+	0x20, 0x3e, 0x3d, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, 0x61, 0x72, 0x41, 0x6e, 0x67, //  >= _specularAng
+	0x6c, 0x65, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // le).
+	0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // {.
+	0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x20, //   float4 sample
+	0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x53, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x28, 0x5f, 0x73, // = readSrcData(_s
+	0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x73, // rcData, coord, s
+	0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, // rcFaceSize);.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x73, 0x61, 0x6d, //              sam
+	0x70, 0x6c, 0x65, 0x2e, 0x77, 0x20, 0x3d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, // ple.w = 1.0f;.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, //               co
+	0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x2b, 0x3d, 0x20, 0x73, 0x61, 0x6d, // lorWeight += sam
+	0x70, 0x6c, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ple.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x2a, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2e, 0x77, 0x0a, 0x20, 0x20, 0x20, 0x20, //  * normal.w.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, 0x61, 0x74, 0x69, 0x76, //          * nativ
+	0x65, 0x5f, 0x70, 0x6f, 0x77, 0x72, 0x28, 0x64, 0x70, 0x2c, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, // e_powr(dp, _spec
+	0x75, 0x6c, 0x61, 0x72, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // ularPower);.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         }.
+	0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, //   }.    }..    c
+	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x64, 0x73, 0x74, 0x20, 0x3d, 0x20, // onst int2 dst =
+	0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // { xx, yy };.
+	0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x6f, 0x75, // write_imagef(_ou
+	0x74, 0x2c, 0x20, 0x64, 0x73, 0x74, 0x2c, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, // t, dst, colorWei
+	0x67, 0x68, 0x74, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x5f, 0x5f, 0x6b, 0x65, 0x72, 0x6e, 0x65, // ght);.}..__kerne
+	0x6c, 0x20, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x73, 0x75, 0x6d, 0x28, 0x5f, 0x5f, 0x77, 0x72, 0x69, // l void sum(__wri
+	0x74, 0x65, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, // te_only image2d_
+	0x74, 0x20, 0x5f, 0x6f, 0x75, 0x74, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // t _out.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, //        , __read_
 	0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, // only image2d_t _
-	0x73, 0x72, 0x63, 0x32, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // src2.
+	0x73, 0x72, 0x63, 0x30, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // src0.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, //      , __read_on
 	0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, // ly image2d_t _sr
-	0x63, 0x33, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // c3.
+	0x63, 0x31, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // c1.
 	0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, //    , __read_only
-	0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x34, //  image2d_t _src4
+	0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x32, //  image2d_t _src2
 	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
 	0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, //  , __read_only i
-	0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x35, 0x0a, 0x20, // mage2d_t _src5.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, //                )
-	0x0a, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, // .{.    const int
-	0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, //  xx = get_global
-	0x5f, 0x69, 0x64, 0x28, 0x31, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, // _id(1);.    cons
-	0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, // t int yy = get_g
-	0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, // lobal_id(0);.
-	0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x6f, 0x6f, 0x72, //  const int2 coor
-	0x64, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, // d = { xx, yy };.
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x6f, // .    float4 colo
-	0x72, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, // r = read_imagef(
-	0x5f, 0x73, 0x72, 0x63, 0x30, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, // _src0, s_sampler
-	0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // , coord).
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, //           + read
-	0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x31, 0x2c, 0x20, 0x73, // _imagef(_src1, s
-	0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, // _sampler, coord)
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
-	0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, //   + read_imagef(
-	0x5f, 0x73, 0x72, 0x63, 0x32, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, // _src2, s_sampler
-	0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // , coord).
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, //           + read
-	0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x33, 0x2c, 0x20, 0x73, // _imagef(_src3, s
-	0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, // _sampler, coord)
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
-	0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, //   + read_imagef(
-	0x5f, 0x73, 0x72, 0x63, 0x34, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, // _src4, s_sampler
-	0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // , coord).
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, //           + read
-	0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x35, 0x2c, 0x20, 0x73, // _imagef(_src5, s
-	0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, // _sampler, coord)
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
-	0x20, 0x20, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x30, 0x2e, 0x30, //   ;..    if (0.0
-	0x20, 0x21, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x77, 0x29, 0x0a, 0x20, 0x20, 0x20, //  != color.w).
-	0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, //  {.        color
-	0x20, 0x2f, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x77, 0x3b, 0x0a, 0x20, 0x20, 0x20, //  /= color.w;.
-	0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x69, 0x6d, //  }..    write_im
-	0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x6f, 0x75, 0x74, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, // agef(_out, coord
-	0x2c, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x5f, 0x5f, 0x6b, // , color);.}..__k
-	0x65, 0x72, 0x6e, 0x65, 0x6c, 0x20, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x72, 0x61, 0x64, 0x69, 0x61, // ernel void radia
-	0x6e, 0x63, 0x65, 0x46, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x28, 0x5f, 0x5f, 0x77, 0x72, 0x69, 0x74, // nceFilter(__writ
-	0x65, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, // e_only image2d_t
-	0x20, 0x5f, 0x6f, 0x75, 0x74, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  _out.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x2c, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x5f, 0x64, 0x73, 0x74, 0x46, //  , int32_t _dstF
-	0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // aceSize.
+	0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x33, 0x0a, 0x20, // mage2d_t _src3.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
+	0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, //  __read_only ima
+	0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x34, 0x0a, 0x20, 0x20, 0x20, // ge2d_t _src4.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, //              , _
+	0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, // _read_only image
+	0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x35, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, // 2d_t _src5.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0a, 0x7b, 0x0a, 0x20, //            ).{.
+	0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x78, 0x78, 0x20, //    const int xx
+	0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, // = get_global_id(
+	0x31, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, // 1);.    const in
+	0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, // t yy = get_globa
+	0x6c, 0x5f, 0x69, 0x64, 0x28, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, // l_id(0);.    con
+	0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, // st int2 coord =
+	0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, // { xx, yy };..
+	0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, //  float4 color =
+	0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, // read_imagef(_src
+	0x30, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, // 0, s_sampler, co
+	0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ord).
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, //       + read_ima
+	0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x31, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, // gef(_src1, s_sam
+	0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, // pler, coord).
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, //               +
+	0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, // read_imagef(_src
+	0x32, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, // 2, s_sampler, co
+	0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ord).
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, //       + read_ima
+	0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x33, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, // gef(_src3, s_sam
+	0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, // pler, coord).
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, //               +
+	0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, // read_imagef(_src
+	0x34, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, // 4, s_sampler, co
+	0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ord).
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, //       + read_ima
+	0x67, 0x65, 0x66, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x35, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, // gef(_src5, s_sam
+	0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a, 0x20, 0x20, 0x20, // pler, coord).
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3b, 0x0a, //               ;.
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x30, 0x2e, 0x30, 0x20, 0x21, 0x3d, 0x20, // .    if (0.0 !=
+	0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x77, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, // color.w).    {.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x2f, 0x3d, 0x20, //        color /=
+	0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x77, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, // color.w;.    }..
+	0x20, 0x20, 0x20, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, //     write_imagef
+	0x28, 0x5f, 0x6f, 0x75, 0x74, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x63, 0x6f, // (_out, coord, co
+	0x6c, 0x6f, 0x72, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x5f, 0x5f, 0x6b, 0x65, 0x72, 0x6e, 0x65, // lor);.}..__kerne
+	0x6c, 0x20, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x72, 0x61, 0x64, 0x69, 0x61, 0x6e, 0x63, 0x65, 0x46, // l void radianceF
+	0x69, 0x6c, 0x74, 0x65, 0x72, 0x28, 0x5f, 0x5f, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x6f, 0x6e, // ilter(__write_on
+	0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6f, 0x75, // ly image2d_t _ou
+	0x74, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // t.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x69, //              , i
+	0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x5f, 0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, // nt32_t _dstFaceS
+	0x69, 0x7a, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ize.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
+	0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, 0x61, 0x72, //  float _specular
+	0x50, 0x6f, 0x77, 0x65, 0x72, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // Power.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, //    , float _spec
-	0x75, 0x6c, 0x61, 0x72, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ularPower.
+	0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, //  , float _specul
+	0x61, 0x72, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // arAngle.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x70, //      , float _sp
-	0x65, 0x63, 0x75, 0x6c, 0x61, 0x72, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, // ecularAngle.
+	0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x66, 0x69, 0x6c, 0x74, //    , float _filt
+	0x65, 0x72, 0x53, 0x69, 0x7a, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // erSize.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, //        , float _
-	0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x53, 0x69, 0x7a, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, // filterSize.
+	0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x0a, //   , float _warp.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x77, //       , float _w
-	0x61, 0x72, 0x70, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // arp.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
-	0x20, 0x69, 0x6e, 0x74, 0x38, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, //  int8_t _srcFace
-	0x49, 0x64, 0x78, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // Idx.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
-	0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, //  float _srcFaceS
-	0x69, 0x7a, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ize.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
-	0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, //  __read_only ima
-	0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x30, // ge2d_t _srcData0
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, //             , __
-	0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, // read_only image2
-	0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x31, 0x0a, 0x20, 0x20, // d_t _srcData1.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x69, 0x6e, 0x74, //            , int
+	0x38, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x0a, // 8_t _srcFaceIdx.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, //          , __rea
-	0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, // d_only image2d_t
-	0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x32, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, //  _srcData2.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, //            , flo
+	0x61, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x0a, // at _srcFaceSize.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, //       , __read_o
-	0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, // nly image2d_t _s
-	0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x33, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // rcData3.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, //            , __r
+	0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, // ead_only image2d
+	0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x30, 0x0a, 0x20, 0x20, 0x20, // _t _srcData0.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, //    , __read_only
-	0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, //  image2d_t _srcD
-	0x61, 0x74, 0x61, 0x34, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ata4.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, //         , __read
+	0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, // _only image2d_t
+	0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x31, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // _srcData1.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, // , __read_only im
-	0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, // age2d_t _srcData
-	0x35, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // 5.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, //              , _
-	0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, // _read_only image
-	0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, // 2d_t _normalSoli
-	0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x30, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // dAngle0.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, //      , __read_on
+	0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, // ly image2d_t _sr
+	0x63, 0x44, 0x61, 0x74, 0x61, 0x32, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // cData2.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, //    , __read_only
-	0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, //  image2d_t _norm
-	0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x31, 0x0a, 0x20, 0x20, // alSolidAngle1.
+	0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, //   , __read_only
+	0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, // image2d_t _srcDa
+	0x74, 0x61, 0x33, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ta3.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
+	0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, //  __read_only ima
+	0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x34, // ge2d_t _srcData4
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, //             , __
+	0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, // read_only image2
+	0x64, 0x5f, 0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x35, 0x0a, 0x20, 0x20, // d_t _srcData5.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, //          , __rea
 	0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, // d_only image2d_t
 	0x20, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, //  _normalSolidAng
-	0x6c, 0x65, 0x32, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // le2.
+	0x6c, 0x65, 0x30, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // le0.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, //                ,
 	0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, //  __read_only ima
 	0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, // ge2d_t _normalSo
-	0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x33, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // lidAngle3.
+	0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x31, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // lidAngle1.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, //      , __read_on
 	0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6e, 0x6f, // ly image2d_t _no
-	0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x34, 0x0a, // rmalSolidAngle4.
+	0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x32, 0x0a, // rmalSolidAngle2.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, //            , __r
 	0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, // ead_only image2d
 	0x5f, 0x74, 0x20, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, // _t _normalSolidA
-	0x6e, 0x67, 0x6c, 0x65, 0x35, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ngle5.
+	0x6e, 0x67, 0x6c, 0x65, 0x33, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ngle3.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x23, 0x69, 0x66, 0x20, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, //  #if CMFT_COMPUT
-	0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, // E_FILTER_AREA_ON
-	0x5f, 0x43, 0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // _CPU.
+	0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, //  , __read_only i
+	0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, // mage2d_t _normal
+	0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x34, 0x0a, 0x20, 0x20, 0x20, 0x20, // SolidAngle4.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, // , __read_only im
-	0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, 0x61, 0x72, 0x65, 0x61, 0x0a, 0x20, 0x20, // age2d_t _area.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x5f, //        , __read_
+	0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, 0x64, 0x5f, 0x74, 0x20, 0x5f, // only image2d_t _
+	0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, // normalSolidAngle
+	0x35, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // 5.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x23, 0x69, 0x66, //              #if
+	0x20, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, //  CMFT_COMPUTE_FI
+	0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, // LTER_AREA_ON_CPU
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x5f, 0x5f, //             , __
+	0x72, 0x65, 0x61, 0x64, 0x5f, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x32, // read_only image2
+	0x64, 0x5f, 0x74, 0x20, 0x5f, 0x61, 0x72, 0x65, 0x61, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // d_t _area.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, //          #endif
-	0x2f, 0x2f, 0x21, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, // //!CMFT_COMPUTE_
-	0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, // FILTER_AREA_ON_C
-	0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // PU.
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0a, //               ).
-	0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, // {.    const int
-	0x78, 0x78, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, // xx = get_global_
-	0x69, 0x64, 0x28, 0x31, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, // id(1);.    const
-	0x20, 0x69, 0x6e, 0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, //  int yy = get_gl
-	0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, 0x30, 0x29, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, // obal_id(0);..
-	0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, //  float4 colorWei
-	0x67, 0x68, 0x74, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, // ght = { 0.0f, 0.
-	0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, // 0f, 0.0f, 0.0f }
-	0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, // ;..    const flo
-	0x61, 0x74, 0x20, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, // at invDstFaceSiz
-	0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x3d, 0x20, 0x32, 0x2e, 0x30, 0x66, 0x2f, 0x5f, 0x64, // e_Mul2 = 2.0f/_d
-	0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // stFaceSize;.
-	0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x76, 0x76, 0x20, 0x3d, // const float vv =
-	0x20, 0x28, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x29, 0x79, 0x79, 0x20, 0x2b, 0x20, 0x30, 0x2e, //  ((float)yy + 0.
-	0x35, 0x66, 0x29, 0x2a, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, // 5f)*invDstFaceSi
-	0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, // ze_Mul2 - 1.0f;.
-	0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, //     const float
-	0x75, 0x75, 0x20, 0x3d, 0x20, 0x28, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x29, 0x78, 0x78, 0x20, // uu = ((float)xx
-	0x2b, 0x20, 0x30, 0x2e, 0x35, 0x66, 0x29, 0x2a, 0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, // + 0.5f)*invDstFa
-	0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x2d, 0x20, 0x31, 0x2e, // ceSize_Mul2 - 1.
-	0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, // 0f;.    const fl
-	0x6f, 0x61, 0x74, 0x34, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, 0x63, 0x20, 0x3d, 0x20, 0x74, 0x65, // oat4 tapVec = te
-	0x78, 0x65, 0x6c, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x54, 0x6f, 0x56, 0x65, 0x63, 0x57, 0x61, 0x72, // xelCoordToVecWar
-	0x70, 0x28, 0x75, 0x75, 0x2c, 0x20, 0x76, 0x76, 0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, // p(uu, vv, _srcFa
-	0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x5f, 0x77, 0x61, 0x72, 0x70, 0x29, 0x3b, 0x0a, 0x0a, // ceIdx, _warp);..
-	0x23, 0x69, 0x66, 0x20, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, // #if CMFT_COMPUTE
-	0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, // _FILTER_AREA_ON_
-	0x43, 0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, // CPU.    #define
-	0x46, 0x4c, 0x4f, 0x41, 0x54, 0x34, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x28, 0x5f, 0x66, 0x61, 0x63, // FLOAT4_AREA(_fac
-	0x65, 0x29, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x61, 0x72, // e) const int2 ar
-	0x65, 0x61, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2a, 0x36, // eaCoord = { xx*6
-	0x20, 0x2b, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x20, //  + _face, yy };
-	0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, // const float4 are
-	0x61, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, // a = read_imagef(
-	0x5f, 0x61, 0x72, 0x65, 0x61, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, // _area, s_sampler
-	0x2c, 0x20, 0x61, 0x72, 0x65, 0x61, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x23, 0x65, // , areaCoord);.#e
-	0x6c, 0x73, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x66, // lse.    float4 f
-	0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x5b, 0x36, 0x5d, 0x20, 0x3d, 0x0a, 0x20, // ilterArea[6] =.
-	0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, //    {.        { 0
-	0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, // .0f, 0.0f, 0.0f,
-	0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  0.0f },.
-	0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, //  { 0.0f, 0.0f, 0
-	0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, // .0f, 0.0f },.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2f, 0x21, 0x43, //      #endif //!C
+	0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, // MFT_COMPUTE_FILT
+	0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, 0x0a, 0x20, // ER_AREA_ON_CPU.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x66, 0x6c, 0x6f, 0x61, //           , floa
+	0x74, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x57, 0x61, 0x72, 0x70, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, // t _srcWarp.
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0a, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, //       ).{.    co
+	0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, // nst int xx = get
+	0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, 0x31, 0x29, 0x3b, 0x0a, 0x20, // _global_id(1);.
+	0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x79, 0x79, 0x20, //    const int yy
+	0x3d, 0x20, 0x67, 0x65, 0x74, 0x5f, 0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x5f, 0x69, 0x64, 0x28, // = get_global_id(
+	0x30, 0x29, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, // 0);..    float4
+	0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x3d, 0x20, 0x7b, 0x20, // colorWeight = {
+	0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, // 0.0f, 0.0f, 0.0f
+	0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, // , 0.0f };..    c
+	0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x69, 0x6e, 0x76, 0x44, 0x73, // onst float invDs
+	0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, 0x3d, // tFaceSize_Mul2 =
+	0x20, 0x32, 0x2e, 0x30, 0x66, 0x2f, 0x5f, 0x64, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, //  2.0f/_dstFaceSi
+	0x7a, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, // ze;.    const fl
+	0x6f, 0x61, 0x74, 0x20, 0x76, 0x76, 0x20, 0x3d, 0x20, 0x28, 0x28, 0x66, 0x6c, 0x6f, 0x61, 0x74, // oat vv = ((float
+	0x29, 0x79, 0x79, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x35, 0x66, 0x29, 0x2a, 0x69, 0x6e, 0x76, 0x44, // )yy + 0.5f)*invD
+	0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, 0x75, 0x6c, 0x32, 0x20, // stFaceSize_Mul2
+	0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, // - 1.0f;.    cons
+	0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x75, 0x75, 0x20, 0x3d, 0x20, 0x28, 0x28, 0x66, // t float uu = ((f
+	0x6c, 0x6f, 0x61, 0x74, 0x29, 0x78, 0x78, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x35, 0x66, 0x29, 0x2a, // loat)xx + 0.5f)*
+	0x69, 0x6e, 0x76, 0x44, 0x73, 0x74, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x5f, 0x4d, // invDstFaceSize_M
+	0x75, 0x6c, 0x32, 0x20, 0x2d, 0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // ul2 - 1.0f;.
+	0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x74, 0x61, 0x70, // const float4 tap
+	0x56, 0x65, 0x63, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x43, 0x6f, 0x6f, 0x72, 0x64, // Vec = texelCoord
+	0x54, 0x6f, 0x56, 0x65, 0x63, 0x57, 0x61, 0x72, 0x70, 0x28, 0x75, 0x75, 0x2c, 0x20, 0x76, 0x76, // ToVecWarp(uu, vv
+	0x2c, 0x20, 0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x49, 0x64, 0x78, 0x2c, 0x20, 0x5f, // , _srcFaceIdx, _
+	0x77, 0x61, 0x72, 0x70, 0x29, 0x3b, 0x0a, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x43, 0x4d, 0x46, 0x54, // warp);..#if CMFT
+	0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, // _COMPUTE_FILTER_
+	0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, 0x0a, 0x20, 0x20, 0x20, 0x20, // AREA_ON_CPU.
+	0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x46, 0x4c, 0x4f, 0x41, 0x54, 0x34, 0x5f, 0x41, // #define FLOAT4_A
+	0x52, 0x45, 0x41, 0x28, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x29, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, // REA(_face) const
+	0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x61, 0x72, 0x65, 0x61, 0x43, 0x6f, 0x6f, 0x72, 0x64, 0x20, //  int2 areaCoord
+	0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2a, 0x36, 0x20, 0x2b, 0x20, 0x5f, 0x66, 0x61, 0x63, 0x65, // = { xx*6 + _face
+	0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, // , yy }; const fl
+	0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, // oat4 area = read
+	0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x61, 0x72, 0x65, 0x61, 0x2c, 0x20, 0x73, // _imagef(_area, s
+	0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x61, 0x72, 0x65, 0x61, 0x43, 0x6f, // _sampler, areaCo
+	0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, // ord);.#else.
+	0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, // float4 filterAre
+	0x61, 0x5b, 0x36, 0x5d, 0x20, 0x3d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, // a[6] =.    {.
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, //      { 0.0f, 0.0
 	0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, // f, 0.0f, 0.0f },
 	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, // .        { 0.0f,
@@ -907,200 +1074,226 @@ static const uint8_t sc_radianceSource[17634] =
 	0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  0.0f },.
 	0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, //  { 0.0f, 0.0f, 0
 	0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, // .0f, 0.0f },.
-	0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x65, 0x74, 0x65, 0x72, 0x6d, 0x69, 0x6e, //  };.    determin
-	0x65, 0x46, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x28, 0x66, 0x69, 0x6c, 0x74, // eFilterArea(filt
-	0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x2c, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, 0x63, 0x2c, 0x20, // erArea, tapVec,
-	0x5f, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, // _filterSize);.
-	0x20, 0x20, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x46, 0x4c, 0x4f, 0x41, 0x54, 0x34, //   #define FLOAT4
-	0x5f, 0x41, 0x52, 0x45, 0x41, 0x28, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x29, 0x20, 0x63, 0x6f, 0x6e, // _AREA(_face) con
-	0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x3d, // st float4 area =
-	0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x5b, 0x5f, 0x66, 0x61, 0x63, //  filterArea[_fac
-	0x65, 0x5d, 0x3b, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2f, 0x43, 0x4d, 0x46, // e];.#endif //CMF
-	0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, // T_COMPUTE_FILTER
-	0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, 0x5f, 0x43, 0x50, 0x55, 0x0a, 0x0a, 0x20, 0x20, // _AREA_ON_CPU..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, //      { 0.0f, 0.0
+	0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x20, 0x7d, 0x2c, // f, 0.0f, 0.0f },
+	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, // .        { 0.0f,
+	0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x66, 0x2c, 0x20, 0x30, 0x2e, 0x30, //  0.0f, 0.0f, 0.0
+	0x66, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, // f },.    };.
+	0x64, 0x65, 0x74, 0x65, 0x72, 0x6d, 0x69, 0x6e, 0x65, 0x46, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, // determineFilterA
+	0x72, 0x65, 0x61, 0x28, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, 0x72, 0x65, 0x61, 0x2c, 0x20, // rea(filterArea,
+	0x74, 0x61, 0x70, 0x56, 0x65, 0x63, 0x2c, 0x20, 0x5f, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x53, // tapVec, _filterS
+	0x69, 0x7a, 0x65, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, // ize);.    #defin
+	0x65, 0x20, 0x46, 0x4c, 0x4f, 0x41, 0x54, 0x34, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x28, 0x5f, 0x66, // e FLOAT4_AREA(_f
+	0x61, 0x63, 0x65, 0x29, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, // ace) const float
+	0x34, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x3d, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x41, // 4 area = filterA
+	0x72, 0x65, 0x61, 0x5b, 0x5f, 0x66, 0x61, 0x63, 0x65, 0x5d, 0x3b, 0x0a, 0x23, 0x65, 0x6e, 0x64, // rea[_face];.#end
+	0x69, 0x66, 0x20, 0x2f, 0x2f, 0x43, 0x4d, 0x46, 0x54, 0x5f, 0x43, 0x4f, 0x4d, 0x50, 0x55, 0x54, // if //CMFT_COMPUT
+	0x45, 0x5f, 0x46, 0x49, 0x4c, 0x54, 0x45, 0x52, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x5f, 0x4f, 0x4e, // E_FILTER_AREA_ON
+	0x5f, 0x43, 0x50, 0x55, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, // _CPU..    const
+	0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, // int32_t srcFaceS
+	0x69, 0x7a, 0x65, 0x20, 0x3d, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x29, 0x5f, // ize = (int32_t)_
+	0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x0a, 0x20, 0x20, // srcFaceSize;..
 	0x20, 0x20, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, //   #define PROCES
 	0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x5f, 0x69, 0x69, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, // S_FACE(_ii)
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, //              ..
-	0x20, 0x20, 0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //    {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, //         ..    {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, //               ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x46, 0x4c, 0x4f, 0x41, 0x54, 0x34, 0x5f, 0x41, //         FLOAT4_A
-	0x52, 0x45, 0x41, 0x28, 0x5f, 0x69, 0x69, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // REA(_ii)
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, //                .
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
+	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x46, 0x4c, //     ..        FL
+	0x4f, 0x41, 0x54, 0x34, 0x5f, 0x41, 0x52, 0x45, 0x41, 0x28, 0x5f, 0x69, 0x69, 0x29, 0x20, 0x20, // OAT4_AREA(_ii)
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, // ..        const
-	0x69, 0x6e, 0x74, 0x34, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x20, 0x3d, 0x20, 0x63, 0x6f, // int4 minmax = co
-	0x6e, 0x76, 0x65, 0x72, 0x74, 0x5f, 0x69, 0x6e, 0x74, 0x34, 0x28, 0x61, 0x72, 0x65, 0x61, 0x2a, // nvert_int4(area*
-	0x5f, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x20, 0x20, // _srcFaceSize);
+	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, //  ..        const
-	0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, 0x58, 0x20, 0x3d, 0x20, //  int32_t minX =
-	0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x78, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // minmax.x;
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, //   ..        cons
-	0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, 0x59, 0x20, 0x3d, // t int32_t minY =
-	0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x79, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  minmax.y;
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, //             ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x34, //       const int4
+	0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x20, 0x3d, 0x20, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, //  minmax = conver
+	0x74, 0x5f, 0x69, 0x6e, 0x74, 0x34, 0x28, 0x61, 0x72, 0x65, 0x61, 0x2a, 0x5f, 0x73, 0x72, 0x63, // t_int4(area*_src
+	0x46, 0x61, 0x63, 0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // FaceSize);
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         ..
+	0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, //   const int32_t
+	0x6d, 0x69, 0x6e, 0x58, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x78, 0x3b, // minX = minmax.x;
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, //    ..        con
-	0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x61, 0x78, 0x58, 0x20, // st int32_t maxX
-	0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x7a, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, // = minmax.z;
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, //     ..        co
-	0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x61, 0x78, 0x59, // nst int32_t maxY
-	0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x77, 0x3b, 0x20, 0x20, 0x20, 0x20, //  = minmax.w;
+	0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x69, 0x6e, 0x59, // nst int32_t minY
+	0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x79, 0x3b, 0x20, 0x20, 0x20, 0x20, //  = minmax.y;
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //      ..
+	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, // ..        const
+	0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x6d, 0x61, 0x78, 0x58, 0x20, 0x3d, 0x20, 0x6d, // int32_t maxX = m
+	0x69, 0x6e, 0x6d, 0x61, 0x78, 0x2e, 0x7a, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // inmax.z;
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, //             ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x33, //       const int3
+	0x32, 0x5f, 0x74, 0x20, 0x6d, 0x61, 0x78, 0x59, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x6d, 0x61, // 2_t maxY = minma
+	0x78, 0x2e, 0x77, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // x.w;
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       ..
-	0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x79, 0x79, 0x20, // for (int32_t yy
-	0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x59, 0x3b, 0x20, 0x79, 0x79, 0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, // = minY; yy < max
-	0x59, 0x3b, 0x20, 0x2b, 0x2b, 0x79, 0x79, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // Y; ++yy)
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //        ..
-	0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, //     ..        fo
+	0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x79, 0x79, 0x20, 0x3d, 0x20, // r (int32_t yy =
+	0x6d, 0x69, 0x6e, 0x59, 0x3b, 0x20, 0x79, 0x79, 0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, 0x59, 0x3b, // minY; yy < maxY;
+	0x20, 0x2b, 0x2b, 0x79, 0x79, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  ++yy)
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, // ..        {
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, //             ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, //           for (i
+	0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x58, // nt32_t xx = minX
+	0x3b, 0x20, 0x78, 0x78, 0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, 0x58, 0x3b, 0x20, 0x2b, 0x2b, 0x78, // ; xx < maxX; ++x
+	0x78, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // x)
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x33, 0x32, //       for (int32
-	0x5f, 0x74, 0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x6d, 0x69, 0x6e, 0x58, 0x3b, 0x20, 0x78, 0x78, // _t xx = minX; xx
-	0x20, 0x3c, 0x20, 0x6d, 0x61, 0x78, 0x58, 0x3b, 0x20, 0x2b, 0x2b, 0x78, 0x78, 0x29, 0x20, 0x20, //  < maxX; ++xx)
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, //          ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //        {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //     ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, //       const int2
+	0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, //  coord = { xx, y
+	0x79, 0x20, 0x7d, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // y };
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, //           ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, //             cons
-	0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x7b, // t int2 coord = {
-	0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  xx, yy };
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, //            ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, //              con
-	0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, // st float4 normal
-	0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, //  = read_imagef(_
-	0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, 0x65, // normalSolidAngle
-	0x20, 0x23, 0x23, 0x20, 0x5f, 0x69, 0x69, 0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, //  ## _ii, s_sampl
-	0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x20, 0x5c, 0x0a, 0x20, 0x20, // er, coord); ..
+	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ..
+	0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x6e, //   const float4 n
+	0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x20, 0x3d, 0x20, 0x52, 0x45, 0x41, 0x44, 0x5f, 0x4e, 0x4f, 0x52, // ormal = READ_NOR
+	0x4d, 0x41, 0x4c, 0x5f, 0x53, 0x4f, 0x4c, 0x49, 0x44, 0x5f, 0x41, 0x4e, 0x47, 0x4c, 0x45, 0x28, // MAL_SOLID_ANGLE(
+	0x5f, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x53, 0x6f, 0x6c, 0x69, 0x64, 0x41, 0x6e, 0x67, 0x6c, // _normalSolidAngl
+	0x65, 0x20, 0x23, 0x23, 0x20, 0x5f, 0x69, 0x69, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, // e ## _ii, coord,
+	0x20, 0x5f, 0x69, 0x69, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, //  _ii);      ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, //               co
 	0x6e, 0x73, 0x74, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x64, 0x70, 0x20, 0x3d, 0x20, 0x64, // nst float dp = d
 	0x6f, 0x74, 0x28, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2c, 0x20, 0x74, 0x61, 0x70, 0x56, 0x65, // ot(normal, tapVe
 	0x63, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // c);
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, //              ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, //                i
-	0x66, 0x20, 0x28, 0x64, 0x70, 0x20, 0x3e, 0x3d, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, // f (dp >= _specul
-	0x61, 0x72, 0x41, 0x6e, 0x67, 0x6c, 0x65, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // arAngle)
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x64, 0x70, //           if (dp
+	0x20, 0x3e, 0x3d, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, 0x61, 0x72, 0x41, 0x6e, 0x67, //  >= _specularAng
+	0x6c, 0x65, 0x29, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // le)
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //     ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, //               ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x7b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // {
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, //                .
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // .
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x73, 0x61, 0x6d, 0x70, //      float4 samp
-	0x6c, 0x65, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, // le = read_imagef
-	0x28, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x20, 0x23, 0x23, 0x20, 0x5f, 0x69, 0x69, // (_srcData ## _ii
-	0x2c, 0x20, 0x73, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6f, // , s_sampler, coo
-	0x72, 0x64, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // rd);
 	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x2e, 0x77, 0x20, 0x3d, //       sample.w =
-	0x20, 0x31, 0x2e, 0x30, 0x66, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  1.0f;
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x34, 0x20, 0x73, 0x61, 0x6d, //       float4 sam
+	0x70, 0x6c, 0x65, 0x20, 0x3d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x53, 0x72, 0x63, 0x44, 0x61, 0x74, // ple = readSrcDat
+	0x61, 0x28, 0x5f, 0x73, 0x72, 0x63, 0x44, 0x61, 0x74, 0x61, 0x20, 0x23, 0x23, 0x20, 0x5f, 0x69, // a(_srcData ## _i
+	0x69, 0x2c, 0x20, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2c, 0x20, 0x73, 0x72, 0x63, 0x46, 0x61, 0x63, // i, coord, srcFac
+	0x65, 0x53, 0x69, 0x7a, 0x65, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // eSize);
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, //             ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x2e, 0x77, 0x20, 0x3d, 0x20, 0x31, 0x2e, 0x30, //   sample.w = 1.0
+	0x66, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // f;
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //  ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, //        colorWeig
-	0x68, 0x74, 0x20, 0x2b, 0x3d, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x20, 0x20, 0x20, 0x20, // ht += sample
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, //               co
+	0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x2b, 0x3d, 0x20, 0x73, 0x61, 0x6d, // lorWeight += sam
+	0x70, 0x6c, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ple
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //   ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2e, 0x77, 0x20, //      * normal.w
+	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //     ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2e, //        * normal.
+	0x77, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // w
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //    ..
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, 0x61, 0x74, 0x69, 0x76, 0x65, 0x5f, 0x70, //       * native_p
-	0x6f, 0x77, 0x72, 0x28, 0x64, 0x70, 0x2c, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, 0x61, // owr(dp, _specula
-	0x72, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // rPower);
+	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x2a, 0x20, 0x6e, 0x61, 0x74, 0x69, 0x76, 0x65, 0x5f, 0x70, 0x6f, 0x77, 0x72, //    * native_powr
+	0x28, 0x64, 0x70, 0x2c, 0x20, 0x5f, 0x73, 0x70, 0x65, 0x63, 0x75, 0x6c, 0x61, 0x72, 0x50, 0x6f, // (dp, _specularPo
+	0x77, 0x65, 0x72, 0x29, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // wer);
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, //             ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, //               }
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //     ..
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       }
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //         ..
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       }
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //      ..
-	0x20, 0x20, 0x20, 0x7d, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //    }
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
+	0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, //     ..        }
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //       ..
-	0x7d, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // }
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
 	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, //
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, //        ..    }..
-	0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, //     PROCESS_FACE
-	0x28, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, // (0);.    PROCESS
-	0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x31, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, // _FACE(1);.    PR
-	0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x32, 0x29, 0x3b, 0x0a, 0x20, // OCESS_FACE(2);.
-	0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, //    PROCESS_FACE(
-	0x33, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, // 3);.    PROCESS_
-	0x46, 0x41, 0x43, 0x45, 0x28, 0x34, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, // FACE(4);.    PRO
-	0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x35, 0x29, 0x3b, 0x0a, 0x0a, 0x20, // CESS_FACE(5);..
-	0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x30, 0x2e, 0x30, 0x20, 0x21, 0x3d, 0x20, 0x63, 0x6f, //    if (0.0 != co
-	0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x2e, 0x77, 0x29, 0x0a, 0x20, 0x20, 0x20, // lorWeight.w).
-	0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, //  {.        color
-	0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x2f, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, // Weight /= colorW
-	0x65, 0x69, 0x67, 0x68, 0x74, 0x2e, 0x77, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, // eight.w;.    }..
-	0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x64, //     const int2 d
-	0x73, 0x74, 0x20, 0x3d, 0x20, 0x7b, 0x20, 0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, // st = { xx, yy };
-	0x0a, 0x20, 0x20, 0x20, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, // .    write_image
-	0x66, 0x28, 0x5f, 0x6f, 0x75, 0x74, 0x2c, 0x20, 0x64, 0x73, 0x74, 0x2c, 0x20, 0x63, 0x6f, 0x6c, // f(_out, dst, col
-	0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x2f, 0x2a, // orWeight);.}../*
-	0x20, 0x76, 0x69, 0x6d, 0x3a, 0x20, 0x73, 0x65, 0x74, 0x20, 0x73, 0x77, 0x3d, 0x34, 0x20, 0x74, //  vim: set sw=4 t
-	0x73, 0x3d, 0x34, 0x20, 0x65, 0x78, 0x70, 0x61, 0x6e, 0x64, 0x74, 0x61, 0x62, 0x3a, 0x20, 0x2a, // s=4 expandtab: *
-	0x2f, 0x0a,                                                                                     // /.
+	0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, // ..    }..    PRO
+	0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, // CESS_FACE(0);.
+	0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x31, //   PROCESS_FACE(1
+	0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, // );.    PROCESS_F
+	0x41, 0x43, 0x45, 0x28, 0x32, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, // ACE(2);.    PROC
+	0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x33, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, // ESS_FACE(3);.
+	0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, 0x43, 0x45, 0x28, 0x34, 0x29, //  PROCESS_FACE(4)
+	0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x52, 0x4f, 0x43, 0x45, 0x53, 0x53, 0x5f, 0x46, 0x41, // ;.    PROCESS_FA
+	0x43, 0x45, 0x28, 0x35, 0x29, 0x3b, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, // CE(5);..    if (
+	0x30, 0x2e, 0x30, 0x20, 0x21, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, // 0.0 != colorWeig
+	0x68, 0x74, 0x2e, 0x77, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, // ht.w).    {.
+	0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, //     colorWeight
+	0x2f, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, 0x74, 0x2e, 0x77, // /= colorWeight.w
+	0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, // ;.    }..    con
+	0x73, 0x74, 0x20, 0x69, 0x6e, 0x74, 0x32, 0x20, 0x64, 0x73, 0x74, 0x20, 0x3d, 0x20, 0x7b, 0x20, // st int2 dst = {
+	0x78, 0x78, 0x2c, 0x20, 0x79, 0x79, 0x20, 0x7d, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x77, 0x72, // xx, yy };.    wr
+	0x69, 0x74, 0x65, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x66, 0x28, 0x5f, 0x6f, 0x75, 0x74, 0x2c, // ite_imagef(_out,
+	0x20, 0x64, 0x73, 0x74, 0x2c, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x57, 0x65, 0x69, 0x67, 0x68, //  dst, colorWeigh
+	0x74, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x2f, 0x2a, 0x20, 0x76, 0x69, 0x6d, 0x3a, 0x20, 0x73, // t);.}../* vim: s
+	0x65, 0x74, 0x20, 0x73, 0x77, 0x3d, 0x34, 0x20, 0x74, 0x73, 0x3d, 0x34, 0x20, 0x65, 0x78, 0x70, // et sw=4 ts=4 exp
+	0x61, 0x6e, 0x64, 0x74, 0x61, 0x62, 0x3a, 0x20, 0x2a, 0x2f, 0x0a,                               // andtab: */.
 };
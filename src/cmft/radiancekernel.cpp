@@ -0,0 +1,1188 @@
+/*
+ * Copyright 2014-2015 Dario Manesku. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "common/config.h"
+#include "common/utils.h"
+#include "common/fpumath.h"
+#include "common/cpu.h"
+#include "common/halffloat.h"
+
+#include "radiancekernel.h"
+#include "cubemaputils.h"
+
+#include <string.h> // memcpy, memset
+#include <math.h>   // powf, fabsf, ldexpf
+#include <float.h>  // FLT_MIN, FLT_MAX
+#include <stddef.h> // ptrdiff_t
+#include <new>         // placement new
+#include <type_traits> // std::aligned_storage
+
+#if CMFT_SIMD_SSE41 || CMFT_SIMD_AVX2 || CMFT_SIMD_AVX512
+#   include <immintrin.h>
+#endif
+
+namespace cmft
+{
+    // Accumulation.
+    //-----
+
+    /// Adds _value to _sum and keeps the rounding error in _compensation (Kahan-Babuska/Neumaier).
+    static inline void compensatedAdd(float& _sum, float& _compensation, float _value)
+    {
+        const float sum = _sum + _value;
+        _compensation += (fabsf(_sum) >= fabsf(_value)) ? (_sum - sum) + _value : (_value - sum) + _sum;
+        _sum = sum;
+    }
+
+    /// Sums the whole filter area in AccumT, which is float or double.
+    template <typename AccumT>
+    struct ScalarAccumulator
+    {
+        ScalarAccumulator(const RadianceKernelArgs& /*_args*/)
+        {
+            m_sum[0] = AccumT(0.0f);
+            m_sum[1] = AccumT(0.0f);
+            m_sum[2] = AccumT(0.0f);
+            m_sum[3] = AccumT(0.0f);
+        }
+
+        void add(float _red, float _green, float _blue, float _weight)
+        {
+            m_sum[0] += _red   * _weight;
+            m_sum[1] += _green * _weight;
+            m_sum[2] += _blue  * _weight;
+            m_sum[3] += _weight;
+        }
+
+        void endRow()
+        {
+        }
+
+        void result(float _colorWeight[4]) const
+        {
+            _colorWeight[0] = float(m_sum[0]);
+            _colorWeight[1] = float(m_sum[1]);
+            _colorWeight[2] = float(m_sum[2]);
+            _colorWeight[3] = float(m_sum[3]);
+        }
+
+        AccumT m_sum[4];
+    };
+
+    /// Sums each source row in float and adds row sums to RadianceKernelArgs::m_runningSum with compensation.
+    struct CompensatedScalarAccumulator
+    {
+        CompensatedScalarAccumulator(const RadianceKernelArgs& _args)
+            : m_runningSum(_args.m_runningSum)
+        {
+            m_row[0] = 0.0f;
+            m_row[1] = 0.0f;
+            m_row[2] = 0.0f;
+            m_row[3] = 0.0f;
+        }
+
+        void add(float _red, float _green, float _blue, float _weight)
+        {
+            m_row[0] += _red   * _weight;
+            m_row[1] += _green * _weight;
+            m_row[2] += _blue  * _weight;
+            m_row[3] += _weight;
+        }
+
+        void endRow()
+        {
+            for (uint8_t ii = 0; ii < 4; ++ii)
+            {
+                compensatedAdd(m_runningSum[ii], m_runningSum[ii+4], m_row[ii]);
+                m_row[ii] = 0.0f;
+            }
+        }
+
+        void result(float _colorWeight[4]) const
+        {
+            _colorWeight[0] = m_runningSum[0] + m_runningSum[4];
+            _colorWeight[1] = m_runningSum[1] + m_runningSum[5];
+            _colorWeight[2] = m_runningSum[2] + m_runningSum[6];
+            _colorWeight[3] = m_runningSum[3] + m_runningSum[7];
+        }
+
+        float* m_runningSum;
+        float m_row[4];
+    };
+
+    /// Accumulators of each source of a group kernel.
+    template <typename AccumTy>
+    struct GroupAccumulators
+    {
+        GroupAccumulators(const RadianceKernelArgs* _args, uint8_t _numArgs)
+        {
+            for (uint8_t ii = 0; ii < _numArgs; ++ii)
+            {
+                ::new (&m_storage[ii]) AccumTy(_args[ii]);
+            }
+        }
+
+        AccumTy& operator[](uint8_t _idx)
+        {
+            return *(AccumTy*)&m_storage[_idx];
+        }
+
+        typename std::aligned_storage<sizeof(AccumTy), alignof(AccumTy)>::type m_storage[RADIANCE_KERNEL_MAX_GROUP];
+    };
+
+    // Scalar.
+    //-----
+
+    /// Decodes r,g,b of a single interleaved source texel.
+    struct Rgba32fTexel
+    {
+        typedef float Type;
+
+        static void decode(float _rgb[3], const float* _texel)
+        {
+            _rgb[0] = _texel[0];
+            _rgb[1] = _texel[1];
+            _rgb[2] = _texel[2];
+        }
+    };
+
+    struct Rgba16fTexel
+    {
+        typedef uint16_t Type;
+
+        static void decode(float _rgb[3], const uint16_t* _texel)
+        {
+            _rgb[0] = halfToFloat(_texel[0]);
+            _rgb[1] = halfToFloat(_texel[1]);
+            _rgb[2] = halfToFloat(_texel[2]);
+        }
+    };
+
+    struct RgbeTexel
+    {
+        typedef uint8_t Type;
+
+        static void decode(float _rgb[3], const uint8_t* _texel)
+        {
+            const float exp = (0 != _texel[3]) ? ldexpf(1.0f, int32_t(_texel[3]) - (128+8)) : 0.0f;
+            _rgb[0] = float(_texel[0]) * exp;
+            _rgb[1] = float(_texel[1]) * exp;
+            _rgb[2] = float(_texel[2]) * exp;
+        }
+    };
+
+    /// Reference implementation, other kernels are checked against it. AccumTy is one of the scalar accumulators,
+    /// DataTy decodes source texels.
+    template <typename AccumTy, typename DataTy>
+    static void radianceKernelScalar(float _colorWeight[4], const RadianceKernelArgs& _args)
+    {
+        typedef typename DataTy::Type DataType;
+
+        AccumTy accum(_args);
+
+        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+        const uint32_t pitch = _args.m_srcFaceSize*bytesPerPixel;
+        const uint32_t normalFaceSize = pitch*_args.m_srcFaceSize;
+        const uint32_t dataPitch = _args.m_srcFaceSize*4;
+
+        for (uint32_t ii = 0; ii < _args.m_numSpans; ++ii)
+        {
+            const RadianceFilterSpan& span = _args.m_spans[ii];
+
+            const DataType* faceData   = (const DataType*)((const uint8_t*)_args.m_srcData + _args.m_faceOffsets[span.m_face]);
+            const uint8_t* faceNormals = (const uint8_t*)_args.m_cubemapNormalSolidAngle + normalFaceSize*span.m_face;
+
+            for (uint32_t yy = span.m_minY; yy <= span.m_maxY; ++yy)
+            {
+                const DataType* rowData   = faceData + yy*dataPitch;
+                const uint8_t* rowNormals = (const uint8_t*)faceNormals + yy*pitch;
+
+                for (uint32_t xx = span.m_minX; xx <= span.m_maxX; ++xx)
+                {
+                    const float* normalPtr = (const float*)((const uint8_t*)rowNormals + xx*bytesPerPixel);
+                    const float dotProduct = vec3Dot(normalPtr, _args.m_tapVec);
+
+                    if (span.m_inside || dotProduct >= _args.m_specularAngle)
+                    {
+                        const float solidAngle = normalPtr[3];
+                        const float weight = solidAngle * powf(dotProduct, _args.m_specularPower);
+
+                        float rgb[3];
+                        DataTy::decode(rgb, rowData + xx*4);
+                        accum.add(rgb[0], rgb[1], rgb[2], weight);
+                    }
+                }
+
+                accum.endRow();
+            }
+        }
+
+        accum.result(_colorWeight);
+    }
+
+    /// Same as radianceKernelScalar() but reads planar tables.
+    template <typename AccumTy>
+    static void radianceKernelScalarPlanar(float _colorWeight[4], const RadianceKernelArgs& _args)
+    {
+        AccumTy accum(_args);
+
+        const uint32_t pitch = _args.m_planePitch;
+        const uint32_t planeSize = pitch*_args.m_srcFaceSize;
+
+        for (uint32_t ii = 0; ii < _args.m_numSpans; ++ii)
+        {
+            const RadianceFilterSpan& span = _args.m_spans[ii];
+
+            const float* faceData    = _args.m_srcPlanes    + planeSize*3*span.m_face;
+            const float* faceNormals = _args.m_normalPlanes + planeSize*4*span.m_face;
+
+            for (uint32_t yy = span.m_minY; yy <= span.m_maxY; ++yy)
+            {
+                const float* rowData    = faceData    + yy*pitch;
+                const float* rowNormals = faceNormals + yy*pitch;
+
+                for (uint32_t xx = span.m_minX; xx <= span.m_maxX; ++xx)
+                {
+                    const float dotProduct = rowNormals[xx            ]*_args.m_tapVec[0]
+                                           + rowNormals[xx+planeSize  ]*_args.m_tapVec[1]
+                                           + rowNormals[xx+planeSize*2]*_args.m_tapVec[2]
+                                           ;
+
+                    if (span.m_inside || dotProduct >= _args.m_specularAngle)
+                    {
+                        const float solidAngle = rowNormals[xx+planeSize*3];
+                        const float weight = solidAngle * powf(dotProduct, _args.m_specularPower);
+
+                        accum.add(rowData[xx], rowData[xx+planeSize], rowData[xx+planeSize*2], weight);
+                    }
+                }
+
+                accum.endRow();
+            }
+        }
+
+        accum.result(_colorWeight);
+    }
+
+    /// Same as radianceKernelScalar() and radianceKernelScalarPlanar() but computes texel normals and solid
+    /// angles from texel coordinates, see ComputedNormals in radiancekernel_simd.h. DataTy is only used when not PlanarT.
+    template <bool PlanarT, typename AccumTy, typename DataTy>
+    static void radianceKernelScalarComputed(float _colorWeight[4], const RadianceKernelArgs& _args)
+    {
+        typedef typename DataTy::Type DataType;
+
+        AccumTy accum(_args);
+
+        const float invFaceSize = 1.0f/float(int32_t(_args.m_srcFaceSize));
+        const float step = 2.0f*invFaceSize;
+        const float offset = invFaceSize - 1.0f;
+        const float warp = _args.m_warpFixup;
+        const float texelArea = step*step;
+
+        const uint32_t pitch = PlanarT ? _args.m_planePitch : _args.m_srcFaceSize*4;
+        const uint32_t planeSize = _args.m_planePitch*_args.m_srcFaceSize;
+
+        for (uint32_t ii = 0; ii < _args.m_numSpans; ++ii)
+        {
+            const RadianceFilterSpan& span = _args.m_spans[ii];
+
+            const float* facePlanes = PlanarT ? _args.m_srcPlanes + planeSize*3*span.m_face : NULL;
+            const DataType* faceData = PlanarT ? NULL : (const DataType*)((const uint8_t*)_args.m_srcData + _args.m_faceOffsets[span.m_face]);
+
+            // Texel direction is faceUv[0]*u + faceUv[1]*v + faceUv[2], normalized.
+            const float (*faceUv)[3] = s_faceUvVectors[span.m_face];
+            const float tapU = vec3Dot(faceUv[0], _args.m_tapVec);
+            const float tapV = vec3Dot(faceUv[1], _args.m_tapVec);
+            const float tapW = vec3Dot(faceUv[2], _args.m_tapVec);
+
+            for (uint32_t yy = span.m_minY; yy <= span.m_maxY; ++yy)
+            {
+                const float* rowPlanes = PlanarT ? facePlanes + yy*pitch : NULL;
+                const DataType* rowData = PlanarT ? NULL : faceData + yy*pitch;
+
+                const float vv = float(int32_t(yy))*step + offset;
+                const float vvWarp = vv*(1.0f + warp*vv*vv);
+                const float rowDot = tapV*vvWarp + tapW;
+                const float rowLenSq = 1.0f + vvWarp*vvWarp;
+                const float rowAreaSq = 1.0f + vv*vv;
+
+                for (uint32_t xx = span.m_minX; xx <= span.m_maxX; ++xx)
+                {
+                    const float uu = float(int32_t(xx))*step + offset;
+                    const float uuWarp = uu*(1.0f + warp*uu*uu);
+                    const float invLen = 1.0f/sqrtf(uuWarp*uuWarp + rowLenSq);
+                    const float dotProduct = (tapU*uuWarp + rowDot)*invLen;
+
+                    if (span.m_inside || dotProduct >= _args.m_specularAngle)
+                    {
+                        const float invArea = 1.0f/sqrtf(uu*uu + rowAreaSq);
+                        const float solidAngle = texelArea*invArea*invArea*invArea;
+                        const float weight = solidAngle * powf(dotProduct, _args.m_specularPower);
+
+                        float rgb[3];
+                        if (PlanarT)
+                        {
+                            rgb[0] = rowPlanes[xx            ];
+                            rgb[1] = rowPlanes[xx+planeSize  ];
+                            rgb[2] = rowPlanes[xx+planeSize*2];
+                        }
+                        else
+                        {
+                            DataTy::decode(rgb, rowData + xx*4);
+                        }
+                        accum.add(rgb[0], rgb[1], rgb[2], weight);
+                    }
+                }
+
+                accum.endRow();
+            }
+        }
+
+        accum.result(_colorWeight);
+    }
+
+    /// Group kernel of the scalar kernels above, see RadianceGroupKernelFn. Weights of a run of texels are
+    /// evaluated from the first source the same way as the single source kernel does, then every source adds
+    /// its data of the same texels in the same order. DataTy is only used when not PlanarT.
+    template <bool PlanarT, bool ComputedT, typename AccumTy, typename DataTy>
+    static void radianceGroupKernelScalar(float* _colorWeight, const RadianceKernelArgs* _args, uint8_t _numArgs)
+    {
+        typedef typename DataTy::Type DataType;
+
+        enum { MaxRun = 64 };
+
+        const RadianceKernelArgs& args = _args[0];
+        GroupAccumulators<AccumTy> accum(_args, _numArgs);
+
+        const uint32_t bytesPerPixel = 4 /*numChannels*/ * 4 /*bytesPerChannel*/;
+        const uint32_t normalPitch = args.m_srcFaceSize*bytesPerPixel;
+        const uint32_t normalFaceSize = normalPitch*args.m_srcFaceSize;
+        const uint32_t pitch = PlanarT ? args.m_planePitch : args.m_srcFaceSize*4;
+        const uint32_t planeSize = args.m_planePitch*args.m_srcFaceSize;
+
+        const float invFaceSize = 1.0f/float(int32_t(args.m_srcFaceSize));
+        const float step = 2.0f*invFaceSize;
+        const float offset = invFaceSize - 1.0f;
+        const float warp = args.m_warpFixup;
+        const float texelArea = step*step;
+
+        float weights[MaxRun];
+        uint32_t runX[MaxRun];
+
+        for (uint32_t ii = 0; ii < args.m_numSpans; ++ii)
+        {
+            const RadianceFilterSpan& span = args.m_spans[ii];
+
+            const uint8_t* faceNormals = (const uint8_t*)args.m_cubemapNormalSolidAngle + normalFaceSize*span.m_face;
+            const float* facePlaneNormals = PlanarT && !ComputedT ? args.m_normalPlanes + planeSize*4*span.m_face : NULL;
+
+            // Texel direction is faceUv[0]*u + faceUv[1]*v + faceUv[2], normalized.
+            const float (*faceUv)[3] = s_faceUvVectors[span.m_face];
+            const float tapU = vec3Dot(faceUv[0], args.m_tapVec);
+            const float tapV = vec3Dot(faceUv[1], args.m_tapVec);
+            const float tapW = vec3Dot(faceUv[2], args.m_tapVec);
+
+            for (uint32_t yy = span.m_minY; yy <= span.m_maxY; ++yy)
+            {
+                const uint8_t* rowNormals = faceNormals + yy*normalPitch;
+                const float* rowPlaneNormals = PlanarT && !ComputedT ? facePlaneNormals + yy*pitch : NULL;
+
+                const float vv = float(int32_t(yy))*step + offset;
+                const float vvWarp = vv*(1.0f + warp*vv*vv);
+                const float rowDot = tapV*vvWarp + tapW;
+                const float rowLenSq = 1.0f + vvWarp*vvWarp;
+                const float rowAreaSq = 1.0f + vv*vv;
+
+                for (uint32_t xx = span.m_minX; xx <= span.m_maxX;)
+                {
+                    uint32_t numRun = 0;
+                    for (; xx <= span.m_maxX && numRun < MaxRun; ++xx)
+                    {
+                        float dotProduct;
+                        if (ComputedT)
+                        {
+                            const float uu = float(int32_t(xx))*step + offset;
+                            const float uuWarp = uu*(1.0f + warp*uu*uu);
+                            const float invLen = 1.0f/sqrtf(uuWarp*uuWarp + rowLenSq);
+                            dotProduct = (tapU*uuWarp + rowDot)*invLen;
+                        }
+                        else if (PlanarT)
+                        {
+                            dotProduct = rowPlaneNormals[xx            ]*args.m_tapVec[0]
+                                       + rowPlaneNormals[xx+planeSize  ]*args.m_tapVec[1]
+                                       + rowPlaneNormals[xx+planeSize*2]*args.m_tapVec[2]
+                                       ;
+                        }
+                        else
+                        {
+                            dotProduct = vec3Dot((const float*)(rowNormals + xx*bytesPerPixel), args.m_tapVec);
+                        }
+
+                        if (!span.m_inside && dotProduct < args.m_specularAngle)
+                        {
+                            continue;
+                        }
+
+                        float solidAngle;
+                        if (ComputedT)
+                        {
+                            const float uu = float(int32_t(xx))*step + offset;
+                            const float invArea = 1.0f/sqrtf(uu*uu + rowAreaSq);
+                            solidAngle = texelArea*invArea*invArea*invArea;
+                        }
+                        else if (PlanarT)
+                        {
+                            solidAngle = rowPlaneNormals[xx+planeSize*3];
+                        }
+                        else
+                        {
+                            solidAngle = ((const float*)(rowNormals + xx*bytesPerPixel))[3];
+                        }
+
+                        weights[numRun] = solidAngle * powf(dotProduct, args.m_specularPower);
+                        runX[numRun] = xx;
+                        ++numRun;
+                    }
+
+                    for (uint8_t jj = 0; jj < _numArgs; ++jj)
+                    {
+                        if (PlanarT)
+                        {
+                            const float* rowPlanes = _args[jj].m_srcPlanes + planeSize*3*span.m_face + yy*pitch;
+                            for (uint32_t run = 0; run < numRun; ++run)
+                            {
+                                const uint32_t xr = runX[run];
+                                accum[jj].add(rowPlanes[xr], rowPlanes[xr+planeSize], rowPlanes[xr+planeSize*2], weights[run]);
+                            }
+                        }
+                        else
+                        {
+                            const DataType* rowData = (const DataType*)((const uint8_t*)_args[jj].m_srcData + _args[jj].m_faceOffsets[span.m_face]) + yy*pitch;
+                            for (uint32_t run = 0; run < numRun; ++run)
+                            {
+                                float rgb[3];
+                                DataTy::decode(rgb, rowData + runX[run]*4);
+                                accum[jj].add(rgb[0], rgb[1], rgb[2], weights[run]);
+                            }
+                        }
+                    }
+                }
+
+                for (uint8_t jj = 0; jj < _numArgs; ++jj)
+                {
+                    accum[jj].endRow();
+                }
+            }
+        }
+
+        for (uint8_t jj = 0; jj < _numArgs; ++jj)
+        {
+            accum[jj].result(&_colorWeight[jj*4]);
+        }
+    }
+
+    // SSE4.1.
+    //-----
+
+#if CMFT_SIMD_SSE41
+#   if defined(__clang__)
+#       pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#   elif defined(__GNUC__)
+#       pragma GCC push_options
+#       pragma GCC target("sse4.1")
+#   endif
+
+    namespace sse41
+    {
+        typedef __m128 vfloat;
+        typedef __m128 vmask;
+        enum { VecWidth = 4 };
+
+        static inline vfloat vzero()                               { return _mm_setzero_ps();                 }
+        static inline vfloat vsplat(float _a)                      { return _mm_set1_ps(_a);                  }
+        static inline vfloat vadd(vfloat _a, vfloat _b)            { return _mm_add_ps(_a, _b);               }
+        static inline vfloat vsub(vfloat _a, vfloat _b)            { return _mm_sub_ps(_a, _b);               }
+        static inline vfloat vmul(vfloat _a, vfloat _b)            { return _mm_mul_ps(_a, _b);               }
+        static inline vfloat vdiv(vfloat _a, vfloat _b)            { return _mm_div_ps(_a, _b);               }
+        static inline vfloat vmin(vfloat _a, vfloat _b)            { return _mm_min_ps(_a, _b);               }
+        static inline vfloat vmax(vfloat _a, vfloat _b)            { return _mm_max_ps(_a, _b);               }
+        static inline vfloat vmadd(vfloat _a, vfloat _b, vfloat _c) { return _mm_add_ps(_mm_mul_ps(_a, _b), _c); }
+        static inline vfloat vround(vfloat _a)                     { return _mm_round_ps(_a, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+        static inline vmask  vcmpge(vfloat _a, vfloat _b)          { return _mm_cmpge_ps(_a, _b);             }
+        static inline vmask  vcmpgt(vfloat _a, vfloat _b)          { return _mm_cmpgt_ps(_a, _b);             }
+        static inline vfloat vselect(vmask _m, vfloat _a, vfloat _b) { return _mm_blendv_ps(_b, _a, _m);       }
+        static inline vfloat vand(vmask _m, vfloat _a)             { return _mm_and_ps(_m, _a);               }
+        static inline bool   vany(vmask _m)                        { return 0 != _mm_movemask_ps(_m);         }
+
+        /// 1/sqrt() estimate refined with one Newton-Raphson step.
+        static inline vfloat vrsqrt(vfloat _a)
+        {
+            const __m128 est = _mm_rsqrt_ps(_a);
+            const __m128 hax = _mm_mul_ps(_a, _mm_set1_ps(0.5f));
+            return _mm_mul_ps(est, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(hax, _mm_mul_ps(est, est))));
+        }
+
+        /// Lane indices and texel index of each lane after vloadTexels().
+        static inline vfloat vlaneIndex()  { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+        static inline vfloat vtexelIndex() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+
+        /// Returns mantissa in [1,2) and unbiased exponent of positive normalized values.
+        static inline vfloat vfrexp(vfloat _a, vfloat& _exp)
+        {
+            const __m128i bits = _mm_castps_si128(_a);
+            _exp = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+            return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+        }
+
+        /// Returns 2^n for integral n in [-126, 127].
+        static inline vfloat vldexp(vfloat _n)
+        {
+            return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(_n), _mm_set1_epi32(127)), 23));
+        }
+
+        static inline float vhsum(vfloat _a)
+        {
+            const __m128 hi = _mm_movehl_ps(_a, _a);
+            const __m128 s0 = _mm_add_ps(_a, hi);
+            const __m128 s1 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+            return _mm_cvtss_f32(s1);
+        }
+
+        static inline vfloat vloadu(const float* _ptr)
+        {
+            return _mm_loadu_ps(_ptr);
+        }
+
+        /// Loads _count < VecWidth floats, remaining lanes are zero.
+        static inline vfloat vloadPartial(const float* _ptr, uint32_t _count)
+        {
+            float tmp[VecWidth];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*sizeof(float));
+            return _mm_loadu_ps(tmp);
+        }
+
+        /// Loads VecWidth float4 texels and transposes them into x,y,z,w vectors.
+        static inline void vloadTexels(vfloat _out[4], const float* _ptr)
+        {
+            __m128 r0 = _mm_loadu_ps(_ptr+ 0);
+            __m128 r1 = _mm_loadu_ps(_ptr+ 4);
+            __m128 r2 = _mm_loadu_ps(_ptr+ 8);
+            __m128 r3 = _mm_loadu_ps(_ptr+12);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _out[0] = r0;
+            _out[1] = r1;
+            _out[2] = r2;
+            _out[3] = r3;
+        }
+
+        static inline void vloadTexelsPartial(vfloat _out[4], const float* _ptr, uint32_t _count)
+        {
+            float tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4*sizeof(float));
+            vloadTexels(_out, tmp);
+        }
+
+        /// Converts half floats zero extended to 32 bits. There is no F16C at this level, so the exponent is
+        /// rebiased by multiplication, which keeps denormals exact. Infinities and NaNs are restored afterwards.
+        static inline vfloat vhalfToFloat(__m128i _half)
+        {
+            const __m128i bits   = _mm_slli_epi32(_mm_and_si128(_half, _mm_set1_epi32(0x7fff)), 13);
+            const __m128i sign   = _mm_slli_epi32(_mm_and_si128(_half, _mm_set1_epi32(0x8000)), 16);
+            const __m128i infNan = _mm_and_si128(_mm_cmpgt_epi32(bits, _mm_set1_epi32(0x0f7fffff)), _mm_set1_epi32(0x7f800000));
+            const __m128 value   = _mm_mul_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(_mm_set1_epi32(0x77800000) /*2^112*/));
+            return _mm_or_ps(value, _mm_castsi128_ps(_mm_or_si128(sign, infNan)));
+        }
+
+        /// Same as vloadTexels() for RGBA16F texels.
+        static inline void vloadTexelsHalf(vfloat _out[4], const uint16_t* _ptr)
+        {
+            __m128 r0 = vhalfToFloat(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)(_ptr+ 0))));
+            __m128 r1 = vhalfToFloat(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)(_ptr+ 4))));
+            __m128 r2 = vhalfToFloat(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)(_ptr+ 8))));
+            __m128 r3 = vhalfToFloat(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)(_ptr+12))));
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _out[0] = r0;
+            _out[1] = r1;
+            _out[2] = r2;
+            _out[3] = r3;
+        }
+
+        static inline void vloadTexelsHalfPartial(vfloat _out[4], const uint16_t* _ptr, uint32_t _count)
+        {
+            uint16_t tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4*sizeof(uint16_t));
+            vloadTexelsHalf(_out, tmp);
+        }
+
+        /// Same as vloadTexels() for RGBE texels, see rgbeToRgba32f(). Values below 2^-118 decode to zero.
+        static inline void vloadTexelsRgbe(vfloat _out[4], const uint8_t* _ptr)
+        {
+            const __m128i rgbe  = _mm_loadu_si128((const __m128i*)_ptr);
+            const __m128i mask  = _mm_set1_epi32(0xff);
+            const __m128i exp   = _mm_srli_epi32(rgbe, 24);
+            const __m128i scale = _mm_and_si128(_mm_cmpgt_epi32(exp, _mm_set1_epi32(9)), _mm_slli_epi32(_mm_sub_epi32(exp, _mm_set1_epi32(9)), 23));
+            _out[0] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(rgbe,                     mask)), _mm_castsi128_ps(scale));
+            _out[1] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(rgbe,  8), mask)), _mm_castsi128_ps(scale));
+            _out[2] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(rgbe, 16), mask)), _mm_castsi128_ps(scale));
+            _out[3] = _mm_set1_ps(1.0f);
+        }
+
+        static inline void vloadTexelsRgbePartial(vfloat _out[4], const uint8_t* _ptr, uint32_t _count)
+        {
+            uint8_t tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4);
+            vloadTexelsRgbe(_out, tmp);
+        }
+
+        #include "radiancekernel_simd.h"
+
+    } // namespace sse41
+
+#   if defined(__clang__)
+#       pragma clang attribute pop
+#   elif defined(__GNUC__)
+#       pragma GCC pop_options
+#   endif
+#endif //CMFT_SIMD_SSE41
+
+    // AVX2.
+    //-----
+
+#if CMFT_SIMD_AVX2
+#   if defined(__clang__)
+#       pragma clang attribute push(__attribute__((target("avx2,fma,f16c"))), apply_to = function)
+#   elif defined(__GNUC__)
+#       pragma GCC push_options
+#       pragma GCC target("avx2,fma,f16c")
+#   endif
+
+    namespace avx2
+    {
+        typedef __m256 vfloat;
+        typedef __m256 vmask;
+        enum { VecWidth = 8 };
+
+        static inline vfloat vzero()                               { return _mm256_setzero_ps();              }
+        static inline vfloat vsplat(float _a)                      { return _mm256_set1_ps(_a);               }
+        static inline vfloat vadd(vfloat _a, vfloat _b)            { return _mm256_add_ps(_a, _b);            }
+        static inline vfloat vsub(vfloat _a, vfloat _b)            { return _mm256_sub_ps(_a, _b);            }
+        static inline vfloat vmul(vfloat _a, vfloat _b)            { return _mm256_mul_ps(_a, _b);            }
+        static inline vfloat vdiv(vfloat _a, vfloat _b)            { return _mm256_div_ps(_a, _b);            }
+        static inline vfloat vmin(vfloat _a, vfloat _b)            { return _mm256_min_ps(_a, _b);            }
+        static inline vfloat vmax(vfloat _a, vfloat _b)            { return _mm256_max_ps(_a, _b);            }
+        static inline vfloat vmadd(vfloat _a, vfloat _b, vfloat _c) { return _mm256_fmadd_ps(_a, _b, _c);     }
+        static inline vfloat vround(vfloat _a)                     { return _mm256_round_ps(_a, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+        static inline vmask  vcmpge(vfloat _a, vfloat _b)          { return _mm256_cmp_ps(_a, _b, _CMP_GE_OQ); }
+        static inline vmask  vcmpgt(vfloat _a, vfloat _b)          { return _mm256_cmp_ps(_a, _b, _CMP_GT_OQ); }
+        static inline vfloat vselect(vmask _m, vfloat _a, vfloat _b) { return _mm256_blendv_ps(_b, _a, _m);    }
+        static inline vfloat vand(vmask _m, vfloat _a)             { return _mm256_and_ps(_m, _a);            }
+        static inline bool   vany(vmask _m)                        { return 0 != _mm256_movemask_ps(_m);      }
+
+        static inline vfloat vrsqrt(vfloat _a)
+        {
+            const __m256 est = _mm256_rsqrt_ps(_a);
+            const __m256 hax = _mm256_mul_ps(_a, _mm256_set1_ps(0.5f));
+            return _mm256_mul_ps(est, _mm256_fnmadd_ps(hax, _mm256_mul_ps(est, est), _mm256_set1_ps(1.5f)));
+        }
+
+        static inline vfloat vlaneIndex()  { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+        static inline vfloat vtexelIndex() { return _mm256_setr_ps(0.0f, 2.0f, 4.0f, 6.0f, 1.0f, 3.0f, 5.0f, 7.0f); }
+
+        static inline vfloat vfrexp(vfloat _a, vfloat& _exp)
+        {
+            const __m256i bits = _mm256_castps_si256(_a);
+            _exp = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+            return _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+        }
+
+        static inline vfloat vldexp(vfloat _n)
+        {
+            return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(_n), _mm256_set1_epi32(127)), 23));
+        }
+
+        static inline float vhsum(vfloat _a)
+        {
+            const __m128 sum = _mm_add_ps(_mm256_castps256_ps128(_a), _mm256_extractf128_ps(_a, 1));
+            const __m128 s0 = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            const __m128 s1 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+            return _mm_cvtss_f32(s1);
+        }
+
+        /// Transposes two texels per register within 128-bit lanes.
+        /// Resulting lane order is permuted, but it is the same for normals and data.
+        static inline void vtranspose(vfloat _out[4], __m256 _r0, __m256 _r1, __m256 _r2, __m256 _r3)
+        {
+            const __m256 t0 = _mm256_unpacklo_ps(_r0, _r1);
+            const __m256 t1 = _mm256_unpackhi_ps(_r0, _r1);
+            const __m256 t2 = _mm256_unpacklo_ps(_r2, _r3);
+            const __m256 t3 = _mm256_unpackhi_ps(_r2, _r3);
+            _out[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            _out[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            _out[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            _out[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+
+        static inline vfloat vloadu(const float* _ptr)
+        {
+            return _mm256_loadu_ps(_ptr);
+        }
+
+        static inline vfloat vloadPartial(const float* _ptr, uint32_t _count)
+        {
+            const __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            return _mm256_maskload_ps(_ptr, _mm256_cmpgt_epi32(_mm256_set1_epi32(int32_t(_count)), index));
+        }
+
+        static inline void vloadTexels(vfloat _out[4], const float* _ptr)
+        {
+            vtranspose(_out
+                     , _mm256_loadu_ps(_ptr+ 0)
+                     , _mm256_loadu_ps(_ptr+ 8)
+                     , _mm256_loadu_ps(_ptr+16)
+                     , _mm256_loadu_ps(_ptr+24)
+                     );
+        }
+
+        static inline void vloadTexelsPartial(vfloat _out[4], const float* _ptr, uint32_t _count)
+        {
+            const __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const int32_t num = int32_t(_count*4);
+
+            vtranspose(_out
+                     , _mm256_maskload_ps(_ptr+ 0, _mm256_cmpgt_epi32(_mm256_set1_epi32(num- 0), index))
+                     , _mm256_maskload_ps(_ptr+ 8, _mm256_cmpgt_epi32(_mm256_set1_epi32(num- 8), index))
+                     , _mm256_maskload_ps(_ptr+16, _mm256_cmpgt_epi32(_mm256_set1_epi32(num-16), index))
+                     , _mm256_maskload_ps(_ptr+24, _mm256_cmpgt_epi32(_mm256_set1_epi32(num-24), index))
+                     );
+        }
+
+        /// Same as vloadTexels() for RGBA16F texels.
+        static inline void vloadTexelsHalf(vfloat _out[4], const uint16_t* _ptr)
+        {
+            vtranspose(_out
+                     , _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(_ptr+ 0)))
+                     , _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(_ptr+ 8)))
+                     , _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(_ptr+16)))
+                     , _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(_ptr+24)))
+                     );
+        }
+
+        static inline void vloadTexelsHalfPartial(vfloat _out[4], const uint16_t* _ptr, uint32_t _count)
+        {
+            uint16_t tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4*sizeof(uint16_t));
+            vloadTexelsHalf(_out, tmp);
+        }
+
+        /// Same as vloadTexels() for RGBE texels, see rgbeToRgba32f(). Values below 2^-118 decode to zero.
+        /// Texels are decoded in lane order and permuted to the order of vtranspose().
+        static inline void vloadTexelsRgbe(vfloat _out[4], const uint8_t* _ptr)
+        {
+            const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+            const __m256i rgbe  = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)_ptr), order);
+            const __m256i mask  = _mm256_set1_epi32(0xff);
+            const __m256i exp   = _mm256_srli_epi32(rgbe, 24);
+            const __m256i scale = _mm256_and_si256(_mm256_cmpgt_epi32(exp, _mm256_set1_epi32(9)), _mm256_slli_epi32(_mm256_sub_epi32(exp, _mm256_set1_epi32(9)), 23));
+            _out[0] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(rgbe,                        mask)), _mm256_castsi256_ps(scale));
+            _out[1] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(rgbe,  8), mask)), _mm256_castsi256_ps(scale));
+            _out[2] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(rgbe, 16), mask)), _mm256_castsi256_ps(scale));
+            _out[3] = _mm256_set1_ps(1.0f);
+        }
+
+        static inline void vloadTexelsRgbePartial(vfloat _out[4], const uint8_t* _ptr, uint32_t _count)
+        {
+            uint8_t tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4);
+            vloadTexelsRgbe(_out, tmp);
+        }
+
+        #include "radiancekernel_simd.h"
+
+    } // namespace avx2
+
+#   if defined(__clang__)
+#       pragma clang attribute pop
+#   elif defined(__GNUC__)
+#       pragma GCC pop_options
+#   endif
+#endif //CMFT_SIMD_AVX2
+
+    // AVX-512.
+    //-----
+
+#if CMFT_SIMD_AVX512
+#   if defined(__clang__)
+#       pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#   elif defined(__GNUC__)
+#       pragma GCC push_options
+#       pragma GCC target("avx512f")
+#   endif
+
+    // Gcc reports _mm*_undefined_*() used inside of avx512 intrinsics as uninitialized.
+    CMFT_PRAGMA_DIAGNOSTIC_PUSH();
+    CMFT_PRAGMA_DIAGNOSTIC_IGNORED_CLANG_GCC("-Wuninitialized");
+    CMFT_PRAGMA_DIAGNOSTIC_IGNORED_GCC("-Wmaybe-uninitialized");
+
+    namespace avx512
+    {
+        typedef __m512 vfloat;
+        typedef __mmask16 vmask;
+        enum { VecWidth = 16 };
+
+        static inline vfloat vzero()                               { return _mm512_setzero_ps();              }
+        static inline vfloat vsplat(float _a)                      { return _mm512_set1_ps(_a);               }
+        static inline vfloat vadd(vfloat _a, vfloat _b)            { return _mm512_add_ps(_a, _b);            }
+        static inline vfloat vsub(vfloat _a, vfloat _b)            { return _mm512_sub_ps(_a, _b);            }
+        static inline vfloat vmul(vfloat _a, vfloat _b)            { return _mm512_mul_ps(_a, _b);            }
+        static inline vfloat vdiv(vfloat _a, vfloat _b)            { return _mm512_div_ps(_a, _b);            }
+        static inline vfloat vmin(vfloat _a, vfloat _b)            { return _mm512_min_ps(_a, _b);            }
+        static inline vfloat vmax(vfloat _a, vfloat _b)            { return _mm512_max_ps(_a, _b);            }
+        static inline vfloat vmadd(vfloat _a, vfloat _b, vfloat _c) { return _mm512_fmadd_ps(_a, _b, _c);     }
+        static inline vfloat vround(vfloat _a)                     { return _mm512_roundscale_ps(_a, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+        static inline vmask  vcmpge(vfloat _a, vfloat _b)          { return _mm512_cmp_ps_mask(_a, _b, _CMP_GE_OQ); }
+        static inline vmask  vcmpgt(vfloat _a, vfloat _b)          { return _mm512_cmp_ps_mask(_a, _b, _CMP_GT_OQ); }
+        static inline vfloat vselect(vmask _m, vfloat _a, vfloat _b) { return _mm512_mask_blend_ps(_m, _b, _a); }
+        static inline vfloat vand(vmask _m, vfloat _a)             { return _mm512_maskz_mov_ps(_m, _a);      }
+        static inline bool   vany(vmask _m)                        { return 0 != _m;                          }
+
+        static inline vfloat vrsqrt(vfloat _a)
+        {
+            const __m512 est = _mm512_rsqrt14_ps(_a);
+            const __m512 hax = _mm512_mul_ps(_a, _mm512_set1_ps(0.5f));
+            return _mm512_mul_ps(est, _mm512_fnmadd_ps(hax, _mm512_mul_ps(est, est), _mm512_set1_ps(1.5f)));
+        }
+
+        static inline vfloat vlaneIndex()
+        {
+            return _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+        }
+
+        static inline vfloat vtexelIndex()
+        {
+            return _mm512_setr_ps(0.0f, 4.0f, 8.0f, 12.0f, 1.0f, 5.0f, 9.0f, 13.0f, 2.0f, 6.0f, 10.0f, 14.0f, 3.0f, 7.0f, 11.0f, 15.0f);
+        }
+
+        static inline vfloat vfrexp(vfloat _a, vfloat& _exp)
+        {
+            const __m512i bits = _mm512_castps_si512(_a);
+            _exp = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(127)));
+            return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_and_epi32(bits, _mm512_set1_epi32(0x007fffff)), _mm512_set1_epi32(0x3f800000)));
+        }
+
+        static inline vfloat vldexp(vfloat _n)
+        {
+            return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvttps_epi32(_n), _mm512_set1_epi32(127)), 23));
+        }
+
+        static inline float vhsum(vfloat _a)
+        {
+            const __m256 lo = _mm512_castps512_ps256(_a);
+            const __m256 hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(_a), 1));
+            const __m256 s8 = _mm256_add_ps(lo, hi);
+            const __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(s8), _mm256_extractf128_ps(s8, 1));
+            const __m128 s2 = _mm_add_ps(s4, _mm_movehl_ps(s4, s4));
+            const __m128 s1 = _mm_add_ss(s2, _mm_shuffle_ps(s2, s2, 1));
+            return _mm_cvtss_f32(s1);
+        }
+
+        /// Transposes four texels per register within 128-bit lanes.
+        /// Resulting lane order is permuted, but it is the same for normals and data.
+        static inline void vtranspose(vfloat _out[4], __m512 _r0, __m512 _r1, __m512 _r2, __m512 _r3)
+        {
+            const __m512 t0 = _mm512_unpacklo_ps(_r0, _r1);
+            const __m512 t1 = _mm512_unpackhi_ps(_r0, _r1);
+            const __m512 t2 = _mm512_unpacklo_ps(_r2, _r3);
+            const __m512 t3 = _mm512_unpackhi_ps(_r2, _r3);
+            _out[0] = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            _out[1] = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            _out[2] = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            _out[3] = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+
+        static inline void vloadTexels(vfloat _out[4], const float* _ptr)
+        {
+            vtranspose(_out
+                     , _mm512_loadu_ps(_ptr+ 0)
+                     , _mm512_loadu_ps(_ptr+16)
+                     , _mm512_loadu_ps(_ptr+32)
+                     , _mm512_loadu_ps(_ptr+48)
+                     );
+        }
+
+        static inline __mmask16 vloadMask(int32_t _num)
+        {
+            return (_num >= 16) ? __mmask16(0xffff) : (_num <= 0) ? __mmask16(0) : __mmask16((1u<<_num)-1);
+        }
+
+        static inline vfloat vloadu(const float* _ptr)
+        {
+            return _mm512_loadu_ps(_ptr);
+        }
+
+        static inline vfloat vloadPartial(const float* _ptr, uint32_t _count)
+        {
+            return _mm512_maskz_loadu_ps(vloadMask(int32_t(_count)), _ptr);
+        }
+
+        static inline void vloadTexelsPartial(vfloat _out[4], const float* _ptr, uint32_t _count)
+        {
+            const int32_t num = int32_t(_count*4);
+
+            vtranspose(_out
+                     , _mm512_maskz_loadu_ps(vloadMask(num- 0), _ptr+ 0)
+                     , _mm512_maskz_loadu_ps(vloadMask(num-16), _ptr+16)
+                     , _mm512_maskz_loadu_ps(vloadMask(num-32), _ptr+32)
+                     , _mm512_maskz_loadu_ps(vloadMask(num-48), _ptr+48)
+                     );
+        }
+
+        /// Same as vloadTexels() for RGBA16F texels.
+        static inline void vloadTexelsHalf(vfloat _out[4], const uint16_t* _ptr)
+        {
+            vtranspose(_out
+                     , _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(_ptr+ 0)))
+                     , _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(_ptr+16)))
+                     , _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(_ptr+32)))
+                     , _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(_ptr+48)))
+                     );
+        }
+
+        static inline void vloadTexelsHalfPartial(vfloat _out[4], const uint16_t* _ptr, uint32_t _count)
+        {
+            uint16_t tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4*sizeof(uint16_t));
+            vloadTexelsHalf(_out, tmp);
+        }
+
+        /// Same as vloadTexels() for RGBE texels, see rgbeToRgba32f(). Values below 2^-118 decode to zero.
+        /// Texels are decoded in lane order and permuted to the order of vtranspose().
+        static inline void vloadTexelsRgbe(vfloat _out[4], const uint8_t* _ptr)
+        {
+            const __m512i order = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+            const __m512i rgbe  = _mm512_permutexvar_epi32(order, _mm512_loadu_si512(_ptr));
+            const __m512i mask  = _mm512_set1_epi32(0xff);
+            const __m512i exp   = _mm512_srli_epi32(rgbe, 24);
+            const __m512  scale = _mm512_maskz_mov_ps(_mm512_cmpgt_epi32_mask(exp, _mm512_set1_epi32(9))
+                                                    , _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_sub_epi32(exp, _mm512_set1_epi32(9)), 23))
+                                                    );
+            _out[0] = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_epi32(rgbe,                        mask)), scale);
+            _out[1] = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_epi32(_mm512_srli_epi32(rgbe,  8), mask)), scale);
+            _out[2] = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_epi32(_mm512_srli_epi32(rgbe, 16), mask)), scale);
+            _out[3] = _mm512_set1_ps(1.0f);
+        }
+
+        static inline void vloadTexelsRgbePartial(vfloat _out[4], const uint8_t* _ptr, uint32_t _count)
+        {
+            uint8_t tmp[VecWidth*4];
+            memset(tmp, 0, sizeof(tmp));
+            memcpy(tmp, _ptr, _count*4);
+            vloadTexelsRgbe(_out, tmp);
+        }
+
+        #include "radiancekernel_simd.h"
+
+    } // namespace avx512
+
+    CMFT_PRAGMA_DIAGNOSTIC_POP();
+
+#   if defined(__clang__)
+#       pragma clang attribute pop
+#   elif defined(__GNUC__)
+#       pragma GCC pop_options
+#   endif
+#endif //CMFT_SIMD_AVX512
+
+    // Dispatch.
+    //-----
+
+    SimdLevel::Enum simdLevelDetect()
+    {
+        const uint32_t features = cpuFeatures();
+        CMFT_UNUSED(features);
+
+        #if CMFT_SIMD_AVX512
+            if (features&CpuFeature::Avx512f)
+            {
+                return SimdLevel::Avx512;
+            }
+        #endif //CMFT_SIMD_AVX512
+
+        #if CMFT_SIMD_AVX2
+            if ((features&CpuFeature::Avx2)
+            &&  (features&CpuFeature::Fma)
+            &&  (features&CpuFeature::F16c))
+            {
+                return SimdLevel::Avx2;
+            }
+        #endif //CMFT_SIMD_AVX2
+
+        #if CMFT_SIMD_SSE41
+            if (features&CpuFeature::Sse41)
+            {
+                return SimdLevel::Sse41;
+            }
+        #endif //CMFT_SIMD_SSE41
+
+        return SimdLevel::Scalar;
+    }
+
+    static const char* s_simdLevelStr[SimdLevel::Count] =
+    {
+        "scalar",
+        "sse4.1",
+        "avx2",
+        "avx512",
+    };
+
+    const char* getSimdLevelStr(SimdLevel::Enum _simdLevel)
+    {
+        DEBUG_CHECK(_simdLevel < SimdLevel::Count, "Reading array out of bounds!");
+        return s_simdLevelStr[uint8_t(_simdLevel)];
+    }
+
+    template <typename AccumTy, typename DataTy>
+    static RadianceKernelFn scalarRadianceKernel(TableLayout::Enum _tableLayout, TexelNormals::Enum _texelNormals)
+    {
+        const bool planar = (TableLayout::Planar == _tableLayout);
+
+        if (TexelNormals::Computed == _texelNormals)
+        {
+            return planar ? radianceKernelScalarComputed<true, AccumTy, Rgba32fTexel> : radianceKernelScalarComputed<false, AccumTy, DataTy>;
+        }
+
+        return planar ? radianceKernelScalarPlanar<AccumTy> : radianceKernelScalar<AccumTy, DataTy>;
+    }
+
+    template <typename AccumTy>
+    static RadianceKernelFn scalarRadianceKernel(TableLayout::Enum _tableLayout, TexelNormals::Enum _texelNormals, TextureFormat::Enum _srcFormat)
+    {
+        switch (_srcFormat)
+        {
+        case TextureFormat::RGBA32F: return scalarRadianceKernel<AccumTy, Rgba32fTexel>(_tableLayout, _texelNormals);
+        case TextureFormat::RGBA16F: return scalarRadianceKernel<AccumTy, Rgba16fTexel>(_tableLayout, _texelNormals);
+        case TextureFormat::RGBE:    return scalarRadianceKernel<AccumTy, RgbeTexel>(_tableLayout, _texelNormals);
+        default:                     return NULL;
+        }
+    }
+
+    static RadianceKernelFn scalarRadianceKernel(TableLayout::Enum _tableLayout, TexelNormals::Enum _texelNormals, Accumulation::Enum _accumulation, TextureFormat::Enum _srcFormat)
+    {
+        // Planar kernels read float planes, whatever the source format is.
+        if (TableLayout::Planar == _tableLayout)
+        {
+            _srcFormat = TextureFormat::RGBA32F;
+        }
+
+        switch (_accumulation)
+        {
+        case Accumulation::Double:      return scalarRadianceKernel< ScalarAccumulator<double> >(_tableLayout, _texelNormals, _srcFormat);
+        case Accumulation::Compensated: return scalarRadianceKernel<CompensatedScalarAccumulator>(_tableLayout, _texelNormals, _srcFormat);
+        default:                        return scalarRadianceKernel< ScalarAccumulator<float> >(_tableLayout, _texelNormals, _srcFormat);
+        }
+    }
+
+    template <typename AccumTy, typename DataTy>
+    static RadianceGroupKernelFn scalarRadianceGroupKernel(TableLayout::Enum _tableLayout, TexelNormals::Enum _texelNormals)
+    {
+        const bool planar = (TableLayout::Planar == _tableLayout);
+
+        if (TexelNormals::Computed == _texelNormals)
+        {
+            return planar ? radianceGroupKernelScalar<true, true, AccumTy, Rgba32fTexel> : radianceGroupKernelScalar<false, true, AccumTy, DataTy>;
+        }
+
+        return planar ? radianceGroupKernelScalar<true, false, AccumTy, Rgba32fTexel> : radianceGroupKernelScalar<false, false, AccumTy, DataTy>;
+    }
+
+    template <typename AccumTy>
+    static RadianceGroupKernelFn scalarRadianceGroupKernel(TableLayout::Enum _tableLayout, TexelNormals::Enum _texelNormals, TextureFormat::Enum _srcFormat)
+    {
+        switch (_srcFormat)
+        {
+        case TextureFormat::RGBA32F: return scalarRadianceGroupKernel<AccumTy, Rgba32fTexel>(_tableLayout, _texelNormals);
+        case TextureFormat::RGBA16F: return scalarRadianceGroupKernel<AccumTy, Rgba16fTexel>(_tableLayout, _texelNormals);
+        case TextureFormat::RGBE:    return scalarRadianceGroupKernel<AccumTy, RgbeTexel>(_tableLayout, _texelNormals);
+        default:                     return NULL;
+        }
+    }
+
+    static RadianceGroupKernelFn scalarRadianceGroupKernel(TableLayout::Enum _tableLayout, TexelNormals::Enum _texelNormals, Accumulation::Enum _accumulation, TextureFormat::Enum _srcFormat)
+    {
+        if (TableLayout::Planar == _tableLayout)
+        {
+            _srcFormat = TextureFormat::RGBA32F;
+        }
+
+        switch (_accumulation)
+        {
+        case Accumulation::Double:      return scalarRadianceGroupKernel< ScalarAccumulator<double> >(_tableLayout, _texelNormals, _srcFormat);
+        case Accumulation::Compensated: return scalarRadianceGroupKernel<CompensatedScalarAccumulator>(_tableLayout, _texelNormals, _srcFormat);
+        default:                        return scalarRadianceGroupKernel< ScalarAccumulator<float> >(_tableLayout, _texelNormals, _srcFormat);
+        }
+    }
+
+    RadianceKernelFn radianceKernel(SimdLevel::Enum _simdLevel
+                                  , TableLayout::Enum _tableLayout
+                                  , LobeMath::Enum _lobeMath
+                                  , TexelNormals::Enum _texelNormals
+                                  , Accumulation::Enum _accumulation
+                                  , TextureFormat::Enum _srcFormat
+                                  )
+    {
+        CMFT_UNUSED(_lobeMath);
+
+        switch (_simdLevel)
+        {
+        // One powf() per texel is already cheaper than the polynomial evaluated on scalars, lobe math is ignored.
+        case SimdLevel::Scalar: return scalarRadianceKernel(_tableLayout, _texelNormals, _accumulation, _srcFormat);
+        #if CMFT_SIMD_SSE41
+        case SimdLevel::Sse41:  return sse41::radianceKernel(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+        #endif //CMFT_SIMD_SSE41
+        #if CMFT_SIMD_AVX2
+        case SimdLevel::Avx2:   return avx2::radianceKernel(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+        #endif //CMFT_SIMD_AVX2
+        #if CMFT_SIMD_AVX512
+        case SimdLevel::Avx512: return avx512::radianceKernel(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+        #endif //CMFT_SIMD_AVX512
+        default:                return NULL;
+        }
+    }
+
+    RadianceGroupKernelFn radianceGroupKernel(SimdLevel::Enum _simdLevel
+                                            , TableLayout::Enum _tableLayout
+                                            , LobeMath::Enum _lobeMath
+                                            , TexelNormals::Enum _texelNormals
+                                            , Accumulation::Enum _accumulation
+                                            , TextureFormat::Enum _srcFormat
+                                            )
+    {
+        CMFT_UNUSED(_lobeMath);
+
+        switch (_simdLevel)
+        {
+        case SimdLevel::Scalar: return scalarRadianceGroupKernel(_tableLayout, _texelNormals, _accumulation, _srcFormat);
+        #if CMFT_SIMD_SSE41
+        case SimdLevel::Sse41:  return sse41::radianceGroupKernel(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+        #endif //CMFT_SIMD_SSE41
+        #if CMFT_SIMD_AVX2
+        case SimdLevel::Avx2:   return avx2::radianceGroupKernel(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+        #endif //CMFT_SIMD_AVX2
+        #if CMFT_SIMD_AVX512
+        case SimdLevel::Avx512: return avx512::radianceGroupKernel(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+        #endif //CMFT_SIMD_AVX512
+        default:                return NULL;
+        }
+    }
+
+} // namespace cmft
+
+/* vim: set sw=4 ts=4 expandtab: */
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2014-2015 Dario Manesku. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef CMFT_RADIANCEKERNEL_H_HEADER_GUARD
+#define CMFT_RADIANCEKERNEL_H_HEADER_GUARD
+
+#include <stdint.h>
+#include <cmft/cubemapfilter.h> // TableLayout, LobeMath, TexelNormals, Accumulation, TextureFormat
+
+namespace cmft
+{
+    struct SimdLevel
+    {
+        enum Enum
+        {
+            Scalar,
+            Sse41,
+            Avx2,
+            Avx512,
+
+            Count
+        };
+    };
+
+    /// Returns the widest instruction set that is both compiled in and supported by the host cpu.
+    SimdLevel::Enum simdLevelDetect();
+
+    const char* getSimdLevelStr(SimdLevel::Enum _simdLevel);
+
+    /// Inclusive texel range on a single cube face. When m_inside is set, every texel of the span is
+    /// known to be inside the specular lobe and kernels skip the per texel test.
+    struct RadianceFilterSpan
+    {
+        uint32_t m_minX;
+        uint32_t m_maxX;
+        uint32_t m_minY;
+        uint32_t m_maxY;
+        uint8_t m_face;
+        bool m_inside;
+    };
+
+    /// Inputs for accumulating the specular lobe over the filter area of a single output texel.
+    /// Interleaved normals and source data are (x,y,z,solidAngle) and (r,g,b,a) float4 per texel.
+    /// Planar tables are laid out as [face][channel][row][m_planePitch] floats, see buildCubemapPlanes().
+    /// Kernels with computed texel normals read neither normal table, but use m_warpFixup instead,
+    /// which is warpFixupFactor() of the source face size for EdgeFixup::Warp and 0.0 otherwise.
+    /// m_srcData texels are m_srcFormat, one of RGBA32F, RGBA16F or RGBE. Interleaved kernels decode them in
+    /// registers, planar kernels read float m_srcPlanes only.
+    /// Accumulation::Compensated kernels continue the running sums (0..3) and compensations (4..7) in
+    /// m_runningSum, which have to be zeroed for each output texel, and return the compensated total.
+    struct RadianceKernelArgs
+    {
+        const float* m_tapVec;
+        float m_specularPower;
+        float m_specularAngle;
+        const float* m_cubemapNormalSolidAngle;
+        const void* m_srcData;
+        TextureFormat::Enum m_srcFormat;
+        const uint32_t* m_faceOffsets;
+        const float* m_normalPlanes;
+        const float* m_srcPlanes;
+        uint32_t m_planePitch;
+        uint32_t m_srcFaceSize;
+        float m_warpFixup;
+        const RadianceFilterSpan* m_spans;
+        uint32_t m_numSpans;
+        float* m_runningSum;
+    };
+
+    /// Returns weighted color in _colorWeight[0..2] and total weight in _colorWeight[3].
+    typedef void (*RadianceKernelFn)(float _colorWeight[4], const RadianceKernelArgs& _args);
+
+    /// Returns kernel for given instruction set, table layout, lobe evaluation, texel normals (Table or Computed),
+    /// accumulation and source format or NULL when it is not compiled in or the format is not supported. Scalar kernel is always available, it evaluates the
+    /// lobe with powf() and its Table variant is used as the reference for the others.
+    RadianceKernelFn radianceKernel(SimdLevel::Enum _simdLevel
+                                  , TableLayout::Enum _tableLayout = TableLayout::Interleaved
+                                  , LobeMath::Enum _lobeMath = LobeMath::Precise
+                                  , TexelNormals::Enum _texelNormals = TexelNormals::Table
+                                  , Accumulation::Enum _accumulation = Accumulation::Float
+                                  , TextureFormat::Enum _srcFormat = TextureFormat::RGBA32F
+                                  );
+
+    /// Most sources that a group kernel filters at once.
+    #define RADIANCE_KERNEL_MAX_GROUP 8
+
+    /// Accumulates the same spans of _numArgs sources, at most RADIANCE_KERNEL_MAX_GROUP, and returns four floats
+    /// per source in _colorWeight. Sources have the same size and format and differ in m_srcData, m_faceOffsets,
+    /// m_srcPlanes and m_runningSum only, so the lobe weight of each texel is evaluated once for all of them.
+    /// Results are bit exact with the single source kernel.
+    typedef void (*RadianceGroupKernelFn)(float* _colorWeight, const RadianceKernelArgs* _args, uint8_t _numArgs);
+
+    /// Returns group kernel of radianceKernel() with the same parameters, or NULL when there is none.
+    RadianceGroupKernelFn radianceGroupKernel(SimdLevel::Enum _simdLevel
+                                            , TableLayout::Enum _tableLayout
+                                            , LobeMath::Enum _lobeMath
+                                            , TexelNormals::Enum _texelNormals
+                                            , Accumulation::Enum _accumulation
+                                            , TextureFormat::Enum _srcFormat
+                                            );
+
+    /// Row pitch, in floats, of planar tables. Rows are aligned to 64 bytes.
+    static inline uint32_t cubemapPlanePitch(uint32_t _faceSize)
+    {
+        return (_faceSize + 15) & ~UINT32_C(15);
+    }
+
+} // namespace cmft
+
+#endif //CMFT_RADIANCEKERNEL_H_HEADER_GUARD
+
+/* vim: set sw=4 ts=4 expandtab: */
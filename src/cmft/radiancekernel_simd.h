@@ -0,0 +1,754 @@
+/*
+ * Copyright 2014-2015 Dario Manesku. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+// This file is included multiple times from radiancekernel.cpp, once for each instruction set.
+// Before including, the namespace has to provide vfloat/vmask types, VecWidth and the v*() helpers,
+// including vloadTexels*() for interleaved float4 texels, vloadTexelsHalf*() and vloadTexelsRgbe*() for
+// interleaved RGBA16F and RGBE texels and vloadu()/vloadPartial() for planes.
+// No include guard on purpose.
+
+    /// log2() for positive normalized values. Mantissa is mapped to [sqrt(0.5), sqrt(2)) and log
+    /// is evaluated as 2*atanh((m-1)/(m+1)) series, which keeps relative precision around 1.0.
+    static inline vfloat vlog2(vfloat _x)
+    {
+        const vfloat one = vsplat(1.0f);
+
+        vfloat ex;
+        vfloat mm = vfrexp(_x, ex);
+
+        const vmask big = vcmpgt(mm, vsplat(1.41421356f));
+        mm = vselect(big, vmul(mm, vsplat(0.5f)), mm);
+        ex = vadd(ex, vand(big, one));
+
+        const vfloat tt = vdiv(vsub(mm, one), vadd(mm, one));
+        const vfloat t2 = vmul(tt, tt);
+
+        vfloat pp = vmadd(t2, vsplat(1.0f/9.0f), vsplat(1.0f/7.0f));
+        pp = vmadd(pp, t2, vsplat(1.0f/5.0f));
+        pp = vmadd(pp, t2, vsplat(1.0f/3.0f));
+        pp = vmadd(pp, t2, one);
+
+        const vfloat ln = vmul(vmul(tt, vsplat(2.0f)), pp);
+        return vmadd(ln, vsplat(1.44269504f), ex);
+    }
+
+    /// exp2() for values <= 0. Results below 2^-126 are flushed to zero.
+    static inline vfloat vexp2(vfloat _x)
+    {
+        const vmask valid = vcmpgt(_x, vsplat(-126.0f));
+        const vfloat xx = vmin(vmax(_x, vsplat(-126.0f)), vsplat(127.0f));
+
+        const vfloat nn = vround(xx);
+        const vfloat gg = vmul(vsub(xx, nn), vsplat(0.69314718f));
+
+        // Taylor series of e^g, |g| <= ln(2)/2.
+        vfloat pp = vmadd(gg, vsplat(1.0f/5040.0f), vsplat(1.0f/720.0f));
+        pp = vmadd(pp, gg, vsplat(1.0f/120.0f));
+        pp = vmadd(pp, gg, vsplat(1.0f/24.0f));
+        pp = vmadd(pp, gg, vsplat(1.0f/6.0f));
+        pp = vmadd(pp, gg, vsplat(1.0f/2.0f));
+        pp = vmadd(pp, gg, vsplat(1.0f));
+        pp = vmadd(pp, gg, vsplat(1.0f));
+
+        return vand(valid, vmul(pp, vldexp(nn)));
+    }
+
+    /// log2() for positive normalized values without division. Mantissa is mapped to [sqrt(0.5), sqrt(2))
+    /// and log2(1+x) is evaluated as x*P(x), P is a degree 5 fit with max relative error 7.4e-6.
+    static inline vfloat vlog2Fast(vfloat _x)
+    {
+        const vfloat one = vsplat(1.0f);
+
+        vfloat ex;
+        vfloat mm = vfrexp(_x, ex);
+
+        const vmask big = vcmpgt(mm, vsplat(1.41421356f));
+        mm = vselect(big, vmul(mm, vsplat(0.5f)), mm);
+        ex = vadd(ex, vand(big, one));
+
+        const vfloat xx = vsub(mm, one);
+
+        vfloat pp = vmadd(xx, vsplat(-0.206188534f), vsplat(0.318199133f));
+        pp = vmadd(pp, xx, vsplat(-0.366492003f));
+        pp = vmadd(pp, xx, vsplat( 0.479811923f));
+        pp = vmadd(pp, xx, vsplat(-0.721206382f));
+        pp = vmadd(pp, xx, vsplat( 1.442701617f));
+
+        return vmadd(xx, pp, ex);
+    }
+
+    /// exp2() for values <= 0 with a degree 4 fit, max relative error 2.6e-6. Results below 2^-126 are flushed to zero.
+    static inline vfloat vexp2Fast(vfloat _x)
+    {
+        const vmask valid = vcmpgt(_x, vsplat(-126.0f));
+        const vfloat xx = vmax(_x, vsplat(-126.0f));
+        const vfloat nn = vround(xx);
+        const vfloat ff = vsub(xx, nn);
+
+        vfloat pp = vmadd(ff, vsplat(0.00957009667f), vsplat(0.0559178599f));
+        pp = vmadd(pp, ff, vsplat(0.240247450f));
+        pp = vmadd(pp, ff, vsplat(0.693121815f));
+        pp = vmadd(pp, ff, vsplat(0.999999261f));
+
+        return vand(valid, vmul(pp, vldexp(nn)));
+    }
+
+    /// Source data formats of interleaved kernels. Each loads four channel texels to registers in vloadTexels() order.
+    struct Rgba32fData
+    {
+        typedef float Type;
+
+        static void load(vfloat _data[4], const float* _ptr)                      { vloadTexels(_data, _ptr);               }
+        static void loadPartial(vfloat _data[4], const float* _ptr, uint32_t _num) { vloadTexelsPartial(_data, _ptr, _num); }
+    };
+
+    struct Rgba16fData
+    {
+        typedef uint16_t Type;
+
+        static void load(vfloat _data[4], const uint16_t* _ptr)                      { vloadTexelsHalf(_data, _ptr);               }
+        static void loadPartial(vfloat _data[4], const uint16_t* _ptr, uint32_t _num) { vloadTexelsHalfPartial(_data, _ptr, _num); }
+    };
+
+    struct RgbeData
+    {
+        typedef uint8_t Type;
+
+        static void load(vfloat _data[4], const uint8_t* _ptr)                      { vloadTexelsRgbe(_data, _ptr);               }
+        static void loadPartial(vfloat _data[4], const uint8_t* _ptr, uint32_t _num) { vloadTexelsRgbePartial(_data, _ptr, _num); }
+    };
+
+    /// Reads (x,y,z,solidAngle) float4 texels and (r,g,b,a) texels of DataTy format, decoded in registers.
+    template <typename DataTy>
+    struct InterleavedTexels
+    {
+        typedef typename DataTy::Type DataType;
+
+        InterleavedTexels(const RadianceKernelArgs& _args)
+            : m_args(_args)
+            , m_pitch(_args.m_srcFaceSize*4)
+        {
+        }
+
+        void setFace(uint8_t _face)
+        {
+            m_faceData    = (const DataType*)((const uint8_t*)m_args.m_srcData + m_args.m_faceOffsets[_face]);
+            m_faceNormals = m_args.m_cubemapNormalSolidAngle + m_pitch*m_args.m_srcFaceSize*_face;
+        }
+
+        void setRow(uint32_t _yy, uint32_t _minX)
+        {
+            m_rowData    = m_faceData    + _yy*m_pitch + _minX*4;
+            m_rowNormals = m_faceNormals + _yy*m_pitch + _minX*4;
+        }
+
+        static vfloat laneTexels()
+        {
+            return vtexelIndex();
+        }
+
+        void loadNormals(vfloat _normal[4], uint32_t _xx, uint32_t _num) const
+        {
+            if (_num >= VecWidth)
+            {
+                vloadTexels(_normal, m_rowNormals + _xx*4);
+            }
+            else
+            {
+                vloadTexelsPartial(_normal, m_rowNormals + _xx*4, _num);
+            }
+        }
+
+        /// _offset is dataOffset() of another source of a group kernel, 0 for this one.
+        void loadData(vfloat _data[4], uint32_t _xx, uint32_t _num, ptrdiff_t _offset = 0) const
+        {
+            const DataType* ptr = (const DataType*)((const uint8_t*)(m_rowData + _xx*4) + _offset);
+            if (_num >= VecWidth)
+            {
+                DataTy::load(_data, ptr);
+            }
+            else
+            {
+                DataTy::loadPartial(_data, ptr, _num);
+            }
+        }
+
+        /// Bytes from face data of this source to face data of _other, which has the same size and format.
+        ptrdiff_t dataOffset(const RadianceKernelArgs& _other, uint8_t _face) const
+        {
+            return ((const uint8_t*)_other.m_srcData + _other.m_faceOffsets[_face]) - (const uint8_t*)m_faceData;
+        }
+
+        const RadianceKernelArgs& m_args;
+        uint32_t m_pitch;
+        const DataType* m_faceData;
+        const float* m_faceNormals;
+        const DataType* m_rowData;
+        const float* m_rowNormals;
+    };
+
+    /// Reads x,y,z,solidAngle and r,g,b planes. Every channel is a straight vector load.
+    struct PlanarTexels
+    {
+        PlanarTexels(const RadianceKernelArgs& _args)
+            : m_args(_args)
+            , m_planeSize(_args.m_planePitch*_args.m_srcFaceSize)
+        {
+        }
+
+        void setFace(uint8_t _face)
+        {
+            m_faceData    = m_args.m_srcPlanes    + m_planeSize*3*_face;
+            m_faceNormals = m_args.m_normalPlanes + m_planeSize*4*_face;
+        }
+
+        void setRow(uint32_t _yy, uint32_t _minX)
+        {
+            const uint32_t offset = _yy*m_args.m_planePitch + _minX;
+            m_rowData    = m_faceData    + offset;
+            m_rowNormals = m_faceNormals + offset;
+        }
+
+        static vfloat laneTexels()
+        {
+            return vlaneIndex();
+        }
+
+        void loadNormals(vfloat _normal[4], uint32_t _xx, uint32_t _num) const
+        {
+            const float* ptr = m_rowNormals + _xx;
+            if (_num >= VecWidth)
+            {
+                _normal[0] = vloadu(ptr);
+                _normal[1] = vloadu(ptr + m_planeSize);
+                _normal[2] = vloadu(ptr + m_planeSize*2);
+                _normal[3] = vloadu(ptr + m_planeSize*3);
+            }
+            else
+            {
+                _normal[0] = vloadPartial(ptr,                 _num);
+                _normal[1] = vloadPartial(ptr + m_planeSize,   _num);
+                _normal[2] = vloadPartial(ptr + m_planeSize*2, _num);
+                _normal[3] = vloadPartial(ptr + m_planeSize*3, _num);
+            }
+        }
+
+        /// _offset is dataOffset() of another source of a group kernel, 0 for this one.
+        void loadData(vfloat _data[4], uint32_t _xx, uint32_t _num, ptrdiff_t _offset = 0) const
+        {
+            const float* ptr = (const float*)((const uint8_t*)(m_rowData + _xx) + _offset);
+            if (_num >= VecWidth)
+            {
+                _data[0] = vloadu(ptr);
+                _data[1] = vloadu(ptr + m_planeSize);
+                _data[2] = vloadu(ptr + m_planeSize*2);
+            }
+            else
+            {
+                _data[0] = vloadPartial(ptr,                 _num);
+                _data[1] = vloadPartial(ptr + m_planeSize,   _num);
+                _data[2] = vloadPartial(ptr + m_planeSize*2, _num);
+            }
+        }
+
+        /// Bytes from face data of this source to face data of _other, which has the same size.
+        ptrdiff_t dataOffset(const RadianceKernelArgs& _other, uint8_t _face) const
+        {
+            return (const uint8_t*)(_other.m_srcPlanes + m_planeSize*3*_face) - (const uint8_t*)m_faceData;
+        }
+
+        const RadianceKernelArgs& m_args;
+        uint32_t m_planeSize;
+        const float* m_faceData;
+        const float* m_faceNormals;
+        const float* m_rowData;
+        const float* m_rowNormals;
+    };
+
+    /// Reads texel normals and solid angles from the table.
+    template <typename TexelsTy>
+    struct TableNormals : public TexelsTy
+    {
+        TableNormals(const RadianceKernelArgs& _args)
+            : TexelsTy(_args)
+        {
+            m_tap[0] = vsplat(_args.m_tapVec[0]);
+            m_tap[1] = vsplat(_args.m_tapVec[1]);
+            m_tap[2] = vsplat(_args.m_tapVec[2]);
+        }
+
+        /// Loads cosine between texel normals and the tap vector and solid angle of texels.
+        void loadLobe(vfloat& _dotProduct, vfloat& _solidAngle, uint32_t _xx, uint32_t _num) const
+        {
+            vfloat normal[4];
+            TexelsTy::loadNormals(normal, _xx, _num);
+
+            _dotProduct = vmadd(normal[0], m_tap[0], vmadd(normal[1], m_tap[1], vmul(normal[2], m_tap[2])));
+            _solidAngle = normal[3];
+        }
+
+        vfloat m_tap[3];
+    };
+
+    /// Computes texel normals and solid angles from texel coordinates instead of reading the table, so
+    /// only source data is streamed. Texel direction is faceUv[0]*u + faceUv[1]*v + faceUv[2] normalized,
+    /// so the tap vector is projected to face axes once per face and the v terms are evaluated once per row.
+    /// Solid angle is approximated at the texel center by (2/faceSize)^2/(1+u^2+v^2)^1.5 of unwarped u,v.
+    template <typename TexelsTy>
+    struct ComputedNormals : public TexelsTy
+    {
+        ComputedNormals(const RadianceKernelArgs& _args)
+            : TexelsTy(_args)
+            , m_tapVec(_args.m_tapVec)
+        {
+            const float invFaceSize = 1.0f/float(int32_t(_args.m_srcFaceSize));
+            m_step      = 2.0f*invFaceSize;
+            m_offset    = invFaceSize - 1.0f;
+            m_warp      = _args.m_warpFixup;
+            m_laneU     = vmul(TexelsTy::laneTexels(), vsplat(m_step));
+            m_texelArea = vsplat(m_step*m_step);
+        }
+
+        void setFace(uint8_t _face)
+        {
+            TexelsTy::setFace(_face);
+
+            const float (*faceUv)[3] = s_faceUvVectors[_face];
+            m_tapU = vsplat(vec3Dot(faceUv[0], m_tapVec));
+            m_tapV = vec3Dot(faceUv[1], m_tapVec);
+            m_tapW = vec3Dot(faceUv[2], m_tapVec);
+        }
+
+        void setRow(uint32_t _yy, uint32_t _minX)
+        {
+            TexelsTy::setRow(_yy, _minX);
+
+            const float vv = float(int32_t(_yy))*m_step + m_offset;
+            const float vvWarp = vv*(1.0f + m_warp*vv*vv);
+            m_rowDot    = vsplat(m_tapV*vvWarp + m_tapW);
+            m_rowLenSq  = vsplat(1.0f + vvWarp*vvWarp);
+            m_rowAreaSq = vsplat(1.0f + vv*vv);
+            m_rowMinU   = float(int32_t(_minX))*m_step + m_offset;
+        }
+
+        void loadLobe(vfloat& _dotProduct, vfloat& _solidAngle, uint32_t _xx, uint32_t _num) const
+        {
+            const vfloat uu = vadd(m_laneU, vsplat(float(int32_t(_xx))*m_step + m_rowMinU));
+
+            vfloat invArea;
+            if (0.0f == m_warp)
+            {
+                invArea = vrsqrt(vmadd(uu, uu, m_rowLenSq));
+                _dotProduct = vmul(vmadd(m_tapU, uu, m_rowDot), invArea);
+            }
+            else
+            {
+                const vfloat uuWarp = vmul(uu, vmadd(vmul(uu, uu), vsplat(m_warp), vsplat(1.0f)));
+                const vfloat invLen = vrsqrt(vmadd(uuWarp, uuWarp, m_rowLenSq));
+                _dotProduct = vmul(vmadd(m_tapU, uuWarp, m_rowDot), invLen);
+                invArea = vrsqrt(vmadd(uu, uu, m_rowAreaSq));
+            }
+
+            _solidAngle = vmul(m_texelArea, vmul(invArea, vmul(invArea, invArea)));
+
+            // Lanes past the end of the row must not add any weight.
+            if (_num < VecWidth)
+            {
+                _solidAngle = vand(vcmpgt(vsplat(float(int32_t(_num))), TexelsTy::laneTexels()), _solidAngle);
+            }
+        }
+
+        const float* m_tapVec;
+        float m_step;
+        float m_offset;
+        float m_warp;
+        float m_tapV;
+        float m_tapW;
+        float m_rowMinU;
+        vfloat m_laneU;
+        vfloat m_texelArea;
+        vfloat m_tapU;
+        vfloat m_rowDot;
+        vfloat m_rowLenSq;
+        vfloat m_rowAreaSq;
+    };
+
+    /// Sums weighted color and weight of the whole filter area in float lanes.
+    struct FloatAccumulator
+    {
+        enum { AnchorLanes = false };
+
+        FloatAccumulator(const RadianceKernelArgs& /*_args*/)
+        {
+            m_sum[0] = vzero();
+            m_sum[1] = vzero();
+            m_sum[2] = vzero();
+            m_sum[3] = vzero();
+        }
+
+        void add(const vfloat _data[4], vfloat _weight)
+        {
+            m_sum[0] = vmadd(_data[0], _weight, m_sum[0]);
+            m_sum[1] = vmadd(_data[1], _weight, m_sum[1]);
+            m_sum[2] = vmadd(_data[2], _weight, m_sum[2]);
+            m_sum[3] = vadd(_weight, m_sum[3]);
+        }
+
+        void endRow()
+        {
+        }
+
+        void result(float _colorWeight[4]) const
+        {
+            _colorWeight[0] = vhsum(m_sum[0]);
+            _colorWeight[1] = vhsum(m_sum[1]);
+            _colorWeight[2] = vhsum(m_sum[2]);
+            _colorWeight[3] = vhsum(m_sum[3]);
+        }
+
+        vfloat m_sum[4];
+    };
+
+    /// Sums each source row in float lanes and adds row sums in double.
+    struct DoubleAccumulator
+    {
+        enum { AnchorLanes = false };
+
+        DoubleAccumulator(const RadianceKernelArgs& /*_args*/)
+        {
+            for (uint8_t ii = 0; ii < 4; ++ii)
+            {
+                m_row[ii] = vzero();
+                m_sum[ii] = 0.0;
+            }
+        }
+
+        void add(const vfloat _data[4], vfloat _weight)
+        {
+            m_row[0] = vmadd(_data[0], _weight, m_row[0]);
+            m_row[1] = vmadd(_data[1], _weight, m_row[1]);
+            m_row[2] = vmadd(_data[2], _weight, m_row[2]);
+            m_row[3] = vadd(_weight, m_row[3]);
+        }
+
+        void endRow()
+        {
+            for (uint8_t ii = 0; ii < 4; ++ii)
+            {
+                m_sum[ii] += double(vhsum(m_row[ii]));
+                m_row[ii] = vzero();
+            }
+        }
+
+        void result(float _colorWeight[4]) const
+        {
+            _colorWeight[0] = float(m_sum[0]);
+            _colorWeight[1] = float(m_sum[1]);
+            _colorWeight[2] = float(m_sum[2]);
+            _colorWeight[3] = float(m_sum[3]);
+        }
+
+        vfloat m_row[4];
+        double m_sum[4];
+    };
+
+    /// Sums each source row in float lanes and adds row sums to RadianceKernelArgs::m_runningSum with
+    /// compensation. Lanes are anchored to texel columns, so a row sums to the same value whatever its span.
+    struct CompensatedAccumulator
+    {
+        enum { AnchorLanes = true };
+
+        CompensatedAccumulator(const RadianceKernelArgs& _args)
+            : m_runningSum(_args.m_runningSum)
+        {
+            m_row[0] = vzero();
+            m_row[1] = vzero();
+            m_row[2] = vzero();
+            m_row[3] = vzero();
+        }
+
+        void add(const vfloat _data[4], vfloat _weight)
+        {
+            m_row[0] = vmadd(_data[0], _weight, m_row[0]);
+            m_row[1] = vmadd(_data[1], _weight, m_row[1]);
+            m_row[2] = vmadd(_data[2], _weight, m_row[2]);
+            m_row[3] = vadd(_weight, m_row[3]);
+        }
+
+        void endRow()
+        {
+            for (uint8_t ii = 0; ii < 4; ++ii)
+            {
+                compensatedAdd(m_runningSum[ii], m_runningSum[ii+4], vhsum(m_row[ii]));
+                m_row[ii] = vzero();
+            }
+        }
+
+        void result(float _colorWeight[4]) const
+        {
+            _colorWeight[0] = m_runningSum[0] + m_runningSum[4];
+            _colorWeight[1] = m_runningSum[1] + m_runningSum[5];
+            _colorWeight[2] = m_runningSum[2] + m_runningSum[6];
+            _colorWeight[3] = m_runningSum[3] + m_runningSum[7];
+        }
+
+        float* m_runningSum;
+        vfloat m_row[4];
+    };
+
+    template <typename TexelsTy, typename AccumTy, bool FastLobeT>
+    static void radianceKernelImpl(float _colorWeight[4], const RadianceKernelArgs& _args)
+    {
+        const vfloat specularPower = vsplat(_args.m_specularPower);
+        const vfloat minDot = vsplat(FLT_MIN);
+
+        AccumTy accum(_args);
+        TexelsTy texels(_args);
+
+        for (uint32_t ii = 0; ii < _args.m_numSpans; ++ii)
+        {
+            const RadianceFilterSpan& span = _args.m_spans[ii];
+
+            // Spans inside of the lobe accept every texel.
+            const vfloat specularAngle = vsplat(span.m_inside ? -FLT_MAX : _args.m_specularAngle);
+
+            texels.setFace(span.m_face);
+
+            // Anchored rows start at a multiple of VecWidth and texels before the span get zero weight.
+            const uint32_t lead = AccumTy::AnchorLanes ? span.m_minX % VecWidth : 0;
+            const uint32_t minX = span.m_minX - lead;
+            const uint32_t count = span.m_maxX - minX + 1;
+            const vfloat leadTexels = vsplat(float(int32_t(lead)));
+
+            for (uint32_t yy = span.m_minY; yy <= span.m_maxY; ++yy)
+            {
+                texels.setRow(yy, minX);
+
+                for (uint32_t xx = 0; xx < count; xx += VecWidth)
+                {
+                    // Lanes past the end of the row are zero filled, so their solid angle, hence weight, is zero.
+                    const uint32_t num = count - xx;
+                    vfloat dotProduct;
+                    vfloat solidAngle;
+                    texels.loadLobe(dotProduct, solidAngle, xx, num);
+
+                    const vmask inside = vcmpge(dotProduct, specularAngle);
+                    if (!vany(inside))
+                    {
+                        continue;
+                    }
+
+                    vfloat data[4];
+                    texels.loadData(data, xx, num);
+
+                    const vfloat lobe = FastLobeT
+                                      ? vexp2Fast(vmul(vlog2Fast(vmax(dotProduct, minDot)), specularPower))
+                                      : vexp2    (vmul(vlog2    (vmax(dotProduct, minDot)), specularPower))
+                                      ;
+                    vfloat weight = vand(inside, vmul(solidAngle, lobe));
+                    if (0 == xx && 0 != lead)
+                    {
+                        weight = vand(vcmpge(TexelsTy::laneTexels(), leadTexels), weight);
+                    }
+
+                    accum.add(data, weight);
+                }
+
+                accum.endRow();
+            }
+        }
+
+        accum.result(_colorWeight);
+    }
+
+    /// radianceKernelImpl() for a group of sources. Weights of a run of texel vectors are evaluated with tables of
+    /// the first source, then every source adds its data of the same vectors in the same order as the single
+    /// source kernel does, so results are bit exact.
+    template <typename TexelsTy, typename AccumTy, bool FastLobeT>
+    static void radianceGroupKernelImpl(float* _colorWeight, const RadianceKernelArgs* _args, uint8_t _numArgs)
+    {
+        enum { MaxRun = 32 };
+
+        const vfloat specularPower = vsplat(_args[0].m_specularPower);
+        const vfloat minDot = vsplat(FLT_MIN);
+
+        GroupAccumulators<AccumTy> accum(_args, _numArgs);
+        TexelsTy texels(_args[0]);
+
+        vfloat weights[MaxRun];
+        uint32_t runX[MaxRun];
+        ptrdiff_t dataOffset[RADIANCE_KERNEL_MAX_GROUP];
+
+        for (uint32_t ii = 0; ii < _args[0].m_numSpans; ++ii)
+        {
+            const RadianceFilterSpan& span = _args[0].m_spans[ii];
+
+            // Spans inside of the lobe accept every texel.
+            const vfloat specularAngle = vsplat(span.m_inside ? -FLT_MAX : _args[0].m_specularAngle);
+
+            texels.setFace(span.m_face);
+            for (uint8_t jj = 0; jj < _numArgs; ++jj)
+            {
+                dataOffset[jj] = texels.dataOffset(_args[jj], span.m_face);
+            }
+
+            // Anchored rows start at a multiple of VecWidth and texels before the span get zero weight.
+            const uint32_t lead = AccumTy::AnchorLanes ? span.m_minX % VecWidth : 0;
+            const uint32_t minX = span.m_minX - lead;
+            const uint32_t count = span.m_maxX - minX + 1;
+            const vfloat leadTexels = vsplat(float(int32_t(lead)));
+
+            for (uint32_t yy = span.m_minY; yy <= span.m_maxY; ++yy)
+            {
+                texels.setRow(yy, minX);
+
+                for (uint32_t xx = 0; xx < count;)
+                {
+                    uint32_t numRun = 0;
+                    for (; xx < count && numRun < MaxRun; xx += VecWidth)
+                    {
+                        // Lanes past the end of the row are zero filled, so their solid angle, hence weight, is zero.
+                        const uint32_t num = count - xx;
+                        vfloat dotProduct;
+                        vfloat solidAngle;
+                        texels.loadLobe(dotProduct, solidAngle, xx, num);
+
+                        const vmask inside = vcmpge(dotProduct, specularAngle);
+                        if (!vany(inside))
+                        {
+                            continue;
+                        }
+
+                        const vfloat lobe = FastLobeT
+                                          ? vexp2Fast(vmul(vlog2Fast(vmax(dotProduct, minDot)), specularPower))
+                                          : vexp2    (vmul(vlog2    (vmax(dotProduct, minDot)), specularPower))
+                                          ;
+                        vfloat weight = vand(inside, vmul(solidAngle, lobe));
+                        if (0 == xx && 0 != lead)
+                        {
+                            weight = vand(vcmpge(TexelsTy::laneTexels(), leadTexels), weight);
+                        }
+
+                        weights[numRun] = weight;
+                        runX[numRun] = xx;
+                        ++numRun;
+                    }
+
+                    for (uint8_t jj = 0; jj < _numArgs; ++jj)
+                    {
+                        for (uint32_t run = 0; run < numRun; ++run)
+                        {
+                            vfloat data[4];
+                            texels.loadData(data, runX[run], count - runX[run], dataOffset[jj]);
+                            accum[jj].add(data, weights[run]);
+                        }
+                    }
+                }
+
+                for (uint8_t jj = 0; jj < _numArgs; ++jj)
+                {
+                    accum[jj].endRow();
+                }
+            }
+        }
+
+        for (uint8_t jj = 0; jj < _numArgs; ++jj)
+        {
+            accum[jj].result(&_colorWeight[jj*4]);
+        }
+    }
+
+    /// Selects the single source or the group kernel in the radianceKernel() chain below.
+    struct SingleKernel
+    {
+        typedef RadianceKernelFn FnType;
+
+        template <typename TexelsTy, typename AccumTy, bool FastLobeT>
+        static FnType get()
+        {
+            return radianceKernelImpl<TexelsTy, AccumTy, FastLobeT>;
+        }
+    };
+
+    struct GroupKernel
+    {
+        typedef RadianceGroupKernelFn FnType;
+
+        template <typename TexelsTy, typename AccumTy, bool FastLobeT>
+        static FnType get()
+        {
+            return radianceGroupKernelImpl<TexelsTy, AccumTy, FastLobeT>;
+        }
+    };
+
+    template <typename KernelTy, typename TexelsTy, typename AccumTy>
+    static typename KernelTy::FnType radianceKernel(LobeMath::Enum _lobeMath)
+    {
+        return (LobeMath::Fast == _lobeMath) ? KernelTy::template get<TexelsTy, AccumTy, true>() : KernelTy::template get<TexelsTy, AccumTy, false>();
+    }
+
+    template <typename KernelTy, typename TexelsTy>
+    static typename KernelTy::FnType radianceKernel(LobeMath::Enum _lobeMath, Accumulation::Enum _accumulation)
+    {
+        switch (_accumulation)
+        {
+        case Accumulation::Double:      return radianceKernel<KernelTy, TexelsTy, DoubleAccumulator>(_lobeMath);
+        case Accumulation::Compensated: return radianceKernel<KernelTy, TexelsTy, CompensatedAccumulator>(_lobeMath);
+        default:                        return radianceKernel<KernelTy, TexelsTy, FloatAccumulator>(_lobeMath);
+        }
+    }
+
+    template <typename KernelTy, typename TexelsTy>
+    static typename KernelTy::FnType radianceKernel(LobeMath::Enum _lobeMath, TexelNormals::Enum _texelNormals, Accumulation::Enum _accumulation)
+    {
+        return (TexelNormals::Computed == _texelNormals)
+             ? radianceKernel< KernelTy, ComputedNormals<TexelsTy> >(_lobeMath, _accumulation)
+             : radianceKernel< KernelTy, TableNormals<TexelsTy> >(_lobeMath, _accumulation)
+             ;
+    }
+
+    template <typename KernelTy>
+    static typename KernelTy::FnType radianceKernel(TableLayout::Enum _tableLayout
+                                                   , LobeMath::Enum _lobeMath
+                                                   , TexelNormals::Enum _texelNormals
+                                                   , Accumulation::Enum _accumulation
+                                                   , TextureFormat::Enum _srcFormat
+                                                   )
+    {
+        if (TableLayout::Planar == _tableLayout)
+        {
+            return radianceKernel<KernelTy, PlanarTexels>(_lobeMath, _texelNormals, _accumulation);
+        }
+
+        switch (_srcFormat)
+        {
+        case TextureFormat::RGBA32F: return radianceKernel< KernelTy, InterleavedTexels<Rgba32fData> >(_lobeMath, _texelNormals, _accumulation);
+        case TextureFormat::RGBA16F: return radianceKernel< KernelTy, InterleavedTexels<Rgba16fData> >(_lobeMath, _texelNormals, _accumulation);
+        case TextureFormat::RGBE:    return radianceKernel< KernelTy, InterleavedTexels<RgbeData> >(_lobeMath, _texelNormals, _accumulation);
+        default:                     return NULL;
+        }
+    }
+
+    static RadianceKernelFn radianceKernel(TableLayout::Enum _tableLayout
+                                         , LobeMath::Enum _lobeMath
+                                         , TexelNormals::Enum _texelNormals
+                                         , Accumulation::Enum _accumulation
+                                         , TextureFormat::Enum _srcFormat
+                                         )
+    {
+        return radianceKernel<SingleKernel>(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+    }
+
+    static RadianceGroupKernelFn radianceGroupKernel(TableLayout::Enum _tableLayout
+                                                   , LobeMath::Enum _lobeMath
+                                                   , TexelNormals::Enum _texelNormals
+                                                   , Accumulation::Enum _accumulation
+                                                   , TextureFormat::Enum _srcFormat
+                                                   )
+    {
+        return radianceKernel<GroupKernel>(_tableLayout, _lobeMath, _texelNormals, _accumulation, _srcFormat);
+    }
+
+/* vim: set sw=4 ts=4 expandtab: */
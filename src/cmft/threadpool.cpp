@@ -0,0 +1,274 @@
+/*
+ * Copyright 2016 Dario Manesku. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "common/config.h"
+#include "common/utils.h"
+
+#include <cmft/threadpool.h>
+
+#include <thread>             // C++11
+#include <mutex>              // C++11
+#include <condition_variable> // C++11
+
+namespace cmft
+{
+    // ThreadPool.
+    //-----
+
+    struct ThreadPoolJob
+    {
+        ThreadPoolTaskFn m_fn;
+        void* m_userData;
+        uint32_t m_count;
+        uint32_t m_nextIndex;
+        uint32_t m_numDone;
+        uint32_t m_maxWorkers;
+        uint32_t m_numWorkers;
+        ThreadPoolJob* m_next;
+    };
+
+    struct ThreadPool
+    {
+        enum
+        {
+            MaxWorkers = 64,
+        };
+
+        ThreadPool()
+        {
+            m_jobs       = NULL;
+            m_numWorkers = 0;
+            m_started    = false;
+            m_quit       = false;
+        }
+
+        ~ThreadPool()
+        {
+            shutdown();
+        }
+
+        void start(uint8_t _numWorkers)
+        {
+            shutdown();
+
+            std::lock_guard<std::mutex> lock(m_startAccess);
+            spawn(_numWorkers);
+        }
+
+        // Starts the pool with default number of workers unless it was already started.
+        void startDefault()
+        {
+            std::lock_guard<std::mutex> lock(m_startAccess);
+            if (m_started)
+            {
+                return;
+            }
+
+            const int32_t hwThreads = int32_t(std::thread::hardware_concurrency());
+            spawn(uint8_t(CMFT_CLAMP(hwThreads-1, 0, int32_t(MaxWorkers))));
+        }
+
+        void shutdown()
+        {
+            std::lock_guard<std::mutex> lock(m_startAccess);
+            if (!m_started)
+            {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> jobsLock(m_access);
+                m_quit = true;
+            }
+            m_wake.notify_all();
+
+            for (uint8_t ii = 0; ii < m_numWorkers; ++ii)
+            {
+                m_workers[ii].join();
+            }
+
+            m_numWorkers = 0;
+            m_started    = false;
+        }
+
+        uint8_t numWorkers() const
+        {
+            return m_numWorkers;
+        }
+
+        void run(ThreadPoolTaskFn _fn, void* _userData, uint32_t _count, uint8_t _maxWorkers)
+        {
+            startDefault();
+
+            // Nothing to share, process everything on the calling thread.
+            if (0 == m_numWorkers || 0 == _maxWorkers || _count <= 1)
+            {
+                for (uint32_t ii = 0; ii < _count; ++ii)
+                {
+                    _fn(_userData, ii);
+                }
+                return;
+            }
+
+            ThreadPoolJob job;
+            job.m_fn         = _fn;
+            job.m_userData   = _userData;
+            job.m_count      = _count;
+            job.m_nextIndex  = 0;
+            job.m_numDone    = 0;
+            job.m_maxWorkers = _maxWorkers;
+            job.m_numWorkers = 0;
+            job.m_next       = NULL;
+
+            std::unique_lock<std::mutex> lock(m_access);
+
+            // Append to the end, jobs are served in submission order.
+            ThreadPoolJob** tail = &m_jobs;
+            while (NULL != *tail)
+            {
+                tail = &(*tail)->m_next;
+            }
+            *tail = &job;
+
+            if (_count > 2 && _maxWorkers > 1)
+            {
+                m_wake.notify_all();
+            }
+            else
+            {
+                m_wake.notify_one();
+            }
+
+            // Calling thread is processing as well.
+            process(job, lock);
+
+            // Wait for tasks that are still running on the workers.
+            while (job.m_numDone != job.m_count)
+            {
+                m_done.wait(lock);
+            }
+        }
+
+    private:
+        // Expects m_startAccess to be locked.
+        void spawn(uint8_t _numWorkers)
+        {
+            m_quit       = false;
+            m_numWorkers = CMFT_MIN(_numWorkers, uint8_t(MaxWorkers));
+            for (uint8_t ii = 0; ii < m_numWorkers; ++ii)
+            {
+                m_workers[ii] = std::thread(workerFunc, this);
+            }
+            m_started = true;
+        }
+
+        static void workerFunc(ThreadPool* _pool)
+        {
+            std::unique_lock<std::mutex> lock(_pool->m_access);
+
+            for (;;)
+            {
+                ThreadPoolJob* job = _pool->m_jobs;
+                while (NULL != job && job->m_numWorkers >= job->m_maxWorkers)
+                {
+                    job = job->m_next;
+                }
+
+                if (NULL != job)
+                {
+                    job->m_numWorkers++;
+                    _pool->process(*job, lock);
+                    job->m_numWorkers--;
+                }
+                else if (_pool->m_quit)
+                {
+                    break;
+                }
+                else
+                {
+                    _pool->m_wake.wait(lock);
+                }
+            }
+        }
+
+        // Runs tasks of the job until all of them are started. Expects m_access to be locked.
+        // Job memory must not be accessed after the last task is done and m_access is released.
+        void process(ThreadPoolJob& _job, std::unique_lock<std::mutex>& _lock)
+        {
+            while (_job.m_nextIndex < _job.m_count)
+            {
+                const uint32_t index = _job.m_nextIndex++;
+                if (_job.m_nextIndex == _job.m_count)
+                {
+                    unlink(_job);
+                }
+
+                _lock.unlock();
+                _job.m_fn(_job.m_userData, index);
+                _lock.lock();
+
+                if (++_job.m_numDone == _job.m_count)
+                {
+                    m_done.notify_all();
+                }
+            }
+        }
+
+        void unlink(ThreadPoolJob& _job)
+        {
+            for (ThreadPoolJob** job = &m_jobs; NULL != *job; job = &(*job)->m_next)
+            {
+                if (*job == &_job)
+                {
+                    *job = _job.m_next;
+                    break;
+                }
+            }
+        }
+
+        std::mutex m_startAccess;
+        std::mutex m_access;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        ThreadPoolJob* m_jobs;
+        std::thread m_workers[MaxWorkers];
+        uint8_t m_numWorkers;
+        bool m_started;
+        bool m_quit;
+    };
+
+    static ThreadPool s_threadPool;
+
+    bool threadPoolInit(uint8_t _numWorkers)
+    {
+        if (_numWorkers > ThreadPool::MaxWorkers)
+        {
+            WARN("Thread pool supports at most %u workers, %u requested.", uint32_t(ThreadPool::MaxWorkers), uint32_t(_numWorkers));
+            return false;
+        }
+
+        s_threadPool.start(_numWorkers);
+        return true;
+    }
+
+    void threadPoolShutdown()
+    {
+        s_threadPool.shutdown();
+    }
+
+    uint8_t threadPoolNumWorkers()
+    {
+        s_threadPool.startDefault();
+        return s_threadPool.numWorkers();
+    }
+
+    void threadPoolRun(ThreadPoolTaskFn _fn, void* _userData, uint32_t _count, uint8_t _maxWorkers)
+    {
+        s_threadPool.run(_fn, _userData, _count, _maxWorkers);
+    }
+
+} // namespace cmft
+
+/* vim: set sw=4 ts=4 expandtab: */
@@ -18,6 +18,7 @@
 #include <cmft/cubemapfilter.h>
 #include <cmft/clcontext.h>
 #include <cmft/print.h>         // setWarningPrintf(), setInfoPrintf()
+#include <cmft/threadpool.h>    // threadPoolInit()
 
 using namespace cmft;
 
@@ -54,6 +55,7 @@ static const CliOptionMap s_lightingModel[] =
     { "phongbrdf", LightingModel::PhongBrdf },
     { "blinn",     LightingModel::Blinn     },
     { "blinnbrdf", LightingModel::BlinnBrdf },
+    { "ggx",       LightingModel::Ggx       },
     CLI_OPTION_MAP_TERMINATOR,
 };
 
@@ -64,6 +66,44 @@ static const CliOptionMap s_edgeFixup[] =
     CLI_OPTION_MAP_TERMINATOR,
 };
 
+static const CliOptionMap s_tableLayout[] =
+{
+    { "interleaved", TableLayout::Interleaved },
+    { "planar",      TableLayout::Planar      },
+    CLI_OPTION_MAP_TERMINATOR,
+};
+
+static const CliOptionMap s_lobeMath[] =
+{
+    { "precise", LobeMath::Precise },
+    { "fast",    LobeMath::Fast    },
+    CLI_OPTION_MAP_TERMINATOR,
+};
+
+static const CliOptionMap s_texelNormals[] =
+{
+    { "auto",     TexelNormals::Auto     },
+    { "table",    TexelNormals::Table    },
+    { "computed", TexelNormals::Computed },
+    CLI_OPTION_MAP_TERMINATOR,
+};
+
+static const CliOptionMap s_accumulation[] =
+{
+    { "float",       Accumulation::Float       },
+    { "double",      Accumulation::Double      },
+    { "compensated", Accumulation::Compensated },
+    CLI_OPTION_MAP_TERMINATOR,
+};
+
+static const CliOptionMap s_deviceFormat[] =
+{
+    { "auto",  DeviceFormat::Auto  },
+    { "float", DeviceFormat::Float },
+    { "half",  DeviceFormat::Half  },
+    CLI_OPTION_MAP_TERMINATOR,
+};
+
 static const CliOptionMap s_clVendors[] =
 {
     { "NONE_FROM_THE_LIST", (uint32_t)CMFT_CL_VENDOR_OTHER   },
@@ -216,6 +256,17 @@ struct InputParameters
     uint32_t m_dstFaceSize;
     uint32_t m_lightingModel;
     uint32_t m_edgeFixup;
+    uint32_t m_tableLayout;
+    float m_sourceMipThreshold;
+    bool m_tileCulling;
+    uint32_t m_lobeMath;
+    uint32_t m_texelNormals;
+    uint32_t m_accumulation;
+    uint32_t m_ggxSamples;
+    float m_shPowerThreshold;
+    uint32_t m_shMip;
+    uint32_t m_shMaxBand;
+    uint32_t m_shRotations;
 
     // Processing devices.
     uint32_t m_numCpuProcessingThreads;
@@ -224,6 +275,8 @@ struct InputParameters
     char m_vendorStrPart[1024];
     uint32_t m_deviceType;
     uint32_t m_deviceIndex;
+    uint32_t m_deviceFormat;
+    char m_clProgramCacheDir[CMFT_PATH_LEN];
 
     // Output.
     uint32_t m_outputFilesNum;
@@ -316,6 +369,9 @@ void inputParametersFromCommandLine(InputParameters& _inputParameters, const cmf
     _cmdLine.hasArg(_inputParameters.m_glossScale,  '\0', "glossScale");
     _cmdLine.hasArg(_inputParameters.m_glossBias,   '\0', "glossBias");
     _cmdLine.hasArg(_inputParameters.m_dstFaceSize, '\0', "dstFaceSize");
+    _cmdLine.hasArg(_inputParameters.m_shMip,       '\0', "shMip");
+    _cmdLine.hasArg(_inputParameters.m_shMaxBand,   '\0', "shMaxBand");
+    _cmdLine.hasArg(_inputParameters.m_shRotations, '\0', "shRotations");
 
     // Lighting model.
     valueFromOptionMap(_inputParameters.m_lightingModel, s_lightingModel, _cmdLine.findOption("lightingModel"));
@@ -323,6 +379,30 @@ void inputParametersFromCommandLine(InputParameters& _inputParameters, const cmf
     // Edge fixup.
     valueFromOptionMap(_inputParameters.m_edgeFixup, s_edgeFixup, _cmdLine.findOption("edgeFixup"));
 
+    // Table layout.
+    valueFromOptionMap(_inputParameters.m_tableLayout, s_tableLayout, _cmdLine.findOption("tableLayout"));
+
+    // Source mips.
+    _cmdLine.hasArg(_inputParameters.m_sourceMipThreshold, '\0', "sourceMipThreshold");
+
+    // Tile culling.
+    _cmdLine.hasArg(_inputParameters.m_tileCulling, '\0', "tileCulling");
+
+    // Lobe math.
+    valueFromOptionMap(_inputParameters.m_lobeMath, s_lobeMath, _cmdLine.findOption("lobeMath"));
+
+    // Texel normals.
+    valueFromOptionMap(_inputParameters.m_texelNormals, s_texelNormals, _cmdLine.findOption("texelNormals"));
+
+    // Accumulation.
+    valueFromOptionMap(_inputParameters.m_accumulation, s_accumulation, _cmdLine.findOption("accumulation"));
+
+    // Ggx samples.
+    _cmdLine.hasArg(_inputParameters.m_ggxSamples, '\0', "ggxSamples");
+
+    // SH power threshold.
+    _cmdLine.hasArg(_inputParameters.m_shPowerThreshold, '\0', "shPowerThreshold");
+
     // Processing devices.
     _cmdLine.hasArg(_inputParameters.m_numCpuProcessingThreads, '\0', "numCpuProcessingThreads");
     _cmdLine.hasArg(_inputParameters.m_useOpenCL, '\0', "useOpenCL");
@@ -339,6 +419,8 @@ void inputParametersFromCommandLine(InputParameters& _inputParameters, const cmf
     // Device type/index.
     valueFromOptionMap(_inputParameters.m_deviceType, s_deviceType, _cmdLine.findOption("deviceType"));
     _cmdLine.hasArg(_inputParameters.m_deviceIndex, '\0', "deviceIndex");
+    valueFromOptionMap(_inputParameters.m_deviceFormat, s_deviceFormat, _cmdLine.findOption("deviceFormat"));
+    cmft::stracpy(_inputParameters.m_clProgramCacheDir, _cmdLine.findOption("clProgramCache"));
 
     // Misc.
     _inputParameters.m_silent = _cmdLine.hasArg("silent");
@@ -533,6 +615,17 @@ void inputParametersDefault(InputParameters& _inputParameters)
     _inputParameters.m_dstFaceSize   = 0;
     _inputParameters.m_lightingModel = 0;
     _inputParameters.m_edgeFixup     = 0;
+    _inputParameters.m_tableLayout   = TableLayout::Interleaved;
+    _inputParameters.m_sourceMipThreshold = 0.0f;
+    _inputParameters.m_tileCulling = false;
+    _inputParameters.m_lobeMath    = LobeMath::Precise;
+    _inputParameters.m_texelNormals = TexelNormals::Auto;
+    _inputParameters.m_accumulation = Accumulation::Float;
+    _inputParameters.m_ggxSamples   = 256;
+    _inputParameters.m_shPowerThreshold = 0.0f;
+    _inputParameters.m_shMip        = 0;
+    _inputParameters.m_shMaxBand    = 4;
+    _inputParameters.m_shRotations  = 1;
 
     // Processing devices.
     _inputParameters.m_numCpuProcessingThreads = UINT32_MAX;
@@ -541,14 +634,16 @@ void inputParametersDefault(InputParameters& _inputParameters)
     _inputParameters.m_clVendor                = CMFT_CL_VENDOR_ANY_GPU;
     _inputParameters.m_vendorStrPart[0]        = '\0';
     _inputParameters.m_deviceType              = CMFT_CL_DEVICE_TYPE_GPU;
+    _inputParameters.m_deviceFormat            = DeviceFormat::Auto;
+    _inputParameters.m_clProgramCacheDir[0]    = '\0';
 
     // Misc.
     _inputParameters.m_silent = false;
     _inputParameters.m_encodeRGBM = false;
 }
 
-/// Outputs C file.
-void outputShCoeffs(const char* _pathName, double _shCoeffs[SH_COEFF_NUM][3])
+/// Outputs C file with coefficients of bands 0.._maxBand.
+void outputShCoeffs(const char* _pathName, double _shCoeffs[][3], uint8_t _maxBand = 4)
 {
     // Get base name.
     char baseName[128];
@@ -562,49 +657,38 @@ void outputShCoeffs(const char* _pathName, double _shCoeffs[SH_COEFF_NUM][3])
     cmft::strtoupper(baseNameUpper, baseName);
 
     // File content.
-    char content[10240];
-    sprintf(content,
+    char content[16384];
+    int32_t size = sprintf(content,
            "#ifndef CMFT_%s_H_HEADER_GUARD\n"
            "#define CMFT_%s_H_HEADER_GUARD\n"
            "\n"
-           "static const float s_shCoeffs%s[25][3] =\n"
+           "static const float s_shCoeffs%s[%u][3] =\n"
            "{\n"
-           "    /* Band 0 */ { %21.18f, %21.18f, %21.18f },\n"
-           "    /* Band 1 */ { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f },\n"
-           "    /* Band 2 */ { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f },\n"
-           "    /* Band 3 */ { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f },\n"
-           "    /* Band 4 */ { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }, { %21.18f, %21.18f, %21.18f }\n"
-           "};\n"
-           "\n"
-           "#endif // CMFT_%s_H_HEADER_GUARD\n"
            , baseNameUpper
            , baseNameUpper
            , baseName
-           , _shCoeffs[ 0][0], _shCoeffs[ 0][1], _shCoeffs[ 0][2]
-           , _shCoeffs[ 1][0], _shCoeffs[ 1][1], _shCoeffs[ 1][2]
-           , _shCoeffs[ 2][0], _shCoeffs[ 2][1], _shCoeffs[ 2][2]
-           , _shCoeffs[ 3][0], _shCoeffs[ 3][1], _shCoeffs[ 3][2]
-           , _shCoeffs[ 4][0], _shCoeffs[ 4][1], _shCoeffs[ 4][2]
-           , _shCoeffs[ 5][0], _shCoeffs[ 5][1], _shCoeffs[ 5][2]
-           , _shCoeffs[ 6][0], _shCoeffs[ 6][1], _shCoeffs[ 6][2]
-           , _shCoeffs[ 7][0], _shCoeffs[ 7][1], _shCoeffs[ 7][2]
-           , _shCoeffs[ 8][0], _shCoeffs[ 8][1], _shCoeffs[ 8][2]
-           , _shCoeffs[ 9][0], _shCoeffs[ 9][1], _shCoeffs[ 9][2]
-           , _shCoeffs[10][0], _shCoeffs[10][1], _shCoeffs[10][2]
-           , _shCoeffs[11][0], _shCoeffs[11][1], _shCoeffs[11][2]
-           , _shCoeffs[12][0], _shCoeffs[12][1], _shCoeffs[12][2]
-           , _shCoeffs[13][0], _shCoeffs[13][1], _shCoeffs[13][2]
-           , _shCoeffs[14][0], _shCoeffs[14][1], _shCoeffs[14][2]
-           , _shCoeffs[15][0], _shCoeffs[15][1], _shCoeffs[15][2]
-           , _shCoeffs[16][0], _shCoeffs[16][1], _shCoeffs[16][2]
-           , _shCoeffs[17][0], _shCoeffs[17][1], _shCoeffs[17][2]
-           , _shCoeffs[18][0], _shCoeffs[18][1], _shCoeffs[18][2]
-           , _shCoeffs[19][0], _shCoeffs[19][1], _shCoeffs[19][2]
-           , _shCoeffs[20][0], _shCoeffs[20][1], _shCoeffs[20][2]
-           , _shCoeffs[21][0], _shCoeffs[21][1], _shCoeffs[21][2]
-           , _shCoeffs[22][0], _shCoeffs[22][1], _shCoeffs[22][2]
-           , _shCoeffs[23][0], _shCoeffs[23][1], _shCoeffs[23][2]
-           , _shCoeffs[24][0], _shCoeffs[24][1], _shCoeffs[24][2]
+           , cmft::shCoeffNum(_maxBand)
+           );
+
+    for (uint8_t band = 0; band <= _maxBand; ++band)
+    {
+        size += sprintf(&content[size], "    /* Band %u */ ", uint32_t(band));
+
+        for (uint32_t coeff = uint32_t(band)*band, end = cmft::shCoeffNum(band); coeff < end; ++coeff)
+        {
+            size += sprintf(&content[size], "%s{ %21.18f, %21.18f, %21.18f }"
+                           , coeff == uint32_t(band)*band ? "" : ", "
+                           , _shCoeffs[coeff][0], _shCoeffs[coeff][1], _shCoeffs[coeff][2]
+                           );
+        }
+
+        size += sprintf(&content[size], "%s\n", band == _maxBand ? "" : ",");
+    }
+
+    sprintf(&content[size],
+           "};\n"
+           "\n"
+           "#endif // CMFT_%s_H_HEADER_GUARD\n"
            , baseNameUpper
            );
 
@@ -762,10 +846,32 @@ void printHelp()
             "          phongbrdf\n"
             "          blinn\n"
             "          blinnbrdf\n"
+            "          ggx\n"
             "    --edgeFixup <fixup>                DirectX9 and OpenGL without ARB_seamless_cube_map cannot sample cubemap across face edges. In those cases, use 'warp' edge fixup. Otherwise, choose 'none'. Cubemaps filtered with warp edge fixup also require some shader code to be executed at runtime. See 'cmft/include/cubemapfilter.h' for more details. [radiance filter param]\n"
             "          none\n"
             "          warp\n"
-            "    --numCpuProcessingThreads <uint>   Should not be bigger than the number of physical CPU cores/threads. [radiance filter param]\n"
+            "    --tableLayout <layout>             Memory layout of the tables read by the filter. 'interleaved' (default) stores four floats per texel. 'planar' stores each channel in a separate plane and skips the unused alpha channel, which is faster on cpu. RGBA16F and RGBE sources are always read interleaved. [radiance filter param]\n"
+            "          interleaved\n"
+            "          planar\n"
+            "    --sourceMipThreshold <float>       Filter each mip from the coarsest level of a downsampled source whose texel angle is at most sourceMipThreshold * filter angle. Faster, but approximate. 0.0 (default) always filters from the full resolution source, 0.1 is visually lossless. [radiance filter param]\n"
+            "    --tileCulling <bool>               Skip 8x8 texel tiles that are outside of the specular lobe. Pays off only when a large part of the filter area is outside of the lobe. [radiance filter param]\n"
+            "    --lobeMath <math>                  Evaluation of the specular lobe on cpu. 'fast' uses polynomial log2/exp2 with max relative weight error of 1e-4. [radiance filter param]\n"
+            "          precise\n"
+            "          fast\n"
+            "    --texelNormals <normals>           Source of texel directions and solid angles on cpu. 'computed' evaluates them per texel instead of reading a table as large as the source, which is faster for large faces. 'auto' (default) computes them for faces of 1024 texels and more, 2048 with planar tables. [radiance filter param]\n"
+            "          auto\n"
+            "          table\n"
+            "          computed\n"
+            "    --accumulation <accumulation>      Summation of weighted texels on cpu. 'double' sums in double precision, scalar kernels entirely and simd kernels per source row. 'compensated' adds float row sums with error compensation, deterministic for any tile culling. [radiance filter param]\n"
+            "          float\n"
+            "          double\n"
+            "          compensated\n"
+            "    --ggxSamples <uint>                Number of importance samples per output texel of the 'ggx' lighting model. Default is 256. [radiance filter param]\n"
+            "    --shPowerThreshold <float>         Mips with specular power below this value are reconstructed from a single spherical harmonics projection of the source instead of filtered texel by texel. Almost free, with lobe energy above band 8 lost. 0.0 (default) disables it, at most 8.0, which keeps the error below 1%%. Used only when the filtered mips would cost more than projecting the source, so small sources are filtered as before. Does not apply to 'ggx'. [radiance filter param]\n"
+            "    --shMaxBand <uint>                 Highest spherical harmonics band that is computed and written, 2 gives 9 coefficients, 4 (default) gives 25. At most 8. [shCoeffs filter param]\n"
+            "    --shRotations <uint>               Number of coefficient sets rotated around +y axis in equal steps of 360/<uint> degrees. Sets are rotated from a single projection and saved with '_rot<index>' suffix when <uint> > 1. Default is 1. [shCoeffs filter param]\n"
+            "    --shMip <uint>                     Mip level of the input cubemap that spherical harmonics are projected from. Default is 0. [shCoeffs filter param]\n"
+            "    --numCpuProcessingThreads <uint>   Should not be bigger than the number of physical CPU cores/threads. Also sets the size of the thread pool used by all other operations. [radiance filter param]\n"
             "    --useOpenCL <bool>                 OpenCL processing can be used alongside processing on CPU. Therefore, OpenCL device should be GPU. [radiance filter param]\n"
             "    --clVendor <vendor>                This parameter should generally be 'anyGpuVendor'. If other vendor is to be choosen, type in part of the vendor name. Use 'cmft --printCLDevices' to list available devices and vendors. [radiance filter param]\n"
             "          intel\n"
@@ -781,6 +887,11 @@ void printHelp()
             "          accelerator\n"
             "          default\n"
             "    --deviceIndex <uint>               If there are multiple devices of chosen vendor and type, <uint> is used for selection. There is no support for multiple OpenCL devices for now. [radiance filter param]\n"
+            "    --deviceFormat <format>            Texel format of OpenCL device images. 'half' uploads RGBA16F source, computes texel normals on the device and reads RGBA16F targets back as half floats, which takes a quarter of the device memory. 'auto' (default) uses it for RGBA16F inputs and for inputs that do not fit device memory otherwise. [radiance filter param]\n"
+            "          auto\n"
+            "          float\n"
+            "          half\n"
+            "    --clProgramCache <dir>             Directory in which compiled OpenCL programs are stored and reused by following runs on the same device and driver. Disabled by default. [radiance filter param]\n"
             "    --generateMipChain <bool>          After processing, generate entire mip map chain.\n"
             "    --inputGammaNumerator <uint>       Gamma applied to cubemap before processing. Use this field to specify gamma numerator. Gamma equation is value^(numerator/denominator).\n"
             "    --inputGammaDenominator <uint>     Gamma applied to cubemap before processing. Use this field to specify gamma denominator. Gamma equation is value^(numerator/denominator).\n"
@@ -884,6 +995,13 @@ int cmftMain(int _argc, char const* const* _argv)
         setInfoPrintf(NULL);
     }
 
+    // Calling thread is processing as well, pool needs one worker less.
+    if (UINT32_MAX != inputParameters.m_numCpuProcessingThreads)
+    {
+        const uint32_t numThreads = CMFT_MAX(inputParameters.m_numCpuProcessingThreads, 1u);
+        threadPoolInit(uint8_t(CMFT_MIN(numThreads-1, 64u)));
+    }
+
     Image image;
     Image imageFaceList[6];
 
@@ -1009,6 +1127,11 @@ int cmftMain(int _argc, char const* const* _argv)
             clLoaded = cmft::clLoad();
             if (clLoaded)
             {
+                if ('\0' != inputParameters.m_clProgramCacheDir[0])
+                {
+                    clSetProgramCacheDir(inputParameters.m_clProgramCacheDir);
+                }
+
                 clContext = clInit(inputParameters.m_clVendor
                                  , inputParameters.m_deviceType
                                  , inputParameters.m_deviceIndex
@@ -1016,6 +1139,17 @@ int cmftMain(int _argc, char const* const* _argv)
             }
         }
 
+        RadianceFilterOptions options;
+        options.m_tableLayout = (TableLayout::Enum)inputParameters.m_tableLayout;
+        options.m_sourceMipThreshold = inputParameters.m_sourceMipThreshold;
+        options.m_tileCulling = inputParameters.m_tileCulling;
+        options.m_lobeMath = (LobeMath::Enum)inputParameters.m_lobeMath;
+        options.m_texelNormals = (TexelNormals::Enum)inputParameters.m_texelNormals;
+        options.m_accumulation = (Accumulation::Enum)inputParameters.m_accumulation;
+        options.m_ggxSamples = (uint16_t)CMFT_MIN(inputParameters.m_ggxSamples, uint32_t(UINT16_MAX));
+        options.m_deviceFormat = (DeviceFormat::Enum)inputParameters.m_deviceFormat;
+        options.m_shPowerThreshold = inputParameters.m_shPowerThreshold;
+
         // Start filter.
         imageRadianceFilter(image
                           , inputParameters.m_dstFaceSize
@@ -1027,6 +1161,8 @@ int cmftMain(int _argc, char const* const* _argv)
                           , (EdgeFixup::Enum)inputParameters.m_edgeFixup
                           , (int8_t)inputParameters.m_numCpuProcessingThreads
                           , clContext
+                          , g_allocator
+                          , &options
                           );
 
         clDestroy(clContext);
@@ -1043,14 +1179,54 @@ int cmftMain(int _argc, char const* const* _argv)
     }
     else if (FilterType::ShCoeffs == inputParameters.m_filterType)
     {
-        double shCoeffs[SH_COEFF_NUM][3];
-        imageShCoeffs(shCoeffs, image);
+        const uint8_t shMaxBand = (uint8_t)CMFT_MIN(inputParameters.m_shMaxBand, uint32_t(UINT8_MAX));
+        double shCoeffs[SH_MAX_COEFF_NUM][3];
+        if (!imageShCoeffs(shCoeffs, shMaxBand, image, g_allocator, (uint8_t)CMFT_MIN(inputParameters.m_shMip, uint32_t(UINT8_MAX))))
+        {
+            WARN("Computing spherical harmonics coefficients failed.");
+            return EXIT_FAILURE;
+        }
 
-        for (uint32_t ii = 0; ii < inputParameters.m_outputFilesNum; ++ii)
+        const uint32_t numRotations = CMFT_MAX(inputParameters.m_shRotations, UINT32_C(1));
+        for (uint32_t rot = 0; rot < numRotations; ++rot)
         {
-            const char* fileName = inputParameters.m_outputFiles[ii].m_fileName;
-            INFO("Saving spherical harmonics coefficients to %s.c", fileName);
-            outputShCoeffs(fileName, shCoeffs);
+            // Yaw around +y axis.
+            const float yaw = 2.0f*3.14159265358979323846f*float(rot)/float(numRotations);
+            const float rotation[9] =
+            {
+                 cosf(yaw), 0.0f, sinf(yaw),
+                 0.0f,      1.0f, 0.0f,
+                -sinf(yaw), 0.0f, cosf(yaw),
+            };
+
+            // First set is the projection itself.
+            double rotated[SH_MAX_COEFF_NUM][3];
+            if (0 == rot)
+            {
+                memcpy(rotated, shCoeffs, sizeof(rotated));
+            }
+            else if (!shCoeffsRotate(rotated, shCoeffs, shMaxBand, rotation))
+            {
+                WARN("Rotating spherical harmonics coefficients failed.");
+                return EXIT_FAILURE;
+            }
+
+            for (uint32_t ii = 0; ii < inputParameters.m_outputFilesNum; ++ii)
+            {
+                char fileName[CMFT_PATH_LEN];
+                if (1 == numRotations)
+                {
+                    cmft::stracpy(fileName, inputParameters.m_outputFiles[ii].m_fileName);
+                    INFO("Saving spherical harmonics coefficients to %s.c", fileName);
+                }
+                else
+                {
+                    cmft::snprintf(fileName, CMFT_PATH_LEN, "%s_rot%u", inputParameters.m_outputFiles[ii].m_fileName, rot);
+                    INFO("Saving spherical harmonics coefficients rotated by %.2f degrees to %s.c", double(yaw)*(180.0/3.14159265358979323846), fileName);
+                }
+
+                outputShCoeffs(fileName, rotated, shMaxBand);
+            }
         }
 
         INFO("Done.");
@@ -7,8 +7,21 @@
 #define CMFT_TESTS_H_HEADER_GUARD
 
 #include "../cmft_cli/cmft_cli.h"
+#include <cmft/threadpool.h>
+#include "../cmft/radiancekernel.h"
+#include "../cmft/cubemaputils.h"  // texelCoordToVec()
+#include "../cmft/common/timer.h"  // getHPCounter()
 #include "tokenize.h"
 
+#include <float.h> // FLT_MIN
+#include <atomic>  // C++11
+#include <thread>  // C++11
+
+#if CMFT_PLATFORM_LINUX || CMFT_PLATFORM_APPLE
+#   include <dirent.h> // opendir
+#   include <unistd.h> // rmdir
+#endif // CMFT_PLATFORM_
+
 static const char s_radianceTest[] =
 {
     "--input \"okretnica.tga\"           "
@@ -142,8 +155,2712 @@ int test(const char* _cmd)
     return cmftMain(argc, argv);
 }
 
+static float testRandf(uint32_t& _seed)
+{
+    _seed = _seed*1664525u + 1013904223u;
+    return float(_seed>>8)/16777216.0f;
+}
+
+/// Checks all simd radiance kernels supported by the host against the scalar reference.
+int testRadianceKernels()
+{
+    const uint32_t faceSize = 37; // Not a multiple of any vector width.
+    const uint32_t faceTexels = faceSize*faceSize;
+    const float tolerance = 0.001f;
+
+    float* normals = (float*)malloc(faceTexels*6*4*sizeof(float));
+    float* data    = (float*)malloc(faceTexels*6*4*sizeof(float));
+    uint32_t faceOffsets[6];
+
+    uint32_t seed = 1;
+    for (uint32_t ii = 0; ii < faceTexels*6; ++ii)
+    {
+        float vec[3] = { testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f };
+        const float invLen = 1.0f/sqrtf(vec[0]*vec[0] + vec[1]*vec[1] + vec[2]*vec[2]);
+        normals[ii*4+0] = vec[0]*invLen;
+        normals[ii*4+1] = vec[1]*invLen;
+        normals[ii*4+2] = vec[2]*invLen;
+        normals[ii*4+3] = (0.5f + testRandf(seed))/float(faceTexels);
+
+        data[ii*4+0] = testRandf(seed)*10.0f;
+        data[ii*4+1] = testRandf(seed);
+        data[ii*4+2] = testRandf(seed)*0.1f;
+        data[ii*4+3] = 1.0f;
+    }
+
+    for (uint8_t face = 0; face < 6; ++face)
+    {
+        faceOffsets[face] = face*faceTexels*4*sizeof(float);
+    }
+
+    // Same data in planar layout.
+    const uint32_t planePitch = cubemapPlanePitch(faceSize);
+    const uint32_t planeSize = planePitch*faceSize;
+    float* normalPlanes = (float*)calloc(planeSize*4*6, sizeof(float));
+    float* dataPlanes   = (float*)calloc(planeSize*3*6, sizeof(float));
+    for (uint8_t face = 0; face < 6; ++face)
+    {
+        for (uint32_t ii = 0; ii < faceTexels; ++ii)
+        {
+            const uint32_t dst = (ii/faceSize)*planePitch + ii%faceSize;
+            const uint32_t src = (face*faceTexels + ii)*4;
+            for (uint8_t ch = 0; ch < 4; ++ch)
+            {
+                normalPlanes[planeSize*(face*4+ch) + dst] = normals[src+ch];
+            }
+            for (uint8_t ch = 0; ch < 3; ++ch)
+            {
+                dataPlanes[planeSize*(face*3+ch) + dst] = data[src+ch];
+            }
+        }
+    }
+
+    const SimdLevel::Enum maxLevel = simdLevelDetect();
+    const RadianceKernelFn reference = radianceKernel(SimdLevel::Scalar);
+
+    uint32_t numFailed = 0;
+    for (uint32_t accumulation = 0; accumulation < Accumulation::Count; ++accumulation)
+    for (uint32_t lobeMath = 0; lobeMath < LobeMath::Count; ++lobeMath)
+    for (uint32_t layout = 0; layout < TableLayout::Count; ++layout)
+    for (uint32_t level = SimdLevel::Scalar + (TableLayout::Interleaved == layout && LobeMath::Precise == lobeMath && Accumulation::Float == accumulation); level <= uint32_t(maxLevel); ++level)
+    {
+        const RadianceKernelFn kernel = radianceKernel(SimdLevel::Enum(level), TableLayout::Enum(layout), LobeMath::Enum(lobeMath), TexelNormals::Table, Accumulation::Enum(accumulation));
+        if (NULL == kernel)
+        {
+            continue;
+        }
+
+        float maxError = 0.0f;
+        for (uint32_t test = 0; test < 1000; ++test)
+        {
+            float tapVec[3] = { testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f };
+            const float invLen = 1.0f/sqrtf(tapVec[0]*tapVec[0] + tapVec[1]*tapVec[1] + tapVec[2]*tapVec[2]);
+            tapVec[0] *= invLen;
+            tapVec[1] *= invLen;
+            tapVec[2] *= invLen;
+
+            RadianceKernelArgs args;
+            args.m_tapVec = tapVec;
+            args.m_specularPower = powf(2.0f, testRandf(seed)*12.0f);
+            args.m_specularAngle = testRandf(seed)*0.999f;
+            args.m_cubemapNormalSolidAngle = normals;
+            args.m_srcData = data;
+            args.m_srcFormat = TextureFormat::RGBA32F;
+            args.m_faceOffsets = faceOffsets;
+            args.m_normalPlanes = normalPlanes;
+            args.m_srcPlanes = dataPlanes;
+            args.m_planePitch = planePitch;
+            args.m_srcFaceSize = faceSize;
+            args.m_warpFixup = 0.0f;
+
+            float runningSum[8] = { 0.0f };
+            args.m_runningSum = runningSum;
+
+            // Spans where every texel passes the lobe test may skip it, as they would after tile culling.
+            RadianceFilterSpan spans[8];
+            for (uint8_t ii = 0; ii < CMFT_COUNTOF(spans); ++ii)
+            {
+                const bool small = (ii&1);
+                RadianceFilterSpan& span = spans[ii];
+                const uint32_t xx = uint32_t(testRandf(seed)*faceSize);
+                const uint32_t yy = uint32_t(testRandf(seed)*faceSize);
+                const uint32_t ww = uint32_t(testRandf(seed)*(small ? 3 : faceSize));
+                const uint32_t hh = small ? 0 : uint32_t(testRandf(seed)*faceSize);
+                span.m_minX = CMFT_MIN(xx, faceSize-1);
+                span.m_minY = CMFT_MIN(yy, faceSize-1);
+                span.m_maxX = CMFT_MIN(span.m_minX + ww, faceSize-1);
+                span.m_maxY = CMFT_MIN(span.m_minY + hh, faceSize-1);
+                span.m_face = uint8_t(testRandf(seed)*6.0f);
+
+                bool inside = true;
+                for (uint32_t sy = span.m_minY; sy <= span.m_maxY; ++sy)
+                {
+                    for (uint32_t sx = span.m_minX; sx <= span.m_maxX; ++sx)
+                    {
+                        const float* normal = normals + (span.m_face*faceTexels + sy*faceSize + sx)*4;
+                        inside &= (normal[0]*tapVec[0] + normal[1]*tapVec[1] + normal[2]*tapVec[2] >= args.m_specularAngle);
+                    }
+                }
+                span.m_inside = inside;
+            }
+            args.m_spans = spans;
+            args.m_numSpans = uint32_t(testRandf(seed)*CMFT_COUNTOF(spans));
+
+            float expected[4];
+            float result[4];
+            reference(expected, args);
+            kernel(result, args);
+
+            // Simd kernels flush lobe values below 2^-126 to zero, skip results made of denormals only.
+            if (expected[3] < FLT_MIN)
+            {
+                continue;
+            }
+
+            for (uint8_t ch = 0; ch < 3; ++ch)
+            {
+                const float ref = expected[ch]/expected[3];
+                const float res = (0.0f != result[3]) ? result[ch]/result[3] : 0.0f;
+                const float error = fabsf(res-ref)/CMFT_MAX(fabsf(ref), 1.0f);
+                maxError = CMFT_MAX(maxError, error);
+            }
+        }
+
+        const bool passed = (maxError <= tolerance);
+        numFailed += !passed;
+
+        printf("Radiance kernel %-8s %-11s %-7s %-11s max error: %g ... %s\n"
+              , getSimdLevelStr(SimdLevel::Enum(level))
+              , (TableLayout::Planar == layout) ? "planar" : "interleaved"
+              , (LobeMath::Fast == lobeMath) ? "fast" : "precise"
+              , (Accumulation::Double == accumulation) ? "double" : (Accumulation::Compensated == accumulation) ? "compensated" : "float"
+              , maxError
+              , passed ? "ok" : "FAILED"
+              );
+    }
+
+    // Compact source formats are decoded by interleaved kernels, compare them against the reference
+    // reading the same texels decoded to Rgba32f.
+    static const TextureFormat::Enum s_formats[] = { TextureFormat::RGBA16F, TextureFormat::RGBE };
+    uint8_t* compact = (uint8_t*)malloc(faceTexels*6*4*sizeof(float));
+    float* decoded   = (float*)malloc(faceTexels*6*4*sizeof(float));
+    for (uint8_t format = 0; format < CMFT_COUNTOF(s_formats); ++format)
+    {
+        const uint32_t bytesPerPixel = getImageDataInfo(s_formats[format]).m_bytesPerPixel;
+        uint32_t compactFaceOffsets[6];
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            compactFaceOffsets[face] = face*faceTexels*bytesPerPixel;
+        }
+        for (uint32_t ii = 0; ii < faceTexels*6; ++ii)
+        {
+            fromRgba32f(compact + ii*bytesPerPixel, s_formats[format], data + ii*4);
+            toRgba32f(decoded + ii*4, s_formats[format], compact + ii*bytesPerPixel);
+        }
+
+        for (uint32_t level = SimdLevel::Scalar; level <= uint32_t(maxLevel); ++level)
+        {
+            const RadianceKernelFn kernel = radianceKernel(SimdLevel::Enum(level), TableLayout::Interleaved, LobeMath::Precise, TexelNormals::Table, Accumulation::Float, s_formats[format]);
+            if (NULL == kernel)
+            {
+                continue;
+            }
+
+            float maxError = 0.0f;
+            for (uint32_t test = 0; test < 200; ++test)
+            {
+                float tapVec[3] = { testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f };
+                const float invLen = 1.0f/sqrtf(tapVec[0]*tapVec[0] + tapVec[1]*tapVec[1] + tapVec[2]*tapVec[2]);
+                tapVec[0] *= invLen;
+                tapVec[1] *= invLen;
+                tapVec[2] *= invLen;
+
+                RadianceFilterSpan span;
+                span.m_minX = uint32_t(testRandf(seed)*(faceSize/2));
+                span.m_minY = uint32_t(testRandf(seed)*(faceSize/2));
+                span.m_maxX = span.m_minX + uint32_t(testRandf(seed)*(faceSize/2));
+                span.m_maxY = span.m_minY + uint32_t(testRandf(seed)*(faceSize/2));
+                span.m_face = uint8_t(testRandf(seed)*6.0f);
+                span.m_inside = false;
+
+                RadianceKernelArgs args;
+                args.m_tapVec = tapVec;
+                args.m_specularPower = powf(2.0f, testRandf(seed)*8.0f);
+                args.m_specularAngle = 0.0f;
+                args.m_cubemapNormalSolidAngle = normals;
+                args.m_srcData = decoded;
+                args.m_srcFormat = TextureFormat::RGBA32F;
+                args.m_faceOffsets = faceOffsets;
+                args.m_normalPlanes = NULL;
+                args.m_srcPlanes = NULL;
+                args.m_planePitch = 0;
+                args.m_srcFaceSize = faceSize;
+                args.m_warpFixup = 0.0f;
+                args.m_spans = &span;
+                args.m_numSpans = 1;
+                args.m_runningSum = NULL;
+
+                float expected[4];
+                reference(expected, args);
+
+                args.m_srcData = compact;
+                args.m_srcFormat = s_formats[format];
+                args.m_faceOffsets = compactFaceOffsets;
+
+                float result[4];
+                kernel(result, args);
+
+                if (expected[3] < FLT_MIN)
+                {
+                    continue;
+                }
+
+                for (uint8_t ch = 0; ch < 3; ++ch)
+                {
+                    const float ref = expected[ch]/expected[3];
+                    const float res = (0.0f != result[3]) ? result[ch]/result[3] : 0.0f;
+                    maxError = CMFT_MAX(maxError, fabsf(res-ref)/CMFT_MAX(fabsf(ref), 1.0f));
+                }
+            }
+
+            const bool passed = (maxError <= tolerance);
+            numFailed += !passed;
+
+            printf("Radiance kernel %-8s %-11s %-7s source      max error: %g ... %s\n"
+                  , getSimdLevelStr(SimdLevel::Enum(level))
+                  , "interleaved"
+                  , getTextureFormatStr(s_formats[format])
+                  , maxError
+                  , passed ? "ok" : "FAILED"
+                  );
+        }
+    }
+
+    free(compact);
+    free(decoded);
+
+    // Group kernels must match their single source kernel bit for bit for every source of the group.
+    enum { NumGroupSources = 3 };
+    float* groupData[NumGroupSources];
+    float* groupPlanes[NumGroupSources];
+    for (uint8_t src = 0; src < NumGroupSources; ++src)
+    {
+        groupData[src]   = (float*)malloc(faceTexels*6*4*sizeof(float));
+        groupPlanes[src] = (float*)calloc(planeSize*3*6, sizeof(float));
+        for (uint32_t ii = 0; ii < faceTexels*6; ++ii)
+        {
+            groupData[src][ii*4+0] = testRandf(seed)*10.0f;
+            groupData[src][ii*4+1] = testRandf(seed);
+            groupData[src][ii*4+2] = testRandf(seed)*0.1f;
+            groupData[src][ii*4+3] = 1.0f;
+
+            const uint32_t face = ii/faceTexels;
+            const uint32_t dst = ((ii%faceTexels)/faceSize)*planePitch + ii%faceSize;
+            for (uint8_t ch = 0; ch < 3; ++ch)
+            {
+                groupPlanes[src][planeSize*(face*3+ch) + dst] = groupData[src][ii*4+ch];
+            }
+        }
+    }
+
+    for (uint32_t level = SimdLevel::Scalar; level <= uint32_t(maxLevel); ++level)
+    for (uint32_t layout = 0; layout < TableLayout::Count; ++layout)
+    for (uint32_t texelNormals = TexelNormals::Table; texelNormals < TexelNormals::Count; ++texelNormals)
+    for (uint32_t accumulation = 0; accumulation < Accumulation::Count; ++accumulation)
+    {
+        const RadianceKernelFn kernel = radianceKernel(SimdLevel::Enum(level), TableLayout::Enum(layout), LobeMath::Precise, TexelNormals::Enum(texelNormals), Accumulation::Enum(accumulation));
+        const RadianceGroupKernelFn groupKernel = radianceGroupKernel(SimdLevel::Enum(level), TableLayout::Enum(layout), LobeMath::Precise, TexelNormals::Enum(texelNormals), Accumulation::Enum(accumulation), TextureFormat::RGBA32F);
+        if (NULL == kernel
+        ||  NULL == groupKernel)
+        {
+            continue;
+        }
+
+        bool exact = true;
+        for (uint32_t test = 0; test < 100; ++test)
+        {
+            float tapVec[3] = { testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f };
+            const float invLen = 1.0f/sqrtf(tapVec[0]*tapVec[0] + tapVec[1]*tapVec[1] + tapVec[2]*tapVec[2]);
+            tapVec[0] *= invLen;
+            tapVec[1] *= invLen;
+            tapVec[2] *= invLen;
+
+            RadianceFilterSpan span;
+            span.m_minX = uint32_t(testRandf(seed)*(faceSize/2));
+            span.m_minY = uint32_t(testRandf(seed)*(faceSize/2));
+            span.m_maxX = span.m_minX + uint32_t(testRandf(seed)*(faceSize/2));
+            span.m_maxY = span.m_minY + uint32_t(testRandf(seed)*(faceSize/2));
+            span.m_face = uint8_t(testRandf(seed)*6.0f);
+            span.m_inside = false;
+
+            // Sources of a group share the lobe.
+            const float specularPower = powf(2.0f, testRandf(seed)*8.0f);
+            const float specularAngle = testRandf(seed)*0.5f;
+
+            RadianceKernelArgs args[NumGroupSources];
+            float runningSum[NumGroupSources][8];
+            float expected[NumGroupSources][4];
+            for (uint8_t src = 0; src < NumGroupSources; ++src)
+            {
+                args[src].m_tapVec = tapVec;
+                args[src].m_specularPower = specularPower;
+                args[src].m_specularAngle = specularAngle;
+                args[src].m_cubemapNormalSolidAngle = normals;
+                args[src].m_srcData = groupData[src];
+                args[src].m_srcFormat = TextureFormat::RGBA32F;
+                args[src].m_faceOffsets = faceOffsets;
+                args[src].m_normalPlanes = normalPlanes;
+                args[src].m_srcPlanes = groupPlanes[src];
+                args[src].m_planePitch = planePitch;
+                args[src].m_srcFaceSize = faceSize;
+                args[src].m_warpFixup = 0.0f;
+                args[src].m_spans = &span;
+                args[src].m_numSpans = 1;
+                args[src].m_runningSum = runningSum[src];
+
+                memset(runningSum[src], 0, sizeof(runningSum[src]));
+                kernel(expected[src], args[src]);
+                memset(runningSum[src], 0, sizeof(runningSum[src]));
+            }
+
+            float result[NumGroupSources][4];
+            groupKernel(&result[0][0], args, NumGroupSources);
+            exact &= (0 == memcmp(result, expected, sizeof(result)));
+        }
+
+        numFailed += !exact;
+
+        printf("Radiance kernel %-8s %-11s %-8s %-11s group of %d ... %s\n"
+              , getSimdLevelStr(SimdLevel::Enum(level))
+              , (TableLayout::Planar == layout) ? "planar" : "interleaved"
+              , (TexelNormals::Computed == texelNormals) ? "computed" : "table"
+              , (Accumulation::Double == accumulation) ? "double" : (Accumulation::Compensated == accumulation) ? "compensated" : "float"
+              , NumGroupSources
+              , exact ? "ok" : "FAILED"
+              );
+    }
+
+    for (uint8_t src = 0; src < NumGroupSources; ++src)
+    {
+        free(groupData[src]);
+        free(groupPlanes[src]);
+    }
+
+    free(normals);
+    free(data);
+    free(normalPlanes);
+    free(dataPlanes);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Cubemap of random colors with normal and solid angle table and planar copies of both, as read by cpu kernels.
+struct TestKernelCubemap
+{
+    void create(uint32_t _faceSize, uint8_t _numFaces, cmft::EdgeFixup::Enum _fixup, uint32_t& _seed)
+    {
+        using namespace cmft;
+
+        const uint32_t faceTexels = _faceSize*_faceSize;
+        const float cfs = float(int32_t(_faceSize));
+        const float invCfs = 1.0f/cfs;
+        const float warp = warpFixupFactor(cfs);
+
+        m_faceSize   = _faceSize;
+        m_planePitch = cubemapPlanePitch(_faceSize);
+        m_normals    = (float*)malloc(faceTexels*_numFaces*4*sizeof(float));
+        m_data       = (float*)malloc(faceTexels*_numFaces*4*sizeof(float));
+
+        const uint32_t planeSize = m_planePitch*_faceSize;
+        m_normalPlanes = (float*)calloc(planeSize*4*_numFaces, sizeof(float));
+        m_dataPlanes   = (float*)calloc(planeSize*3*_numFaces, sizeof(float));
+
+        for (uint8_t face = 0; face < _numFaces; ++face)
+        {
+            m_faceOffsets[face] = face*faceTexels*4*sizeof(float);
+
+            for (uint32_t yy = 0; yy < _faceSize; ++yy)
+            {
+                for (uint32_t xx = 0; xx < _faceSize; ++xx)
+                {
+                    const uint32_t texel = (face*faceTexels + yy*_faceSize + xx)*4;
+                    const float uu = float(int32_t(2*xx+1))*invCfs - 1.0f;
+                    const float vv = float(int32_t(2*yy+1))*invCfs - 1.0f;
+
+                    float* normal = m_normals + texel;
+                    if (EdgeFixup::Warp == _fixup)
+                    {
+                        texelCoordToVecWarp(normal, uu, vv, face, warp);
+                    }
+                    else
+                    {
+                        texelCoordToVec(normal, uu, vv, face);
+                    }
+                    normal[3] = texelSolidAngle(uu, vv, invCfs);
+
+                    float* data = m_data + texel;
+                    data[0] = testRandf(_seed)*10.0f;
+                    data[1] = testRandf(_seed);
+                    data[2] = testRandf(_seed)*0.1f;
+                    data[3] = 1.0f;
+
+                    const uint32_t dst = yy*m_planePitch + xx;
+                    for (uint8_t ch = 0; ch < 4; ++ch)
+                    {
+                        m_normalPlanes[planeSize*(face*4+ch) + dst] = normal[ch];
+                    }
+                    for (uint8_t ch = 0; ch < 3; ++ch)
+                    {
+                        m_dataPlanes[planeSize*(face*3+ch) + dst] = data[ch];
+                    }
+                }
+            }
+        }
+
+        m_warpFixup = (EdgeFixup::Warp == _fixup) ? warp : 0.0f;
+    }
+
+    void destroy()
+    {
+        free(m_normals);
+        free(m_data);
+        free(m_normalPlanes);
+        free(m_dataPlanes);
+    }
+
+    void setArgs(cmft::RadianceKernelArgs& _args) const
+    {
+        _args.m_cubemapNormalSolidAngle = m_normals;
+        _args.m_srcData = m_data;
+        _args.m_srcFormat = cmft::TextureFormat::RGBA32F;
+        _args.m_faceOffsets = m_faceOffsets;
+        _args.m_normalPlanes = m_normalPlanes;
+        _args.m_srcPlanes = m_dataPlanes;
+        _args.m_planePitch = m_planePitch;
+        _args.m_srcFaceSize = m_faceSize;
+        _args.m_warpFixup = m_warpFixup;
+        _args.m_runningSum = NULL;
+    }
+
+    uint32_t m_faceSize;
+    uint32_t m_planePitch;
+    uint32_t m_faceOffsets[6];
+    float m_warpFixup;
+    float* m_normals;
+    float* m_data;
+    float* m_normalPlanes;
+    float* m_dataPlanes;
+};
+
+/// Checks kernels with computed texel normals against the scalar kernel reading the table and
+/// reports time per texel of both over a whole face for several face sizes.
+int testRadianceComputedNormals()
+{
+    using namespace cmft;
+
+    // Computed dot products differ from the table ones in the last bits, texels right at the
+    // lobe cutoff can therefore fall on the other side of it and shift the result slightly.
+    const float tolerance = 0.002f;
+    const SimdLevel::Enum maxLevel = simdLevelDetect();
+    const RadianceKernelFn reference = radianceKernel(SimdLevel::Scalar);
+
+    uint32_t seed = 1;
+    uint32_t numFailed = 0;
+
+    for (uint8_t fixup = 0; fixup < 2; ++fixup)
+    {
+        TestKernelCubemap cubemap;
+        cubemap.create(37, 6, EdgeFixup::Enum(fixup), seed);
+
+        for (uint32_t layout = 0; layout < TableLayout::Count; ++layout)
+        for (uint32_t level = SimdLevel::Scalar; level <= uint32_t(maxLevel); ++level)
+        {
+            const RadianceKernelFn kernel = radianceKernel(SimdLevel::Enum(level), TableLayout::Enum(layout), LobeMath::Precise, TexelNormals::Computed);
+            if (NULL == kernel)
+            {
+                continue;
+            }
+
+            float maxError = 0.0f;
+            for (uint32_t test = 0; test < 1000; ++test)
+            {
+                float tapVec[3] = { testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f, testRandf(seed)*2.0f-1.0f };
+                const float invLen = 1.0f/sqrtf(tapVec[0]*tapVec[0] + tapVec[1]*tapVec[1] + tapVec[2]*tapVec[2]);
+                tapVec[0] *= invLen;
+                tapVec[1] *= invLen;
+                tapVec[2] *= invLen;
+
+                RadianceKernelArgs args;
+                cubemap.setArgs(args);
+                args.m_tapVec = tapVec;
+                args.m_specularPower = powf(2.0f, testRandf(seed)*10.0f);
+                args.m_specularAngle = testRandf(seed)*0.999f;
+
+                RadianceFilterSpan spans[4];
+                for (uint8_t ii = 0; ii < CMFT_COUNTOF(spans); ++ii)
+                {
+                    const uint32_t xx = uint32_t(testRandf(seed)*37.0f);
+                    const uint32_t yy = uint32_t(testRandf(seed)*37.0f);
+                    const uint32_t ww = uint32_t(testRandf(seed)*37.0f);
+                    const uint32_t hh = uint32_t(testRandf(seed)*37.0f);
+                    spans[ii].m_minX   = xx;
+                    spans[ii].m_minY   = yy;
+                    spans[ii].m_maxX   = CMFT_MIN(xx + ww, UINT32_C(36));
+                    spans[ii].m_maxY   = CMFT_MIN(yy + hh, UINT32_C(36));
+                    spans[ii].m_face   = uint8_t(testRandf(seed)*6.0f);
+                    spans[ii].m_inside = false;
+                }
+                args.m_spans = spans;
+                args.m_numSpans = CMFT_COUNTOF(spans);
+
+                float expected[4];
+                float result[4];
+                reference(expected, args);
+                kernel(result, args);
+
+                if (expected[3] < FLT_MIN)
+                {
+                    continue;
+                }
+
+                for (uint8_t ch = 0; ch < 3; ++ch)
+                {
+                    const float ref = expected[ch]/expected[3];
+                    const float res = (0.0f != result[3]) ? result[ch]/result[3] : 0.0f;
+                    maxError = CMFT_MAX(maxError, fabsf(res-ref)/CMFT_MAX(fabsf(ref), 1.0f));
+                }
+            }
+
+            const bool passed = (maxError <= tolerance);
+            numFailed += !passed;
+
+            printf("Radiance computed normals %-8s %-11s %-4s max error: %g ... %s\n"
+                  , getSimdLevelStr(SimdLevel::Enum(level))
+                  , (TableLayout::Planar == layout) ? "planar" : "interleaved"
+                  , (EdgeFixup::Warp == fixup) ? "warp" : "none"
+                  , maxError
+                  , passed ? "ok" : "FAILED"
+                  );
+        }
+
+        cubemap.destroy();
+    }
+
+    // Speed over a whole face, every texel inside of the lobe.
+    for (uint32_t faceSize = 64; faceSize <= 2048; faceSize *= 2)
+    {
+        TestKernelCubemap cubemap;
+        cubemap.create(faceSize, 1, EdgeFixup::None, seed);
+
+        float tapVec[3] = { 1.0f, 0.0f, 0.0f };
+        const RadianceFilterSpan span = { 0, faceSize-1, 0, faceSize-1, 0, true };
+
+        RadianceKernelArgs args;
+        cubemap.setArgs(args);
+        args.m_tapVec = tapVec;
+        args.m_specularPower = 64.0f;
+        args.m_specularAngle = -1.0f;
+        args.m_spans = &span;
+        args.m_numSpans = 1;
+
+        double time[TableLayout::Count][2];
+        for (uint32_t layout = 0; layout < TableLayout::Count; ++layout)
+        for (uint32_t normals = 0; normals < 2; ++normals)
+        {
+            const RadianceKernelFn kernel = radianceKernel(maxLevel
+                                                         , TableLayout::Enum(layout)
+                                                         , LobeMath::Precise
+                                                         , (0 == normals) ? TexelNormals::Table : TexelNormals::Computed
+                                                         );
+
+            // Best of a few repetitions, single runs are too noisy to pick TexelNormals::Auto thresholds from.
+            const uint32_t numRuns = CMFT_MAX(UINT32_C(2), (UINT32_C(16)<<20)/(faceSize*faceSize));
+            time[layout][normals] = DBL_MAX;
+            for (uint32_t rep = 0; rep < 5; ++rep)
+            {
+                const int64_t start = getHPCounter();
+                for (uint32_t run = 0; run < numRuns; ++run)
+                {
+                    float result[4];
+                    kernel(result, args);
+                }
+                const double texelTime = double(getHPCounter()-start)/double(getHPFrequency())/double(numRuns)/double(faceSize*faceSize)*1e9;
+                time[layout][normals] = CMFT_MIN(time[layout][normals], texelTime);
+            }
+        }
+
+        printf("Radiance computed normals %-8s face %4u: interleaved %.2f -> %.2fns/texel, planar %.2f -> %.2fns/texel\n"
+              , getSimdLevelStr(maxLevel)
+              , faceSize
+              , time[TableLayout::Interleaved][0]
+              , time[TableLayout::Interleaved][1]
+              , time[TableLayout::Planar][0]
+              , time[TableLayout::Planar][1]
+              );
+
+        cubemap.destroy();
+    }
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Reports speed of every cpu kernel with precise and fast lobe and max relative error of single
+/// lobe weights against powf().
+int testRadianceLobeMath()
+{
+    const uint32_t faceSize = 64;
+    const uint32_t faceTexels = faceSize*faceSize;
+    const float powers[] = { 8.0f, 64.0f, 512.0f, 2048.0f };
+    const float tolerance[LobeMath::Count] = { 1e-5f, 1e-4f };
+
+    // Normals within the lobe of the largest power around +z.
+    float* normals = (float*)malloc(faceTexels*4*sizeof(float));
+    float* data    = (float*)malloc(faceTexels*4*sizeof(float));
+    const uint32_t faceOffsets[6] = { 0, 0, 0, 0, 0, 0 };
+
+    uint32_t seed = 1;
+    for (uint32_t ii = 0; ii < faceTexels; ++ii)
+    {
+        const float zz = 1.0f - testRandf(seed)*0.005f;
+        const float phi = testRandf(seed)*6.2831853f;
+        const float rr = sqrtf(1.0f - zz*zz);
+        normals[ii*4+0] = rr*cosf(phi);
+        normals[ii*4+1] = rr*sinf(phi);
+        normals[ii*4+2] = zz;
+        normals[ii*4+3] = 1.0f;
+
+        data[ii*4+0] = 1.0f;
+        data[ii*4+1] = testRandf(seed);
+        data[ii*4+2] = testRandf(seed);
+        data[ii*4+3] = 1.0f;
+    }
+
+    float tapVec[3] = { 0.0f, 0.0f, 1.0f };
+
+    RadianceKernelArgs args;
+    args.m_tapVec = tapVec;
+    args.m_specularAngle = -1.0f;
+    args.m_cubemapNormalSolidAngle = normals;
+    args.m_srcData = data;
+    args.m_faceOffsets = faceOffsets;
+    args.m_normalPlanes = NULL;
+    args.m_srcPlanes = NULL;
+    args.m_planePitch = 0;
+    args.m_srcFaceSize = faceSize;
+    args.m_warpFixup = 0.0f;
+
+    const SimdLevel::Enum maxLevel = simdLevelDetect();
+    const RadianceKernelFn reference = radianceKernel(SimdLevel::Scalar);
+
+    uint32_t numFailed = 0;
+    for (uint32_t level = SimdLevel::Scalar; level <= uint32_t(maxLevel); ++level)
+    for (uint32_t lobeMath = 0; lobeMath < LobeMath::Count; ++lobeMath)
+    {
+        const RadianceKernelFn kernel = radianceKernel(SimdLevel::Enum(level), TableLayout::Interleaved, LobeMath::Enum(lobeMath));
+        if (NULL == kernel)
+        {
+            continue;
+        }
+
+        // Error of single weights.
+        float maxError = 0.0f;
+        for (uint32_t pp = 0; pp < CMFT_COUNTOF(powers); ++pp)
+        {
+            args.m_specularPower = powers[pp];
+            for (uint32_t ii = 0; ii < faceTexels; ++ii)
+            {
+                RadianceFilterSpan span = { ii%faceSize, ii%faceSize, ii/faceSize, ii/faceSize, 0, true };
+                args.m_spans = &span;
+                args.m_numSpans = 1;
+
+                float expected[4];
+                float result[4];
+                reference(expected, args);
+                kernel(result, args);
+
+                if (expected[3] >= FLT_MIN)
+                {
+                    maxError = CMFT_MAX(maxError, fabsf(result[3]-expected[3])/expected[3]);
+                }
+            }
+        }
+
+        // Speed over the whole face.
+        RadianceFilterSpan span = { 0, faceSize-1, 0, faceSize-1, 0, true };
+        args.m_spans = &span;
+        args.m_numSpans = 1;
+
+        const uint32_t numRuns = 50;
+        const int64_t start = getHPCounter();
+        for (uint32_t run = 0; run < numRuns; ++run)
+        {
+            for (uint32_t pp = 0; pp < CMFT_COUNTOF(powers); ++pp)
+            {
+                args.m_specularPower = powers[pp];
+
+                float result[4];
+                kernel(result, args);
+            }
+        }
+        const double time = double(getHPCounter()-start)/double(getHPFrequency());
+        const double numTaps = double(numRuns)*double(CMFT_COUNTOF(powers))*double(faceTexels);
+
+        const bool passed = (maxError <= tolerance[lobeMath]);
+        numFailed += !passed;
+
+        printf("Radiance lobe %-8s %-7s %.2fns/tap max weight error: %g ... %s\n"
+              , getSimdLevelStr(SimdLevel::Enum(level))
+              , (LobeMath::Fast == lobeMath) ? "fast" : "precise"
+              , time/numTaps*1e9
+              , maxError
+              , passed ? "ok" : "FAILED"
+              );
+    }
+
+    free(normals);
+    free(data);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Creates RGBA32F cubemap of a sky gradient with a bright sun disc.
+static void testCreateSunCubemap(cmft::Image& _image, uint32_t _faceSize, float _sunIntensity = 50.0f, const float* _sunDir = NULL)
+{
+    using namespace cmft;
+
+    static const float s_sunDir[3] = { 0.48f, 0.64f, 0.6f };
+    const float* sunDir = (NULL == _sunDir) ? s_sunDir : _sunDir;
+
+    imageCreate(_image, _faceSize, _faceSize, 0, 1, 6, TextureFormat::RGBA32F);
+
+    uint32_t faceOffsets[CUBE_FACE_NUM];
+    imageGetFaceOffsets(faceOffsets, _image);
+
+    for (uint8_t face = 0; face < 6; ++face)
+    {
+        float* texel = (float*)((uint8_t*)_image.m_data + faceOffsets[face]);
+        for (uint32_t yy = 0; yy < _faceSize; ++yy)
+        {
+            for (uint32_t xx = 0; xx < _faceSize; ++xx, texel += 4)
+            {
+                const float uu = (float(int32_t(xx))+0.5f)/float(int32_t(_faceSize))*2.0f - 1.0f;
+                const float vv = (float(int32_t(yy))+0.5f)/float(int32_t(_faceSize))*2.0f - 1.0f;
+
+                float vec[3];
+                texelCoordToVec(vec, uu, vv, face);
+
+                const float cosSun = vec[0]*sunDir[0] + vec[1]*sunDir[1] + vec[2]*sunDir[2];
+                const float sun = (cosSun > 0.999f) ? _sunIntensity : 0.0f;
+                const float sky = 0.5f + 0.5f*vec[1];
+
+                texel[0] = sky*0.3f + sun;
+                texel[1] = sky*0.5f + sun;
+                texel[2] = sky*0.9f + sun;
+                texel[3] = 1.0f;
+            }
+        }
+    }
+}
+
+/// Filters a sky with a bright sun disc from the source pyramid at several thresholds and
+/// reports time and PSNR against the exhaustive result.
+int testRadianceSourceMips()
+{
+    using namespace cmft;
+
+    const uint32_t faceSize = 128;
+    const uint8_t mipCount = 8;
+
+    Image src;
+    testCreateSunCubemap(src, faceSize);
+
+    const float thresholds[] = { 0.0f, 0.05f, 0.1f, 0.2f, 0.4f };
+
+    Image reference;
+    int numFailed = 0;
+    for (uint32_t ii = 0; ii < CMFT_COUNTOF(thresholds); ++ii)
+    {
+        RadianceFilterOptions options;
+        options.m_sourceMipThreshold = thresholds[ii];
+
+        Image result;
+        imageCopy(result, src);
+
+        const int64_t start = getHPCounter();
+        const bool ok = imageRadianceFilter(result, 0, LightingModel::BlinnBrdf, false, mipCount, 10, 2
+                                          , EdgeFixup::None, 1, NULL, g_allocator, &options);
+        const double time = double(getHPCounter()-start)/double(getHPFrequency());
+
+        if (!ok)
+        {
+            printf("Source mips threshold %.2f ... FAILED\n", thresholds[ii]);
+            ++numFailed;
+            imageUnload(result);
+            continue;
+        }
+
+        if (0 == ii)
+        {
+            imageMove(reference, result);
+            printf("Source mips threshold %.2f time: %.3fs (exhaustive reference)\n", thresholds[ii], time);
+            continue;
+        }
+
+        const float* ref = (const float*)reference.m_data;
+        const float* res = (const float*)result.m_data;
+        const uint32_t numValues = reference.m_dataSize/sizeof(float);
+
+        double peak = 0.0;
+        double sqError = 0.0;
+        for (uint32_t jj = 0; jj < numValues; ++jj)
+        {
+            const double diff = double(res[jj]) - double(ref[jj]);
+            sqError += diff*diff;
+            peak = CMFT_MAX(peak, double(ref[jj]));
+        }
+        const double mse = sqError/double(numValues);
+        const double psnr = (0.0 < mse) ? 10.0*log10(peak*peak/mse) : 999.0;
+
+        printf("Source mips threshold %.2f time: %.3fs PSNR: %.1fdB\n", thresholds[ii], time, psnr);
+
+        imageUnload(result);
+    }
+
+    imageUnload(reference);
+    imageUnload(src);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Checks that tile culling gives the same result as testing every texel of the filter area.
+int testRadianceTileCulling()
+{
+    using namespace cmft;
+
+    const uint32_t faceSize = 64;
+    const uint8_t mipCount = 7;
+    const float tolerance = 0.001f;
+
+    Image src;
+    testCreateSunCubemap(src, faceSize);
+
+    Image result[2];
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        RadianceFilterOptions options;
+        options.m_tileCulling = (1 == ii);
+
+        imageCopy(result[ii], src);
+        imageRadianceFilter(result[ii], 0, LightingModel::BlinnBrdf, false, mipCount, 10, 2
+                          , EdgeFixup::Warp, 1, NULL, g_allocator, &options);
+    }
+
+    const float* ref = (const float*)result[0].m_data;
+    const float* res = (const float*)result[1].m_data;
+    const uint32_t numValues = result[0].m_dataSize/sizeof(float);
+
+    float maxError = 0.0f;
+    for (uint32_t ii = 0; ii < numValues; ++ii)
+    {
+        const float error = fabsf(res[ii]-ref[ii])/CMFT_MAX(fabsf(ref[ii]), 1.0f);
+        maxError = CMFT_MAX(maxError, error);
+    }
+
+    const bool passed = (maxError <= tolerance);
+    printf("Radiance tile culling max error: %g ... %s\n", maxError, passed ? "ok" : "FAILED");
+
+    imageUnload(result[0]);
+    imageUnload(result[1]);
+    imageUnload(src);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Compares float and compensated accumulation against double on a sky with a very bright sun disc.
+/// Compensated result has to be the same with and without tile culling.
+int testRadianceAccumulation()
+{
+    using namespace cmft;
+
+    const uint32_t faceSize = 256;
+    const uint32_t dstFaceSize = 16;
+    const uint8_t mipCount = 5;
+    const float tolerance = 1e-5f;
+
+    Image src;
+    testCreateSunCubemap(src, faceSize, 50000.0f);
+
+    struct Mode
+    {
+        Accumulation::Enum m_accumulation;
+        bool m_tileCulling;
+    };
+
+    static const Mode s_modes[] =
+    {
+        { Accumulation::Double,      false },
+        { Accumulation::Float,       false },
+        { Accumulation::Compensated, false },
+        { Accumulation::Compensated, true  },
+    };
+
+    Image result[CMFT_COUNTOF(s_modes)];
+    double time[CMFT_COUNTOF(s_modes)];
+    for (uint8_t ii = 0; ii < CMFT_COUNTOF(s_modes); ++ii)
+    {
+        RadianceFilterOptions options;
+        options.m_accumulation = s_modes[ii].m_accumulation;
+        options.m_tileCulling = s_modes[ii].m_tileCulling;
+
+        imageCopy(result[ii], src);
+
+        const int64_t start = getHPCounter();
+        imageRadianceFilter(result[ii], dstFaceSize, LightingModel::BlinnBrdf, false, mipCount, 4, 1
+                          , EdgeFixup::None, 1, NULL, g_allocator, &options);
+        time[ii] = double(getHPCounter()-start)/double(getHPFrequency());
+    }
+
+    const float* ref = (const float*)result[0].m_data;
+    const uint32_t numValues = result[0].m_dataSize/sizeof(float);
+
+    float maxError[CMFT_COUNTOF(s_modes)] = { 0.0f };
+    for (uint8_t ii = 1; ii < CMFT_COUNTOF(s_modes); ++ii)
+    {
+        const float* res = (const float*)result[ii].m_data;
+        for (uint32_t jj = 0; jj < numValues; ++jj)
+        {
+            const float error = fabsf(res[jj]-ref[jj])/CMFT_MAX(fabsf(ref[jj]), 1.0f);
+            maxError[ii] = CMFT_MAX(maxError[ii], error);
+        }
+    }
+
+    const bool deterministic = (result[2].m_dataSize == result[3].m_dataSize)
+                            && (0 == memcmp(result[2].m_data, result[3].m_data, result[2].m_dataSize));
+    const bool passed = deterministic && (maxError[2] <= tolerance) && (maxError[2] <= maxError[1]);
+
+    printf("Radiance accumulation max error against double (%.3fs): float %g (%.3fs), compensated %g (%.3fs), tile culling %s ... %s\n"
+          , time[0]
+          , maxError[1], time[1]
+          , maxError[2], time[2]
+          , deterministic ? "identical" : "different"
+          , passed ? "ok" : "FAILED"
+          );
+
+    for (uint8_t ii = 0; ii < CMFT_COUNTOF(s_modes); ++ii)
+    {
+        imageUnload(result[ii]);
+    }
+    imageUnload(src);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Filters RGBA16F and RGBE sources directly and compares them against filtering the same texels
+/// converted to RGBA32F, with default options and for both table layouts. Planar tables read compact
+/// sources interleaved, so their output has to match the interleaved one exactly.
+int testRadianceSourceFormats()
+{
+    using namespace cmft;
+
+    const uint32_t faceSize = 128;
+    const uint32_t dstFaceSize = 16;
+    const uint8_t mipCount = 4;
+    // One step of the output quantization.
+    const float tolerance[2] = { 1e-3f, 8e-3f };
+
+    Image sun;
+    testCreateSunCubemap(sun, faceSize);
+
+    static const TextureFormat::Enum s_formats[] = { TextureFormat::RGBA16F, TextureFormat::RGBE };
+
+    int numFailed = 0;
+    for (uint8_t ii = 0; ii < CMFT_COUNTOF(s_formats); ++ii)
+    {
+        Image src;
+        imageConvert(src, s_formats[ii], sun);
+
+        Image interleaved;
+
+        // Default options first, then every table layout.
+        for (uint32_t config = 0; config <= TableLayout::Count; ++config)
+        {
+            RadianceFilterOptions layoutOptions;
+            const RadianceFilterOptions* options = NULL;
+            if (0 != config)
+            {
+                layoutOptions.m_tableLayout = TableLayout::Enum(config-1);
+                options = &layoutOptions;
+            }
+
+            Image result[2];
+            double time[2];
+            for (uint8_t jj = 0; jj < 2; ++jj)
+            {
+                if (0 == jj)
+                {
+                    imageToRgba32f(result[jj], src);
+                }
+                else
+                {
+                    imageCopy(result[jj], src);
+                }
+
+                const int64_t start = getHPCounter();
+                imageRadianceFilter(result[jj], dstFaceSize, LightingModel::BlinnBrdf, false, mipCount, 8, 1
+                                  , EdgeFixup::None, 1, NULL, g_allocator, options);
+                time[jj] = double(getHPCounter()-start)/double(getHPFrequency());
+            }
+
+            bool matchesInterleaved = true;
+            if (TableLayout::Interleaved+1 == config)
+            {
+                imageCopy(interleaved, result[1]);
+            }
+            else if (TableLayout::Planar+1 == config)
+            {
+                matchesInterleaved = (interleaved.m_dataSize == result[1].m_dataSize)
+                                  && (0 == memcmp(interleaved.m_data, result[1].m_data, interleaved.m_dataSize));
+            }
+
+            // Output is written in the source format, quantize the reference the same way.
+            imageConvert(result[0], s_formats[ii]);
+            imageToRgba32f(result[0]);
+            imageToRgba32f(result[1]);
+
+            const float* ref = (const float*)result[0].m_data;
+            const float* res = (const float*)result[1].m_data;
+            const uint32_t numValues = result[0].m_dataSize/sizeof(float);
+
+            float maxError = 0.0f;
+            for (uint32_t kk = 0; kk < numValues; ++kk)
+            {
+                const float error = fabsf(res[kk]-ref[kk])/CMFT_MAX(fabsf(ref[kk]), 1.0f);
+                maxError = CMFT_MAX(maxError, error);
+            }
+
+            const bool passed = (maxError <= tolerance[ii]) && matchesInterleaved;
+            numFailed += !passed;
+
+            printf("Radiance %s source, %s: max error %g, %.3fs (rgba32f %.3fs) ... %s\n"
+                  , getTextureFormatStr(s_formats[ii])
+                  , (0 == config) ? "default options" : (TableLayout::Planar+1 == config) ? "planar tables" : "interleaved tables"
+                  , maxError
+                  , time[1]
+                  , time[0]
+                  , passed ? "ok" : "FAILED"
+                  );
+
+            imageUnload(result[0]);
+            imageUnload(result[1]);
+        }
+
+        imageUnload(interleaved);
+        imageUnload(src);
+    }
+
+    imageUnload(sun);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Sky with a broad sun lobe around _sunDir.
+static void testCreateSkyCubemap(cmft::Image& _image, uint32_t _faceSize, const float _sunDir[3])
+{
+    using namespace cmft;
+
+    imageCreate(_image, _faceSize, _faceSize, 0, 1, 6, TextureFormat::RGBA32F);
+
+    uint32_t faceOffsets[CUBE_FACE_NUM];
+    imageGetFaceOffsets(faceOffsets, _image);
+
+    const float invFaceSize = 1.0f/float(int32_t(_faceSize));
+    for (uint8_t face = 0; face < 6; ++face)
+    {
+        float* texel = (float*)((uint8_t*)_image.m_data + faceOffsets[face]);
+        for (uint32_t yy = 0; yy < _faceSize; ++yy)
+        {
+            for (uint32_t xx = 0; xx < _faceSize; ++xx, texel += 4)
+            {
+                const float uu = (float(int32_t(xx))+0.5f)*invFaceSize*2.0f - 1.0f;
+                const float vv = (float(int32_t(yy))+0.5f)*invFaceSize*2.0f - 1.0f;
+
+                float vec[3];
+                texelCoordToVec(vec, uu, vv, face);
+
+                const float cosSun = CMFT_MAX(0.0f, vec[0]*_sunDir[0] + vec[1]*_sunDir[1] + vec[2]*_sunDir[2]);
+                const float sun = 5.0f*powf(cosSun, 16.0f);
+                const float sky = 0.5f + 0.5f*vec[1];
+
+                texel[0] = sky*0.3f + sun;
+                texel[1] = sky*0.5f + sun;
+                texel[2] = sky*0.9f + sun;
+                texel[3] = 1.0f;
+            }
+        }
+    }
+}
+
+/// Compares importance sampled Ggx lobe against integration over every source texel and reports time
+/// of both the Ggx and the exhaustively integrated BlinnBrdf lobe, on a small source and on a 512
+/// texel source where brute force integration gets expensive.
+int testRadianceGgx()
+{
+    using namespace cmft;
+
+    const uint32_t srcFaceSize = 64;
+    const uint32_t dstFaceSize = 32;
+    const uint8_t mipCount = 6;
+    const uint8_t glossScale = 6;
+    const uint8_t glossBias = 0;
+    const float tolerance = 0.04f;
+
+    const float sunDir[3] = { 0.48f, 0.64f, 0.6f };
+    Image src;
+    testCreateSkyCubemap(src, srcFaceSize, sunDir);
+
+    uint32_t srcFaceOffsets[CUBE_FACE_NUM];
+    imageGetFaceOffsets(srcFaceOffsets, src);
+
+    const float invSrcFaceSize = 1.0f/float(int32_t(srcFaceSize));
+
+    Image result[2];
+    double time[2];
+    const LightingModel::Enum lightingModel[2] = { LightingModel::Ggx, LightingModel::BlinnBrdf };
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        const int64_t start = getHPCounter();
+        imageRadianceFilter(result[ii], dstFaceSize, lightingModel[ii], false, mipCount, glossScale, glossBias, src, EdgeFixup::None, 1);
+        time[ii] = double(getHPCounter()-start)/double(getHPFrequency());
+    }
+
+    uint32_t dstOffsets[CUBE_FACE_NUM][MAX_MIP_NUM];
+    imageGetMipOffsets(dstOffsets, result[0]);
+
+    // Integrate radiance*(n.l)*D(h) over every source texel, which is what the samples estimate.
+    float maxError = 0.0f;
+    for (uint8_t mip = 0; mip < mipCount; ++mip)
+    {
+        const float specularPower = specularPowerFor(float(mip), float(mipCount), float(glossScale), float(glossBias));
+        const float alphaSq = 2.0f/(applyLightningModel(specularPower, LightingModel::Ggx) + 2.0f);
+        const uint32_t mipFaceSize = dstFaceSize >> mip;
+
+        // 1x1 faces are averaged over the cube.
+        if (1 == mipFaceSize)
+        {
+            continue;
+        }
+
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            const float* res = (const float*)((const uint8_t*)result[0].m_data + dstOffsets[face][mip]);
+            for (uint32_t texel = 0; texel < mipFaceSize*mipFaceSize; ++texel, res += 4)
+            {
+                const float uu = (float(int32_t(texel%mipFaceSize))+0.5f)/float(int32_t(mipFaceSize))*2.0f - 1.0f;
+                const float vv = (float(int32_t(texel/mipFaceSize))+0.5f)/float(int32_t(mipFaceSize))*2.0f - 1.0f;
+
+                float normal[3];
+                texelCoordToVec(normal, uu, vv, face);
+
+                double ref[4] = { 0.0, 0.0, 0.0, 0.0 };
+                for (uint8_t srcFace = 0; srcFace < 6; ++srcFace)
+                {
+                    const float* srcTexel = (const float*)((const uint8_t*)src.m_data + srcFaceOffsets[srcFace]);
+                    for (uint32_t yy = 0; yy < srcFaceSize; ++yy)
+                    {
+                        for (uint32_t xx = 0; xx < srcFaceSize; ++xx, srcTexel += 4)
+                        {
+                            const float su = (float(int32_t(xx))+0.5f)*invSrcFaceSize*2.0f - 1.0f;
+                            const float sv = (float(int32_t(yy))+0.5f)*invSrcFaceSize*2.0f - 1.0f;
+
+                            float dir[3];
+                            texelCoordToVec(dir, su, sv, srcFace);
+
+                            const float nDotL = normal[0]*dir[0] + normal[1]*dir[1] + normal[2]*dir[2];
+                            if (nDotL <= 0.0f)
+                            {
+                                continue;
+                            }
+
+                            // n.h for h = normalize(n+l).
+                            const float nDotH = sqrtf(0.5f*(1.0f + nDotL));
+                            const float dd = (alphaSq - 1.0f)*nDotH*nDotH + 1.0f;
+                            const double weight = double(nDotL*alphaSq/(dd*dd)*texelSolidAngle(su, sv, invSrcFaceSize));
+
+                            ref[0] += srcTexel[0]*weight;
+                            ref[1] += srcTexel[1]*weight;
+                            ref[2] += srcTexel[2]*weight;
+                            ref[3] += weight;
+                        }
+                    }
+                }
+
+                for (uint8_t ch = 0; ch < 3; ++ch)
+                {
+                    const float expected = float(ref[ch]/ref[3]);
+                    maxError = CMFT_MAX(maxError, fabsf(res[ch]-expected)/CMFT_MAX(fabsf(expected), 1.0f));
+                }
+            }
+        }
+    }
+
+    const bool passed = (maxError <= tolerance);
+    printf("Radiance ggx %4u -> %3u time: %.3fs, blinnbrdf time: %.3fs, max error: %g ... %s\n", srcFaceSize, dstFaceSize, time[0], time[1], maxError, passed ? "ok" : "FAILED");
+
+    imageUnload(result[0]);
+    imageUnload(result[1]);
+    imageUnload(src);
+
+    // Speed only, brute force reference is too slow at this size.
+    {
+        const uint32_t bigSrcFaceSize = 512;
+        const uint32_t bigDstFaceSize = 128;
+        const uint8_t bigMipCount = 8;
+
+        Image bigSrc;
+        testCreateSkyCubemap(bigSrc, bigSrcFaceSize, sunDir);
+
+        for (uint8_t ii = 0; ii < 2; ++ii)
+        {
+            Image bigResult;
+            const int64_t start = getHPCounter();
+            imageRadianceFilter(bigResult, bigDstFaceSize, lightingModel[ii], false, bigMipCount, 10, 1, bigSrc, EdgeFixup::None, 1);
+            time[ii] = double(getHPCounter()-start)/double(getHPFrequency());
+            imageUnload(bigResult);
+        }
+
+        printf("Radiance ggx %4u -> %3u time: %.3fs, blinnbrdf time: %.3fs\n", bigSrcFaceSize, bigDstFaceSize, time[0], time[1]);
+
+        imageUnload(bigSrc);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+struct TestThreadPoolData
+{
+    enum
+    {
+        NumOuter = 8,
+        NumInner = 100,
+    };
+
+    std::atomic<uint32_t> m_hits[NumOuter*NumInner];
+    uint32_t m_outer;
+};
+
+static void testThreadPoolInner(void* _data, uint32_t _index)
+{
+    TestThreadPoolData* data = (TestThreadPoolData*)_data;
+    data->m_hits[data->m_outer*TestThreadPoolData::NumInner + _index]++;
+}
+
+static void testThreadPoolOuter(void* _data, uint32_t _index)
+{
+    TestThreadPoolData* data = (TestThreadPoolData*)_data;
+
+    TestThreadPoolData inner = {};
+    inner.m_outer = _index;
+    cmft::threadPoolRun(testThreadPoolInner, &inner, TestThreadPoolData::NumInner);
+
+    for (uint32_t ii = 0; ii < TestThreadPoolData::NumInner; ++ii)
+    {
+        data->m_hits[_index*TestThreadPoolData::NumInner + ii] += inner.m_hits[_index*TestThreadPoolData::NumInner + ii];
+    }
+}
+
+int testThreadPool()
+{
+    using namespace cmft;
+
+    uint32_t numFailed = 0;
+
+    // Every task runs exactly once, also when started from inside of another task.
+    threadPoolInit(3);
+
+    TestThreadPoolData data = {};
+    threadPoolRun(testThreadPoolOuter, &data, TestThreadPoolData::NumOuter);
+
+    for (uint32_t ii = 0; ii < TestThreadPoolData::NumOuter*TestThreadPoolData::NumInner; ++ii)
+    {
+        numFailed += (1 != data.m_hits[ii]);
+    }
+    printf("Thread pool nested tasks ... %s\n", 0 == numFailed ? "ok" : "FAILED");
+
+    // Results must not depend on the number of workers.
+    Image src;
+    testCreateSunCubemap(src, 64);
+
+    Image result[2];
+    Image converted[2];
+    Image resized[2];
+    Image mipChain[2];
+    const uint8_t numWorkers[2] = { 0, 3 };
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        threadPoolInit(numWorkers[ii]);
+
+        imageCopy(result[ii], src);
+        imageRadianceFilter(result[ii], 0, LightingModel::BlinnBrdf, false, 7, 10, 2, EdgeFixup::Warp, 4);
+
+        imageConvert(converted[ii], TextureFormat::RGBA16F, result[ii]);
+        imageToRgba32f(converted[ii]);
+
+        imageResize(resized[ii], 40, result[ii]);
+
+        imageCopy(mipChain[ii], src);
+        imageGenerateMipMapChain(mipChain[ii], 7);
+    }
+
+    const bool radianceEqual = (0 == memcmp(result[0].m_data, result[1].m_data, result[0].m_dataSize));
+    const bool convertEqual  = (0 == memcmp(converted[0].m_data, converted[1].m_data, converted[0].m_dataSize));
+    const bool resizeEqual   = (0 == memcmp(resized[0].m_data, resized[1].m_data, resized[0].m_dataSize));
+    const bool mipChainEqual = (0 == memcmp(mipChain[0].m_data, mipChain[1].m_data, mipChain[0].m_dataSize));
+    numFailed += !radianceEqual + !convertEqual + !resizeEqual + !mipChainEqual;
+    printf("Thread pool radiance filter ... %s\n", radianceEqual ? "ok" : "FAILED");
+    printf("Thread pool image conversion ... %s\n", convertEqual ? "ok" : "FAILED");
+    printf("Thread pool image resize ... %s\n", resizeEqual ? "ok" : "FAILED");
+    printf("Thread pool mip map chain ... %s\n", mipChainEqual ? "ok" : "FAILED");
+
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        imageUnload(result[ii]);
+        imageUnload(converted[ii]);
+        imageUnload(resized[ii]);
+        imageUnload(mipChain[ii]);
+    }
+    imageUnload(src);
+
+    threadPoolShutdown();
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+struct TestRadianceBake
+{
+    cmft::RadianceFilterContext* m_context;
+    const cmft::Image* m_src;
+    cmft::Image m_result;
+    cmft::EdgeFixup::Enum m_edgeFixup;
+    bool m_ok;
+};
+
+static void testRadianceBake(TestRadianceBake* _bake)
+{
+    using namespace cmft;
+
+    _bake->m_ok = imageRadianceFilter(_bake->m_context, _bake->m_result, 0, LightingModel::BlinnBrdf, false, 7, 10, 2
+                                    , *_bake->m_src, _bake->m_edgeFixup, 2);
+}
+
+int testRadianceFilterContext()
+{
+    using namespace cmft;
+
+    enum { NumBakes = 4 };
+
+    Image src;
+    testCreateSunCubemap(src, 64);
+
+    // Reference results, one bake at a time.
+    Image reference[2];
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        imageRadianceFilter(reference[ii], 0, LightingModel::BlinnBrdf, false, 7, 10, 2, src, EdgeFixup::Enum(ii), 2);
+    }
+
+    // Concurrent bakes, each with its own context.
+    TestRadianceBake bake[NumBakes];
+    std::thread threads[NumBakes];
+    for (uint8_t ii = 0; ii < NumBakes; ++ii)
+    {
+        bake[ii].m_context   = radianceFilterContextCreate();
+        bake[ii].m_src       = &src;
+        bake[ii].m_edgeFixup = EdgeFixup::Enum(ii%2);
+        bake[ii].m_ok        = false;
+        threads[ii] = std::thread(testRadianceBake, &bake[ii]);
+    }
+
+    uint32_t numFailed = 0;
+    for (uint8_t ii = 0; ii < NumBakes; ++ii)
+    {
+        threads[ii].join();
+
+        const Image& ref = reference[ii%2];
+        numFailed += !bake[ii].m_ok || 0 != memcmp(bake[ii].m_result.m_data, ref.m_data, ref.m_dataSize);
+
+        imageUnload(bake[ii].m_result);
+        radianceFilterContextDestroy(bake[ii].m_context);
+    }
+
+    printf("Radiance filter concurrent contexts ... %s\n", 0 == numFailed ? "ok" : "FAILED");
+
+    imageUnload(reference[0]);
+    imageUnload(reference[1]);
+    imageUnload(src);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Filters cubemaps of different sizes in one batch and checks that results are the same as filtering them
+/// one at a time, also when the batch writes over its sources and for every group kernel variant. Fails when
+/// a batch of many small probes has lower throughput than filtering them one call each.
+int testRadianceFilterBatch()
+{
+    using namespace cmft;
+
+    enum { NumMixed = 4, NumProbes = 64 };
+
+    static const uint32_t s_faceSizes[NumMixed] = { 64, 16, 128, 32 };
+    static const float s_sunIntensity[NumMixed] = { 50.0f, 5.0f, 500.0f, 1.0f };
+
+    Image src[NumMixed];
+    Image reference[NumMixed];
+    Image batch[NumMixed];
+    for (uint8_t ii = 0; ii < NumMixed; ++ii)
+    {
+        testCreateSunCubemap(src[ii], s_faceSizes[ii], s_sunIntensity[ii]);
+        imageRadianceFilter(reference[ii], 0, LightingModel::BlinnBrdf, false, 5, 10, 2, src[ii], EdgeFixup::Warp, 1);
+    }
+
+    uint32_t numFailed = 0;
+    numFailed += !imageRadianceFilterBatch(batch, src, NumMixed, 0, LightingModel::BlinnBrdf, false, 5, 10, 2, EdgeFixup::Warp, 1);
+    numFailed += !imageRadianceFilterBatch(src, src, NumMixed, 0, LightingModel::BlinnBrdf, false, 5, 10, 2, EdgeFixup::Warp, 1);
+    for (uint8_t ii = 0; ii < NumMixed; ++ii)
+    {
+        numFailed += (batch[ii].m_dataSize != reference[ii].m_dataSize)
+                  || (0 != memcmp(batch[ii].m_data, reference[ii].m_data, reference[ii].m_dataSize))
+                  || (0 != memcmp(src[ii].m_data, reference[ii].m_data, reference[ii].m_dataSize))
+                  ;
+
+        imageUnload(src[ii]);
+        imageUnload(reference[ii]);
+        imageUnload(batch[ii]);
+    }
+
+    printf("Radiance filter batch of mixed sizes ... %s\n", 0 == numFailed ? "ok" : "FAILED");
+
+    // Cubemaps of equal size and format are filtered by group kernels, which have to be bit exact.
+    enum { NumGroup = 3 };
+    static const float s_sunDir[NumGroup][3] =
+    {
+        { 0.0f,  1.0f, 0.0f },
+        { 0.6f,  0.0f, 0.8f },
+        { 0.0f, -0.8f, 0.6f },
+    };
+
+    static const char* s_variantStr[] =
+    {
+        "default", "planar", "computed normals", "double", "compensated", "fast lobe", "tile culling", "RGBA16F", "RGBE",
+    };
+
+    for (uint8_t variant = 0; variant < CMFT_COUNTOF(s_variantStr); ++variant)
+    {
+        RadianceFilterOptions options;
+        TextureFormat::Enum format = TextureFormat::RGBA32F;
+        switch (variant)
+        {
+        case 1: options.m_tableLayout  = TableLayout::Planar;       break;
+        case 2: options.m_texelNormals = TexelNormals::Computed;    break;
+        case 3: options.m_accumulation = Accumulation::Double;      break;
+        case 4: options.m_accumulation = Accumulation::Compensated; break;
+        case 5: options.m_lobeMath     = LobeMath::Fast;            break;
+        case 6: options.m_tileCulling  = true;                      break;
+        case 7: format = TextureFormat::RGBA16F;                    break;
+        case 8: format = TextureFormat::RGBE;                       break;
+        default:                                                    break;
+        }
+
+        Image groupSrc[NumGroup];
+        Image groupDst[NumGroup];
+        Image groupRef[NumGroup];
+        for (uint8_t ii = 0; ii < NumGroup; ++ii)
+        {
+            Image sun;
+            testCreateSunCubemap(sun, 64, 50.0f, s_sunDir[ii]);
+            imageConvert(groupSrc[ii], format, sun);
+            imageUnload(sun);
+
+            imageRadianceFilter(groupRef[ii], 0, LightingModel::BlinnBrdf, false, 5, 10, 2, groupSrc[ii], EdgeFixup::Warp, 1, NULL, g_allocator, &options);
+        }
+
+        bool exact = imageRadianceFilterBatch(groupDst, groupSrc, NumGroup, 0, LightingModel::BlinnBrdf, false, 5, 10, 2, EdgeFixup::Warp, 1, NULL, g_allocator, &options);
+        for (uint8_t ii = 0; ii < NumGroup; ++ii)
+        {
+            exact &= (groupDst[ii].m_dataSize == groupRef[ii].m_dataSize)
+                  && (0 == memcmp(groupDst[ii].m_data, groupRef[ii].m_data, groupRef[ii].m_dataSize))
+                  ;
+
+            imageUnload(groupSrc[ii]);
+            imageUnload(groupDst[ii]);
+            imageUnload(groupRef[ii]);
+        }
+
+        numFailed += !exact;
+        printf("Radiance filter batch group %-16s ... %s\n", s_variantStr[variant], exact ? "ok" : "FAILED");
+    }
+
+    // Throughput of many small probes, one call each against a single batch.
+    Image probe;
+    testCreateSunCubemap(probe, 32);
+
+    Image probeSrc[NumProbes];
+    Image probeDst[NumProbes];
+    for (uint8_t ii = 0; ii < NumProbes; ++ii)
+    {
+        imageCopy(probeSrc[ii], probe);
+    }
+
+    const int64_t start = getHPCounter();
+    for (uint8_t ii = 0; ii < NumProbes; ++ii)
+    {
+        imageRadianceFilter(probeDst[ii], 0, LightingModel::BlinnBrdf, false, 6, 10, 2, probeSrc[ii], EdgeFixup::None, 1);
+    }
+    const int64_t mid = getHPCounter();
+    imageRadianceFilterBatch(probeSrc, probeSrc, NumProbes, 0, LightingModel::BlinnBrdf, false, 6, 10, 2, EdgeFixup::None, 1);
+    const int64_t end = getHPCounter();
+
+    const double freq = double(getHPFrequency());
+    const double single = double(NumProbes)*freq/double(mid-start);
+    const double batched = double(NumProbes)*freq/double(end-mid);
+
+    for (uint8_t ii = 0; ii < NumProbes; ++ii)
+    {
+        numFailed += (0 != memcmp(probeSrc[ii].m_data, probeDst[ii].m_data, probeDst[ii].m_dataSize));
+
+        imageUnload(probeSrc[ii]);
+        imageUnload(probeDst[ii]);
+    }
+    imageUnload(probe);
+
+    // Batch filters the same work with less overhead and never has to be slower.
+    const bool faster = (batched >= single);
+    numFailed += !faster;
+
+    printf("Radiance filter batch of %u 32x32 probes: %.1f probes/s, one call each %.1f probes/s ... %s\n"
+          , uint32_t(NumProbes)
+          , batched
+          , single
+          , faster ? "ok" : "FAILED"
+          );
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Returns OpenCL context of a CPU device, such as PoCL, or NULL when there is no OpenCL library or device.
+static cmft::ClContext* testClInit()
+{
+    using namespace cmft;
+
+    if (!clLoad())
+    {
+        return NULL;
+    }
+
+    ClContext* clContext = clInit(CMFT_CL_VENDOR_ANY_GPU|CMFT_CL_VENDOR_ANY_CPU|CMFT_CL_VENDOR_OTHER, CMFT_CL_DEVICE_TYPE_CPU);
+    if (NULL == clContext)
+    {
+        clUnload();
+    }
+
+    return clContext;
+}
+
+static void testClShutdown(cmft::ClContext* _clContext)
+{
+    cmft::clDestroy(_clContext);
+    cmft::clUnload();
+}
+
+/// Returns the largest difference between RGBA32F images of the same size, relative to the peak of _reference.
+static float testImageMaxError(const cmft::Image& _result, const cmft::Image& _reference)
+{
+    if (_result.m_dataSize != _reference.m_dataSize
+    ||  _result.m_format   != _reference.m_format)
+    {
+        return FLT_MAX;
+    }
+
+    const float* res = (const float*)_result.m_data;
+    const float* ref = (const float*)_reference.m_data;
+    const uint32_t numValues = _reference.m_dataSize/sizeof(float);
+
+    float peak = 0.0f;
+    float maxDiff = 0.0f;
+    for (uint32_t ii = 0; ii < numValues; ++ii)
+    {
+        peak = CMFT_MAX(peak, fabsf(ref[ii]));
+        maxDiff = CMFT_MAX(maxDiff, fabsf(res[ii]-ref[ii]));
+    }
+
+    return maxDiff/CMFT_MAX(peak, FLT_MIN);
+}
+
+/// Rows filtered for every face of the mips of a face size, when none is excluded or reconstructed from SH.
+static uint32_t testRadianceNumRows(uint32_t _faceSize, uint8_t _mipCount)
+{
+    const uint8_t mipMax = uint8_t(cmft::ftou(cmft::log2f(cmft::utof(_faceSize))) + 1);
+    const uint8_t mipCount = CMFT_MIN(_mipCount, mipMax);
+
+    uint32_t numRows = 0;
+    for (uint8_t mip = 0; mip < mipCount; ++mip)
+    {
+        numRows += 6*CMFT_MAX(_faceSize >> mip, UINT32_C(1));
+    }
+
+    return numRows;
+}
+
+/// Filters on the OpenCL device alone and together with a cpu worker, which split rows by the cost model, and
+/// compares both with the cpu filter. Device tests need an OpenCL CPU device such as PoCL and are skipped without one.
+int testRadianceOpenCl()
+{
+    using namespace cmft;
+
+    uint32_t numFailed = 0;
+
+    Image src;
+    testCreateSunCubemap(src, 64);
+
+    const uint32_t numRows = testRadianceNumRows(64, 7);
+
+    RadianceFilterContext* context = radianceFilterContextCreate();
+
+    Image reference;
+    numFailed += !imageRadianceFilter(context, reference, 0, LightingModel::BlinnBrdf, false, 7, 10, 2, src, EdgeFixup::None, 1);
+
+    // Without a device every row is filtered on cpu.
+    RadianceFilterStats stats;
+    radianceFilterContextGetStats(context, stats);
+    numFailed += (stats.m_cpuRows != numRows || 0 != stats.m_gpuRows || 6*7 != stats.m_cpuFaces || 0 != stats.m_gpuFaces)
+              || (DeviceFormat::Auto != stats.m_deviceFormat);
+    printf("Radiance filter stats rows cpu %u gpu %u, faces cpu %u gpu %u ... %s\n"
+          , stats.m_cpuRows, stats.m_gpuRows, stats.m_cpuFaces, stats.m_gpuFaces, 0 == numFailed ? "ok" : "FAILED");
+
+    ClContext* clContext = testClInit();
+    if (NULL == clContext)
+    {
+        printf("Radiance OpenCL ... skipped, no OpenCL device\n");
+    }
+    else
+    {
+        RadianceFilterOptions options;
+        options.m_deviceFormat = DeviceFormat::Float;
+
+        // Cpu worker runs on a pool thread while the calling thread hosts the device.
+        threadPoolInit(1);
+
+        for (uint8_t numCpuThreads = 0; numCpuThreads < 2; ++numCpuThreads)
+        {
+            Image result;
+            const bool ok = imageRadianceFilter(context, result, 0, LightingModel::BlinnBrdf, false, 7, 10, 2, src
+                                              , EdgeFixup::None, numCpuThreads, clContext, g_allocator, &options);
+            radianceFilterContextGetStats(context, stats);
+
+            // Every row is filtered once, by the device alone when there are no cpu workers and by both otherwise.
+            const float maxError = ok ? testImageMaxError(result, reference) : FLT_MAX;
+            const bool passed = ok
+                             && maxError < 0.01f
+                             && 0 != stats.m_gpuRows
+                             && numRows == stats.m_cpuRows + stats.m_gpuRows
+                             && (0 == numCpuThreads) == (0 == stats.m_cpuRows)
+                             ;
+            numFailed += !passed;
+
+            printf("Radiance OpenCL float, %u cpu thread%s, rows cpu %u gpu %u, max error: %g ... %s\n"
+                  , numCpuThreads, 1 == numCpuThreads ? "" : "s", stats.m_cpuRows, stats.m_gpuRows, maxError, passed ? "ok" : "FAILED");
+
+            imageUnload(result);
+        }
+
+        threadPoolShutdown();
+        testClShutdown(clContext);
+    }
+
+    radianceFilterContextDestroy(context);
+    imageUnload(reference);
+    imageUnload(src);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Filters a batch of cubemaps of different sizes on the OpenCL device alone and together with a cpu worker.
+/// Many small faces keep several device jobs in flight, results are compared with the cpu filter of each cubemap.
+/// Needs an OpenCL CPU device such as PoCL and is skipped without one.
+int testRadianceOpenClBatch()
+{
+    using namespace cmft;
+
+    ClContext* clContext = testClInit();
+    if (NULL == clContext)
+    {
+        printf("Radiance OpenCL batch ... skipped, no OpenCL device\n");
+        return EXIT_SUCCESS;
+    }
+
+    enum { NumCubemaps = 4 };
+    static const uint32_t s_faceSizes[NumCubemaps] = { 32, 64, 16, 64 };
+    static const float s_sunIntensity[NumCubemaps] = { 50.0f, 5.0f, 500.0f, 1.0f };
+
+    uint32_t numFailed = 0;
+    uint32_t numRows = 0;
+
+    Image src[NumCubemaps];
+    Image reference[NumCubemaps];
+    for (uint8_t ii = 0; ii < NumCubemaps; ++ii)
+    {
+        testCreateSunCubemap(src[ii], s_faceSizes[ii], s_sunIntensity[ii]);
+        numFailed += !imageRadianceFilter(reference[ii], 0, LightingModel::BlinnBrdf, false, 5, 10, 2, src[ii], EdgeFixup::Warp, 1);
+        numRows += testRadianceNumRows(s_faceSizes[ii], 5);
+    }
+
+    RadianceFilterContext* context = radianceFilterContextCreate();
+
+    RadianceFilterOptions options;
+    options.m_deviceFormat = DeviceFormat::Float;
+
+    // Cpu worker runs on a pool thread while the calling thread hosts the device.
+    threadPoolInit(1);
+
+    for (uint8_t numCpuThreads = 0; numCpuThreads < 2; ++numCpuThreads)
+    {
+        Image batch[NumCubemaps];
+        const bool ok = imageRadianceFilterBatch(context, batch, src, NumCubemaps, 0, LightingModel::BlinnBrdf, false, 5, 10, 2
+                                               , EdgeFixup::Warp, numCpuThreads, clContext, g_allocator, &options);
+
+        RadianceFilterStats stats;
+        radianceFilterContextGetStats(context, stats);
+
+        float maxError = ok ? 0.0f : FLT_MAX;
+        for (uint8_t ii = 0; ii < NumCubemaps; ++ii)
+        {
+            if (ok)
+            {
+                maxError = CMFT_MAX(maxError, testImageMaxError(batch[ii], reference[ii]));
+            }
+
+            imageUnload(batch[ii]);
+        }
+
+        const bool passed = ok
+                         && maxError < 0.01f
+                         && 0 != stats.m_gpuRows
+                         && numRows == stats.m_cpuRows + stats.m_gpuRows
+                         && (0 == numCpuThreads) == (0 == stats.m_cpuRows)
+                         ;
+        numFailed += !passed;
+
+        printf("Radiance OpenCL batch of %u, %u cpu thread%s, rows cpu %u gpu %u, max error: %g ... %s\n"
+              , NumCubemaps, numCpuThreads, 1 == numCpuThreads ? "" : "s", stats.m_cpuRows, stats.m_gpuRows, maxError, passed ? "ok" : "FAILED");
+    }
+
+    threadPoolShutdown();
+
+    for (uint8_t ii = 0; ii < NumCubemaps; ++ii)
+    {
+        imageUnload(reference[ii]);
+        imageUnload(src[ii]);
+    }
+
+    radianceFilterContextDestroy(context);
+    testClShutdown(clContext);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Filters RGBA32F and RGBA16F sources with half float device images, whose kernels compute texel normals, and
+/// compares results with the cpu filter. RGBA16F sources pick half images by themselves and give RGBA16F output.
+/// Needs an OpenCL CPU device such as PoCL and is skipped without one.
+int testRadianceOpenClHalf()
+{
+    using namespace cmft;
+
+    ClContext* clContext = testClInit();
+    if (NULL == clContext)
+    {
+        printf("Radiance OpenCL half ... skipped, no OpenCL device\n");
+        return EXIT_SUCCESS;
+    }
+
+    struct Case
+    {
+        const char* m_name;
+        TextureFormat::Enum m_srcFormat;
+        DeviceFormat::Enum m_format;
+        EdgeFixup::Enum m_edgeFixup;
+        DeviceFormat::Enum m_expected;
+    };
+
+    static const Case s_cases[] =
+    {
+        { "RGBA32F auto",       TextureFormat::RGBA32F, DeviceFormat::Auto,  EdgeFixup::None, DeviceFormat::Float },
+        { "RGBA32F half",       TextureFormat::RGBA32F, DeviceFormat::Half,  EdgeFixup::None, DeviceFormat::Half  },
+        { "RGBA32F half, warp", TextureFormat::RGBA32F, DeviceFormat::Half,  EdgeFixup::Warp, DeviceFormat::Half  },
+        { "RGBA16F auto",       TextureFormat::RGBA16F, DeviceFormat::Auto,  EdgeFixup::None, DeviceFormat::Half  },
+        { "RGBA16F auto, warp", TextureFormat::RGBA16F, DeviceFormat::Auto,  EdgeFixup::Warp, DeviceFormat::Half  },
+        { "RGBA16F float",      TextureFormat::RGBA16F, DeviceFormat::Float, EdgeFixup::None, DeviceFormat::Float },
+    };
+
+    uint32_t numFailed = 0;
+
+    Image sun;
+    testCreateSunCubemap(sun, 64);
+
+    RadianceFilterContext* context = radianceFilterContextCreate();
+
+    for (uint32_t ii = 0; ii < CMFT_COUNTOF(s_cases); ++ii)
+    {
+        const Case& testCase = s_cases[ii];
+
+        Image src;
+        imageConvert(src, testCase.m_srcFormat, sun);
+
+        Image reference;
+        numFailed += !imageRadianceFilter(reference, 0, LightingModel::BlinnBrdf, false, 7, 10, 2, src, testCase.m_edgeFixup, 1);
+
+        RadianceFilterOptions options;
+        options.m_deviceFormat = testCase.m_format;
+
+        Image result;
+        const bool ok = imageRadianceFilter(context, result, 0, LightingModel::BlinnBrdf, false, 7, 10, 2, src
+                                          , testCase.m_edgeFixup, 0, clContext, g_allocator, &options);
+
+        RadianceFilterStats stats;
+        radianceFilterContextGetStats(context, stats);
+
+        // Output keeps the source format, compared as RGBA32F.
+        const bool sameFormat = ok && (result.m_format == testCase.m_srcFormat);
+        imageConvert(reference, TextureFormat::RGBA32F);
+        if (ok)
+        {
+            imageConvert(result, TextureFormat::RGBA32F);
+        }
+
+        const float maxError = ok ? testImageMaxError(result, reference) : FLT_MAX;
+        const bool passed = sameFormat
+                         && maxError < 0.01f
+                         && 0 == stats.m_cpuRows
+                         && testCase.m_expected == stats.m_deviceFormat
+                         ;
+        numFailed += !passed;
+
+        printf("Radiance OpenCL %-20s device %s, max error: %g ... %s\n"
+              , testCase.m_name
+              , DeviceFormat::Half == stats.m_deviceFormat ? "half " : "float"
+              , maxError
+              , passed ? "ok" : "FAILED"
+              );
+
+        imageUnload(result);
+        imageUnload(reference);
+        imageUnload(src);
+    }
+
+    radianceFilterContextDestroy(context);
+    imageUnload(sun);
+    testClShutdown(clContext);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if CMFT_PLATFORM_LINUX || CMFT_PLATFORM_APPLE
+/// Returns the number of program binaries in _dir, removing them and anything else in it when _remove is set.
+static uint32_t testClCacheFiles(const char* _dir, bool _remove)
+{
+    uint32_t numBinaries = 0;
+
+    DIR* dir = opendir(_dir);
+    if (NULL == dir)
+    {
+        return 0;
+    }
+
+    for (struct dirent* entry = readdir(dir); NULL != entry; entry = readdir(dir))
+    {
+        const char* name = entry->d_name;
+        if ('.' == name[0])
+        {
+            continue;
+        }
+
+        const size_t len = strlen(name);
+        numBinaries += (0 == strncmp(name, "cmft_", 5) && len > 6 && 0 == strcmp(name+len-6, ".clbin"));
+
+        if (_remove)
+        {
+            char filePath[CMFT_PATH_LEN];
+            cmft::snprintf(filePath, sizeof(filePath), "%s/%s", _dir, name);
+            remove(filePath);
+        }
+    }
+
+    closedir(dir);
+
+    return numBinaries;
+}
+#endif // CMFT_PLATFORM_
+
+/// Checks program cache counters and binaries on disk: the first filter compiles and stores the program,
+/// the same context reuses it, a new context loads the stored binary and other defines compile a new one.
+/// Device results are compared with the cpu filter. Needs an OpenCL CPU device such as PoCL and is skipped without one.
+int testClProgramCache()
+{
+    using namespace cmft;
+
+#if CMFT_PLATFORM_LINUX || CMFT_PLATFORM_APPLE
+    ClContext* clContext = testClInit();
+    if (NULL == clContext)
+    {
+        printf("OpenCL program cache ... skipped, no OpenCL device\n");
+        return EXIT_SUCCESS;
+    }
+
+    char cacheDir[] = "/tmp/cmft_clcache_XXXXXX";
+    if (NULL == mkdtemp(cacheDir))
+    {
+        printf("OpenCL program cache ... FAILED, could not create %s\n", cacheDir);
+        testClShutdown(clContext);
+        return EXIT_FAILURE;
+    }
+
+    clSetProgramCacheDir(cacheDir);
+
+    uint32_t numFailed = 0;
+
+    Image src;
+    testCreateSunCubemap(src, 32);
+
+    RadianceFilterOptions options;
+    options.m_deviceFormat = DeviceFormat::Float;
+
+    Image reference[2];
+    numFailed += !imageRadianceFilter(reference[0], 0, LightingModel::BlinnBrdf, false, 5, 10, 2, src, EdgeFixup::None, 1);
+    numFailed += !imageRadianceFilter(reference[1], 0, LightingModel::BlinnBrdf, false, 5, 10, 2, src, EdgeFixup::Warp, 1);
+
+    struct Step
+    {
+        const char* m_name;
+        bool m_newContext;
+        EdgeFixup::Enum m_edgeFixup;
+        uint64_t m_hits;
+        uint64_t m_diskHits;
+        uint64_t m_misses;
+        uint64_t m_diskWrites;
+        uint32_t m_numFiles;
+    };
+
+    // Expected increments of the counters and binaries on disk after each step.
+    const Step steps[] =
+    {
+        { "first build",           false, EdgeFixup::None, 0, 0, 1, 1, 1 },
+        { "same context",          false, EdgeFixup::None, 1, 0, 0, 0, 1 },
+        { "new context",           true,  EdgeFixup::None, 0, 1, 0, 0, 1 },
+        { "new context, reused",   false, EdgeFixup::None, 1, 0, 0, 0, 1 },
+        { "other defines",         false, EdgeFixup::Warp, 0, 0, 1, 1, 2 },
+    };
+
+    for (uint32_t ii = 0; ii < CMFT_COUNTOF(steps); ++ii)
+    {
+        const Step& step = steps[ii];
+
+        if (step.m_newContext)
+        {
+            // Programs built on the old context are released with it, only the binaries on disk remain.
+            clDestroy(clContext);
+            clContext = clInit(CMFT_CL_VENDOR_ANY_GPU|CMFT_CL_VENDOR_ANY_CPU|CMFT_CL_VENDOR_OTHER, CMFT_CL_DEVICE_TYPE_CPU);
+            if (NULL == clContext)
+            {
+                printf("OpenCL program cache %s ... FAILED, no OpenCL device\n", step.m_name);
+                ++numFailed;
+                break;
+            }
+        }
+
+        ClProgramCacheStats before;
+        clProgramCacheGetStats(before);
+
+        Image result;
+        const bool ok = imageRadianceFilter(result, 0, LightingModel::BlinnBrdf, false, 5, 10, 2, src
+                                          , step.m_edgeFixup, 0, clContext, g_allocator, &options);
+
+        ClProgramCacheStats after;
+        clProgramCacheGetStats(after);
+
+        const uint32_t numFiles = testClCacheFiles(cacheDir, false);
+        const Image& ref = reference[EdgeFixup::Warp == step.m_edgeFixup];
+        const float maxError = ok ? testImageMaxError(result, ref) : FLT_MAX;
+        const bool passed = ok
+                         && maxError < 0.01f
+                         && after.m_hits       - before.m_hits       == step.m_hits
+                         && after.m_diskHits   - before.m_diskHits   == step.m_diskHits
+                         && after.m_misses     - before.m_misses     == step.m_misses
+                         && after.m_diskWrites - before.m_diskWrites == step.m_diskWrites
+                         && numFiles == step.m_numFiles
+                         ;
+        numFailed += !passed;
+
+        printf("OpenCL program cache %-20s hits %u disk hits %u misses %u writes %u, binaries %u, max error: %g ... %s\n"
+              , step.m_name
+              , uint32_t(after.m_hits       - before.m_hits)
+              , uint32_t(after.m_diskHits   - before.m_diskHits)
+              , uint32_t(after.m_misses     - before.m_misses)
+              , uint32_t(after.m_diskWrites - before.m_diskWrites)
+              , numFiles
+              , maxError
+              , passed ? "ok" : "FAILED"
+              );
+
+        imageUnload(result);
+    }
+
+    clSetProgramCacheDir(NULL);
+    testClCacheFiles(cacheDir, true);
+    rmdir(cacheDir);
+
+    imageUnload(reference[1]);
+    imageUnload(reference[0]);
+    imageUnload(src);
+
+    if (NULL != clContext)
+    {
+        testClShutdown(clContext);
+    }
+    else
+    {
+        clUnload();
+    }
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+    printf("OpenCL program cache ... skipped, test needs a posix temp dir\n");
+    return EXIT_SUCCESS;
+#endif // CMFT_PLATFORM_
+}
+
+/// Filters the same cubemap repeatedly and checks that cached tables give the same results,
+/// that repeated calls only hit the cache and that nothing is kept when the max size is 0.
+int testTableCache()
+{
+    using namespace cmft;
+
+    Image src;
+    testCreateSunCubemap(src, 256);
+
+    tableCacheClear();
+
+    uint32_t numFailed = 0;
+
+    // Irradiance, building the tables on the first call only.
+    Image irradiance[2];
+    double irradianceTime[2];
+    TableCacheStats stats[2];
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        const int64_t start = getHPCounter();
+        imageIrradianceFilterSh(irradiance[ii], 0, src);
+        irradianceTime[ii] = double(getHPCounter()-start)/double(getHPFrequency());
+        tableCacheGetStats(stats[ii]);
+    }
+    numFailed += 0 != memcmp(irradiance[0].m_data, irradiance[1].m_data, irradiance[0].m_dataSize);
+    numFailed += stats[1].m_misses != stats[0].m_misses || stats[1].m_hits <= stats[0].m_hits;
+
+    // Radiance, cached and with tables freed after every use.
+    Image radiance[2];
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        tableCacheSetMaxSize(0 == ii ? UINT64_C(256)<<20 : 0);
+        numFailed += !imageRadianceFilter(radiance[ii], 64, LightingModel::BlinnBrdf, false, 6, 10, 2, src, EdgeFixup::Warp, 1);
+    }
+    numFailed += 0 != memcmp(radiance[0].m_data, radiance[1].m_data, radiance[0].m_dataSize);
+
+    TableCacheStats emptyStats;
+    tableCacheGetStats(emptyStats);
+    numFailed += 0 != emptyStats.m_numTables || 0 != emptyStats.m_size;
+
+    tableCacheSetMaxSize(UINT64_C(256)<<20);
+
+    printf("Table cache irradiance time: %.3fs, cached: %.3fs, hits: %u, misses: %u, evictions: %u ... %s\n"
+          , irradianceTime[0]
+          , irradianceTime[1]
+          , uint32_t(emptyStats.m_hits)
+          , uint32_t(emptyStats.m_misses)
+          , uint32_t(emptyStats.m_evictions)
+          , 0 == numFailed ? "ok" : "FAILED"
+          );
+
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        imageUnload(irradiance[ii]);
+        imageUnload(radiance[ii]);
+    }
+    imageUnload(src);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Projects a sky gradient, whose only non zero coefficients are known analytically, and checks that
+/// results do not depend on the number of workers, that coarser mips project close to the base and
+/// that L2 and L8 agree with the default L4 on the shared bands.
+int testShCoeffs()
+{
+    using namespace cmft;
+
+    uint32_t numFailed = 0;
+
+    Image src;
+    testCreateSunCubemap(src, 512, 0.0f);
+    imageGenerateMipMapChain(src, 3);
+
+    // Sky is (0.5 + 0.5*y)*color, which projects to bands 0 and 1 only.
+    const double color[3] = { 0.3, 0.5, 0.9 };
+    double expected[SH_COEFF_NUM][3];
+    memset(expected, 0, sizeof(expected));
+    for (uint8_t ch = 0; ch < 3; ++ch)
+    {
+        expected[0][ch] =  0.5*color[ch] * 2.0*sqrt(M_PI);
+        expected[1][ch] = -0.5*color[ch] * sqrt(3.0/(4.0*M_PI)) * (4.0*M_PI/3.0);
+    }
+
+    double shCoeffs[2][SH_COEFF_NUM][3];
+    double shTime[2];
+    const uint8_t numWorkers[2] = { 0, 3 };
+    for (uint8_t ii = 0; ii < 2; ++ii)
+    {
+        threadPoolInit(numWorkers[ii]);
+
+        const int64_t start = getHPCounter();
+        numFailed += !imageShCoeffs(shCoeffs[ii], src);
+        shTime[ii] = double(getHPCounter()-start)/double(getHPFrequency());
+    }
+    numFailed += 0 != memcmp(shCoeffs[0], shCoeffs[1], sizeof(shCoeffs[0]));
+
+    double maxError = 0.0;
+    for (uint8_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
+    {
+        for (uint8_t ch = 0; ch < 3; ++ch)
+        {
+            maxError = CMFT_MAX(maxError, fabs(shCoeffs[0][coeff][ch] - expected[coeff][ch]));
+        }
+    }
+    numFailed += maxError > 1e-4;
+
+    // Downsampling keeps the low frequencies.
+    double maxMipError = 0.0;
+    for (uint8_t mip = 1; mip < 3; ++mip)
+    {
+        double mipCoeffs[SH_COEFF_NUM][3];
+        numFailed += !imageShCoeffs(mipCoeffs, src, g_allocator, mip);
+        for (uint8_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
+        {
+            for (uint8_t ch = 0; ch < 3; ++ch)
+            {
+                maxMipError = CMFT_MAX(maxMipError, fabs(mipCoeffs[coeff][ch] - shCoeffs[0][coeff][ch]));
+            }
+        }
+    }
+    numFailed += maxMipError > 1e-2;
+
+    double unused[SH_COEFF_NUM][3];
+    numFailed += imageShCoeffs(unused, src, g_allocator, 3);
+
+    // Lower orders evaluate the same bands, recurrence of higher orders matches the closed form.
+    double l2Coeffs[SH_MAX_COEFF_NUM][3];
+    numFailed += !imageShCoeffs(l2Coeffs, 2, src);
+    numFailed += 0 != memcmp(l2Coeffs, shCoeffs[0], shCoeffNum(2)*sizeof(double)*3);
+
+    double l8Coeffs[SH_MAX_COEFF_NUM][3];
+    numFailed += !imageShCoeffs(l8Coeffs, 8, src);
+
+    double maxOrderError = 0.0;
+    for (uint32_t coeff = 0; coeff < SH_MAX_COEFF_NUM; ++coeff)
+    {
+        for (uint8_t ch = 0; ch < 3; ++ch)
+        {
+            const double reference = (coeff < SH_COEFF_NUM) ? shCoeffs[0][coeff][ch] : 0.0;
+            maxOrderError = CMFT_MAX(maxOrderError, fabs(l8Coeffs[coeff][ch] - reference));
+        }
+    }
+    numFailed += maxOrderError > 1e-4;
+    numFailed += imageShCoeffs(l8Coeffs, SH_MAX_BAND+1, src);
+
+    uint32_t faceOffsets[6];
+    imageGetFaceOffsets(faceOffsets, src);
+    numFailed += cubemapShCoeffs(l8Coeffs, SH_MAX_BAND+1, src.m_data, src.m_width, faceOffsets);
+
+    printf("Sh coeffs time: %.3fs, 3 workers: %.3fs, max error: %g, mip error: %g, L8 error: %g ... %s\n"
+          , shTime[0]
+          , shTime[1]
+          , maxError
+          , maxMipError
+          , maxOrderError
+          , 0 == numFailed ? "ok" : "FAILED"
+          );
+
+    imageUnload(src);
+
+    threadPoolShutdown();
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Reconstructs irradiance from the cached basis table and from per block basis evaluation, with and
+/// without workers, and checks that all results are the same and close to the double precision reference.
+int testIrradianceSh()
+{
+    using namespace cmft;
+
+    uint32_t numFailed = 0;
+
+    Image src;
+    testCreateSunCubemap(src, 128);
+
+    // Sky only, irradiance of (0.5 + 0.5*y)*color is (0.5 + 1/3*y)*color.
+    Image sky;
+    testCreateSunCubemap(sky, 64, 0.0f);
+
+    TableCacheStats stats;
+    tableCacheGetStats(stats);
+    const uint64_t maxSize = stats.m_maxSize;
+
+    Image irradiance[3];
+    double irradianceTime[3];
+    const uint8_t numWorkers[3] = { 0, 3, 3 };
+    for (uint8_t ii = 0; ii < 3; ++ii)
+    {
+        threadPoolInit(numWorkers[ii]);
+
+        // Last run does not fit the table into the cache.
+        tableCacheSetMaxSize(2 == ii ? 0 : maxSize);
+
+        const int64_t start = getHPCounter();
+        numFailed += !imageIrradianceFilterSh(irradiance[ii], 256, src);
+        irradianceTime[ii] = double(getHPCounter()-start)/double(getHPFrequency());
+    }
+    tableCacheSetMaxSize(maxSize);
+
+    for (uint8_t ii = 1; ii < 3; ++ii)
+    {
+        numFailed += 0 != memcmp(irradiance[0].m_data, irradiance[ii].m_data, irradiance[0].m_dataSize);
+    }
+
+    Image skyIrradiance;
+    numFailed += !imageIrradianceFilterSh(skyIrradiance, 0, sky);
+
+    uint32_t faceOffsets[CUBE_FACE_NUM];
+    imageGetFaceOffsets(faceOffsets, skyIrradiance);
+
+    const float color[3] = { 0.3f, 0.5f, 0.9f };
+    float maxError = 0.0f;
+    for (uint8_t face = 0; face < 6; ++face)
+    {
+        const float* texel = (const float*)((const uint8_t*)skyIrradiance.m_data + faceOffsets[face]);
+        for (uint32_t yy = 0; yy < 64; ++yy)
+        {
+            for (uint32_t xx = 0; xx < 64; ++xx, texel += 4)
+            {
+                const float uu = (float(int32_t(xx))+0.5f)/64.0f*2.0f - 1.0f;
+                const float vv = (float(int32_t(yy))+0.5f)/64.0f*2.0f - 1.0f;
+
+                float vec[3];
+                texelCoordToVec(vec, uu, vv, face);
+
+                for (uint8_t ch = 0; ch < 3; ++ch)
+                {
+                    const float expected = (0.5f + vec[1]/3.0f)*color[ch];
+                    maxError = CMFT_MAX(maxError, fabsf(texel[ch] - expected));
+                }
+            }
+        }
+    }
+    numFailed += maxError > 1e-4f;
+
+    printf("Irradiance sh time: %.3fs, 3 workers: %.3fs, without table: %.3fs, max error: %g ... %s\n"
+          , irradianceTime[0]
+          , irradianceTime[1]
+          , irradianceTime[2]
+          , maxError
+          , 0 == numFailed ? "ok" : "FAILED"
+          );
+
+    for (uint8_t ii = 0; ii < 3; ++ii)
+    {
+        imageUnload(irradiance[ii]);
+    }
+    imageUnload(skyIrradiance);
+    imageUnload(sky);
+    imageUnload(src);
+
+    threadPoolShutdown();
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Rotates coefficients by identity and back and forth, and compares yaw rotated coefficients with
+/// the projection of a cubemap with the rotated sun. Rotation needs orthonormal basis, so closed form
+/// bands of L4 are checked against the recurrence of L8 as well.
+int testShRotate()
+{
+    using namespace cmft;
+
+    uint32_t numFailed = 0;
+
+    const float sunDir[3] = { 0.48f, 0.64f, 0.6f };
+    const float yaw = 1.2f;
+    const float rotation[9] =
+    {
+         cosf(yaw), 0.0f, sinf(yaw),
+         0.0f,      1.0f, 0.0f,
+        -sinf(yaw), 0.0f, cosf(yaw),
+    };
+    const float inverse[9] =
+    {
+        rotation[0], rotation[3], rotation[6],
+        rotation[1], rotation[4], rotation[7],
+        rotation[2], rotation[5], rotation[8],
+    };
+    const float identity[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+    Image src;
+    testCreateSunCubemap(src, 256, 50.0f, sunDir);
+
+    double shCoeffs[SH_MAX_COEFF_NUM][3];
+    numFailed += !imageShCoeffs(shCoeffs, SH_MAX_BAND, src);
+
+    double closedForm[SH_COEFF_NUM][3];
+    numFailed += !imageShCoeffs(closedForm, src);
+
+    double maxBasisError = 0.0;
+    for (uint32_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
+    {
+        for (uint8_t ch = 0; ch < 3; ++ch)
+        {
+            maxBasisError = CMFT_MAX(maxBasisError, fabs(closedForm[coeff][ch] - shCoeffs[coeff][ch]));
+        }
+    }
+    numFailed += maxBasisError > 1e-4;
+
+    double same[SH_MAX_COEFF_NUM][3];
+    numFailed += !shCoeffsRotate(same, shCoeffs, SH_MAX_BAND, identity);
+
+    double back[SH_MAX_COEFF_NUM][3];
+    numFailed += !shCoeffsRotate(back, shCoeffs, SH_MAX_BAND, rotation);
+    numFailed += !shCoeffsRotate(back, back, SH_MAX_BAND, inverse);
+
+    // Bands above SH_MAX_BAND are rejected before touching the coefficients.
+    numFailed += shCoeffsRotate(back, back, SH_MAX_BAND+1, identity);
+
+    double maxIdentityError = 0.0;
+    for (uint32_t coeff = 0; coeff < SH_MAX_COEFF_NUM; ++coeff)
+    {
+        for (uint8_t ch = 0; ch < 3; ++ch)
+        {
+            maxIdentityError = CMFT_MAX(maxIdentityError, fabs(same[coeff][ch] - shCoeffs[coeff][ch]));
+            maxIdentityError = CMFT_MAX(maxIdentityError, fabs(back[coeff][ch] - shCoeffs[coeff][ch]));
+        }
+    }
+    // Float rotation matrix is orthonormal up to float precision.
+    numFailed += maxIdentityError > 1e-6;
+
+    // Sky gradient is invariant to yaw, only the sun moves.
+    float rotatedSunDir[3];
+    for (uint8_t ii = 0; ii < 3; ++ii)
+    {
+        rotatedSunDir[ii] = rotation[ii*3+0]*sunDir[0] + rotation[ii*3+1]*sunDir[1] + rotation[ii*3+2]*sunDir[2];
+    }
+
+    Image rotatedSrc;
+    testCreateSunCubemap(rotatedSrc, 256, 50.0f, rotatedSunDir);
+
+    double projected[SH_COEFF_NUM][3];
+    numFailed += !imageShCoeffs(projected, rotatedSrc);
+
+    const int64_t start = getHPCounter();
+    double rotated[SH_COEFF_NUM][3];
+    numFailed += !shCoeffsRotate(rotated, shCoeffs, 4, rotation);
+    const double rotateTime = double(getHPCounter()-start)/double(getHPFrequency());
+
+    double maxError = 0.0;
+    double maxCoeff = 0.0;
+    for (uint32_t coeff = 0; coeff < SH_COEFF_NUM; ++coeff)
+    {
+        for (uint8_t ch = 0; ch < 3; ++ch)
+        {
+            maxError = CMFT_MAX(maxError, fabs(rotated[coeff][ch] - projected[coeff][ch]));
+            maxCoeff = CMFT_MAX(maxCoeff, fabs(projected[coeff][ch]));
+        }
+    }
+    numFailed += maxError > 0.005*maxCoeff;
+
+    printf("Sh rotate time: %.6fs, basis error: %g, identity error: %g, rotated error: %g of %g ... %s\n"
+          , rotateTime
+          , maxBasisError
+          , maxIdentityError
+          , maxError
+          , maxCoeff
+          , 0 == numFailed ? "ok" : "FAILED"
+          );
+
+    imageUnload(rotatedSrc);
+    imageUnload(src);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Filters _src exhaustively and with SH reconstruction of mips below _powerThreshold, reports times of both and
+/// compares them per mip. Returns number of failed checks.
+static int testRadianceShCase(const cmft::Image& _src
+                            , uint32_t _dstFaceSize
+                            , cmft::LightingModel::Enum _lightingModel
+                            , const char* _name
+                            , uint8_t _mipCount
+                            , uint8_t _glossScale
+                            , uint8_t _glossBias
+                            , float _powerThreshold
+                            , bool _expectSh
+                            )
+{
+    using namespace cmft;
+
+    int numFailed = 0;
+
+    Image reference;
+    imageCopy(reference, _src);
+    int64_t start = getHPCounter();
+    const bool okRef = imageRadianceFilter(reference, _dstFaceSize, _lightingModel, false, _mipCount, _glossScale, _glossBias, EdgeFixup::None, 1);
+    const double timeRef = double(getHPCounter()-start)/double(getHPFrequency());
+
+    RadianceFilterOptions options;
+    options.m_shPowerThreshold = _powerThreshold;
+
+    Image result;
+    imageCopy(result, _src);
+    start = getHPCounter();
+    const bool ok = imageRadianceFilter(result, _dstFaceSize, _lightingModel, false, _mipCount, _glossScale, _glossBias
+                                      , EdgeFixup::None, 1, NULL, g_allocator, &options);
+    const double time = double(getHPCounter()-start)/double(getHPFrequency());
+
+    if (!okRef || !ok)
+    {
+        printf("Radiance SH %s ... FAILED\n", _name);
+        imageUnload(result);
+        imageUnload(reference);
+        return 1;
+    }
+
+    // Where SH does not pay off every mip is filtered texel by texel, where it does it must be faster.
+    const bool fast = !_expectSh || time < timeRef;
+    printf("Radiance SH %s %u to %u time: %.3fs, exhaustive: %.3fs, speedup: %.1fx%s ... %s\n"
+          , _name, _src.m_width, result.m_width, time, timeRef, timeRef/CMFT_MAX(time, 1e-9)
+          , _expectSh ? "" : " (SH not used)", fast ? "ok" : "FAILED");
+    numFailed += int(!fast);
+
+    // Thresholds above the bound are clamped to it.
+    RadianceFilterOptions clampedOptions;
+    clampedOptions.m_shPowerThreshold = 2.0f*_powerThreshold;
+
+    Image clamped;
+    imageCopy(clamped, _src);
+    const bool okClamped = imageRadianceFilter(clamped, _dstFaceSize, _lightingModel, false, _mipCount, _glossScale, _glossBias
+                                             , EdgeFixup::None, 1, NULL, g_allocator, &clampedOptions);
+    const bool sameClamped = okClamped && clamped.m_dataSize == result.m_dataSize && 0 == memcmp(clamped.m_data, result.m_data, result.m_dataSize);
+    printf("Radiance SH %s threshold %.1f clamped to %.1f ... %s\n", _name, 2.0f*_powerThreshold, _powerThreshold, sameClamped ? "ok" : "FAILED");
+    numFailed += int(!sameClamped);
+    imageUnload(clamped);
+
+    uint32_t offsets[CUBE_FACE_NUM][MAX_MIP_NUM];
+    imageGetMipOffsets(offsets, reference);
+
+    for (uint8_t mip = 0; mip < _mipCount; ++mip)
+    {
+        const float specularPower = applyLightningModel(specularPowerFor(float(mip), float(_mipCount), float(_glossScale), float(_glossBias)), _lightingModel);
+        const uint32_t mipFaceSize = CMFT_MAX(result.m_width >> mip, UINT32_C(1));
+
+        double peak = 0.0;
+        double sqError = 0.0;
+        for (uint8_t face = 0; face < 6; ++face)
+        {
+            const float* ref = (const float*)((const uint8_t*)reference.m_data + offsets[face][mip]);
+            const float* res = (const float*)((const uint8_t*)result.m_data + offsets[face][mip]);
+            for (uint32_t ii = 0; ii < mipFaceSize*mipFaceSize*4; ++ii)
+            {
+                const double diff = double(res[ii]) - double(ref[ii]);
+                sqError += diff*diff;
+                peak = CMFT_MAX(peak, double(ref[ii]));
+            }
+        }
+        const double rms = sqrt(sqError/double(mipFaceSize*mipFaceSize*24));
+
+        // Mips above the threshold are filtered as before, SH mips lose lobe energy above band SH_MAX_BAND.
+        const bool sh = _expectSh && specularPower < _powerThreshold;
+        const bool passed = sh ? (rms < 0.01*peak) : (0.0 == rms);
+        printf("Radiance SH %s mip %u %ux%u power %.2f%s rms error: %.3f%% of peak ... %s\n"
+              , _name, mip, mipFaceSize, mipFaceSize, specularPower, sh ? " (SH)" : ""
+              , 100.0*rms/CMFT_MAX(peak, 1e-9), passed ? "ok" : "FAILED");
+        numFailed += int(!passed);
+    }
+
+    imageUnload(result);
+    imageUnload(reference);
+
+    return numFailed;
+}
+
+/// Reconstructs the roughest mips from SH and compares them with the exhaustive filter, per mip.
+int testRadianceSh()
+{
+    using namespace cmft;
+
+    const float powerThreshold = 8.0f;
+
+    int numFailed = 0;
+
+    // Only the last mips of a small source are rough enough, projecting the source would cost more than
+    // filtering them, so every mip is filtered exactly as before.
+    Image src;
+    testCreateSunCubemap(src, 64);
+    numFailed += testRadianceShCase(src, 0, LightingModel::Phong,     "phong",     7, 10, 2, powerThreshold, false);
+    numFailed += testRadianceShCase(src, 0, LightingModel::BlinnBrdf, "blinnbrdf", 7, 10, 2, powerThreshold, false);
+    imageUnload(src);
+
+    // Rough 32x32 and 16x16 mips of a large source, where the exhaustive filter integrates most of the sphere per texel.
+    Image large;
+    testCreateSunCubemap(large, 256);
+    numFailed += testRadianceShCase(large, 32, LightingModel::Phong, "phong", 6, 2, 0, powerThreshold, true);
+    imageUnload(large);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Converts random pixels to and from every format with imageFromRgba32f()/imageToRgba32f(), checks them against
+/// the per pixel functions and reports throughput of both.
+int testImageConvert()
+{
+    using namespace cmft;
+
+    // Odd size, so bulk converters leave a few pixels to the scalar loop.
+    const uint32_t faceSize = 255;
+
+    Image src;
+    imageCreate(src, faceSize, faceSize, 0, 1, 6, TextureFormat::RGBA32F);
+
+    const uint32_t numPixels = imageGetNumPixels(src);
+    float* srcData = (float*)src.m_data;
+    uint32_t seed = 13;
+    for (uint32_t ii = 0; ii < numPixels*4; ++ii)
+    {
+        // Mostly [0.0, 1.1] with some hdr values, negative values, zeros and powers of two.
+        const float rnd = testRandf(seed);
+        const float scale = (ii%16 < 12) ? 1.1f : ldexpf(1.0f, int32_t(testRandf(seed)*24.0f) - 12);
+        srcData[ii] = (ii%61 == 0) ? -rnd
+                    : (ii%67 == 0) ? 0.0f
+                    : (ii%71 == 0) ? scale
+                    : rnd*scale
+                    ;
+    }
+
+    static const TextureFormat::Enum s_formats[] =
+    {
+        TextureFormat::BGR8,
+        TextureFormat::RGB8,
+        TextureFormat::RGB16,
+        TextureFormat::RGB16F,
+        TextureFormat::RGB32F,
+        TextureFormat::RGBE,
+        TextureFormat::BGRA8,
+        TextureFormat::RGBA8,
+        TextureFormat::RGBA16,
+        TextureFormat::RGBA16F,
+    };
+
+    const double toMpix = double(numPixels)*1e-6;
+    const double freq = double(getHPFrequency());
+
+    int numFailed = 0;
+    for (uint8_t ff = 0; ff < CMFT_COUNTOF(s_formats); ++ff)
+    {
+        const TextureFormat::Enum format = s_formats[ff];
+        const uint32_t bytesPerPixel = getImageDataInfo(format).m_bytesPerPixel;
+        const bool half = (TextureFormat::RGB16F == format || TextureFormat::RGBA16F == format);
+
+        // From rgba32f.
+        Image encoded;
+        int64_t start = getHPCounter();
+        imageFromRgba32f(encoded, format, src);
+        const double timeFrom = double(getHPCounter()-start)/freq;
+
+        uint8_t* reference = (uint8_t*)malloc(numPixels*bytesPerPixel);
+        start = getHPCounter();
+        for (uint32_t ii = 0; ii < numPixels; ++ii)
+        {
+            fromRgba32f(reference + ii*bytesPerPixel, format, srcData + ii*4);
+        }
+        const double timeFromRef = double(getHPCounter()-start)/freq;
+
+        uint32_t mismatchFrom = 0;
+        if (half)
+        {
+            // F16C rounds to nearest even, results have to be at least as close to the source as the per pixel ones.
+            const uint8_t numChannels = (TextureFormat::RGB16F == format) ? 3 : 4;
+            for (uint32_t ii = 0; ii < numPixels; ++ii)
+            {
+                float res[4];
+                float ref[4];
+                toRgba32f(res, format, (const uint8_t*)encoded.m_data + ii*bytesPerPixel);
+                toRgba32f(ref, format, reference + ii*bytesPerPixel);
+
+                const float* value = srcData + ii*4;
+                for (uint8_t ch = 0; ch < numChannels; ++ch)
+                {
+                    mismatchFrom += uint32_t(fabsf(res[ch]-value[ch]) > fabsf(ref[ch]-value[ch]));
+                }
+            }
+        }
+        else
+        {
+            for (uint32_t ii = 0; ii < numPixels*bytesPerPixel; ++ii)
+            {
+                mismatchFrom += uint32_t(((const uint8_t*)encoded.m_data)[ii] != reference[ii]);
+            }
+        }
+
+        // To rgba32f.
+        Image decoded;
+        start = getHPCounter();
+        imageToRgba32f(decoded, encoded);
+        const double timeTo = double(getHPCounter()-start)/freq;
+
+        float* referenceRgba32f = (float*)malloc(numPixels*4*sizeof(float));
+        start = getHPCounter();
+        for (uint32_t ii = 0; ii < numPixels; ++ii)
+        {
+            toRgba32f(referenceRgba32f + ii*4, format, (const uint8_t*)encoded.m_data + ii*bytesPerPixel);
+        }
+        const double timeToRef = double(getHPCounter()-start)/freq;
+
+        const uint32_t mismatchTo = uint32_t(0 != memcmp(decoded.m_data, referenceRgba32f, numPixels*4*sizeof(float)));
+
+        const bool passed = (0 == mismatchFrom && 0 == mismatchTo);
+        printf("Convert %-8s from rgba32f: %7.1f Mpix/s (per pixel %6.1f)  to rgba32f: %7.1f Mpix/s (per pixel %6.1f) ... %s\n"
+              , getTextureFormatStr(format)
+              , toMpix/CMFT_MAX(timeFrom, 1e-9), toMpix/CMFT_MAX(timeFromRef, 1e-9)
+              , toMpix/CMFT_MAX(timeTo,   1e-9), toMpix/CMFT_MAX(timeToRef,   1e-9)
+              , passed ? "ok" : "FAILED"
+              );
+        numFailed += int(!passed);
+
+        free(referenceRgba32f);
+        free(reference);
+        imageUnload(decoded);
+        imageUnload(encoded);
+    }
+
+    imageUnload(src);
+
+    return (0 == numFailed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int testsMain(int /*_argc*/, char const* const* /*_argv*/)
 {
+    testRadianceKernels();
+    testRadianceLobeMath();
+    testRadianceComputedNormals();
+    testRadianceSourceMips();
+    testRadianceTileCulling();
+    testRadianceAccumulation();
+    testRadianceSourceFormats();
+    testRadianceGgx();
+    testThreadPool();
+    testRadianceFilterContext();
+    testRadianceFilterBatch();
+    testRadianceOpenCl();
+    testRadianceOpenClBatch();
+    testRadianceOpenClHalf();
+    testClProgramCache();
+    testTableCache();
+    testShCoeffs();
+    testIrradianceSh();
+    testShRotate();
+    testRadianceSh();
+    testImageConvert();
     test(s_radianceTest);
     //test(s_tgaRadianceTest);
     //test(s_outputTest);